@@ -0,0 +1,213 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <string.h>
+
+
+#include <cryptopp/dll.h>
+
+#include "threshsign/ThresholdSignaturesTypes.h"
+#include "Crypto.hpp"
+#include "MsgCode.hpp"
+#include "BenchCluster.hpp"
+
+namespace bftEngine {
+namespace bench {
+
+static const unsigned int rsaKeyLength = 2048;
+
+static std::pair<std::string, std::string> generateRsaKey(
+    CryptoPP::RandomPool& randGen) {
+  std::pair<std::string, std::string> keyPair;
+
+  CryptoPP::RSAES<CryptoPP::OAEP<CryptoPP::SHA256>>::Decryptor
+    priv(randGen, rsaKeyLength);
+  CryptoPP::HexEncoder privEncoder(new CryptoPP::StringSink(keyPair.first));
+  priv.DEREncode(privEncoder);
+  privEncoder.MessageEnd();
+
+  CryptoPP::RSAES<CryptoPP::OAEP<CryptoPP::SHA256>>::Encryptor pub(priv);
+  CryptoPP::HexEncoder pubEncoder(new CryptoPP::StringSink(keyPair.second));
+  pub.DEREncode(pubEncoder);
+  pubEncoder.MessageEnd();
+
+  return keyPair;
+}
+
+static std::pair<std::string, std::string> generateEdDSAKey() {
+  std::pair<std::string, std::string> keyPair;
+  impl::EdDSAKeysGenerator::generateKeys(keyPair.second, keyPair.first);
+  return keyPair;
+}
+
+static Cryptosystem* generateCryptosystem(uint16_t n, uint16_t threshold) {
+  Cryptosystem* sys = new Cryptosystem("threshold-bls", "BN-P254", n,
+                                       threshold);
+  sys->generateNewPseudorandomKeys();
+  return sys;
+}
+
+static void createSignerAndVerifier(const Cryptosystem& sys,
+                                    uint16_t replicaId,
+                                    IThresholdSigner*& outSigner,
+                                    IThresholdVerifier*& outVerifier) {
+  // signer IDs are 1-indexed
+  const uint16_t signerId = replicaId + 1;
+  Cryptosystem replicaSys(sys);
+  replicaSys.loadPrivateKey(signerId, sys.getPrivateKey(signerId));
+
+  outSigner = replicaSys.createThresholdSigner();
+  outVerifier = replicaSys.createThresholdVerifier();
+}
+
+ClusterKeys::ClusterKeys(uint16_t f, uint16_t c, SignatureScheme sigScheme)
+    : f_(f), c_(c), n_(3 * f + 2 * c + 1), sigScheme_(sigScheme) {
+  CryptoPP::RandomPool randGen;
+  for (uint16_t i = 0; i < n_; i++) {
+    replicaKeys_.push_back(sigScheme == SignatureScheme::EdDSA
+                               ? generateEdDSAKey()
+                               : generateRsaKey(randGen));
+  }
+
+  // same thresholds as in GenerateConcordKeys
+  execSys_.reset(generateCryptosystem(n_, f + 1));
+  slowSys_.reset(generateCryptosystem(n_, f * 2 + c + 1));
+  commitSys_.reset(generateCryptosystem(n_, f * 3 + c + 1));
+  optSys_.reset(generateCryptosystem(n_, n_));
+}
+
+ClusterKeys::~ClusterKeys() {}
+
+void ClusterKeys::fillReplicaConfig(uint16_t replicaId,
+                                    ReplicaConfig& config) const {
+  config.fVal = f_;
+  config.cVal = c_;
+  config.replicaId = replicaId;
+
+  config.publicKeysOfReplicas.clear();
+  for (uint16_t i = 0; i < n_; i++)
+    config.publicKeysOfReplicas.insert(
+        std::pair<uint16_t, std::string>(i, replicaKeys_[i].second));
+  config.replicaPrivateKey = replicaKeys_[replicaId].first;
+  config.replicaSignatureScheme = sigScheme_;
+
+  createSignerAndVerifier(*execSys_, replicaId,
+                          config.thresholdSignerForExecution,
+                          config.thresholdVerifierForExecution);
+  createSignerAndVerifier(*slowSys_, replicaId,
+                          config.thresholdSignerForSlowPathCommit,
+                          config.thresholdVerifierForSlowPathCommit);
+  createSignerAndVerifier(*commitSys_, replicaId,
+                          config.thresholdSignerForCommit,
+                          config.thresholdVerifierForCommit);
+  createSignerAndVerifier(*optSys_, replicaId,
+                          config.thresholdSignerForOptimisticCommit,
+                          config.thresholdVerifierForOptimisticCommit);
+}
+
+const char* msgTypeName(uint16_t msgType) {
+  using bftEngine::impl::MsgCode;
+  switch (msgType) {
+    case MsgCode::Checkpoint: return "Checkpoint";
+    case MsgCode::CommitPartial: return "CommitPartial";
+    case MsgCode::CommitFull: return "CommitFull";
+    case MsgCode::FullCommitProof: return "FullCommitProof";
+    case MsgCode::FullExecProof: return "FullExecProof";
+    case MsgCode::NewView: return "NewView";
+    case MsgCode::PrePrepare: return "PrePrepare";
+    case MsgCode::PartialCommitProof: return "PartialCommitProof";
+    case MsgCode::PartialExecProof: return "PartialExecProof";
+    case MsgCode::PreparePartial: return "PreparePartial";
+    case MsgCode::PrepareFull: return "PrepareFull";
+    case MsgCode::ReqMissingData: return "ReqMissingData";
+    case MsgCode::SimpleAckMsg: return "SimpleAck";
+    case MsgCode::StartSlowCommit: return "StartSlowCommit";
+    case MsgCode::ViewChange: return "ViewChange";
+    case MsgCode::ReplicaStatus: return "ReplicaStatus";
+    case MsgCode::StateTransfer: return "StateTransfer";
+    case MsgCode::CompactPrePrepare: return "CompactPrePrepare";
+    case MsgCode::PrePrepareDigest: return "PrePrepareDigest";
+    case MsgCode::Request: return "Request";
+    case MsgCode::Reply: return "Reply";
+    case MsgCode::TentativeReply: return "TentativeReply";
+    default: return "Unknown";
+  }
+}
+
+static int writeCounterReply(uint64_t counter, uint32_t requestSize,
+                             uint32_t maxReplySize, char* outReply,
+                             uint32_t& outActualReplySize) {
+  uint32_t replySize = requestSize;
+  if (replySize < sizeof(counter)) replySize = sizeof(counter);
+  if (replySize > maxReplySize) return -1;
+
+  memset(outReply, 0, replySize);
+  memcpy(outReply, &counter, sizeof(counter));
+  outActualReplySize = replySize;
+  return 0;
+}
+
+int CounterRequestsHandler::execute(uint16_t clientId,
+                                    uint64_t sequenceNum,
+                                    bool readOnly,
+                                    uint32_t requestSize,
+                                    const char* request,
+                                    uint32_t maxReplySize,
+                                    char* outReply,
+                                    uint32_t& outActualReplySize) {
+  if (!readOnly) counter_++;
+
+  return writeCounterReply(counter_, requestSize, maxReplySize, outReply,
+                           outActualReplySize);
+}
+
+int CounterRequestsHandler::executeSpeculatively(uint16_t clientId,
+                                                 uint64_t sequenceNum,
+                                                 bool readOnly,
+                                                 uint32_t requestSize,
+                                                 const char* request,
+                                                 uint32_t maxReplySize,
+                                                 char* outReply,
+                                                 uint32_t& outActualReplySize) {
+  if (speculativeCounters_.empty() ||
+      speculativeCounters_.back().first != sequenceNum) {
+    const uint64_t prev = speculativeCounters_.empty()
+                              ? counter_
+                              : speculativeCounters_.back().second;
+    speculativeCounters_.emplace_back(sequenceNum, prev);
+  }
+
+  uint64_t& counter = speculativeCounters_.back().second;
+  if (!readOnly) counter++;
+
+  return writeCounterReply(counter, requestSize, maxReplySize, outReply,
+                           outActualReplySize);
+}
+
+void CounterRequestsHandler::commitSpeculative(uint64_t sequenceNum) {
+  while (!speculativeCounters_.empty() &&
+         speculativeCounters_.front().first <= sequenceNum) {
+    counter_ = speculativeCounters_.front().second;
+    speculativeCounters_.pop_front();
+  }
+}
+
+void CounterRequestsHandler::rollbackSpeculative(
+    uint64_t lastCommittedSeqNum) {
+  while (!speculativeCounters_.empty() &&
+         speculativeCounters_.back().first > lastCommittedSeqNum)
+    speculativeCounters_.pop_back();
+}
+
+}  // namespace bench
+}  // namespace bftEngine
@@ -0,0 +1,107 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#ifndef BFTENGINE_BENCH_BENCHCLUSTER_HPP_
+#define BFTENGINE_BENCH_BENCHCLUSTER_HPP_
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Replica.hpp"
+#include "ReplicaConfig.hpp"
+
+class Cryptosystem;
+
+namespace bftEngine {
+namespace bench {
+
+// Keys of all the replicas of a benchmark, generated in-process (in the same
+// way as GenerateConcordKeys generates them), so a benchmark does not depend
+// on key files.
+class ClusterKeys {
+ public:
+  // N = 3 * f + 2 * c + 1
+  ClusterKeys(uint16_t f, uint16_t c,
+              SignatureScheme sigScheme = SignatureScheme::RSA);
+  ~ClusterKeys();
+
+  uint16_t numOfReplicas() const { return n_; }
+
+  // Fills the fields of config that inputReplicaKeyfile fills: fVal, cVal,
+  // replicaId, publicKeysOfReplicas, replicaPrivateKey,
+  // replicaSignatureScheme and the threshold signers/verifiers (new objects
+  // are created on each call).
+  void fillReplicaConfig(uint16_t replicaId, ReplicaConfig& config) const;
+
+ private:
+  const uint16_t f_;
+  const uint16_t c_;
+  const uint16_t n_;
+  const SignatureScheme sigScheme_;
+
+  // pairs of (private key, public key)
+  std::vector<std::pair<std::string, std::string>> replicaKeys_;
+
+  std::unique_ptr<Cryptosystem> execSys_;
+  std::unique_ptr<Cryptosystem> slowSys_;
+  std::unique_ptr<Cryptosystem> commitSys_;
+  std::unique_ptr<Cryptosystem> optSys_;
+};
+
+// Name of a message type (the first 2 bytes of a message), for reports
+const char* msgTypeName(uint16_t msgType);
+
+// Request handler of the benchmarks: counts the executed write requests, and
+// replies with the current value of the counter (the reply has the size of
+// the request, up to maxReplySize). Supports speculative execution.
+class CounterRequestsHandler : public RequestsHandler {
+ public:
+  int execute(uint16_t clientId,
+              uint64_t sequenceNum,
+              bool readOnly,
+              uint32_t requestSize,
+              const char* request,
+              uint32_t maxReplySize,
+              char* outReply,
+              uint32_t& outActualReplySize) override;
+
+  int executeSpeculatively(uint16_t clientId,
+                           uint64_t sequenceNum,
+                           bool readOnly,
+                           uint32_t requestSize,
+                           const char* request,
+                           uint32_t maxReplySize,
+                           char* outReply,
+                           uint32_t& outActualReplySize) override;
+
+  void commitSpeculative(uint64_t sequenceNum) override;
+
+  void rollbackSpeculative(uint64_t lastCommittedSeqNum) override;
+
+ private:
+  uint64_t counter_ = 0;  // committed
+
+  // pairs of (sequence number, counter after its speculative requests), in
+  // the order of the sequence numbers
+  std::deque<std::pair<uint64_t, uint64_t>> speculativeCounters_;
+};
+
+}  // namespace bench
+}  // namespace bftEngine
+
+#endif  // BFTENGINE_BENCH_BENCHCLUSTER_HPP_
@@ -0,0 +1,232 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <string.h>
+
+#include <chrono>
+
+#include "InMemoryCommunication.hpp"
+
+namespace bftEngine {
+namespace bench {
+
+//////////////////////////////////////////////////////////////////////////////
+// InMemoryNetwork
+//////////////////////////////////////////////////////////////////////////////
+
+InMemoryNetwork::InMemoryNetwork(uint16_t numOfNodes, uint32_t maxMessageSize)
+    : maxMessageSize_(maxMessageSize), phases_(1) {
+  for (uint16_t i = 0; i < numOfNodes; i++) nodes_.emplace_back(new Node());
+}
+
+InMemoryNetwork::~InMemoryNetwork() {
+  for (size_t i = 0; i < nodes_.size(); i++) stopNode(i);
+  for (auto& n : nodes_) drain(n.get());
+}
+
+void InMemoryNetwork::setIsolated(NodeNum node, bool isolated) {
+  if (node >= nodes_.size()) return;
+  nodes_[node]->isolated = isolated;
+}
+
+void InMemoryNetwork::setPhase(uint32_t phase) {
+  std::unique_lock<std::mutex> lock(statsLock_);
+  if (phase >= phases_.size()) phases_.resize(phase + 1);
+  currentPhase_ = phase;
+}
+
+PhaseStats InMemoryNetwork::getPhaseStats(uint32_t phase) {
+  std::unique_lock<std::mutex> lock(statsLock_);
+  if (phase >= phases_.size()) return PhaseStats();
+  return phases_[phase];
+}
+
+int InMemoryNetwork::startNode(NodeNum node, IReceiver* receiver) {
+  if (node >= nodes_.size() || receiver == nullptr) return -1;
+
+  Node* n = nodes_[node].get();
+  std::unique_lock<std::mutex> lock(n->lock);
+  if (n->running) return -1;
+  if (n->deliveryThread.joinable()) {
+    // the node was stopped, and is restarted
+    lock.unlock();
+    n->deliveryThread.join();
+    lock.lock();
+  }
+  // messages that were sent while the node was stopped are dropped
+  drain(n);
+  n->receiver = receiver;
+  n->running = true;
+  n->deliveryThread = std::thread(&InMemoryNetwork::deliveryLoop, this, n);
+  return 0;
+}
+
+int InMemoryNetwork::stopNode(NodeNum node) {
+  if (node >= nodes_.size()) return -1;
+
+  Node* n = nodes_[node].get();
+  {
+    std::unique_lock<std::mutex> lock(n->lock);
+    n->running = false;
+  }
+  n->cond.notify_all();
+
+  // a node may be stopped by its own receiver (i.e. by the delivery thread)
+  if (n->deliveryThread.joinable() &&
+      n->deliveryThread.get_id() != std::this_thread::get_id())
+    n->deliveryThread.join();
+  return 0;
+}
+
+bool InMemoryNetwork::isRunning(NodeNum node) const {
+  if (node >= nodes_.size()) return false;
+  return nodes_[node]->running;
+}
+
+int InMemoryNetwork::send(NodeNum src, NodeNum dst, const char* msg,
+                          size_t len) {
+  if (dst >= nodes_.size() || len > maxMessageSize_) return -1;
+
+  uint16_t msgType = 0;
+  if (len >= sizeof(msgType)) memcpy(&msgType, msg, sizeof(msgType));
+
+  Node* d = nodes_[dst].get();
+  bool delivered = false;
+
+  if (!d->isolated && !(src < nodes_.size() && nodes_[src]->isolated) &&
+      d->running) {
+    Msg* m = new Msg();
+    m->src = src;
+    m->data.assign(msg, msg + len);
+    push(d, m);
+    delivered = true;
+
+    // pairs with the check of the delivery thread before it sleeps (both
+    // sides use sequentially consistent operations, so either the delivery
+    // thread sees the message, or this thread sees that it sleeps)
+    if (d->sleeping) {
+      std::unique_lock<std::mutex> lock(d->lock);
+      d->cond.notify_one();
+    }
+  }
+
+  if (statsEnabled_) countMessage(msgType, len, !delivered);
+  if (delivered && observer_) observer_(src, dst, msgType);
+  return 0;
+}
+
+void InMemoryNetwork::push(Node* node, Msg* msg) {
+  msg->next.store(nullptr, std::memory_order_relaxed);
+  Msg* prev = node->head.exchange(msg);
+  prev->next.store(msg, std::memory_order_release);
+}
+
+InMemoryNetwork::Msg* InMemoryNetwork::pop(Node* node) {
+  Msg* tail = node->tail;
+  Msg* next = tail->next.load(std::memory_order_acquire);
+  if (tail == &node->stub) {
+    if (next == nullptr) return nullptr;
+    node->tail = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+  if (next != nullptr) {
+    node->tail = next;
+    return tail;
+  }
+
+  // tail is the last message, unless a push is in progress
+  if (tail != node->head.load()) return nullptr;
+  push(node, &node->stub);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next == nullptr) return nullptr;
+  node->tail = next;
+  return tail;
+}
+
+bool InMemoryNetwork::mayHaveMessages(Node* node) {
+  return node->tail != &node->stub || node->head.load() != &node->stub;
+}
+
+void InMemoryNetwork::drain(Node* node) {
+  while (Msg* m = pop(node)) delete m;
+}
+
+void InMemoryNetwork::deliveryLoop(Node* node) {
+  while (node->running) {
+    Msg* m = pop(node);
+    if (m != nullptr) {
+      node->receiver->onNewMessage(m->src, m->data.data(), m->data.size());
+      delete m;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(node->lock);
+    node->sleeping = true;
+    // a push that is in progress is seen by mayHaveMessages (the thread
+    // yields the lock and retries), so the timeout is only a safety net
+    if (node->running && !mayHaveMessages(node))
+      node->cond.wait_for(lock, std::chrono::milliseconds(100));
+    node->sleeping = false;
+  }
+}
+
+void InMemoryNetwork::countMessage(uint16_t msgType, size_t len,
+                                   bool dropped) {
+  std::unique_lock<std::mutex> lock(statsLock_);
+  PhaseStats& p = phases_[currentPhase_];
+  MsgStats& s = dropped ? p.dropped : p.sent[msgType];
+  s.msgs++;
+  s.bytes += len;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// InMemoryCommunication
+//////////////////////////////////////////////////////////////////////////////
+
+int InMemoryCommunication::getMaxMessageSize() {
+  return static_cast<int>(network_->maxMessageSize());
+}
+
+int InMemoryCommunication::Start() {
+  return network_->startNode(selfId_, receiver_);
+}
+
+int InMemoryCommunication::Stop() {
+  return network_->stopNode(selfId_);
+}
+
+bool InMemoryCommunication::isRunning() const {
+  return network_->isRunning(selfId_);
+}
+
+ConnectionStatus InMemoryCommunication::getCurrentConnectionStatus(
+    const NodeNum node) const {
+  return network_->isRunning(node) ? ConnectionStatus::Connected
+                                   : ConnectionStatus::Disconnected;
+}
+
+int InMemoryCommunication::sendAsyncMessage(const NodeNum destNode,
+                                            const char* const message,
+                                            const size_t messageLength) {
+  if (!isRunning()) return -1;
+  return network_->send(selfId_, destNode, message, messageLength);
+}
+
+void InMemoryCommunication::setReceiver(NodeNum receiverNum,
+                                        IReceiver* receiver) {
+  if (receiverNum == selfId_) receiver_ = receiver;
+}
+
+}  // namespace bench
+}  // namespace bftEngine
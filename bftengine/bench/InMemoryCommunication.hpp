@@ -0,0 +1,160 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#ifndef BFTENGINE_BENCH_INMEMORYCOMMUNICATION_HPP_
+#define BFTENGINE_BENCH_INMEMORYCOMMUNICATION_HPP_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ICommunication.hpp"
+
+namespace bftEngine {
+namespace bench {
+
+// Traffic of one type of messages
+struct MsgStats {
+  uint64_t msgs = 0;
+  uint64_t bytes = 0;
+};
+
+// Traffic of one phase of a benchmark (the key is the type of the message,
+// i.e. the first 2 bytes of the message)
+struct PhaseStats {
+  std::map<uint16_t, MsgStats> sent;
+  MsgStats dropped;
+};
+
+// In-memory network between the replicas and the clients of a benchmark that
+// run in the same process. Each node has a queue of incoming messages and a
+// thread that delivers them to the node's receiver.
+// The queues are lock-free (multiple producers, a single consumer), so the
+// senders do not contend with each other or with the delivery thread. The
+// node's mutex is only used to put an idle delivery thread to sleep.
+// Faults are injected by isolating a node: all the messages that are sent to
+// or from an isolated node are dropped. The messages sent to a node that is
+// not running are also dropped.
+class InMemoryNetwork {
+ public:
+  // invoked (by the sending thread) for each message that is not dropped
+  typedef std::function<void(NodeNum src, NodeNum dst, uint16_t msgType)>
+      SendObserver;
+
+  InMemoryNetwork(uint16_t numOfNodes, uint32_t maxMessageSize);
+  ~InMemoryNetwork();
+
+  uint32_t maxMessageSize() const { return maxMessageSize_; }
+
+  // should be called before the nodes are started
+  void setObserver(SendObserver observer) { observer_ = observer; }
+
+  // The per-phase traffic stats are collected under a global lock. A
+  // benchmark that does not use them should disable them (before the nodes
+  // are started), so the stats do not serialize the senders.
+  void setTrafficStatsEnabled(bool enabled) { statsEnabled_ = enabled; }
+
+  void setIsolated(NodeNum node, bool isolated);
+
+  // messages are counted in the current phase (phases are numbered from 0)
+  void setPhase(uint32_t phase);
+  uint32_t currentPhase() const { return currentPhase_; }
+  PhaseStats getPhaseStats(uint32_t phase);
+
+  int startNode(NodeNum node, IReceiver* receiver);
+  int stopNode(NodeNum node);
+  bool isRunning(NodeNum node) const;
+
+  int send(NodeNum src, NodeNum dst, const char* msg, size_t len);
+
+ protected:
+  struct Msg {
+    std::atomic<Msg*> next{nullptr};
+    NodeNum src = 0;
+    std::vector<char> data;
+  };
+
+  // The queue of a node is an intrusive MPSC queue (D. Vyukov): the senders
+  // push at head, and the delivery thread (the only consumer) pops at tail.
+  // stub is a dummy message that keeps the queue non-empty.
+  struct Node {
+    Node() : head(&stub), tail(&stub) {}
+
+    std::atomic<Msg*> head;
+    Msg* tail;  // only accessed by the consumer
+    Msg stub;
+
+    std::mutex lock;  // start/stop, and the sleep of the delivery thread
+    std::condition_variable cond;
+    std::atomic<bool> sleeping{false};
+
+    IReceiver* receiver = nullptr;
+    std::atomic<bool> running{false};
+    std::thread deliveryThread;
+    std::atomic<bool> isolated{false};
+  };
+
+  static void push(Node* node, Msg* msg);
+  // returns nullptr if the queue is empty (or if a concurrent push did not
+  // complete yet); should only be called by the consumer
+  static Msg* pop(Node* node);
+  static bool mayHaveMessages(Node* node);
+  static void drain(Node* node);
+
+  void deliveryLoop(Node* node);
+  void countMessage(uint16_t msgType, size_t len, bool dropped);
+
+  const uint32_t maxMessageSize_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+  SendObserver observer_;
+
+  bool statsEnabled_ = true;
+  std::mutex statsLock_;
+  std::atomic<uint32_t> currentPhase_{0};
+  std::vector<PhaseStats> phases_;
+};
+
+// ICommunication of one node of an InMemoryNetwork
+class InMemoryCommunication : public ICommunication {
+ public:
+  InMemoryCommunication(InMemoryNetwork* network, NodeNum selfId)
+      : network_(network), selfId_(selfId) {}
+
+  int getMaxMessageSize() override;
+  int Start() override;
+  int Stop() override;
+  bool isRunning() const override;
+  ConnectionStatus getCurrentConnectionStatus(
+      const NodeNum node) const override;
+  int sendAsyncMessage(const NodeNum destNode,
+                       const char* const message,
+                       const size_t messageLength) override;
+  void setReceiver(NodeNum receiverNum, IReceiver* receiver) override;
+
+ private:
+  InMemoryNetwork* const network_;
+  const NodeNum selfId_;
+  IReceiver* receiver_ = nullptr;
+};
+
+}  // namespace bench
+}  // namespace bftEngine
+
+#endif  // BFTENGINE_BENCH_INMEMORYCOMMUNICATION_HPP_
@@ -0,0 +1,254 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+// Measures the cost of the signature schemes of SigManager (see
+// ReplicaConfig::replicaSignatureScheme).
+//
+// For each scheme, the benchmark reports the sizes of the keys and of the
+// signatures, and the time per operation (and operations per second) of key
+// generation, signing and verification, one by one and in batches of
+// --batch signatures (IVerifier::verifyBatch; only EdDSA verifies a batch
+// faster than its signatures one by one).
+//
+// Example: SignatureBench --message_size 4096 --iterations 2000
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ReplicaConfig.hpp"
+#include "Crypto.hpp"
+
+using namespace bftEngine;
+using namespace bftEngine::impl;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+struct BenchParams {
+  uint32_t messageSize = 256;
+  uint32_t iterations = 1000;
+  uint32_t numOfKeys = 10;
+  uint32_t batchSize = 64;
+};
+
+const char* schemeName(SignatureScheme scheme) {
+  return (scheme == SignatureScheme::EdDSA) ? "eddsa" : "rsa";
+}
+
+void generateKeys(SignatureScheme scheme, std::string& outPublicKey,
+                  std::string& outPrivateKey) {
+  if (scheme == SignatureScheme::EdDSA)
+    EdDSAKeysGenerator::generateKeys(outPublicKey, outPrivateKey);
+  else
+    RSAKeysGenerator::generateKeys(outPublicKey, outPrivateKey);
+}
+
+ISigner* createSigner(SignatureScheme scheme, const std::string& key) {
+  if (scheme == SignatureScheme::EdDSA) return new EdDSASigner(key.c_str());
+  return new RSASigner(key.c_str());
+}
+
+IVerifier* createVerifier(SignatureScheme scheme, const std::string& key) {
+  if (scheme == SignatureScheme::EdDSA) return new EdDSAVerifier(key.c_str());
+  return new RSAVerifier(key.c_str());
+}
+
+double microsPerOp(Clock::time_point start, uint32_t numOfOps) {
+  const double micros = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           start).count()) /
+                        1000.0;
+  return micros / numOfOps;
+}
+
+void printOp(const char* scheme, const char* op, double micros) {
+  std::cout << std::left << std::setw(8) << scheme << std::setw(16) << op
+            << std::right << std::fixed << std::setprecision(2)
+            << std::setw(12) << micros << " us/op" << std::setw(12)
+            << std::setprecision(0) << (1000000.0 / micros) << " ops/s\n";
+}
+
+bool runScheme(const BenchParams& p, SignatureScheme scheme) {
+  const char* name = schemeName(scheme);
+
+  // key generation
+  std::string publicKey;
+  std::string privateKey;
+  Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < p.numOfKeys; i++)
+    generateKeys(scheme, publicKey, privateKey);
+  const double keyGenMicros = microsPerOp(start, p.numOfKeys);
+
+  std::unique_ptr<ISigner> signer(createSigner(scheme, privateKey));
+  std::unique_ptr<IVerifier> verifier(createVerifier(scheme, publicKey));
+  const size_t sigLength = signer->signatureLength();
+
+  std::cout << name << ": public key " << publicKey.size() / 2
+            << " bytes, private key " << privateKey.size() / 2
+            << " bytes, signature " << sigLength << " bytes\n";
+
+  // different messages (the first bytes hold the index of the message)
+  std::vector<std::string> messages(p.iterations,
+                                    std::string(p.messageSize, 'm'));
+  for (uint32_t i = 0; i < p.iterations; i++)
+    messages[i].replace(0, std::min<size_t>(sizeof(i), p.messageSize),
+                        reinterpret_cast<const char*>(&i),
+                        std::min<size_t>(sizeof(i), p.messageSize));
+  std::vector<std::string> sigs(p.iterations, std::string(sigLength, '\0'));
+
+  start = Clock::now();
+  for (uint32_t i = 0; i < p.iterations; i++) {
+    size_t actualLength = 0;
+    if (!signer->sign(messages[i].data(), messages[i].size(), &sigs[i][0],
+                      sigLength, actualLength)) {
+      std::cout << name << ": signing failed\n";
+      return false;
+    }
+  }
+  const double signMicros = microsPerOp(start, p.iterations);
+
+  start = Clock::now();
+  for (uint32_t i = 0; i < p.iterations; i++) {
+    if (!verifier->verify(messages[i].data(), messages[i].size(),
+                          sigs[i].data(), sigs[i].size())) {
+      std::cout << name << ": verification failed\n";
+      return false;
+    }
+  }
+  const double verifyMicros = microsPerOp(start, p.iterations);
+
+  std::vector<const char*> data(p.iterations);
+  std::vector<size_t> dataLengths(p.iterations);
+  std::vector<const char*> sigData(p.iterations);
+  std::vector<size_t> sigLengths(p.iterations);
+  for (uint32_t i = 0; i < p.iterations; i++) {
+    data[i] = messages[i].data();
+    dataLengths[i] = messages[i].size();
+    sigData[i] = sigs[i].data();
+    sigLengths[i] = sigs[i].size();
+  }
+
+  start = Clock::now();
+  for (uint32_t i = 0; i < p.iterations; i += p.batchSize) {
+    const size_t n = std::min(p.batchSize, p.iterations - i);
+    if (!verifier->verifyBatch(n, &data[i], &dataLengths[i], &sigData[i],
+                               &sigLengths[i])) {
+      std::cout << name << ": batch verification failed\n";
+      return false;
+    }
+  }
+  const double batchMicros = microsPerOp(start, p.iterations);
+
+  // a corrupted signature should be rejected
+  sigs[0][0] ^= 1;
+  if (verifier->verify(messages[0].data(), messages[0].size(), sigs[0].data(),
+                       sigs[0].size())) {
+    std::cout << name << ": a corrupted signature was accepted\n";
+    return false;
+  }
+  const size_t n = std::min(p.batchSize, p.iterations);
+  if (verifier->verifyBatch(n, data.data(), dataLengths.data(), sigData.data(),
+                            sigLengths.data())) {
+    std::cout << name << ": a batch with a corrupted signature was accepted\n";
+    return false;
+  }
+
+  printOp(name, "keygen", keyGenMicros);
+  printOp(name, "sign", signMicros);
+  printOp(name, "verify", verifyMicros);
+  printOp(name, "verify (batch)", batchMicros);
+  return true;
+}
+
+void printUsage(const char* name) {
+  std::cout << "Usage: " << name << " [options]\n"
+    "  --message_size BYTES   size of each signed message (default 256)\n"
+    "  --iterations NUM       number of signed/verified messages (default"
+    " 1000)\n"
+    "  --keys NUM             number of generated key pairs (default 10)\n"
+    "  --batch NUM            signatures per verified batch (default 64)\n"
+    "  --scheme rsa|eddsa     run a single scheme (default both)\n";
+}
+
+bool parseUInt(const char* str, uint64_t max, uint64_t& out) {
+  char* end = nullptr;
+  unsigned long long val = strtoull(str, &end, 10);
+  if (end == str || *end != '\0' || val > max) return false;
+  out = val;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchParams p;
+  std::vector<SignatureScheme> schemes = {SignatureScheme::RSA,
+                                          SignatureScheme::EdDSA};
+
+  for (int i = 1; i < argc; i++) {
+    const std::string option(argv[i]);
+    if (option == "--help") {
+      printUsage(argv[0]);
+      return 0;
+    }
+    if (i + 1 >= argc) {
+      std::cout << "Expected an argument to " << option << ".\n";
+      return -1;
+    }
+    const char* arg = argv[++i];
+    uint64_t val = 0;
+    bool ok = true;
+
+    if (option == "--message_size") {
+      ok = parseUInt(arg, 1024 * 1024, val) && val >= 1;
+      p.messageSize = static_cast<uint32_t>(val);
+    } else if (option == "--iterations") {
+      ok = parseUInt(arg, 10000000, val) && val >= 1;
+      p.iterations = static_cast<uint32_t>(val);
+    } else if (option == "--keys") {
+      ok = parseUInt(arg, 100000, val) && val >= 1;
+      p.numOfKeys = static_cast<uint32_t>(val);
+    } else if (option == "--batch") {
+      ok = parseUInt(arg, 100000, val) && val >= 1;
+      p.batchSize = static_cast<uint32_t>(val);
+    } else if (option == "--scheme") {
+      const std::string scheme(arg);
+      ok = (scheme == "rsa" || scheme == "eddsa");
+      schemes = {(scheme == "eddsa") ? SignatureScheme::EdDSA
+                                     : SignatureScheme::RSA};
+    } else {
+      std::cout << "Unrecognized command line argument: " << option << "\n";
+      return -1;
+    }
+
+    if (!ok) {
+      std::cout << "Invalid value for " << option << ": " << arg << "\n";
+      return -1;
+    }
+  }
+
+  CryptographyWrapper::init();
+
+  for (SignatureScheme scheme : schemes)
+    if (!runScheme(p, scheme)) return -1;
+  return 0;
+}
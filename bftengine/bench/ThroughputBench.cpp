@@ -0,0 +1,481 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+// Measures the throughput and the latency of the replicas in a steady state.
+//
+// Runs N = 3F + 2C + 1 replicas and a number of clients (each client has a
+// single outstanding request) in a single process, over an in-memory network.
+// The benchmark sweeps over all the combinations of the given values of F, C,
+// the request size, the max batch size (the max number of requests in a
+// PrePrepare message) and the number of clients. For each configuration, the
+// load runs for a warmup period and then for a measured period, and the
+// benchmark reports the committed requests per second and the p50, p99 and
+// p999 latencies of the requests of the measured period.
+//
+// With --csv, a header line and a single line per configuration are printed,
+// so the results can be collected by a script (e.g. to track regressions per
+// commit; --tag adds a column with a given label, such as a commit id).
+//
+// With --shm PREFIX, the nodes communicate over SharedMemoryCommunication
+// (the files PREFIX.<node id> are created, e.g. PREFIX=/dev/shm/bench),
+// instead of the in-process network.
+//
+// With --trace N, 1 of every N requests is traced (see RequestTracing.hpp) and
+// the spans of all the configurations are written to --trace_file at the end.
+//
+// Example: ThroughputBench -f 1,2 --clients 1,8,32 --batch 0,16 --csv
+//          --tag $(git rev-parse --short HEAD)
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Replica.hpp"
+#include "ReplicaConfig.hpp"
+#include "RequestTracing.hpp"
+#include "SimpleClient.hpp"
+#include "SysConsts.hpp"
+#include "CommDefs.hpp"
+#include "CommFactory.hpp"
+#include "InMemoryCommunication.hpp"
+#include "BenchCluster.hpp"
+
+using namespace bftEngine;
+using namespace bftEngine::bench;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+const uint32_t kMaxMessageSize = 128 * 1024;
+const uint32_t kShmRingSize = 4 * kMaxMessageSize;
+const uint64_t kClientTimeoutMilli = 5000;
+const uint16_t kViewChangeTimerMilli = 60000;
+
+struct BenchParams {
+  std::vector<uint64_t> f = {1};
+  std::vector<uint64_t> c = {0};
+  std::vector<uint64_t> requestSizes = {64};
+  std::vector<uint64_t> batchSizes = {0};  // 0 means no limit
+  std::vector<uint64_t> numsOfClients = {4};
+  uint16_t concurrencyLevel = 1;
+  uint16_t checkpointWindowSize = ReplicaConfig().checkpointWindowSize;
+  uint16_t maxConcurrentFastPaths = ReplicaConfig().maxConcurrentFastPaths;
+  uint16_t statusReportTimerMilli = 1000;
+  uint16_t prePrepareFanout = 0;  // 0 means direct send
+  bool latencyBasedController = false;
+  bool speculativeExecution = false;
+  uint32_t warmupMilli = 1000;
+  uint32_t durationMilli = 5000;
+  bool csv = false;
+  std::string tag;
+  std::string shmPrefix;  // if not empty, use shared memory
+  uint32_t traceSamplingPeriod = 0;  // 0 means no tracing
+  std::string traceFile = "trace.json";
+};
+
+// A single point of the sweep
+struct RunConfig {
+  uint16_t f;
+  uint16_t c;
+  uint32_t requestSize;
+  uint16_t batchSize;
+  uint16_t numOfClients;
+};
+
+struct RunResult {
+  uint64_t requests = 0;
+  uint64_t failedRequests = 0;  // timed out
+  double opsPerSec = 0;
+  double p50Micros = 0;
+  double p99Micros = 0;
+  double p999Micros = 0;
+};
+
+struct RunState {
+  std::atomic<bool> measuring{false};
+  std::atomic<bool> stop{false};
+};
+
+// latencies of the requests that were committed in the measured period
+struct ClientStats {
+  std::vector<uint32_t> latenciesMicros;
+  uint64_t failedRequests = 0;
+};
+
+ICommunication* createCommunication(const BenchParams& p,
+                                   InMemoryNetwork* network, NodeNum id,
+                                   uint16_t numOfReplicas,
+                                   uint16_t numOfNodes) {
+  if (p.shmPrefix.empty()) return new InMemoryCommunication(network, id);
+
+  NodeMap nodes;
+  for (uint16_t i = 0; i < numOfNodes; i++)
+    nodes[i] = NodeInfo{"", 0, i < numOfReplicas};
+  SharedMemoryConfig config(p.shmPrefix, kMaxMessageSize, kShmRingSize,
+                            nodes, id);
+  return CommFactory::create(config);
+}
+
+void clientLoop(const BenchParams& p, InMemoryNetwork* network,
+                uint16_t clientId, uint16_t numOfReplicas,
+                const RunConfig& rc, RunState* state, ClientStats* stats) {
+  std::unique_ptr<ICommunication> comm(createCommunication(
+      p, network, clientId, numOfReplicas, numOfReplicas + rc.numOfClients));
+  SimpleClientParams clientParams;
+  clientParams.clientAcceptsTentativeReplies = p.speculativeExecution;
+  std::unique_ptr<SimpleClient> client(SimpleClient::createSimpleClient(
+      comm.get(), clientId, rc.f, rc.c, clientParams));
+  std::unique_ptr<SeqNumberGeneratorForClientRequests> seqGen(
+      SeqNumberGeneratorForClientRequests::
+          createSeqNumberGeneratorForClientRequests());
+
+  std::vector<char> request(rc.requestSize, 'r');
+  std::vector<char> reply(std::max<uint32_t>(rc.requestSize, 8));
+
+  while (!state->stop) {
+    uint32_t replySize = 0;
+    const Clock::time_point start = Clock::now();
+    int res = client->sendRequest(
+        false, request.data(), static_cast<uint32_t>(request.size()),
+        seqGen->generateUniqueSequenceNumberForRequest(), kClientTimeoutMilli,
+        static_cast<uint32_t>(reply.size()), reply.data(), replySize);
+    if (!state->measuring || state->stop) continue;
+
+    if (res != 0) {
+      stats->failedRequests++;
+      continue;
+    }
+    stats->latenciesMicros.push_back(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - start).count()));
+  }
+
+  comm->Stop();
+}
+
+// the smallest value such that at least p of the values are <= the value
+double percentile(const std::vector<uint32_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t rank = static_cast<size_t>(p * sorted.size());
+  if (rank >= sorted.size()) rank = sorted.size() - 1;
+  return sorted[rank];
+}
+
+RunResult runOnce(const BenchParams& p, const RunConfig& rc,
+                  const ClusterKeys& keys) {
+  const uint16_t n = keys.numOfReplicas();
+  InMemoryNetwork network(n + rc.numOfClients, kMaxMessageSize);
+  network.setTrafficStatsEnabled(false);
+  RunState state;
+
+  std::vector<CounterRequestsHandler> handlers(n);
+  std::vector<std::unique_ptr<Replica>> replicas;
+  for (uint16_t i = 0; i < n; i++) {
+    ReplicaConfig config = ReplicaConfig();
+    keys.fillReplicaConfig(i, config);
+    config.numOfClientProxies = rc.numOfClients;
+    config.statusReportTimerMillisec = p.statusReportTimerMilli;
+    config.concurrencyLevel = p.concurrencyLevel;
+    config.checkpointWindowSize = p.checkpointWindowSize;
+    config.maxConcurrentFastPaths = p.maxConcurrentFastPaths;
+    config.prePrepareFanout = p.prePrepareFanout;
+    config.latencyBasedController = p.latencyBasedController;
+    config.speculativeExecution = p.speculativeExecution;
+    config.autoViewChangeEnabled = false;
+    config.viewChangeTimerMillisec = kViewChangeTimerMilli;
+    config.maxBatchSize = rc.batchSize;
+
+    // the replica owns its communication object
+    replicas.emplace_back(Replica::createNewReplica(
+        &config, &handlers[i], nullptr,
+        createCommunication(p, &network, i, n, n + rc.numOfClients),
+        nullptr));
+  }
+  for (auto& r : replicas) r->start();
+
+  std::vector<ClientStats> stats(rc.numOfClients);
+  std::vector<std::thread> clients;
+  for (uint16_t i = 0; i < rc.numOfClients; i++)
+    clients.emplace_back(clientLoop, std::cref(p), &network, n + i, n,
+                         std::cref(rc), &state, &stats[i]);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(p.warmupMilli));
+  const Clock::time_point start = Clock::now();
+  state.measuring = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(p.durationMilli));
+  state.stop = true;
+  const double secs =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  for (auto& t : clients) t.join();
+  for (auto& r : replicas) r->stop();
+  replicas.clear();
+
+  if (!p.shmPrefix.empty()) {
+    for (uint16_t i = 0; i < n + rc.numOfClients; i++)
+      unlink((p.shmPrefix + "." + std::to_string(i)).c_str());
+  }
+
+  std::vector<uint32_t> latencies;
+  RunResult result;
+  for (const ClientStats& s : stats) {
+    latencies.insert(latencies.end(), s.latenciesMicros.begin(),
+                     s.latenciesMicros.end());
+    result.failedRequests += s.failedRequests;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  result.requests = latencies.size();
+  result.opsPerSec = latencies.size() / secs;
+  result.p50Micros = percentile(latencies, 0.5);
+  result.p99Micros = percentile(latencies, 0.99);
+  result.p999Micros = percentile(latencies, 0.999);
+  return result;
+}
+
+void printCsvHeader() {
+  std::cout << "tag,f,c,request_size,batch,clients,concurrency,duration_ms,"
+               "requests,failed,ops_per_sec,p50_us,p99_us,p999_us"
+            << std::endl;
+}
+
+void printCsv(const BenchParams& p, const RunConfig& rc, const RunResult& r) {
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << p.tag << "," << rc.f << "," << rc.c << "," << rc.requestSize
+            << "," << rc.batchSize << "," << rc.numOfClients << ","
+            << p.concurrencyLevel << "," << p.durationMilli << ","
+            << r.requests << "," << r.failedRequests << "," << r.opsPerSec
+            << "," << r.p50Micros << "," << r.p99Micros << ","
+            << r.p999Micros << std::endl;
+}
+
+void printRun(const RunConfig& rc, const RunResult& r) {
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "f=" << rc.f << " c=" << rc.c
+            << " request_size=" << rc.requestSize << " batch="
+            << (rc.batchSize == 0 ? std::string("unlimited")
+                                  : std::to_string(rc.batchSize))
+            << " clients=" << rc.numOfClients << "\n";
+  std::cout << "  " << r.opsPerSec << " ops/s (" << r.requests
+            << " requests, " << r.failedRequests << " timed out)\n";
+  std::cout << "  latency (ms): p50 " << r.p50Micros / 1000 << " p99 "
+            << r.p99Micros / 1000 << " p999 " << r.p999Micros / 1000
+            << std::endl;
+}
+
+void printUsage(const char* name) {
+  std::cout << "Usage: " << name << " [options]\n"
+    "Options that take a LIST accept comma separated values, and the\n"
+    "benchmark runs all the combinations of their values.\n"
+    "  -f LIST                     max number of faulty replicas (default 1)\n"
+    "  -c LIST                     max number of slow replicas (default 0)\n"
+    "  --request_size LIST         size of each request in bytes (default"
+    " 64)\n"
+    "  --batch LIST                ReplicaConfig::maxBatchSize, 0 for no"
+    " limit (default 0)\n"
+    "  --clients LIST              number of clients, i.e. the load (default"
+    " 4)\n"
+    "  --concurrency NUM           ReplicaConfig::concurrencyLevel (default"
+    " 1)\n"
+    "  --checkpoint_window NUM     ReplicaConfig::checkpointWindowSize"
+    " (default 150)\n"
+    "  --max_fast_paths NUM        ReplicaConfig::maxConcurrentFastPaths"
+    " (default 75)\n"
+    "  --status_timer_ms MS        ReplicaConfig::statusReportTimerMillisec"
+    " (default 1000)\n"
+    "  --pp_fanout NUM             ReplicaConfig::prePrepareFanout, 0 for"
+    " direct send (default 0)\n"
+    "  --latency_controller        ReplicaConfig::latencyBasedController\n"
+    "  --speculative               ReplicaConfig::speculativeExecution (the"
+    " clients accept tentative replies)\n"
+    "  --warmup_ms MS              time before the measured period (default"
+    " 1000)\n"
+    "  --duration_ms MS            length of the measured period (default"
+    " 5000)\n"
+    "  --csv                       machine-readable output\n"
+    "  --tag STR                   value of the 'tag' column of the csv"
+    " output\n"
+    "  --shm PREFIX                communicate over shared memory files"
+    " PREFIX.<node id>\n"
+    "  --trace N                   trace 1 of every N requests\n"
+    "  --trace_file FILE           trace-event JSON output (default"
+    " trace.json)\n";
+}
+
+bool parseUInt(const char* str, uint64_t max, uint64_t& out) {
+  char* end = nullptr;
+  unsigned long long val = strtoull(str, &end, 10);
+  if (end == str || *end != '\0' || val > max) return false;
+  out = val;
+  return true;
+}
+
+bool parseList(const char* str, uint64_t min, uint64_t max,
+               std::vector<uint64_t>& out) {
+  std::vector<uint64_t> vals;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    uint64_t val = 0;
+    if (!parseUInt(item.c_str(), max, val) || val < min) return false;
+    vals.push_back(val);
+  }
+  if (vals.empty()) return false;
+  out = vals;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchParams p;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string option(argv[i]);
+    if (option == "--help") {
+      printUsage(argv[0]);
+      return 0;
+    }
+    if (option == "--csv") {
+      p.csv = true;
+      continue;
+    }
+    if (option == "--latency_controller") {
+      p.latencyBasedController = true;
+      continue;
+    }
+    if (option == "--speculative") {
+      p.speculativeExecution = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cout << "Expected an argument to " << option << ".\n";
+      return -1;
+    }
+    const char* arg = argv[++i];
+    uint64_t val = 0;
+    bool ok = true;
+
+    if (option == "-f") {
+      ok = parseList(arg, 1, 10, p.f);
+    } else if (option == "-c") {
+      ok = parseList(arg, 0, 10, p.c);
+    } else if (option == "--request_size") {
+      ok = parseList(arg, 1, 64 * 1024, p.requestSizes);
+    } else if (option == "--batch") {
+      ok = parseList(arg, 0, maxNumOfRequestsInBatch, p.batchSizes);
+    } else if (option == "--clients") {
+      ok = parseList(arg, 1, 1000, p.numsOfClients);
+    } else if (option == "--concurrency") {
+      ok = parseUInt(arg, maxCheckpointWindowSize, val) && val >= 1;
+      p.concurrencyLevel = static_cast<uint16_t>(val);
+    } else if (option == "--checkpoint_window") {
+      ok = parseUInt(arg, maxCheckpointWindowSize, val) &&
+           val >= minCheckpointWindowSize;
+      p.checkpointWindowSize = static_cast<uint16_t>(val);
+    } else if (option == "--max_fast_paths") {
+      ok = parseUInt(arg, maxCheckpointWindowSize, val) && val >= 2;
+      p.maxConcurrentFastPaths = static_cast<uint16_t>(val);
+    } else if (option == "--status_timer_ms") {
+      ok = parseUInt(arg, UINT16_MAX, val) && val >= 1;
+      p.statusReportTimerMilli = static_cast<uint16_t>(val);
+    } else if (option == "--pp_fanout") {
+      ok = parseUInt(arg, UINT16_MAX, val);
+      p.prePrepareFanout = static_cast<uint16_t>(val);
+    } else if (option == "--warmup_ms") {
+      ok = parseUInt(arg, UINT32_MAX, val);
+      p.warmupMilli = static_cast<uint32_t>(val);
+    } else if (option == "--duration_ms") {
+      ok = parseUInt(arg, UINT32_MAX, val) && val >= 1;
+      p.durationMilli = static_cast<uint32_t>(val);
+    } else if (option == "--tag") {
+      ok = (std::string(arg).find(',') == std::string::npos);
+      p.tag = arg;
+    } else if (option == "--shm") {
+      p.shmPrefix = arg;
+      ok = !p.shmPrefix.empty();
+    } else if (option == "--trace") {
+      ok = parseUInt(arg, UINT32_MAX, val);
+      p.traceSamplingPeriod = static_cast<uint32_t>(val);
+    } else if (option == "--trace_file") {
+      p.traceFile = arg;
+      ok = !p.traceFile.empty();
+    } else {
+      std::cout << "Unrecognized command line argument: " << option << "\n";
+      return -1;
+    }
+
+    if (!ok) {
+      std::cout << "Invalid value for " << option << ": " << arg << "\n";
+      return -1;
+    }
+  }
+
+  if (p.concurrencyLevel >= p.maxConcurrentFastPaths ||
+      p.maxConcurrentFastPaths >= p.checkpointWindowSize) {
+    std::cout << "Expected concurrency < max_fast_paths < checkpoint_window.\n";
+    return -1;
+  }
+
+  if (p.traceSamplingPeriod > 0)
+    RequestTracing::enable(p.traceSamplingPeriod);
+
+  if (p.csv) printCsvHeader();
+
+  for (uint64_t f : p.f) {
+    for (uint64_t c : p.c) {
+      if (!p.csv)
+        std::cout << "generating keys for " << (3 * f + 2 * c + 1)
+                  << " replicas..." << std::endl;
+      const ClusterKeys keys(static_cast<uint16_t>(f),
+                             static_cast<uint16_t>(c));
+
+      for (uint64_t requestSize : p.requestSizes) {
+        for (uint64_t batch : p.batchSizes) {
+          for (uint64_t clients : p.numsOfClients) {
+            RunConfig rc;
+            rc.f = static_cast<uint16_t>(f);
+            rc.c = static_cast<uint16_t>(c);
+            rc.requestSize = static_cast<uint32_t>(requestSize);
+            rc.batchSize = static_cast<uint16_t>(batch);
+            rc.numOfClients = static_cast<uint16_t>(clients);
+
+            const RunResult r = runOnce(p, rc, keys);
+            if (p.csv)
+              printCsv(p, rc, r);
+            else
+              printRun(rc, r);
+          }
+        }
+      }
+    }
+  }
+
+  if (p.traceSamplingPeriod > 0 && !RequestTracing::dump(p.traceFile)) {
+    std::cout << "Failed to write " << p.traceFile << "\n";
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,399 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+// Measures the latency of a view change.
+//
+// Runs N = 3F + 2C + 1 replicas and a number of clients in a single process,
+// over an in-memory network. After a warmup period under a given load (the
+// number of clients, each client has a single outstanding request), the
+// primary of view 0 is killed (or partitioned from all the other nodes), and
+// the benchmark reports:
+// - the time until the first ViewChange message is sent (mostly determined
+//   by viewChangeTimerMillisec)
+// - the time until the new primary sends the first NewView message
+// - the time until the first request is committed in the new view
+// - the messages/bytes sent in each phase (before the fault, during the view
+//   change, and in the new view until the first commit)
+//
+// Example: ViewChangeBench -f 1 --clients 8 --view_change_timer_ms 1000
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Replica.hpp"
+#include "ReplicaConfig.hpp"
+#include "SimpleClient.hpp"
+#include "Crypto.hpp"
+#include "MsgCode.hpp"
+#include "InMemoryCommunication.hpp"
+#include "BenchCluster.hpp"
+
+using namespace bftEngine;
+using namespace bftEngine::bench;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+const uint32_t kMaxMessageSize = 128 * 1024;
+const uint64_t kClientTimeoutMilli = 5000;
+
+struct BenchParams {
+  uint16_t f = 1;
+  uint16_t c = 0;
+  uint16_t numOfClients = 4;
+  uint32_t requestSize = 64;
+  uint16_t concurrencyLevel = 1;
+  uint32_t warmupMilli = 2000;
+  uint16_t viewChangeTimerMilli = 2000;
+  uint16_t statusReportTimerMilli = 1000;
+  bool partition = false;  // kill the primary if false
+  SignatureScheme sigScheme = SignatureScheme::RSA;
+  uint32_t numOfRuns = 1;
+  uint32_t maxWaitMilli = 60000;
+};
+
+enum Phase : uint32_t {
+  kBeforeFault = 0,
+  kViewChange,       // from the fault until the first NewView message
+  kNewView,          // from the first NewView message until the first commit
+  kAfterFirstCommit,
+  kNumOfPhases
+};
+
+const char* phaseName(uint32_t phase) {
+  switch (phase) {
+    case kBeforeFault: return "before fault";
+    case kViewChange: return "view change";
+    case kNewView: return "new view";
+    default: return "after first commit";
+  }
+}
+
+struct RunResult {
+  bool completed = false;
+  double opsPerSecBeforeFault = 0;
+  double firstViewChangeMilli = -1;
+  double newViewMilli = -1;
+  double firstCommitMilli = -1;
+  PhaseStats phases[kNumOfPhases];
+};
+
+// State shared by the threads of a run. Times are in microseconds since the
+// fault (-1 if the event did not happen yet).
+struct RunState {
+  explicit RunState(InMemoryNetwork* net) : network(net) {}
+
+  int64_t microsSinceFault() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - faultTime).count();
+  }
+
+  // invoked (by the sending thread) for each message on the network
+  void onMessageSent(uint16_t msgType) {
+    if (!faultInjected) return;
+    int64_t expected = -1;
+    if (msgType == impl::MsgCode::ViewChange) {
+      firstViewChangeMicros.compare_exchange_strong(expected,
+                                                    microsSinceFault());
+    } else if (msgType == impl::MsgCode::NewView) {
+      if (newViewMicros.compare_exchange_strong(expected, microsSinceFault()))
+        network->setPhase(kNewView);
+    }
+  }
+
+  // invoked by a client thread when a request is committed
+  void onCommit() {
+    if (!faultInjected) {
+      commitsBeforeFault++;
+      return;
+    }
+    if (newViewMicros < 0) return;
+    int64_t expected = -1;
+    if (firstCommitMicros.compare_exchange_strong(expected,
+                                                  microsSinceFault()))
+      network->setPhase(kAfterFirstCommit);
+  }
+
+  InMemoryNetwork* const network;
+  Clock::time_point faultTime;
+  std::atomic<bool> faultInjected{false};
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> commitsBeforeFault{0};
+  std::atomic<int64_t> firstViewChangeMicros{-1};
+  std::atomic<int64_t> newViewMicros{-1};
+  std::atomic<int64_t> firstCommitMicros{-1};
+};
+
+void clientLoop(InMemoryNetwork* network, uint16_t clientId,
+                const BenchParams& p, RunState* state) {
+  InMemoryCommunication comm(network, clientId);
+  std::unique_ptr<SimpleClient> client(
+      SimpleClient::createSimpleClient(&comm, clientId, p.f, p.c));
+  std::unique_ptr<SeqNumberGeneratorForClientRequests> seqGen(
+      SeqNumberGeneratorForClientRequests::
+          createSeqNumberGeneratorForClientRequests());
+
+  std::vector<char> request(p.requestSize, 'r');
+  std::vector<char> reply(std::max<uint32_t>(p.requestSize, 8));
+
+  while (!state->stop) {
+    uint32_t replySize = 0;
+    int res = client->sendRequest(
+        false, request.data(), static_cast<uint32_t>(request.size()),
+        seqGen->generateUniqueSequenceNumberForRequest(), kClientTimeoutMilli,
+        static_cast<uint32_t>(reply.size()), reply.data(), replySize);
+    if (res == 0) state->onCommit();
+  }
+
+  comm.Stop();
+}
+
+RunResult runOnce(const BenchParams& p, const ClusterKeys& keys) {
+  const uint16_t n = keys.numOfReplicas();
+  InMemoryNetwork network(n + p.numOfClients, kMaxMessageSize);
+  RunState state(&network);
+  network.setObserver([&state](NodeNum, NodeNum, uint16_t msgType) {
+    state.onMessageSent(msgType);
+  });
+
+  std::vector<CounterRequestsHandler> handlers(n);
+  std::vector<std::unique_ptr<Replica>> replicas;
+  for (uint16_t i = 0; i < n; i++) {
+    ReplicaConfig config = ReplicaConfig();
+    keys.fillReplicaConfig(i, config);
+    config.numOfClientProxies = p.numOfClients;
+    config.statusReportTimerMillisec = p.statusReportTimerMilli;
+    config.concurrencyLevel = p.concurrencyLevel;
+    config.autoViewChangeEnabled = true;
+    config.viewChangeTimerMillisec = p.viewChangeTimerMilli;
+
+    // the replica owns its communication object
+    replicas.emplace_back(Replica::createNewReplica(
+        &config, &handlers[i], nullptr, new InMemoryCommunication(&network, i),
+        nullptr));
+  }
+  for (auto& r : replicas) r->start();
+
+  std::vector<std::thread> clients;
+  const Clock::time_point startTime = Clock::now();
+  for (uint16_t i = 0; i < p.numOfClients; i++)
+    clients.emplace_back(clientLoop, &network, n + i, std::cref(p), &state);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(p.warmupMilli));
+
+  // the primary of view 0 is replica 0
+  network.setPhase(kViewChange);
+  state.faultTime = Clock::now();
+  state.faultInjected = true;
+  if (p.partition)
+    network.setIsolated(0, true);
+  else
+    replicas[0]->stop();
+
+  const double warmupSecs = std::chrono::duration<double>(
+      state.faultTime - startTime).count();
+
+  while (state.firstCommitMicros < 0 &&
+         state.microsSinceFault() < int64_t(p.maxWaitMilli) * 1000)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  state.stop = true;
+  for (auto& t : clients) t.join();
+  for (auto& r : replicas)
+    if (r->isRunning()) r->stop();
+
+  RunResult result;
+  result.completed = (state.firstCommitMicros >= 0);
+  result.opsPerSecBeforeFault = state.commitsBeforeFault / warmupSecs;
+  result.firstViewChangeMilli = state.firstViewChangeMicros / 1000.0;
+  result.newViewMilli = state.newViewMicros / 1000.0;
+  result.firstCommitMilli = state.firstCommitMicros / 1000.0;
+  for (uint32_t i = 0; i < kNumOfPhases; i++)
+    result.phases[i] = network.getPhaseStats(i);
+  return result;
+}
+
+void printRun(uint32_t run, const RunResult& r) {
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "run " << run << ": " << r.opsPerSecBeforeFault
+            << " ops/s before the fault\n";
+  std::cout << "  first ViewChange msg:  " << r.firstViewChangeMilli
+            << " ms\n";
+  std::cout << "  time to new view:      " << r.newViewMilli << " ms\n";
+  std::cout << "  time to first commit:  " << r.firstCommitMilli << " ms"
+            << (r.completed ? "" : " (did not complete)") << "\n";
+
+  for (uint32_t phase = kBeforeFault; phase <= kNewView; phase++) {
+    const PhaseStats& s = r.phases[phase];
+    uint64_t msgs = 0, bytes = 0;
+    for (const auto& t : s.sent) {
+      msgs += t.second.msgs;
+      bytes += t.second.bytes;
+    }
+    std::cout << "  phase '" << phaseName(phase) << "': " << msgs
+              << " msgs, " << bytes << " bytes (dropped: " << s.dropped.msgs
+              << " msgs, " << s.dropped.bytes << " bytes)\n";
+    for (const auto& t : s.sent) {
+      std::cout << "    " << std::left << std::setw(20)
+                << msgTypeName(t.first) << std::right << std::setw(10)
+                << t.second.msgs << " msgs " << std::setw(12)
+                << t.second.bytes << " bytes\n";
+    }
+  }
+}
+
+void printSummary(const std::vector<RunResult>& results) {
+  std::vector<double> newView, firstCommit;
+  for (const RunResult& r : results) {
+    if (!r.completed) continue;
+    newView.push_back(r.newViewMilli);
+    firstCommit.push_back(r.firstCommitMilli);
+  }
+  std::cout << "completed runs: " << newView.size() << "/" << results.size()
+            << "\n";
+  if (newView.empty()) return;
+
+  std::sort(newView.begin(), newView.end());
+  std::sort(firstCommit.begin(), firstCommit.end());
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "time to new view (ms):     min " << newView.front()
+            << " median " << newView[newView.size() / 2] << " max "
+            << newView.back() << "\n";
+  std::cout << "time to first commit (ms): min " << firstCommit.front()
+            << " median " << firstCommit[firstCommit.size() / 2] << " max "
+            << firstCommit.back() << "\n";
+}
+
+void printUsage(const char* name) {
+  std::cout << "Usage: " << name << " [options]\n"
+    "  -f F                        max number of faulty replicas (default 1)\n"
+    "  -c C                        max number of slow replicas (default 0)\n"
+    "  --clients NUM               number of clients, i.e. the load (default"
+    " 4)\n"
+    "  --request_size BYTES        size of each request (default 64)\n"
+    "  --concurrency NUM           ReplicaConfig::concurrencyLevel (default"
+    " 1)\n"
+    "  --warmup_ms MS              time before the fault (default 2000)\n"
+    "  --view_change_timer_ms MS   ReplicaConfig::viewChangeTimerMillisec"
+    " (default 2000)\n"
+    "  --status_timer_ms MS        ReplicaConfig::statusReportTimerMillisec"
+    " (default 1000)\n"
+    "  --fault kill|partition      how the primary fails (default kill)\n"
+    "  --sig_scheme rsa|eddsa      ReplicaConfig::replicaSignatureScheme, used"
+    " to sign\n"
+    "                              the ViewChange messages (default rsa)\n"
+    "  --runs NUM                  number of runs (default 1)\n"
+    "  --max_wait_ms MS            max time to wait for the first commit"
+    " (default 60000)\n";
+}
+
+bool parseUInt(const char* str, uint64_t max, uint64_t& out) {
+  char* end = nullptr;
+  unsigned long long val = strtoull(str, &end, 10);
+  if (end == str || *end != '\0' || val > max) return false;
+  out = val;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchParams p;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string option(argv[i]);
+    if (option == "--help") {
+      printUsage(argv[0]);
+      return 0;
+    }
+    if (i + 1 >= argc) {
+      std::cout << "Expected an argument to " << option << ".\n";
+      return -1;
+    }
+    const char* arg = argv[++i];
+    uint64_t val = 0;
+    bool ok = true;
+
+    if (option == "--fault") {
+      const std::string fault(arg);
+      ok = (fault == "kill" || fault == "partition");
+      p.partition = (fault == "partition");
+    } else if (option == "--sig_scheme") {
+      const std::string scheme(arg);
+      ok = (scheme == "rsa" || scheme == "eddsa");
+      p.sigScheme = (scheme == "eddsa") ? SignatureScheme::EdDSA
+                                        : SignatureScheme::RSA;
+    } else if (option == "-f") {
+      ok = parseUInt(arg, 10, val) && val >= 1;
+      p.f = static_cast<uint16_t>(val);
+    } else if (option == "-c") {
+      ok = parseUInt(arg, 10, val);
+      p.c = static_cast<uint16_t>(val);
+    } else if (option == "--clients") {
+      ok = parseUInt(arg, 1000, val) && val >= 1;
+      p.numOfClients = static_cast<uint16_t>(val);
+    } else if (option == "--request_size") {
+      ok = parseUInt(arg, 64 * 1024, val) && val >= 1;
+      p.requestSize = static_cast<uint32_t>(val);
+    } else if (option == "--concurrency") {
+      ok = parseUInt(arg, 30, val) && val >= 1;
+      p.concurrencyLevel = static_cast<uint16_t>(val);
+    } else if (option == "--warmup_ms") {
+      ok = parseUInt(arg, UINT32_MAX, val);
+      p.warmupMilli = static_cast<uint32_t>(val);
+    } else if (option == "--view_change_timer_ms") {
+      ok = parseUInt(arg, UINT16_MAX, val) && val >= 1;
+      p.viewChangeTimerMilli = static_cast<uint16_t>(val);
+    } else if (option == "--status_timer_ms") {
+      ok = parseUInt(arg, UINT16_MAX, val) && val >= 1;
+      p.statusReportTimerMilli = static_cast<uint16_t>(val);
+    } else if (option == "--runs") {
+      ok = parseUInt(arg, 1000, val) && val >= 1;
+      p.numOfRuns = static_cast<uint32_t>(val);
+    } else if (option == "--max_wait_ms") {
+      ok = parseUInt(arg, UINT32_MAX, val) && val >= 1;
+      p.maxWaitMilli = static_cast<uint32_t>(val);
+    } else {
+      std::cout << "Unrecognized command line argument: " << option << "\n";
+      return -1;
+    }
+
+    if (!ok) {
+      std::cout << "Invalid value for " << option << ": " << arg << "\n";
+      return -1;
+    }
+  }
+
+  std::cout << "generating keys for " << (3 * p.f + 2 * p.c + 1)
+            << " replicas..." << std::endl;
+  ClusterKeys keys(p.f, p.c, p.sigScheme);
+
+  std::vector<RunResult> results;
+  for (uint32_t run = 1; run <= p.numOfRuns; run++) {
+    results.push_back(runOnce(p, keys));
+    printRun(run, results.back());
+  }
+  printSummary(results);
+  return 0;
+}
@@ -98,8 +98,17 @@ struct Config {
   uint32_t maxChunkSize = 2*1024;  // 128;
 
   uint16_t maxNumberOfChunksInBatch = 24;
+  // NB: counts the bytes that were actually received (i.e. compressed bytes
+  // when compression is used)
   uint32_t maxPendingDataFromSourceReplica = 32 * 1024 * 1024;
 
+  // If true, chunks are compressed when they are sent to (and accepted when
+  // they are received from) replicas that also enable compression.
+  bool enableCompression = false;
+  // number of worker threads used by a source replica to compress chunks
+  // (0 means that chunks are compressed by the calling thread)
+  uint16_t numOfCompressionThreads = 2;
+
   uint32_t maxNumOfReservedPages = 2048;
 
   uint32_t refreshTimerMilli = 300;  // 300ms
@@ -12,6 +12,7 @@
 
 #define REQUEST_MSG_TYPE (700)
 #define REPLY_MSG_TYPE   (800)
+#define TENTATIVE_REPLY_MSG_TYPE (801) // a reply of a speculative execution (see ClientTentativeReplyMsgHeader)
 
 namespace bftEngine
 {
@@ -20,7 +21,7 @@ namespace bftEngine
 	{
 		uint16_t msgType; // always == REQUEST_MSG_TYPE
 		uint16_t idOfClientProxy;
-		uint8_t  flags; // bit 0 == isReadOnly ; bits 1-7 are reserved
+		uint8_t  flags; // bit 0 == isReadOnly ; bit 1 == isTraced (see RequestTracing.hpp) ; bit 2 == isSigned (see ClientRequestMsg::sign) ; bits 3-7 are reserved
 		uint64_t reqSeqNum;
 		uint32_t requestLength;
 		// followed by the request (security information, such as signatures, should be part of the request)
@@ -31,10 +32,21 @@ namespace bftEngine
 
 	struct ClientReplyMsgHeader
 	{
-		uint16_t msgType; // always == REPLY_MSG_TYPE
+		uint16_t msgType; // REPLY_MSG_TYPE or TENTATIVE_REPLY_MSG_TYPE
 		uint16_t currentPrimaryId;
 		uint64_t reqSeqNum;
 		uint32_t replyLength;
 	};
+
+	// the header of a reply of a speculative execution: the client accepts the reply only if enough
+	// replicas executed the request at the same sequence number of the same view, after the same
+	// history (see ReplicaConfig::speculativeExecution)
+	struct ClientTentativeReplyMsgHeader
+	{
+		ClientReplyMsgHeader replyHeader; // msgType == TENTATIVE_REPLY_MSG_TYPE
+		uint64_t viewNum;
+		uint64_t seqNum;
+		char historyDigest[32]; // the digest of the requests of the sequence numbers since the last checkpoint, up to seqNum
+	};
 #pragma pack(pop)
 }
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <set>
 
 typedef uint64_t NodeNum;
 
@@ -70,6 +71,22 @@ namespace bftEngine
                                    const char *const message,
                                    const size_t messageLength) = 0;
 
+      // Sends the same message to each of the given destination nodes.
+      // Asynchronous (non-blocking) method. Implementations may override it
+      // to copy the message once for all the destinations (the default
+      // implementation calls sendAsyncMessage for each destination).
+      // Returns 0 on success (i.e., if all the sends succeeded).
+      virtual int sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                                         const char *const message,
+                                         const size_t messageLength) {
+         int res = 0;
+         for (NodeNum d : destNodes) {
+            const int r = sendAsyncMessage(d, message, messageLength);
+            if (r != 0) res = r;
+         }
+         return res;
+      }
+
       virtual void setReceiver(NodeNum receiverNum, IReceiver *receiver) = 0;
 
       virtual ~ICommunication() {};
@@ -33,6 +33,34 @@ class RequestsHandler {
                       uint32_t maxReplySize,
                       char *outReply,
                       uint32_t &outActualReplySize) = 0;
+
+  // Speculative execution (used if ReplicaConfig::speculativeExecution is
+  // true). A replica may execute the requests of a sequence number before it
+  // is committed. The handler keeps the effects of each speculative sequence
+  // number in a separate version of the state, on top of the previous
+  // versions; the committed state (the state seen by state transfer) is only
+  // updated by commitSpeculative.
+  // Returns 0 on success (a handler that does not support speculative
+  // execution returns an error, and the request is executed when committed).
+  // The reply buffer is initially empty.
+  virtual int executeSpeculatively(uint16_t clientId,
+                                   uint64_t sequenceNum,
+                                   bool readOnly,
+                                   uint32_t requestSize,
+                                   const char *request,
+                                   uint32_t maxReplySize,
+                                   char *outReply,
+                                   uint32_t &outActualReplySize) {
+    return -1;
+  }
+
+  // the speculative versions of the sequence numbers <= sequenceNum are
+  // committed
+  virtual void commitSpeculative(uint64_t sequenceNum) {}
+
+  // the speculative versions of the sequence numbers > lastCommittedSeqNum
+  // are discarded (e.g. after a view change)
+  virtual void rollbackSpeculative(uint64_t lastCommittedSeqNum) {}
 };
 
 class Replica {
@@ -10,11 +10,19 @@
 
 #include <stdint.h>
 #include <set>
+#include <string>
 
 class IThresholdSigner;
 class IThresholdVerifier;
 namespace bftEngine
 {
+	// signature schemes of the keys in ReplicaConfig::publicKeysOfReplicas and ReplicaConfig::replicaPrivateKey
+	enum class SignatureScheme : uint8_t
+	{
+		RSA = 0,   // RSA (2048 bits)
+		EdDSA = 1  // Ed25519 (faster, with smaller keys and signatures)
+	};
+
 	struct ReplicaConfig
 	{
 		// F value - max number of faulty/malicious replicas. fVal >= 1 
@@ -34,26 +42,90 @@ namespace bftEngine
 		// numOfClientProxies >= 1
 		uint16_t numOfClientProxies; 
 
+		// max size of the reply to a client request (see RequestsHandler::execute).
+		// The latest reply to each client is kept in the reserved pages, and the replies of several clients share
+		// a reserved page when they fit in it, so a smaller value allows many more clients for the same number of
+		// reserved pages (e.g. 4 clients per 4KB page with replies of up to 1000 bytes, instead of 2 pages per client).
+		// 0 means the largest reply that fits in a reply message (see maxReplyMessageSize in SysConsts.hpp).
+		// All the replicas should use the same value.
+		uint32_t maxReplySize = 0;
+
 		// a time interval in milliseconds. represents how often the replica sends a status report to the other replicas. 
 		// statusReportTimerMillisec > 0
 		uint16_t statusReportTimerMillisec; 
 
 		// number of consensus operations that can be executed in parallel
-		// 1 <= concurrencyLevel <= 30
+		// 1 <= concurrencyLevel < maxConcurrentFastPaths
 		uint16_t concurrencyLevel;
 
+		// the replicas create a checkpoint every checkpointWindowSize sequence numbers, and work on the sequence
+		// numbers in the range (lastStableSeqNum, lastStableSeqNum + 2 * checkpointWindowSize] (the work window).
+		// A larger window allows a deeper pipeline (e.g. in high-latency networks), and a smaller window uses less memory.
+		// minCheckpointWindowSize <= checkpointWindowSize <= maxCheckpointWindowSize (see SysConsts.hpp), and a
+		// ViewChangeMsg with a prepared certificate for each sequence number in the work window should fit in
+		// maxExternalMessageSize (e.g. about 340 with BLS threshold signatures and RSA-2048 replica keys)
+		// All the replicas should use the same value.
+		uint16_t checkpointWindowSize = 150;
+
+		// max number of fast paths that are simultaneously in progress (i.e. max number of sequence numbers after the
+		// last executed one, for which a replica sends its partial commit proof).
+		// concurrencyLevel < maxConcurrentFastPaths < checkpointWindowSize
+		uint16_t maxConcurrentFastPaths = 75;
+
 		// autoViewChangeEnabled=true , if the automatic view change protocol is enabled
 		bool autoViewChangeEnabled;
 
 		// a time interval in milliseconds. represents the timeout used by the  view change protocol (TODO: add more details)
 		uint16_t viewChangeTimerMillisec;
 
+		// clientsMulticastRequests=true, if clients send their requests to all replicas (see SimpleClientParams).
+		// In this mode, the replicas cache the requests, and the primary sends PrePrepare messages that only
+		// contain the identifiers and the digests of the requests (missing requests are fetched from the primary).
+		bool clientsMulticastRequests = false;
+
+		// max number of client requests in a PrePrepare message (i.e. the max size of a batch).
+		// 0 means that the number of requests is only limited by the size of the message.
+		// 0 <= maxBatchSize <= maxNumOfRequestsInBatch (see SysConsts.hpp)
+		uint16_t maxBatchSize = 0;
+
+		// coalesceMessages=true, if the messages that the replica sends to the same replica during an iteration
+		// of its main loop are packed into a single message (all the replicas should support it).
+		bool coalesceMessages = false;
+
+		// if prePrepareFanout > 0, the primary sends each PrePrepare message only to prePrepareFanout replicas, which
+		// relay it along a tree (each replica relays it to up to prePrepareFanout replicas); the other replicas
+		// only receive its digest from the primary, and fetch the message from the primary if it does not arrive in time.
+		// 0 means that the primary sends the PrePrepare messages directly to all the replicas.
+		// Not used if clientsMulticastRequests=true (all the replicas should use the same value).
+		uint16_t prePrepareFanout = 0;
+
+		// latencyBasedController=true, if the primary selects the first commit path, and the time to start the slow
+		// path of each sequence number, from the measured response latencies of the replicas (see LatencyBasedController).
+		// Otherwise, the primary uses the success rate of the fast paths in recent sequence numbers.
+		bool latencyBasedController = false;
+
+		// speculativeExecution=true, if the replicas execute the requests of a PrePrepare message on the fast path
+		// before it is committed (see RequestsHandler::executeSpeculatively), and send tentative replies to the
+		// clients (see SimpleClientParams::clientAcceptsTentativeReplies). Speculative executions are committed
+		// when the sequence number is committed, and rolled back on a view change or a state transfer.
+		// A sequence number is executed speculatively only after the sequence numbers before its checkpoint window
+		// were committed.
+		bool speculativeExecution = false;
+
 		// public keys of all replicas. map from replica identifier to a public key
 		std::set<std::pair<uint16_t, std::string>> publicKeysOfReplicas;
 
 		// private key of the current replica
 		std::string replicaPrivateKey;
 
+		// the signature scheme of publicKeysOfReplicas and replicaPrivateKey (all the replicas should use the same scheme)
+		SignatureScheme replicaSignatureScheme = SignatureScheme::RSA;
+
+		// public EdDSA keys of the clients that sign their requests (see SimpleClientParams::clientPrivateKey). map from
+		// client identifier to a public key. The requests of these clients are accepted only with a valid signature;
+		// the primary and the other replicas verify the signatures of the requests of each PrePrepare message in a batch.
+		std::set<std::pair<uint16_t, std::string>> publicKeysOfClients;
+
 		// signer and verifier of a threshold signature (for threshold fVal+1 out of N)
 		// In the current version, both should be nullptr 
 		IThresholdSigner* thresholdSignerForExecution;
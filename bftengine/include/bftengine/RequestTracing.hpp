@@ -0,0 +1,37 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+namespace bftEngine
+{
+	// Sampled tracing of client requests (disabled by default).
+	// A client marks 1 of every samplingPeriod requests as traced; the clients and the replicas record the
+	// stages of the traced requests (sent, received, added to a PrePrepare, committed, executed, ...) in
+	// per-thread memory buffers, which can be written as a trace-event JSON file (chrome://tracing or Perfetto).
+	// Tracing should be enabled in the clients and in the replicas (in replicas, samplingPeriod only
+	// needs to be > 0: the requests are sampled by the clients).
+	// Events are time stamped with the monotonic clock, so the files of different machines can not be merged.
+	class RequestTracing
+	{
+	public:
+		// samplingPeriod == 0 disables tracing
+		static void enable(uint32_t samplingPeriod);
+
+		static void disable();
+
+		static bool isEnabled();
+
+		// writes the events that are still in the buffers (the events of the last 64K stages of each thread);
+		// returns false if the file can not be written
+		static bool dump(const std::string& fileName);
+	};
+}
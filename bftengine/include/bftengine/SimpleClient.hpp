@@ -26,6 +26,15 @@ namespace bftEngine
   		uint16_t clientSendsRequestToAllReplicasFirstThresh = 4;
   		uint16_t clientSendsRequestToAllReplicasPeriodThresh = 2;
   		uint16_t clientPeriodicResetThresh = 30;
+  		// if true, requests are always sent to all replicas (should match ReplicaConfig::clientsMulticastRequests)
+  		bool clientSendsRequestToAllReplicas = false;
+  		// if true, a request also completes when 3F+C+1 replicas send matching tentative replies (sent by
+  		// replicas that use ReplicaConfig::speculativeExecution). Tentative replies match only if they have
+  		// the same view, sequence number and history digest.
+  		bool clientAcceptsTentativeReplies = false;
+  		// if not empty, the private EdDSA key (in hexadecimal) that signs the requests of the client (its public
+  		// key should be in ReplicaConfig::publicKeysOfClients)
+  		std::string clientPrivateKey;
 	};
 
 	class SimpleClient
@@ -45,7 +45,8 @@ enum CommType {
   SimpleAuthUdp,
   PlainTcp,
   SimpleAuthTcp,
-  TlsTcp
+  TlsTcp,
+  SharedMemory
 };
 
 struct BaseCommConfig {
@@ -143,6 +144,37 @@ struct TlsTcpConfig : PlainTcpConfig {
   }
 };
 
+// Communication between processes on the same host, over shared memory.
+// Every node owns a file (pathPrefix + "." + node id, e.g. under /dev/shm)
+// that holds a single-producer/single-consumer ring for each possible sender.
+// All the nodes of a system should use the same pathPrefix, ringSize and
+// nodes (the ids of the nodes should be smaller than the number of nodes).
+// ip, port and the node addresses are not used.
+struct SharedMemoryConfig : BaseCommConfig {
+  std::string pathPrefix;
+
+  // size (in bytes) of each ring; should be a multiple of 8, and large
+  // enough for at least two messages of bufLength bytes
+  uint32_t ringSize;
+
+  SharedMemoryConfig(std::string _pathPrefix,
+                     uint32_t bufLength,
+                     uint32_t _ringSize,
+                     NodeMap _nodes,
+                     NodeNum _selfId,
+                     UPDATE_CONNECTIVITY_FN _statusCallback = nullptr) :
+      BaseCommConfig(CommType::SharedMemory,
+                     "",
+                     0,
+                     bufLength,
+                     std::move(_nodes),
+                     _selfId,
+                     _statusCallback),
+      pathPrefix{std::move(_pathPrefix)},
+      ringSize{_ringSize} {
+  }
+};
+
 class PlainUDPCommunication : public ICommunication {
  public:
   static PlainUDPCommunication *create(const PlainUdpConfig &config);
@@ -158,6 +190,10 @@ class PlainUDPCommunication : public ICommunication {
                        const char *const message,
                        const size_t messageLength) override;
 
+  int sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                             const char *const message,
+                             const size_t messageLength) override;
+
   void setReceiver(NodeNum receiverNum,
                    IReceiver *receiver) override;
 
@@ -186,6 +222,10 @@ class PlainTCPCommunication : public ICommunication {
                        const char *const message,
                        const size_t messageLength) override;
 
+  int sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                             const char *const message,
+                             const size_t messageLength) override;
+
   void setReceiver(NodeNum receiverNum,
                    IReceiver *receiver) override;
 
@@ -212,6 +252,10 @@ class TlsTCPCommunication : public ICommunication {
                        const char *const message,
                        const size_t messageLength) override;
 
+  int sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                             const char *const message,
+                             const size_t messageLength) override;
+
   void setReceiver(NodeNum receiverNum,
                    IReceiver *receiver) override;
 
@@ -222,6 +266,32 @@ class TlsTCPCommunication : public ICommunication {
 
   explicit TlsTCPCommunication(const TlsTcpConfig &config);
 };
+
+class SharedMemoryCommunication : public ICommunication {
+ public:
+  static SharedMemoryCommunication *create(const SharedMemoryConfig &config);
+
+  int getMaxMessageSize() override;
+  int Start() override;
+  int Stop() override;
+  bool isRunning() const override;
+  ConnectionStatus getCurrentConnectionStatus(
+      const NodeNum node) const override;
+
+  int sendAsyncMessage(const NodeNum destNode,
+                       const char *const message,
+                       const size_t messageLength) override;
+
+  void setReceiver(NodeNum receiverNum,
+                   IReceiver *receiver) override;
+
+  virtual ~SharedMemoryCommunication();
+ private:
+  class SharedMemoryImpl;
+  SharedMemoryImpl *_ptrImpl = nullptr;
+
+  explicit SharedMemoryCommunication(const SharedMemoryConfig &config);
+};
 }
 
 #endif //BYZ_COMMDEFS_HPP
@@ -26,12 +26,20 @@ class ISimpleInMemoryStateTransfer : public IStateTransfer {
  public:
     virtual void markUpdate(void* ptrToUpdatedRegion,
                             uint32_t sizeOfUpdatedRegion) = 0;
+
+    // true if the updated pages of the state are found automatically
+    // (in this case, calls to markUpdate are not needed)
+    virtual bool tracksDirtyPages() const = 0;
 };
 
+// if trackDirtyPages is true, the pages of the state that are written between
+// checkpoints are found automatically when the platform supports it (see
+// tracksDirtyPages())
 ISimpleInMemoryStateTransfer* create(
                     void* ptrToState, uint32_t sizeOfState,
                     uint16_t myReplicaId, uint16_t fVal,
-                    uint16_t cVal, bool pedanticChecks);
+                    uint16_t cVal, bool pedanticChecks,
+                    bool trackDirtyPages = false);
 
 }  // namespace SimpleInMemoryStateTransfer
 }  // namespace bftEngine
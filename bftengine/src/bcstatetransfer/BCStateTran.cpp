@@ -159,6 +159,7 @@ BCStateTran::BCStateTran(
   sourceReplicaReplacementTimeoutMilli_
                              { config.sourceReplicaReplacementTimeoutMilli },
   fetchRetransmissionTimeoutMilli_{ config.fetchRetransmissionTimeoutMilli },
+  enableCompression_{ config.enableCompression },
   maxVBlockSize_
   { calcMaxVBlockSize(config.maxNumOfReservedPages, kSizeOfReservedPage) },
   maxItemSize_{ calcMaxItemSize(config.maxBlockSize,
@@ -186,11 +187,15 @@ BCStateTran::BCStateTran(
 
   buffer_ = reinterpret_cast<char*>(std::malloc(maxItemSize_));
 
+  if (enableCompression_)
+    compressor_ = new ChunkCompressor(config.numOfCompressionThreads);
+
 
     LOG_INFO(STLogger, "Creating BCStateTran object:" <<
         " myId_=" << myId_ <<
         " fVal_=" << fVal_ <<
-        " kSizeOfReservedPage=" << kSizeOfReservedPage);
+        " kSizeOfReservedPage=" << kSizeOfReservedPage <<
+        " enableCompression_=" << enableCompression_);
 }
 
 BCStateTran::~BCStateTran() {
@@ -199,6 +204,7 @@ BCStateTran::~BCStateTran() {
   Assert(pendingItemDataMsgs.empty());
 
   delete psd_;
+  delete compressor_;
 
   std::free(buffer_);
 }
@@ -388,11 +394,28 @@ STDigest BCStateTran::checkpointReservedPages(uint64_t checkpointNumber) {
       " pending pages with checkpoint " <<
       checkpointNumber);
 
-  for (uint32_t p : pages) {
-    STDigest d;
-    psd_->getPendingResPage(p, buffer_, kSizeOfReservedPage);
-    computeDigestOfPage(p, checkpointNumber, buffer_, d);
-    psd_->associatePendingResPageWithCheckpoint(p, checkpointNumber, d);
+  // the pages are hashed in batches
+  const size_t kBatchSize = 8;
+  std::vector<char> batchBuffer(kBatchSize * kSizeOfReservedPage);
+  uint32_t pageIds[kBatchSize];
+  const char* pagePtrs[kBatchSize];
+  STDigest digests[kBatchSize];
+  size_t batch = 0;
+  for (auto it = pages.begin(); it != pages.end(); ) {
+    char* page = batchBuffer.data() + batch * kSizeOfReservedPage;
+    psd_->getPendingResPage(*it, page, kSizeOfReservedPage);
+    pageIds[batch] = *it;
+    pagePtrs[batch] = page;
+    batch++;
+    ++it;
+
+    if (batch < kBatchSize && it != pages.end()) continue;
+
+    computeDigestsOfPages(batch, pageIds, checkpointNumber, pagePtrs, digests);
+    for (size_t i = 0; i < batch; i++)
+      psd_->associatePendingResPageWithCheckpoint(pageIds[i], checkpointNumber,
+                                                  digests[i]);
+    batch = 0;
   }
 
   memset(buffer_, 0, kSizeOfReservedPage);
@@ -929,6 +952,8 @@ void BCStateTran::sendFetchBlocksMsg(uint64_t firstRequiredBlock,
   msg.firstRequiredBlock = firstRequiredBlock;
   msg.lastRequiredBlock = lastRequiredBlock;
   msg.lastKnownChunkInLastRequiredBlock = lastKnownChunkInLastRequiredBlock;
+  msg.compressionCodec =
+    enableCompression_ ? CompressionCodec::LZ : CompressionCodec::None;
 
     LOG_INFO(STLogger, "BCStateTran::sendFetchBlocksMsg ("
     << " destination" << currentSourceReplica_
@@ -959,6 +984,8 @@ void BCStateTran::sendFetchResPagesMsg(
   msg.lastCheckpointKnownToRequester = lastStoredCheckpoint;
   msg.requiredCheckpointNum = cp.checkpointNum;
   msg.lastKnownChunk = lastKnownChunkInLastRequiredBlock;
+  msg.compressionCodec =
+    enableCompression_ ? CompressionCodec::LZ : CompressionCodec::None;
 
     LOG_INFO(STLogger, "BCStateTran::sendFetchResPagesMsg ("
     << " destination" << currentSourceReplica_
@@ -973,6 +1000,66 @@ void BCStateTran::sendFetchResPagesMsg(
     sizeof(FetchResPagesMsg), currentSourceReplica_);
 }
 
+void BCStateTran::sendItemDataMsgs(std::vector<ItemDataMsg*>& msgs,
+                                   uint16_t replicaId,
+                                   uint8_t compressionCodec) {
+  if (compressionCodec == CompressionCodec::LZ) {
+    Assert(compressor_ != nullptr);
+
+    // a compressed chunk is used only if it is smaller than the raw chunk
+    std::vector<ItemDataMsg*> compressedMsgs;
+    std::vector<ChunkCompressor::Item> items;
+    for (ItemDataMsg* raw : msgs) {
+      ItemDataMsg* c = ItemDataMsg::alloc(raw->dataSize);
+      compressedMsgs.push_back(c);
+      items.push_back({ raw->data, raw->dataSize,
+                        c->data, raw->dataSize - 1, 0 });
+    }
+
+    compressor_->compress(items);
+
+    for (size_t i = 0; i < msgs.size(); i++) {
+      ItemDataMsg* raw = msgs[i];
+      ItemDataMsg* c = compressedMsgs[i];
+      if (items[i].outSize == 0) {
+        ItemDataMsg::free(c);
+        continue;
+      }
+      c->requestMsgSeqNum = raw->requestMsgSeqNum;
+      c->blockNumber = raw->blockNumber;
+      c->totalNumberOfChunksInBlock = raw->totalNumberOfChunksInBlock;
+      c->chunkNumber = raw->chunkNumber;
+      c->compressionCodec = CompressionCodec::LZ;
+      c->rawDataSize = raw->dataSize;
+      c->dataSize = items[i].outSize;
+
+      msgs[i] = c;
+      ItemDataMsg::free(raw);
+    }
+  }
+
+  for (ItemDataMsg* outMsg : msgs) {
+        LOG_INFO(STLogger, "Sending ItemDataMsg ("
+      << " destination" << replicaId
+      << " requestMsgSeqNum" << outMsg->requestMsgSeqNum
+      << " blockNumber" << outMsg->blockNumber
+      << " totalNumberOfChunksInBlock" << outMsg->totalNumberOfChunksInBlock
+      << " chunkNumber" << outMsg->chunkNumber
+      << " compressionCodec" << static_cast<int>(outMsg->compressionCodec)
+      << " rawDataSize" << outMsg->rawDataSize
+      << " dataSize" << outMsg->dataSize
+      << " )");
+
+    replicaForStateTransfer_->sendStateTransferMessage(
+      reinterpret_cast<char*>(outMsg),
+      outMsg->size(), replicaId);
+
+    ItemDataMsg::free(outMsg);
+  }
+
+  msgs.clear();
+}
+
 
 //////////////////////////////////////////////////////////////////////////////
 // Message handlers
@@ -1240,7 +1327,12 @@ bool BCStateTran::onMessage(const FetchBlocksMsg* m,
     return false;
   }
 
+  const uint8_t compressionCodec =
+    (enableCompression_ && m->compressionCodec == CompressionCodec::LZ) ?
+      CompressionCodec::LZ : CompressionCodec::None;
+
   // send chunks
+  std::vector<ItemDataMsg*> outMsgs;
   uint16_t numOfSentChunks = 0;
   while (true) {
     uint32_t chunkSize =
@@ -1259,20 +1351,7 @@ bool BCStateTran::onMessage(const FetchBlocksMsg* m,
     outMsg->dataSize = chunkSize;
     memcpy(outMsg->data, pRawChunk, chunkSize);
 
-        LOG_INFO(STLogger, "Sending ItemDataMsg ("
-      << " destination" << replicaId
-      << " requestMsgSeqNum" << outMsg->requestMsgSeqNum
-      << " blockNumber" << outMsg->blockNumber
-      << " totalNumberOfChunksInBlock" << outMsg->totalNumberOfChunksInBlock
-      << " chunkNumber" << outMsg->chunkNumber
-      << " dataSize" << outMsg->dataSize
-      << " )");
-
-    replicaForStateTransfer_->sendStateTransferMessage(
-      reinterpret_cast<char*>(outMsg),
-      outMsg->size(), replicaId);
-
-    ItemDataMsg::free(outMsg);
+    outMsgs.push_back(outMsg);
 
     numOfSentChunks++;
 
@@ -1308,6 +1387,8 @@ bool BCStateTran::onMessage(const FetchBlocksMsg* m,
 
   memset(buffer_, 0, sizeOfNextBlock);
 
+  sendItemDataMsgs(outMsgs, replicaId, compressionCodec);
+
   return false;
 }
 
@@ -1397,7 +1478,12 @@ bool BCStateTran::onMessage(const FetchResPagesMsg* m,
     return false;
   }
 
+  const uint8_t compressionCodec =
+    (enableCompression_ && m->compressionCodec == CompressionCodec::LZ) ?
+      CompressionCodec::LZ : CompressionCodec::None;
+
   // send chunks
+  std::vector<ItemDataMsg*> outMsgs;
   uint16_t numOfSentChunks = 0;
   while (true) {
     uint32_t chunkSize =
@@ -1415,20 +1501,7 @@ bool BCStateTran::onMessage(const FetchResPagesMsg* m,
     outMsg->dataSize = chunkSize;
     memcpy(outMsg->data, pRawChunk, chunkSize);
 
-        LOG_INFO(STLogger, "Sending ItemDataMsg ("
-      << " destination" << replicaId
-      << " requestMsgSeqNum" << outMsg->requestMsgSeqNum
-      << " blockNumber" << outMsg->blockNumber
-      << " totalNumberOfChunksInBlock" << outMsg->totalNumberOfChunksInBlock
-      << " chunkNumber" << outMsg->chunkNumber
-      << " dataSize" << outMsg->dataSize
-      << " )");
-
-    replicaForStateTransfer_->sendStateTransferMessage(
-      reinterpret_cast<char*>(outMsg),
-      outMsg->size(), replicaId);
-
-    ItemDataMsg::free(outMsg);
+    outMsgs.push_back(outMsg);
 
     numOfSentChunks++;
 
@@ -1444,6 +1517,8 @@ bool BCStateTran::onMessage(const FetchResPagesMsg* m,
     }
   }
 
+  sendItemDataMsgs(outMsgs, replicaId, compressionCodec);
+
   return false;
 }
 
@@ -1529,6 +1604,18 @@ bool BCStateTran::onMessage(const ItemDataMsg* m,
     return false;
   }
 
+  // if msg is invalid (unexpected compression)
+  if ((m->compressionCodec == CompressionCodec::None &&
+       m->rawDataSize != m->dataSize) ||
+      (m->compressionCodec != CompressionCodec::None &&
+       (!enableCompression_ ||
+        m->compressionCodec != CompressionCodec::LZ ||
+        m->rawDataSize == 0 ||
+        m->rawDataSize > maxChunkSize_))) {
+        LOG_WARN(STLogger, "msg is invalid (illegal compression)");
+    return false;
+  }
+
 //  const DataStore::CheckpointDesc fcp = psd_->getCheckpointBeingFetched();
   const uint64_t firstRequiredBlock = psd_->getFirstRequiredBlock();
   const uint64_t lastRequiredBlock = psd_->getLastRequiredBlock();
@@ -1810,7 +1897,7 @@ bool BCStateTran::getNextFullBlock(
     if (totalNumberOfChunks == 0)
       totalNumberOfChunks = msg->totalNumberOfChunksInBlock;
 
-    blockSize += msg->dataSize;
+    blockSize += msg->rawDataSize;
 
     if (totalNumberOfChunks != msg->totalNumberOfChunksInBlock ||
       msg->chunkNumber > totalNumberOfChunks ||
@@ -1866,12 +1953,23 @@ bool BCStateTran::getNextFullBlock(
 
     Assert(currentChunk + 1 == msg->chunkNumber);
 
-    Assert(currentPos + msg->dataSize <= maxSize);
+    Assert(currentPos + msg->rawDataSize <= maxSize);
 
-    memcpy(outBlock + currentPos, msg->data, msg->dataSize);
+    if (msg->compressionCodec == CompressionCodec::None) {
+      memcpy(outBlock + currentPos, msg->data, msg->dataSize);
+    } else if (!decompressChunk(msg->data, msg->dataSize,
+                                outBlock + currentPos, msg->rawDataSize)) {
+      LOG_WARN(STLogger, "Failed to decompress chunk " << msg->chunkNumber
+        << " of block " << requiredBlock);
+
+      memset(outBlock, 0, currentPos + msg->rawDataSize);
+      outBadDataDetected = true;
+      outLastChunkInRequiredBlock = 0;
+      return false;
+    }
 
     currentChunk = msg->chunkNumber;
-    currentPos += msg->dataSize;
+    currentPos += msg->rawDataSize;
 
     totalSizeOfPendingItemDataMsgs -= (*it)->dataSize;
 
@@ -2571,6 +2669,33 @@ void BCStateTran::computeDigestOfPage(
   c.writeDigest(reinterpret_cast<char*>(&outDigest));
 }
 
+void BCStateTran::computeDigestsOfPages(
+  const size_t n, const uint32_t* pageIds, const uint64_t checkpointNumber,
+  const char* const* pages, STDigest* outDigests) {
+  if (checkpointNumber == 0) {
+    for (size_t i = 0; i < n; i++)
+      computeDigestOfPage(pageIds[i], checkpointNumber, pages[i],
+                          outDigests[i]);
+    return;
+  }
+
+  std::vector<DigestContext> contexts(n);
+  std::vector<DigestContext*> contextPtrs(n);
+  std::vector<size_t> lengths(n, kSizeOfReservedPage);
+  for (size_t i = 0; i < n; i++) {
+    DigestContext& c = contexts[i];
+    c.update(reinterpret_cast<const char*>(&pageIds[i]), sizeof(pageIds[i]));
+    c.update(reinterpret_cast<const char*>(&checkpointNumber),
+             sizeof(checkpointNumber));
+    contextPtrs[i] = &c;
+  }
+
+  DigestContext::updateMany(n, contextPtrs.data(), pages, lengths.data());
+
+  for (size_t i = 0; i < n; i++)
+    contexts[i].writeDigest(reinterpret_cast<char*>(&outDigests[i]));
+}
+
 void BCStateTran::computeDigestOfPagesDescriptor(
   const DataStore::ResPagesDescriptor* pagesDesc, STDigest& outDigest) {
   DigestContext c;
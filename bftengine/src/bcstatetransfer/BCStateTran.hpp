@@ -21,6 +21,7 @@
 #include <cassert>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "Logging.hpp"
 #include "SimpleBCStateTransfer.hpp"
@@ -29,6 +30,7 @@
 #include "MsgsCertificate.hpp"
 #include "Messages.hpp"
 #include "STDigest.hpp"
+#include "Compression.hpp"
 
 using std::set;
 using std::map;
@@ -123,7 +125,7 @@ class BCStateTran : public IStateTransfer {
   const uint32_t maxAcceptableMsgDelayMilli_;
   const uint32_t sourceReplicaReplacementTimeoutMilli_;
   const uint32_t fetchRetransmissionTimeoutMilli_;
-
+  const bool enableCompression_;
 
 
   const uint32_t maxVBlockSize_;
@@ -140,6 +142,10 @@ class BCStateTran : public IStateTransfer {
 
   char* buffer_;  // temporary buffer
 
+  // used by the source replica to compress outgoing chunks
+  // (nullptr if compression is disabled)
+  ChunkCompressor* compressor_ = nullptr;
+
   // random generator
   std::random_device randomDevice_;
   std::mt19937 randomGen_;
@@ -195,6 +201,11 @@ class BCStateTran : public IStateTransfer {
 
   void sendFetchResPagesMsg(int16_t lastKnownChunkInLastRequiredBlock);
 
+  // sends the given messages (in order) and frees them. If compressionCodec
+  // is not None, the chunks are compressed before they are sent.
+  void sendItemDataMsgs(std::vector<ItemDataMsg*>& msgs, uint16_t replicaId,
+                        uint8_t compressionCodec);
+
   ///////////////////////////////////////////////////////////////////////////
   // Message handlers
   ///////////////////////////////////////////////////////////////////////////
@@ -335,6 +346,14 @@ class BCStateTran : public IStateTransfer {
              const uint32_t pageId, const uint64_t checkpointNumber,
              const char* page, STDigest& outDigest);
 
+  // the same as computeDigestOfPage(pageIds[i], checkpointNumber, pages[i],
+  // outDigests[i]) for 0 <= i < n (several pages are hashed together when
+  // the CPU supports it)
+  static void computeDigestsOfPages(
+             const size_t n, const uint32_t* pageIds,
+             const uint64_t checkpointNumber, const char* const* pages,
+             STDigest* outDigests);
+
   static void computeDigestOfPagesDescriptor(
              const DataStore::ResPagesDescriptor* pagesDesc,
              STDigest& outDigest);
@@ -0,0 +1,277 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <string.h>
+
+#include "Compression.hpp"
+
+namespace bftEngine {
+namespace SimpleBlockchainStateTransfer {
+namespace impl {
+
+//////////////////////////////////////////////////////////////////////////////
+// LZ codec
+//
+// The compressed data is a sequence of (literals, match) pairs:
+//   token            - 1 byte: 4 high bits literals length, 4 low bits
+//                      match length (minus kMinMatch); the value 15 means
+//                      that the length continues in the following bytes
+//   literals length  - optional, a run of 255s terminated by a byte < 255
+//   literals         - raw bytes
+//   match offset     - 2 bytes (little endian), distance back in the output
+//   match length     - optional, same encoding as the literals length
+// The last sequence contains only literals.
+//////////////////////////////////////////////////////////////////////////////
+
+static const uint32_t kMinMatch = 4;
+static const uint32_t kLastLiterals = 5;
+static const uint32_t kMinMatchStartFromEnd = 12;
+static const uint32_t kMaxOffset = 65535;
+static const uint32_t kHashLog = 12;
+static const uint8_t kLenMask = 15;
+
+static inline uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// hashes the 6 bytes at p (longer than kMinMatch, which avoids many short
+// matches on repetitive key/value data)
+static inline uint32_t hashOf(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return static_cast<uint32_t>(
+      ((v << 16) * 889523592379ULL) >> (64 - kHashLog));
+}
+
+static inline uint32_t sizeOfLenExtension(uint32_t len) {
+  return (len < kLenMask) ? 0 : ((len - kLenMask) / 255 + 1);
+}
+
+static inline uint8_t* writeLenExtension(uint8_t* op, uint32_t len) {
+  if (len < kLenMask) return op;
+  len -= kLenMask;
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = static_cast<uint8_t>(len);
+  return op;
+}
+
+static inline bool readLenExtension(const uint8_t*& ip, const uint8_t* iend,
+                                    uint32_t maxLen, uint32_t& len) {
+  uint8_t b = 0;
+  do {
+    if (ip >= iend) return false;
+    b = *ip++;
+    len += b;
+    if (len > maxLen) return false;
+  } while (b == 255);
+  return true;
+}
+
+// writes one sequence; a sequence with matchLen == 0 has no match part
+static bool writeSequence(uint8_t*& op, const uint8_t* oend,
+                          const uint8_t* literals, uint32_t litLen,
+                          uint32_t offset, uint32_t matchLen) {
+  const uint32_t mlCode = (matchLen == 0) ? 0 : (matchLen - kMinMatch);
+  const size_t needed = 1 + sizeOfLenExtension(litLen) + litLen +
+      ((matchLen == 0) ? 0 : (2 + sizeOfLenExtension(mlCode)));
+
+  if (needed > static_cast<size_t>(oend - op)) return false;
+
+  uint8_t* token = op++;
+  *token = static_cast<uint8_t>(
+      ((litLen < kLenMask ? litLen : kLenMask) << 4) |
+      (mlCode < kLenMask ? mlCode : kLenMask));
+
+  op = writeLenExtension(op, litLen);
+  memcpy(op, literals, litLen);
+  op += litLen;
+
+  if (matchLen == 0) return true;
+
+  *op++ = static_cast<uint8_t>(offset & 0xFF);
+  *op++ = static_cast<uint8_t>(offset >> 8);
+  op = writeLenExtension(op, mlCode);
+  return true;
+}
+
+uint32_t compressChunk(const char* src, uint32_t srcSize,
+                       char* dst, uint32_t dstCapacity) {
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+  uint8_t* op = reinterpret_cast<uint8_t*>(dst);
+  const uint8_t* const oend = op + dstCapacity;
+
+  uint32_t table[1 << kHashLog];
+  memset(table, 0, sizeof(table));
+
+  uint32_t anchor = 0;
+  uint32_t pos = 0;
+
+  if (srcSize >= kMinMatchStartFromEnd) {
+    const uint32_t lastMatchStart = srcSize - kMinMatchStartFromEnd;
+    const uint32_t matchLimit = srcSize - kLastLiterals;
+
+    while (pos <= lastMatchStart) {
+      const uint32_t v = read32(in + pos);
+      const uint32_t h = hashOf(in + pos);
+      const uint32_t candidate = table[h];
+      table[h] = pos;
+
+      if (candidate >= pos || pos - candidate > kMaxOffset ||
+          read32(in + candidate) != v) {
+        pos++;
+        continue;
+      }
+
+      uint32_t len = kMinMatch;
+      while (pos + len < matchLimit && in[candidate + len] == in[pos + len])
+        len++;
+
+      if (!writeSequence(op, oend, in + anchor, pos - anchor,
+                         pos - candidate, len))
+        return 0;
+
+      pos += len;
+      anchor = pos;
+    }
+  }
+
+  if (!writeSequence(op, oend, in + anchor, srcSize - anchor, 0, 0))
+    return 0;
+
+  return static_cast<uint32_t>(op - reinterpret_cast<uint8_t*>(dst));
+}
+
+bool decompressChunk(const char* src, uint32_t srcSize,
+                     char* dst, uint32_t expectedSize) {
+  const uint8_t* ip = reinterpret_cast<const uint8_t*>(src);
+  const uint8_t* const iend = ip + srcSize;
+  uint8_t* const ostart = reinterpret_cast<uint8_t*>(dst);
+  uint8_t* op = ostart;
+  uint8_t* const oend = ostart + expectedSize;
+
+  while (true) {
+    if (ip >= iend) return false;
+
+    const uint8_t token = *ip++;
+
+    uint32_t litLen = token >> 4;
+    if (litLen == kLenMask &&
+        !readLenExtension(ip, iend, expectedSize, litLen))
+      return false;
+
+    if (litLen > static_cast<size_t>(iend - ip) ||
+        litLen > static_cast<size_t>(oend - op))
+      return false;
+
+    memcpy(op, ip, litLen);
+    ip += litLen;
+    op += litLen;
+
+    // the last sequence has only literals
+    if (ip == iend) return (op == oend);
+
+    if (iend - ip < 2) return false;
+
+    const uint32_t offset = ip[0] | (static_cast<uint32_t>(ip[1]) << 8);
+    ip += 2;
+
+    if (offset == 0 || offset > static_cast<size_t>(op - ostart))
+      return false;
+
+    uint32_t matchLen = token & kLenMask;
+    if (matchLen == kLenMask &&
+        !readLenExtension(ip, iend, expectedSize, matchLen))
+      return false;
+    matchLen += kMinMatch;
+
+    if (matchLen > static_cast<size_t>(oend - op)) return false;
+
+    // the source and destination may overlap (offset < matchLen)
+    const uint8_t* match = op - offset;
+    for (uint32_t i = 0; i < matchLen; i++) op[i] = match[i];
+    op += matchLen;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ChunkCompressor
+//////////////////////////////////////////////////////////////////////////////
+
+ChunkCompressor::ChunkCompressor(uint16_t numOfThreads) {
+  for (uint16_t i = 0; i < numOfThreads; i++)
+    threads_.emplace_back(&ChunkCompressor::workerLoop, this);
+}
+
+ChunkCompressor::~ChunkCompressor() {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    stopped_ = true;
+  }
+  workCond_.notify_all();
+
+  for (std::thread& t : threads_) t.join();
+}
+
+void ChunkCompressor::compress(std::vector<Item>& items) {
+  if (items.empty()) return;
+
+  std::unique_lock<std::mutex> lock(lock_);
+  items_ = &items;
+  nextItem_ = 0;
+  numOfPendingItems_ = items.size();
+
+  if (!threads_.empty()) workCond_.notify_all();
+
+  while (processNextItem(lock)) {}
+
+  doneCond_.wait(lock, [this] { return numOfPendingItems_ == 0; });
+  items_ = nullptr;
+}
+
+void ChunkCompressor::workerLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    workCond_.wait(lock, [this] {
+      return stopped_ || (items_ != nullptr && nextItem_ < items_->size());
+    });
+
+    if (stopped_) return;
+
+    while (processNextItem(lock)) {}
+  }
+}
+
+// should be called with lock_ held; the lock is released while compressing
+bool ChunkCompressor::processNextItem(std::unique_lock<std::mutex>& lock) {
+  if (items_ == nullptr || nextItem_ >= items_->size()) return false;
+
+  Item& item = (*items_)[nextItem_++];
+
+  lock.unlock();
+  item.outSize =
+      compressChunk(item.raw, item.rawSize, item.out, item.outCapacity);
+  lock.lock();
+
+  if (--numOfPendingItems_ == 0) doneCond_.notify_all();
+
+  return true;
+}
+
+}  // namespace impl
+}  // namespace SimpleBlockchainStateTransfer
+}  // namespace bftEngine
@@ -0,0 +1,86 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#ifndef BFTENGINE_SRC_BCSTATETRANSFER_COMPRESSION_HPP_
+#define BFTENGINE_SRC_BCSTATETRANSFER_COMPRESSION_HPP_
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bftEngine {
+namespace SimpleBlockchainStateTransfer {
+namespace impl {
+
+class CompressionCodec {
+ public:
+  enum : uint8_t {
+    None = 0,
+    LZ = 1  // LZ77 byte-oriented codec (LZ4 block format)
+  };
+};
+
+// Compresses srcSize bytes from src into dst.
+// Returns the size of the compressed data, or 0 if the compressed data does
+// not fit into dstCapacity bytes (i.e. the input is not compressible enough).
+uint32_t compressChunk(const char* src, uint32_t srcSize,
+                       char* dst, uint32_t dstCapacity);
+
+// Decompresses srcSize bytes from src into dst.
+// Returns true IFF src is well-formed and decompresses to exactly
+// expectedSize bytes. Never writes more than expectedSize bytes to dst.
+bool decompressChunk(const char* src, uint32_t srcSize,
+                     char* dst, uint32_t expectedSize);
+
+// Compresses the chunks of an outgoing batch on a set of worker threads.
+// compress() is called from a single thread, and returns only after all
+// items were processed (the calling thread participates in the work).
+class ChunkCompressor {
+ public:
+  struct Item {
+    const char* raw;
+    uint32_t rawSize;
+    char* out;
+    uint32_t outCapacity;
+    uint32_t outSize;  // 0 if the chunk was not compressed
+  };
+
+  explicit ChunkCompressor(uint16_t numOfThreads);
+  ~ChunkCompressor();
+
+  void compress(std::vector<Item>& items);
+
+ protected:
+  void workerLoop();
+  bool processNextItem(std::unique_lock<std::mutex>& lock);
+
+  std::mutex lock_;
+  std::condition_variable workCond_;
+  std::condition_variable doneCond_;
+
+  std::vector<Item>* items_ = nullptr;
+  size_t nextItem_ = 0;
+  size_t numOfPendingItems_ = 0;
+  bool stopped_ = false;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace impl
+}  // namespace SimpleBlockchainStateTransfer
+}  // namespace bftEngine
+
+#endif  // BFTENGINE_SRC_BCSTATETRANSFER_COMPRESSION_HPP_
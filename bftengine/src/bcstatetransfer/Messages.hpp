@@ -18,6 +18,7 @@
 
 #include "STDigest.hpp"
 #include "IStateTransfer.hpp"
+#include "Compression.hpp"
 
 namespace bftEngine {
 namespace SimpleBlockchainStateTransfer {
@@ -88,6 +89,7 @@ struct FetchBlocksMsg : public BCStateTranBaseMsg {
   uint64_t firstRequiredBlock;
   uint64_t lastRequiredBlock;
   uint16_t lastKnownChunkInLastRequiredBlock;
+  uint8_t compressionCodec;  // codec accepted by the requester (or None)
 };
 
 struct FetchResPagesMsg : public BCStateTranBaseMsg {
@@ -100,6 +102,7 @@ struct FetchResPagesMsg : public BCStateTranBaseMsg {
   uint64_t lastCheckpointKnownToRequester;
   uint64_t requiredCheckpointNum;
   uint16_t lastKnownChunk;
+  uint8_t compressionCodec;  // codec accepted by the requester (or None)
 };
 
 
@@ -122,6 +125,8 @@ struct ItemDataMsg : public BCStateTranBaseMsg {
     memset(buff, 0, s);
     ItemDataMsg* retVal = reinterpret_cast<ItemDataMsg*>(buff);
     retVal->type = MsgType::ItemData;
+    retVal->compressionCodec = CompressionCodec::None;
+    retVal->rawDataSize = dataSize;
     retVal->dataSize = dataSize;
 
     return retVal;
@@ -140,6 +145,12 @@ struct ItemDataMsg : public BCStateTranBaseMsg {
 
   uint16_t chunkNumber;
 
+  uint8_t compressionCodec;
+
+  // size of the chunk after decompression (equals dataSize if the chunk is
+  // not compressed)
+  uint32_t rawDataSize;
+
   uint32_t dataSize;
   char data[1];
 
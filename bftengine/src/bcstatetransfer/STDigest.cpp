@@ -13,8 +13,7 @@
 
 #include "STDigest.hpp"
 
-#include <cryptopp/dll.h>
-
+#include <algorithm>
 #include <cassert>
 #include <string>
 
@@ -39,34 +38,36 @@ std::string STDigest::toString() const {
   return ret;
 }
 
-DigestContext::DigestContext() {
-  CryptoPP::SHA256* p = new CryptoPP::SHA256();
-  internalState = p;
+DigestContext::DigestContext() : valid(true) {
+  static_assert(concordUtil::Sha256::kDigestSize == BLOCK_DIGEST_SIZE, "");
 }
 
 void DigestContext::update(const char* data, size_t len) {
-  assert(internalState != NULL);
-  CryptoPP::SHA256* p = (CryptoPP::SHA256*)internalState;
-  p->Update(reinterpret_cast<byte*>(const_cast<char*>(data)), len);
+  assert(valid);
+  internalState.Update(data, len);
 }
 
 void DigestContext::writeDigest(char* outDigest) {
-  assert(internalState != NULL);
-  CryptoPP::SHA256* p = (CryptoPP::SHA256*)internalState;
-  CryptoPP::SecByteBlock digest(CryptoPP::SHA256::DIGESTSIZE);
-  p->Final(digest);
-  const byte* h = digest;
-  memcpy(outDigest, h, CryptoPP::SHA256::DIGESTSIZE);
-
-  delete p;
-  internalState = NULL;
+  assert(valid);
+  internalState.Finish(outDigest);
+  valid = false;
 }
 
-DigestContext::~DigestContext() {
-  if (internalState != NULL) {
-    CryptoPP::SHA256* p = (CryptoPP::SHA256*)internalState;
-    delete p;
-    internalState = NULL;
+DigestContext::~DigestContext() {}
+
+void DigestContext::updateMany(size_t n, DigestContext* const* contexts,
+                               const char* const* data, const size_t* lengths) {
+  const size_t kMaxBatch = 64;
+  concordUtil::Sha256* states[kMaxBatch];
+  for (size_t i = 0; i < n; i += kMaxBatch) {
+    const size_t batch = std::min(kMaxBatch, n - i);
+    for (size_t j = 0; j < batch; j++) {
+      assert(contexts[i + j]->valid);
+      states[j] = &contexts[i + j]->internalState;
+    }
+    concordUtil::Sha256::UpdateMany(
+        batch, states, reinterpret_cast<const void* const*>(data + i),
+        lengths + i);
   }
 }
 
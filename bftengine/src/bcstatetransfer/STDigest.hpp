@@ -19,6 +19,7 @@
 #include <string>
 
 #include "SimpleBCStateTransfer.hpp"
+#include "Sha256.hpp"
 
 namespace bftEngine {
 namespace SimpleBlockchainStateTransfer {
@@ -73,8 +74,13 @@ class DigestContext {
 
   ~DigestContext();
 
+  // the same as contexts[i]->update(data[i], lengths[i]) for 0 <= i < n
+  static void updateMany(size_t n, DigestContext* const* contexts,
+                         const char* const* data, const size_t* lengths);
+
  protected:
-  void* internalState;
+  concordUtil::Sha256 internalState;  // no heap allocation
+  bool valid;
 };
 
 
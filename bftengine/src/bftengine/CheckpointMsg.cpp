@@ -50,7 +50,7 @@ namespace bftEngine
 
 			//Logger::printInfo("CheckpointMsg::ToActualMsgType - 4");
 
-			if (t->seqNumber() % checkpointWindowSize != 0) return false;
+			if (t->seqNumber() % repInfo.checkpointWindowSize() != 0) return false;
 
 			//Logger::printInfo("CheckpointMsg::ToActualMsgType - 5");
 
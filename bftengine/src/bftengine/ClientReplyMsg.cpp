@@ -45,11 +45,61 @@ namespace bftEngine
 			setMsgSize(sizeof(ClientReplyMsgHeader) + replyLength);
 		}
 
+		ClientReplyMsg::ClientReplyMsg(ReplicaId replicaId, ReqId reqSeqNum, char* reply, uint32_t replyLength,
+			ViewNum viewNum, SeqNum seqNum, const Digest& historyDigest)
+			: MessageBase(replicaId, MsgCode::TentativeReply, sizeof(ClientTentativeReplyMsgHeader) + replyLength)
+		{
+			b()->reqSeqNum = reqSeqNum;
+			b()->currentPrimaryId = 0;
+			b()->replyLength = replyLength;
+			t()->viewNum = viewNum;
+			t()->seqNum = seqNum;
+			memcpy(t()->historyDigest, historyDigest.content(), sizeof(Digest));
+
+			memcpy(body() + sizeof(ClientTentativeReplyMsgHeader), reply, replyLength);
+			setMsgSize(sizeof(ClientTentativeReplyMsgHeader) + replyLength);
+		}
+
 		void ClientReplyMsg::setReplyLength(uint32_t replyLength)
 		{
 			Assert(replyLength <= maxReplyLength());
 			b()->replyLength = replyLength;
-			setMsgSize(sizeof(ClientReplyMsgHeader) + replyLength);
+			setMsgSize(headerSize() + replyLength);
+		}
+
+		Digest ClientReplyMsg::historyDigest() const
+		{
+			Assert(isTentative());
+			Digest d;
+			memcpy(d.content(), t()->historyDigest, sizeof(Digest));
+			return d;
+		}
+
+		bool ClientReplyMsg::equivalent(ClientReplyMsg* r1, ClientReplyMsg* r2)
+		{
+			if (r1->reqSeqNum() != r2->reqSeqNum()) return false;
+
+			if (r1->currentPrimaryId() != r2->currentPrimaryId()) return false;
+
+			if (r1->isTentative() != r2->isTentative()) return false;
+
+			if (r1->isTentative())
+			{
+				if (r1->viewNumber() != r2->viewNumber()) return false;
+
+				if (r1->seqNumber() != r2->seqNumber()) return false;
+
+				if (memcmp(r1->t()->historyDigest, r2->t()->historyDigest, sizeof(Digest)) != 0) return false;
+			}
+
+			if (r1->replyLength() != r2->replyLength()) return false;
+
+			char* p1 = r1->replyBuf();
+			char* p2 = r2->replyBuf();
+
+			if (memcmp(p1, p2, r1->replyLength()) != 0) return false;
+
+			return true;
 		}
 
 		void ClientReplyMsg::setPrimaryId(ReplicaId primaryId)
@@ -60,12 +110,13 @@ namespace bftEngine
 
 		bool ClientReplyMsg::ToActualMsgType(NodeIdType myId, MessageBase* inMsg, ClientReplyMsg*& outMsg)
 		{
-			Assert(inMsg->type() == MsgCode::Reply);
+			Assert(inMsg->type() == MsgCode::Reply || inMsg->type() == MsgCode::TentativeReply);
 			if (inMsg->size() < sizeof(ClientReplyMsgHeader)) return false;
+			if (inMsg->type() == MsgCode::TentativeReply && inMsg->size() < sizeof(ClientTentativeReplyMsgHeader)) return false;
 
 			ClientReplyMsg* t = (ClientReplyMsg*)inMsg;
 
-			if (t->size() < ((int)sizeof(ClientReplyMsgHeader) + t->replyLength()))
+			if (t->size() < ((int)t->headerSize() + t->replyLength()))
 				return false;
 
 			outMsg = (ClientReplyMsg*)inMsg;
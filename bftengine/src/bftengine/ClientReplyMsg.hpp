@@ -10,6 +10,7 @@
 
 #include "MessageBase.hpp"
 #include "ClientMsgs.hpp"
+#include "Digest.hpp"
 
 namespace bftEngine
 {
@@ -20,10 +21,14 @@ namespace bftEngine
 		class ClientReplyMsg : public MessageBase
 		{
 			static_assert((uint16_t)REPLY_MSG_TYPE == (uint16_t)MsgCode::Reply, "");
+			static_assert((uint16_t)TENTATIVE_REPLY_MSG_TYPE == (uint16_t)MsgCode::TentativeReply, "");
 			static_assert(sizeof(ClientReplyMsgHeader::msgType) == sizeof(MessageBase::Header), "");
 			static_assert(sizeof(ClientReplyMsgHeader::reqSeqNum) == sizeof(ReqId), "");
 			static_assert(sizeof(ClientReplyMsgHeader::currentPrimaryId) == sizeof(ReplicaId), "");
 			static_assert(sizeof(ClientReplyMsgHeader) == 16, "ClientRequestMsgHeader is 16B");
+			static_assert(sizeof(ClientTentativeReplyMsgHeader::viewNum) == sizeof(ViewNum), "");
+			static_assert(sizeof(ClientTentativeReplyMsgHeader::seqNum) == sizeof(SeqNum), "");
+			static_assert(sizeof(ClientTentativeReplyMsgHeader::historyDigest) == sizeof(Digest), "");
 			// TODO(GG): more asserts
 
 		public:
@@ -35,7 +40,12 @@ namespace bftEngine
 
 			ClientReplyMsg(ReplicaId replicaId, uint32_t replyLength);
 
-			uint32_t maxReplyLength() const { return internalStorageSize() - sizeof(ClientReplyMsgHeader); }
+			// a tentative reply: the reply of a speculative execution of the request at seqNum (in view viewNum),
+			// where historyDigest is the digest of the speculative history up to seqNum
+			ClientReplyMsg(ReplicaId replicaId, ReqId reqSeqNum, char* reply, uint32_t replyLength,
+				ViewNum viewNum, SeqNum seqNum, const Digest& historyDigest);
+
+			uint32_t maxReplyLength() const { return internalStorageSize() - headerSize(); }
 
 			ReqId reqSeqNum() const { return b()->reqSeqNum; }
 
@@ -43,12 +53,26 @@ namespace bftEngine
 
 			uint32_t replyLength() const { return b()->replyLength; }
 
-			char* replyBuf() const { return body() + sizeof(ClientReplyMsgHeader); }
+			char* replyBuf() const { return body() + headerSize(); }
 
 			void setReplyLength(uint32_t replyLength);
 
 			void setPrimaryId(ReplicaId primaryId);
 
+			// a tentative reply is the result of a speculative execution (see ReplicaConfig::speculativeExecution)
+			bool isTentative() const { return b()->msgType == MsgCode::TentativeReply; }
+
+			// the following methods are only used for tentative replies
+
+			ViewNum viewNumber() const { return t()->viewNum; }
+
+			SeqNum seqNumber() const { return t()->seqNum; }
+
+			Digest historyDigest() const;
+
+			// used by MsgsCertificate: tentative replies are equivalent only if they were executed at the same
+			// SeqNum of the same view, after the same history
+			static bool equivalent(ClientReplyMsg* r1, ClientReplyMsg* r2);
 
 			uint64_t debugHash() const;
 
@@ -63,6 +87,17 @@ namespace bftEngine
 			{
 				return (ClientReplyMsgHeader*)msgBody_;
 			}
+
+		protected:
+			ClientTentativeReplyMsgHeader* t() const
+			{
+				return (ClientTentativeReplyMsgHeader*)msgBody_;
+			}
+
+			uint32_t headerSize() const
+			{
+				return isTentative() ? sizeof(ClientTentativeReplyMsgHeader) : sizeof(ClientReplyMsgHeader);
+			}
 		};
 	}
 }
@@ -8,6 +8,7 @@
 
 #include <cstring>
 #include "ClientRequestMsg.hpp"
+#include "Crypto.hpp"
 #include "assertUtils.hpp"
 
 namespace bftEngine
@@ -24,7 +25,8 @@ namespace bftEngine
 
 		static int32_t compRequestMsgSize(const ClientRequestMsgHeader* r)
 		{
-			return (sizeof(ClientRequestMsgHeader) + r->requestLength);
+			const uint32_t sigLength = ((r->flags & 0x4) != 0) ? ClientRequestMsg::signatureLength : 0;
+			return (sizeof(ClientRequestMsgHeader) + r->requestLength + sigLength);
 		}
 
 		uint32_t getRequestSizeTemp(const char* request) // TODO(GG): change - TBD
@@ -37,8 +39,8 @@ namespace bftEngine
 
 		// class ClientRequestMsg
 
-		ClientRequestMsg::ClientRequestMsg(NodeIdType sender, bool isReadOnly, uint64_t reqSeqNum, uint32_t requestLength, const char* request)
-			: MessageBase(sender, MsgCode::Request, (sizeof(ClientRequestMsgHeader) + requestLength))
+		ClientRequestMsg::ClientRequestMsg(NodeIdType sender, bool isReadOnly, uint64_t reqSeqNum, uint32_t requestLength, const char* request, bool withSignature)
+			: MessageBase(sender, MsgCode::Request, (sizeof(ClientRequestMsgHeader) + requestLength + (withSignature ? signatureLength : 0)))
 		{
 			// TODO(GG): asserts
 
@@ -50,7 +52,7 @@ namespace bftEngine
 
 			memcpy(body() + sizeof(ClientRequestMsgHeader), request, requestLength);
 
-
+			setMsgSize(sizeof(ClientRequestMsgHeader) + requestLength);
 		}
 
 		ClientRequestMsg::ClientRequestMsg(NodeIdType sender)
@@ -81,6 +83,20 @@ namespace bftEngine
 			setMsgSize(sizeof(ClientRequestMsgHeader) + requestLength);
 		}
 
+		void ClientRequestMsg::sign(ISigner& signer)
+		{
+			Assert(signer.signatureLength() == signatureLength);
+			Assert(signedDataLength() + signatureLength <= internalStorageSize());
+
+			b()->flags |= 0x4;
+
+			size_t actualSigLength = 0;
+			signer.sign(body(), signedDataLength(), body() + signedDataLength(), signatureLength, actualSigLength);
+			Assert(actualSigLength == signatureLength);
+
+			setMsgSize(signedDataLength() + signatureLength);
+		}
+
 		void ClientRequestMsg::setAsReadWrite()
 		{
 			const uint8_t m = ~((uint8_t)0x1);
@@ -93,7 +109,7 @@ namespace bftEngine
 
 			ClientRequestMsg* t = (ClientRequestMsg*)inMsg;
 
-			if (t->size() < (sizeof(ClientRequestMsgHeader) + t->b()->requestLength)) return false;
+			if (t->size() < (uint32_t)compRequestMsgSize(t->b())) return false;
 
 			outMsg = t;
 
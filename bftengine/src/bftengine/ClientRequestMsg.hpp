@@ -16,6 +16,7 @@ namespace bftEngine
 {
 	namespace impl
 	{
+		class ISigner;
 
 		class ClientRequestMsg : public MessageBase
 		{
@@ -30,7 +31,11 @@ namespace bftEngine
 			// TODO(GG): more asserts
 
 		public:
-			ClientRequestMsg(NodeIdType sender, bool isReadOnly, uint64_t reqSeqNum, uint32_t requestLength, const char* request);
+			// length of the signature of a signed request (Ed25519, see ReplicaConfig::publicKeysOfClients)
+			static const uint16_t signatureLength = 64;
+
+			// if withSignature, the message also has space for the signature of the client (see sign())
+			ClientRequestMsg(NodeIdType sender, bool isReadOnly, uint64_t reqSeqNum, uint32_t requestLength, const char* request, bool withSignature = false);
 
 			ClientRequestMsg(NodeIdType sender);
 
@@ -42,6 +47,9 @@ namespace bftEngine
 
 			bool isReadOnly() const { return (b()->flags & 0x1) != 0; }
 
+			// a traced request is identified by (clientProxyId(), requestSeqNum())
+			bool isTraced() const { return (b()->flags & 0x2) != 0; }
+
 			ReqId requestSeqNum() const { return b()->reqSeqNum; }
 
 			uint32_t requestLength() const { return b()->requestLength; }
@@ -52,6 +60,18 @@ namespace bftEngine
 
 			void setAsReadWrite();
 
+			void setAsTraced() { b()->flags |= 0x2; }
+
+			// a signed request is followed by the signature of its client, on the header and the request
+			bool isSigned() const { return (b()->flags & 0x4) != 0; }
+
+			uint32_t signedDataLength() const { return sizeof(ClientRequestMsgHeader) + requestLength(); }
+
+			const char* signature() const { return body() + signedDataLength(); }
+
+			// signs the request with the EdDSA signer of the client (after its flags are set)
+			void sign(ISigner& signer);
+
 			static bool ToActualMsgType(const ReplicasInfo& repInfo, MessageBase* inMsg, ClientRequestMsg*& outMsg);
 
 		protected:
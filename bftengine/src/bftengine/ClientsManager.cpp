@@ -7,6 +7,7 @@
 //This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
 
 #include <string.h>
+#include <algorithm>
 #include "ClientsManager.hpp"
 #include "ClientReplyMsg.hpp"
 #include "ClientRequestMsg.hpp"
@@ -19,12 +20,22 @@ namespace bftEngine
 	namespace impl
 	{
  
-		ClientsManager::ClientsManager(ReplicaId myId, std::set<NodeIdType>& clientsSet, uint32_t sizeOfReservedPage) :
+		const uint16_t ClientsManager::InvalidClientIndex;
+
+		ClientsManager::ClientsManager(ReplicaId myId, std::set<NodeIdType>& clientsSet, uint32_t sizeOfReservedPage, uint32_t maxReplySize) :
 			myId_ (myId),
 			sizeOfReservedPage_(sizeOfReservedPage),
-			indexToClientInfo_(clientsSet.size())
+			maxReplySize_(maxReplySize),
+			indexToClientInfo_(clientsSet.size()),
+			indexToCachedReply_(clientsSet.size())
 		{
 			Assert(clientsSet.size() >= 1);
+			Assert(clientsSet.size() < InvalidClientIndex);
+
+			// client ids are consecutive in practice, so the direct-index table is dense
+			firstClientId_ = *clientsSet.begin();
+			const NodeIdType lastClientId = *clientsSet.rbegin();
+			clientIdToIndex_.assign((size_t)(lastClientId - firstClientId_) + 1, InvalidClientIndex);
 
 			scratchPage_ = (char*)std::malloc(sizeOfReservedPage);
 			memset(scratchPage_, 0, sizeOfReservedPage);
@@ -32,7 +43,7 @@ namespace bftEngine
 			uint16_t idx = 0;
 			for (NodeIdType c : clientsSet)
 			{
-				clientIdToIndex_.insert(std::pair<NodeIdType, uint16_t>(c, idx));
+				clientIdToIndex_[c - firstClientId_] = idx;
 
 				indexToClientInfo_[idx].currentPendingRequest = 0;
 				indexToClientInfo_[idx].timeOfCurrentPendingRequest = MinTime;
@@ -43,12 +54,26 @@ namespace bftEngine
 				idx++;
 			}
 
-			reservedPagesPerClient_ = maxReplyMessageSize / sizeOfReservedPage;
-			if (maxReplyMessageSize % sizeOfReservedPage != 0) reservedPagesPerClient_++;
+			sizeOfReplySlot_ = sizeof(ClientReplyMsgHeader) + maxReplySize;
+			Assert(maxReplySize > 0 && sizeOfReplySlot_ <= maxReplyMessageSize);
+
+			// the replies of several clients share a reserved page if they fit in it (so the number of reserved pages
+			// is not the limit on the number of clients)
+			if (sizeOfReplySlot_ <= sizeOfReservedPage)
+			{
+				clientsPerPage_ = sizeOfReservedPage / sizeOfReplySlot_;
+				reservedPagesPerClient_ = 1;
+			}
+			else
+			{
+				clientsPerPage_ = 1;
+				reservedPagesPerClient_ = sizeOfReplySlot_ / sizeOfReservedPage;
+				if (sizeOfReplySlot_ % sizeOfReservedPage != 0) reservedPagesPerClient_++;
+			}
 
-			uint16_t numOfClients = (uint16_t)clientsSet.size();
+			const uint32_t numOfClients = (uint32_t)clientsSet.size();
 
-			requiredNumberOfPages_ = (numOfClients * reservedPagesPerClient_);
+			requiredNumberOfPages_ = ((numOfClients + clientsPerPage_ - 1) / clientsPerPage_) * reservedPagesPerClient_;
 		}
 		 
 
@@ -71,26 +96,31 @@ namespace bftEngine
 		}
 
 		void ClientsManager::clearReservedPages()
-		{			
+		{
+			clearCachedReplies();
+
 			for (uint32_t i = 0; i < requiredNumberOfPages_; i++)
 				stateTransfer_->zeroReservedPage(i);
 		}
 
 		void ClientsManager::loadInfoFromReservedPages()
 		{
-			for (std::pair<NodeIdType, uint16_t> e : clientIdToIndex_)
+			clearCachedReplies(); // the reserved pages may contain newer replies (e.g., after state transfer)
+
+			for (uint16_t idx = 0; idx < indexToClientInfo_.size(); idx++)
 			{
-				const uint32_t firstPageId = e.second * reservedPagesPerClient_;
+				const uint32_t offset = offsetInPageOf(idx);
 
-				stateTransfer_->loadReservedPage(firstPageId, sizeOfReservedPage_, scratchPage_);
+				// the page is loaded once for all the clients that share it
+				if (offset == 0) stateTransfer_->loadReservedPage(firstPageOf(idx), sizeOfReservedPage_, scratchPage_);
 
-				ClientReplyMsgHeader* replyHeader = (ClientReplyMsgHeader*)scratchPage_;
+				ClientReplyMsgHeader* replyHeader = (ClientReplyMsgHeader*)(scratchPage_ + offset);
 				Assert(replyHeader->msgType == 0 || replyHeader->msgType == MsgCode::Reply);
 				Assert(replyHeader->currentPrimaryId == 0);
 				Assert(replyHeader->replyLength >= 0);
-				Assert(replyHeader->replyLength + sizeof(ClientReplyMsgHeader)  <= maxReplyMessageSize);
+				Assert(replyHeader->replyLength + sizeof(ClientReplyMsgHeader) <= sizeOfReplySlot_);
 
-				ClientInfo& ci = indexToClientInfo_.at(e.second);
+				ClientInfo& ci = indexToClientInfo_[idx];
 				ci.lastSeqNumberOfReply = replyHeader->reqSeqNum;
 				ci.latestReplyTime = MinTime;
 
@@ -103,23 +133,95 @@ namespace bftEngine
 			}
 		}
 
-		ReqId ClientsManager::seqNumberOfLastReplyToClient(NodeIdType clientId)
+		void ClientsManager::flushRepliesToReservedPages()
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			ReqId retVal = indexToClientInfo_.at(idx).lastSeqNumberOfReply;
-			return retVal;
+			if (clientsPerPage_ == 1)
+			{
+				for (uint16_t clientIdx : dirtyReplies_)
+				{
+					CachedReply& c = indexToCachedReply_[clientIdx];
+					Assert(c.dirty);
+					writeReplyToReservedPages(clientIdx, c.msg.data(), (uint32_t)c.msg.size());
+					c.dirty = false;
+				}
+
+				dirtyReplies_.clear();
+				return;
+			}
+
+			// each page is loaded and saved once for all the dirty replies in it
+			std::sort(dirtyReplies_.begin(), dirtyReplies_.end());
+
+			size_t i = 0;
+			while (i < dirtyReplies_.size())
+			{
+				const uint32_t pageId = firstPageOf(dirtyReplies_[i]);
+				stateTransfer_->loadReservedPage(pageId, sizeOfReservedPage_, scratchPage_);
+
+				for (; i < dirtyReplies_.size() && firstPageOf(dirtyReplies_[i]) == pageId; i++)
+				{
+					const uint16_t clientIdx = dirtyReplies_[i];
+					CachedReply& c = indexToCachedReply_[clientIdx];
+					Assert(c.dirty);
+					Assert(c.msg.size() <= sizeOfReplySlot_);
+
+					// the rest of the slot is zeroed, so the reserved pages do not depend on earlier replies
+					char* const slot = scratchPage_ + offsetInPageOf(clientIdx);
+					memcpy(slot, c.msg.data(), c.msg.size());
+					memset(slot + c.msg.size(), 0, sizeOfReplySlot_ - c.msg.size());
+					c.dirty = false;
+				}
+
+				stateTransfer_->saveReservedPage(pageId, sizeOfReservedPage_, scratchPage_);
+			}
+
+			dirtyReplies_.clear();
+		}
+
+		void ClientsManager::writeReplyToReservedPages(uint16_t clientIdx, const char* msg, uint32_t msgSize)
+		{
+			const uint32_t firstPageId = firstPageOf(clientIdx);
+
+			uint32_t numOfPages = msgSize / sizeOfReservedPage_;
+			uint32_t sizeLastPage = sizeOfReservedPage_;
+
+			if (msgSize % sizeOfReservedPage_ != 0)
+			{
+				numOfPages++;
+				sizeLastPage = msgSize % sizeOfReservedPage_;
+			}
+
+			for (uint32_t i = 0; i < numOfPages; i++)
+			{
+				const char* ptrPage = msg + i * sizeOfReservedPage_;
+				const uint32_t sizePage = ((i < numOfPages - 1) ? sizeOfReservedPage_ : sizeLastPage);
+				stateTransfer_->saveReservedPage(firstPageId + i, sizePage, ptrPage);
+			}
 		}
 
-		bool ClientsManager::isValidClient(NodeIdType clientId) const
+		void ClientsManager::clearCachedReplies()
 		{
-			return (clientIdToIndex_.count(clientId) > 0);
+			for (CachedReply& c : indexToCachedReply_)
+			{
+				c.msg.clear();
+				c.dirty = false;
+			}
+
+			dirtyReplies_.clear();
+		}
+
+		ReqId ClientsManager::seqNumberOfLastReplyToClient(NodeIdType clientId)
+		{
+			uint16_t idx = indexOf(clientId);
+			ReqId retVal = indexToClientInfo_[idx].lastSeqNumberOfReply;
+			return retVal;
 		}
 
 
 		void ClientsManager::getInfoAboutLastReplyToClient(NodeIdType clientId, ReqId& outSeqNumber, Time& outLatestTime)
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			const ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			const ClientInfo& c = indexToClientInfo_[idx];
 
 			outSeqNumber = c.lastSeqNumberOfReply;
 			outLatestTime = c.latestReplyTime;
@@ -127,11 +229,11 @@ namespace bftEngine
 
 		ClientReplyMsg* ClientsManager::allocateNewReplyMsgAndWriteToStorage(NodeIdType clientId, ReqId requestSeqNum, uint16_t currentPrimaryId, char* reply, uint32_t replyLength)
 		{
-			//Assert(replyLength <= .... ) - TODO(GG)
+			Assert(replyLength <= maxReplySize_);
 
-			const uint16_t clientIdx = clientIdToIndex_.at(clientId);
+			const uint16_t clientIdx = indexOf(clientId);
 
-			ClientInfo& c = indexToClientInfo_.at(clientIdx);
+			ClientInfo& c = indexToClientInfo_[clientIdx];
 
 			Assert(c.lastSeqNumberOfReply < requestSeqNum);
 
@@ -142,28 +244,13 @@ namespace bftEngine
 
 			ClientReplyMsg* const r = new ClientReplyMsg(myId_, requestSeqNum, reply, replyLength);
 
-			const uint32_t firstPageId = clientIdx * reservedPagesPerClient_;
-
-			//LOG_INFO_F(GL, "allocateNewReplyMsgAndWriteToStorage - firstPageId=%d", (int)firstPageId);
-
-			uint32_t numOfPages = r->size() / sizeOfReservedPage_;
-			uint32_t sizeLastPage = sizeOfReservedPage_;
-
-			if (r->size() % sizeOfReservedPage_ != 0)
-			{
-				numOfPages++;
-				sizeLastPage = r->size() % sizeOfReservedPage_;
-			}
-
-			//LOG_INFO_F(GL, "allocateNewReplyMsgAndWriteToStorage - numOfPages=%d", (int)numOfPages);
-			//LOG_INFO_F(GL, "allocateNewReplyMsgAndWriteToStorage - sizeLastPage=%d", (int)sizeLastPage);
-
-			// write reply message to reserved pages 
-			for (uint32_t i = 0; i < numOfPages; i++)
+			// keep the reply message in memory (it is written to the reserved pages by flushRepliesToReservedPages)
+			CachedReply& cached = indexToCachedReply_[clientIdx];
+			cached.msg.assign(r->body(), r->body() + r->size());
+			if (!cached.dirty)
 			{
-				const char* ptrPage = r->body() + i * sizeOfReservedPage_;
-				const uint32_t sizePage = ((i < numOfPages - 1) ? sizeOfReservedPage_ : sizeLastPage);
-				stateTransfer_->saveReservedPage(firstPageId + i, sizePage, ptrPage); 
+				cached.dirty = true;
+				dirtyReplies_.push_back(clientIdx);
 			}
 
 			// write currentPrimaryId to message (we don't store the currentPrimaryId in the reserved pages)
@@ -177,49 +264,71 @@ namespace bftEngine
 
 		ClientReplyMsg* ClientsManager::allocateMsgWithLatestReply(NodeIdType clientId, uint16_t currentPrimaryId)
 		{
-			const uint16_t clientIdx = clientIdToIndex_.at(clientId);
+			const uint16_t clientIdx = indexOf(clientId);
 
-			ClientInfo& info = indexToClientInfo_.at(clientIdx);
+			ClientInfo& info = indexToClientInfo_[clientIdx];
 
 			Assert(info.lastSeqNumberOfReply != 0);
 
+			CachedReply& cached = indexToCachedReply_[clientIdx];
+			if (!cached.msg.empty())
+			{
+				const ClientReplyMsgHeader* cachedHeader = (const ClientReplyMsgHeader*)cached.msg.data();
+				Assert(cachedHeader->reqSeqNum == info.lastSeqNumberOfReply);
+
+				ClientReplyMsg* const r = new ClientReplyMsg(myId_, cachedHeader->replyLength);
+				memcpy(r->body(), cached.msg.data(), cached.msg.size());
+				r->setPrimaryId(currentPrimaryId);
+				return r;
+			}
+
 			//LOG_INFO_F(GL, "allocateMsgWithLatestReply - info.lastSeqNumberOfReply=%d", (int)info.lastSeqNumberOfReply);
 
-			const uint32_t firstPageId = clientIdx * reservedPagesPerClient_;
+			const uint32_t firstPageId = firstPageOf(clientIdx);
 
 			//LOG_INFO_F(GL, "allocateMsgWithLatestReply - firstPageId=%d", (int)firstPageId);
 
 			stateTransfer_->loadReservedPage(firstPageId, sizeOfReservedPage_, scratchPage_);
 
-			ClientReplyMsgHeader* replyHeader = (ClientReplyMsgHeader*)scratchPage_;
+			ClientReplyMsgHeader* replyHeader = (ClientReplyMsgHeader*)(scratchPage_ + offsetInPageOf(clientIdx));
 			Assert(replyHeader->msgType == MsgCode::Reply); 
 			Assert(replyHeader->currentPrimaryId == 0);
 			Assert(replyHeader->replyLength > 0);
-			Assert(replyHeader->replyLength + sizeof(ClientReplyMsgHeader) <= maxReplyMessageSize);
+			Assert(replyHeader->replyLength + sizeof(ClientReplyMsgHeader) <= sizeOfReplySlot_);
 
 			uint32_t replyMsgSize = sizeof(ClientReplyMsgHeader) + replyHeader->replyLength;
 
-			uint32_t numOfPages = replyMsgSize / sizeOfReservedPage_;
-			uint32_t sizeLastPage = sizeOfReservedPage_;
-			if (replyMsgSize % sizeOfReservedPage_ != 0)
+			ClientReplyMsg* const r = new ClientReplyMsg(myId_, replyHeader->replyLength);
+
+			if (reservedPagesPerClient_ == 1)
 			{
-				numOfPages++;
-				sizeLastPage = replyMsgSize % sizeOfReservedPage_;
+				// the reply is in the page that was loaded
+				memcpy(r->body(), replyHeader, replyMsgSize);
 			}
+			else
+			{
+				uint32_t numOfPages = replyMsgSize / sizeOfReservedPage_;
+				uint32_t sizeLastPage = sizeOfReservedPage_;
+				if (replyMsgSize % sizeOfReservedPage_ != 0)
+				{
+					numOfPages++;
+					sizeLastPage = replyMsgSize % sizeOfReservedPage_;
+				}
 
-			//LOG_INFO_F(GL, "allocateMsgWithLatestReply - numOfPages=%d", (int)numOfPages);
-			//LOG_INFO_F(GL, "allocateMsgWithLatestReply - sizeLastPage=%d", (int)sizeLastPage);
+				//LOG_INFO_F(GL, "allocateMsgWithLatestReply - numOfPages=%d", (int)numOfPages);
+				//LOG_INFO_F(GL, "allocateMsgWithLatestReply - sizeLastPage=%d", (int)sizeLastPage);
 
-			ClientReplyMsg* const r = new ClientReplyMsg(myId_, replyHeader->replyLength);
-			
-			// load reply message from reserved pages 
-			for (uint32_t i = 0; i < numOfPages; i++)
-			{
-				char* const ptrPage = r->body() + i * sizeOfReservedPage_;
-				const uint32_t sizePage = ((i < numOfPages - 1) ? sizeOfReservedPage_ : sizeLastPage);
-				stateTransfer_->loadReservedPage(firstPageId + i, sizePage, ptrPage);
+				// load reply message from reserved pages 
+				for (uint32_t i = 0; i < numOfPages; i++)
+				{
+					char* const ptrPage = r->body() + i * sizeOfReservedPage_;
+					const uint32_t sizePage = ((i < numOfPages - 1) ? sizeOfReservedPage_ : sizeLastPage);
+					stateTransfer_->loadReservedPage(firstPageId + i, sizePage, ptrPage);
+				}
 			}
-			
+
+			cached.msg.assign(r->body(), r->body() + r->size());
+
 			r->setPrimaryId(currentPrimaryId);
 
 			LOG_INFO_F(GL, "allocateMsgWithLatestReply returns reply with hash=%" PRIu64"", r->debugHash());
@@ -230,8 +339,8 @@ namespace bftEngine
 
 		bool ClientsManager::noPendingAndRequestCanBecomePending(NodeIdType clientId, ReqId reqSeqNum) const
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			const ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			const ClientInfo& c = indexToClientInfo_[idx];
 
 			if (c.currentPendingRequest != 0) return false; // if has pending request
 
@@ -243,8 +352,8 @@ namespace bftEngine
 		/*
 		bool ClientsManager::isPendingOrLate(NodeIdType clientId, ReqId reqSeqNum) const
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			const ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			const ClientInfo& c = indexToClientInfo_[idx];
 			bool retVal = (reqSeqNum <= c.lastSeqNumberOfReply || reqSeqNum <= c.currentPendingRequest);
 			return retVal;
 		}
@@ -253,8 +362,8 @@ namespace bftEngine
 
 		void ClientsManager::addPendingRequest(NodeIdType clientId, ReqId reqSeqNum)
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			ClientInfo& c = indexToClientInfo_[idx];
 			Assert(reqSeqNum > c.lastSeqNumberOfReply && reqSeqNum > c.currentPendingRequest);
 
 			c.currentPendingRequest = reqSeqNum;
@@ -264,8 +373,8 @@ namespace bftEngine
 		/*
 		void ClientsManager::removePendingRequest(NodeIdType clientId, ReqId reqSeqNum)
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			ClientInfo& c = indexToClientInfo_[idx];
 
 			if (c.currentPendingRequest == reqSeqNum)
 			{
@@ -277,8 +386,8 @@ namespace bftEngine
 
 		void ClientsManager::removeEarlierPendingRequests(NodeIdType clientId, ReqId reqSeqNum)
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			ClientInfo& c = indexToClientInfo_[idx];
 
 			if (c.currentPendingRequest < reqSeqNum)
 			{
@@ -290,8 +399,8 @@ namespace bftEngine
 
 		void ClientsManager::removeEarlierOrEqualPendingRequests(NodeIdType clientId, ReqId reqSeqNum)
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			ClientInfo& c = indexToClientInfo_[idx];
 
 			if (c.currentPendingRequest <= reqSeqNum)
 			{
@@ -304,8 +413,8 @@ namespace bftEngine
 
 		void ClientsManager::removePendingRequestOfClient(NodeIdType clientId)
 		{
-			uint16_t idx = clientIdToIndex_.at(clientId);
-			ClientInfo& c = indexToClientInfo_.at(idx);
+			uint16_t idx = indexOf(clientId);
+			ClientInfo& c = indexToClientInfo_[idx];
 
 			if (c.currentPendingRequest != 0)
 			{
@@ -10,8 +10,8 @@
  
 #include "PrimitiveTypes.hpp"
 #include "TimeUtils.hpp"
+#include "assertUtils.hpp"
 
-#include <map>
 #include <set>
 #include <vector>
 
@@ -27,7 +27,8 @@ namespace bftEngine
 		class ClientsManager
 		{
 		public:
-			ClientsManager(ReplicaId myId, std::set<NodeIdType>& clientsSet, uint32_t sizeOfReservedPage);
+			// maxReplySize is the max length of a reply (without the header of the reply message)
+			ClientsManager(ReplicaId myId, std::set<NodeIdType>& clientsSet, uint32_t sizeOfReservedPage, uint32_t maxReplySize);
 			~ClientsManager();
 
 			void init(IStateTransfer* stateTransfer);
@@ -38,14 +39,24 @@ namespace bftEngine
 
 			void loadInfoFromReservedPages();
 
+			// writes the replies that were added since the last call to the reserved pages (should be called before
+			// the reserved pages are read by the state transfer module, e.g. before a checkpoint is created)
+			void flushRepliesToReservedPages();
+
 			// Replies
 
 			ReqId seqNumberOfLastReplyToClient(NodeIdType clientId); // TODO(GG): make sure that ReqId is based on time (and ignore requests with time that does not make sense (too high) - this will prevent some potential attacks) 
 
-			bool isValidClient(NodeIdType clientId) const;
+			bool isValidClient(NodeIdType clientId) const
+			{
+				if (clientId < firstClientId_) return false;
+				const size_t i = clientId - firstClientId_;
+				return (i < clientIdToIndex_.size()) && (clientIdToIndex_[i] != InvalidClientIndex);
+			}
 
 			void getInfoAboutLastReplyToClient(NodeIdType clientId, ReqId& outseqNumber, Time& outSentTime);
 
+			// the reply is kept in memory, and written to the reserved pages by the next flushRepliesToReservedPages()
 			ClientReplyMsg* allocateNewReplyMsgAndWriteToStorage(NodeIdType clientId, ReqId requestSeqNum, uint16_t currentPrimaryId, char* reply, uint32_t replyLength);
 
 			ClientReplyMsg* allocateMsgWithLatestReply(NodeIdType clientId, uint16_t currentPrimaryId);
@@ -75,15 +86,41 @@ namespace bftEngine
 		protected:
 			const ReplicaId myId_;
 			const uint32_t sizeOfReservedPage_;
+			const uint32_t maxReplySize_;
 
 			IStateTransfer* stateTransfer_ = nullptr;
 
 			char* scratchPage_ = nullptr;
 
+			// the latest reply to each client is stored in a slot of sizeOfReplySlot_ bytes in the reserved pages.
+			// If a slot fits in a reserved page, each reserved page holds the slots of clientsPerPage_ clients.
+			// Otherwise, each client uses reservedPagesPerClient_ reserved pages.
+			uint32_t sizeOfReplySlot_;
+			uint32_t clientsPerPage_;
 			uint32_t reservedPagesPerClient_;
 			uint32_t requiredNumberOfPages_;
 
-			std::map<NodeIdType, uint16_t> clientIdToIndex_;
+			uint32_t firstPageOf(uint16_t clientIdx) const
+			{
+				return (clientIdx / clientsPerPage_) * reservedPagesPerClient_;
+			}
+
+			uint32_t offsetInPageOf(uint16_t clientIdx) const
+			{
+				return (clientIdx % clientsPerPage_) * sizeOfReplySlot_;
+			}
+
+			static const uint16_t InvalidClientIndex = 0xFFFF;
+
+			// clientIdToIndex_[clientId - firstClientId_] is the index of the client (or InvalidClientIndex)
+			NodeIdType firstClientId_;
+			std::vector<uint16_t> clientIdToIndex_;
+
+			uint16_t indexOf(NodeIdType clientId) const
+			{
+				Assert(isValidClient(clientId));
+				return clientIdToIndex_[clientId - firstClientId_];
+			}
 
 			struct ClientInfo
 			{
@@ -98,6 +135,20 @@ namespace bftEngine
 			};
 
 			std::vector<ClientInfo> indexToClientInfo_;
+
+			// the latest reply to each client (without the currentPrimaryId), as it should appear in the reserved pages
+			struct CachedReply
+			{
+				std::vector<char> msg; // empty if the reply is only in the reserved pages
+				bool dirty = false; // true if msg was not written to the reserved pages
+			};
+
+			std::vector<CachedReply> indexToCachedReply_;
+			std::vector<uint16_t> dirtyReplies_;
+
+			void writeReplyToReservedPages(uint16_t clientIdx, const char* msg, uint32_t msgSize);
+
+			void clearCachedReplies();
 		};
 	}
 }
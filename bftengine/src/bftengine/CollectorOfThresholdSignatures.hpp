@@ -10,11 +10,13 @@
 
 #include <unordered_map>
 #include <set>
+#include <vector>
 
 #include "PrimitiveTypes.hpp"
 #include "Digest.hpp"
 #include "Crypto.hpp"
 #include "SimpleThreadPool.hpp"
+#include "ThresholdSigsCombiner.hpp"
 #include "IncomingMsgsStorage.hpp"
 #include "assertUtils.hpp"
 
@@ -242,13 +244,14 @@ namespace bftEngine
 
 					Assert(numOfPartSigsInJob == numOfRequiredSigs);
 
-					ExternalFunc::threadPool(context).add(bkJob);
+					ExternalFunc::sigsCombiner(context).add(bkJob->thresholdVerifier(), bkJob);
 				}
 			}
 
 
 
-			class SignaturesProcessingJob : public SimpleThreadPool::Job // TODO(GG): include the replica Id (to identify replicas that send bad combined signatures)
+			// combined (with the signatures of other sequence numbers) by ThresholdSigsCombiner
+			class SignaturesProcessingJob : public ThresholdSigsCombiner::Item // TODO(GG): include the replica Id (to identify replicas that send bad combined signatures)
 			{
 			private:
 				struct SigData {
@@ -317,60 +320,61 @@ namespace bftEngine
 					delete this;
 				}
 
-				virtual void execute() override
+				IThresholdVerifier* thresholdVerifier() const
 				{
-					Assert(numOfDataItems == reqDataItems);
+					return verifier;
+				}
 
-					// TODO(GG): can utilize several threads (discuss with Alin)
+				virtual IThresholdAccumulator* createAccumulator(IThresholdVerifier* v) override
+				{
+					Assert(v == verifier);
+					Assert(numOfDataItems == reqDataItems);
 
-					const uint16_t bufferSize = (uint16_t)verifier->requiredLengthForSignedData();
-					char* const bufferForSigComputations = (char*)alloca(bufferSize); // TODO(GG): check
+					IThresholdAccumulator* acc = verifier->newAccumulator(false);
 
+					for (uint16_t i = 0; i < reqDataItems; i++)
 					{
-						IThresholdAccumulator* acc = verifier->newAccumulator(false);
-
-						for (uint16_t i = 0; i < reqDataItems; i++)
-						{
-							acc->add(sigDataItems[i].sigBody, sigDataItems[i].sigLength);
-						}
-
-						acc->setExpectedDigest(reinterpret_cast<unsigned char *>(expectedDigest.content()), DIGEST_SIZE);
+						acc->add(sigDataItems[i].sigBody, sigDataItems[i].sigLength);
+					}
 
-						acc->getFullSignedData(bufferForSigComputations, bufferSize);
+					acc->setExpectedDigest(reinterpret_cast<const unsigned char *>(expectedDigest.content()), DIGEST_SIZE);
 
-						verifier->release(acc);
-					}
+					return acc;
+				}
 
-					bool succ = verifier->verify((char*)&expectedDigest, sizeof(Digest), bufferForSigComputations, bufferSize);
+				virtual const Digest& signedDigest() const override
+				{
+					return expectedDigest;
+				}
 
+				virtual void onCombined(IThresholdVerifier* v, const char* bufferForSigComputations, uint16_t bufferSize, bool succ) override
+				{
+					Assert(v == verifier);
 
 					if (!succ)
 					{
 						std::set<ReplicaId> replicasWithBadSigs;
 
-						// TODO(GG): A clumsy way to do verification - find a better way ....
-
-						IThresholdAccumulator* accWithVer = verifier->newAccumulator(true);
-						accWithVer->setExpectedDigest(reinterpret_cast<unsigned char *>(expectedDigest.content()), DIGEST_SIZE);
-
-						uint16_t currNumOfValidShares = 0;
+						// identify the bad shares (in a batch, if supported by the verifier)
+						std::vector<const char*> shares(reqDataItems);
+						std::vector<int> sharesLengths(reqDataItems);
 						for (uint16_t i = 0; i < reqDataItems; i++)
 						{
-							uint16_t prevNumOfValidShares = currNumOfValidShares;
+							shares[i] = sigDataItems[i].sigBody;
+							sharesLengths[i] = sigDataItems[i].sigLength;
+						}
 
-							currNumOfValidShares = (uint16_t)accWithVer->add(sigDataItems[i].sigBody, sigDataItems[i].sigLength);
+						std::vector<int> invalidShares;
+						verifier->findInvalidShares(expectedDigest.content(), DIGEST_SIZE, shares.data(), sharesLengths.data(), reqDataItems, invalidShares);
 
-							if (prevNumOfValidShares + 1 != currNumOfValidShares)
-								replicasWithBadSigs.insert(sigDataItems[i].srcRepId);
-						}
+						for (int i : invalidShares)
+							replicasWithBadSigs.insert(sigDataItems[i].srcRepId);
 
 						if (replicasWithBadSigs.size() == 0)
 						{
 							// TODO(GG): print warning / error ??
 						}
 
-						verifier->release(accWithVer);
-
 						// send internal message with the results
 						InternalMessage* iMsg = ExternalFunc::createInterCombinedSigFailed(context, expectedSeqNumber, expectedView, replicasWithBadSigs);
 						repMsgsStorage->pushInternalMsg(iMsg);
@@ -0,0 +1,119 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include "CompactPrePrepareMsg.hpp"
+#include "PrePrepareMsg.hpp"
+#include "ClientRequestMsg.hpp"
+#include "RequestsCache.hpp"
+#include "assertUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		CompactPrePrepareMsg::CompactPrePrepareMsg(ReplicaId sender, MsgSize size) :
+			MessageBase(sender, MsgCode::CompactPrePrepare, size)
+		{
+		}
+
+		CompactPrePrepareMsg* CompactPrePrepareMsg::create(const PrePrepareMsg* pp)
+		{
+			Assert(!pp->isNull());
+
+			const uint16_t numOfRequests = pp->numberOfRequests();
+			const size_t size = sizeof(CompactPrePrepareMsgHeader) + numOfRequests * sizeof(RequestRef);
+			if (size >= pp->size()) return nullptr;
+
+			CompactPrePrepareMsg* m = new CompactPrePrepareMsg(pp->senderId(), (MsgSize)size);
+
+			m->b()->viewNum = pp->viewNumber();
+			m->b()->seqNum = pp->seqNumber();
+			m->b()->firstPath = (uint16_t)pp->firstPath();
+			m->b()->digestOfRequests = pp->digestOfRequests();
+			m->b()->numberOfRequests = numOfRequests;
+
+			RequestsIterator it(pp);
+			char* requestBody = nullptr;
+			RequestRef* ref = m->refs();
+			while (it.getAndGoToNext(requestBody))
+			{
+				ClientRequestMsg req((ClientRequestMsgHeader*)requestBody);
+				ref->clientId = req.clientProxyId();
+				ref->reqSeqNum = req.requestSeqNum();
+				RequestsCache::computeDigestOfRequest(&req, ref->reqDigest);
+				ref++;
+			}
+
+			return m;
+		}
+
+		bool CompactPrePrepareMsg::ToActualMsgType(const ReplicasInfo& repInfo, MessageBase* inMsg, CompactPrePrepareMsg*& outMsg)
+		{
+			Assert(inMsg->type() == MsgCode::CompactPrePrepare);
+
+			if (inMsg->size() < sizeof(CompactPrePrepareMsgHeader)) return false;
+
+			if (inMsg->senderId() == repInfo.myId()) return false;
+
+			if (!repInfo.isIdOfReplica(inMsg->senderId())) return false;
+
+			CompactPrePrepareMsg* tmp = (CompactPrePrepareMsg*)inMsg;
+
+			if (tmp->b()->seqNum == 0) return false;
+
+			const uint16_t firstPath = tmp->b()->firstPath;
+			if (firstPath >= 3) return false;
+			if ((tmp->firstPath() == CommitPath::FAST_WITH_THRESHOLD) && (repInfo.cVal() == 0)) return false;
+
+			if (tmp->b()->numberOfRequests == 0) return false;
+			if (tmp->size() != sizeof(CompactPrePrepareMsgHeader) + tmp->b()->numberOfRequests * sizeof(RequestRef)) return false;
+
+			outMsg = tmp;
+			return true;
+		}
+
+		PrePrepareMsg* CompactPrePrepareMsg::createPrePrepareMsg(const RequestsCache& cache, uint16_t& outNumOfMissingRequests) const
+		{
+			const uint16_t numOfRequests = b()->numberOfRequests;
+			const RequestRef* ref = refs();
+
+			outNumOfMissingRequests = 0;
+			for (uint16_t i = 0; i < numOfRequests; i++)
+			{
+				if (cache.get(ref[i].clientId, ref[i].reqSeqNum, ref[i].reqDigest) == nullptr) outNumOfMissingRequests++;
+			}
+
+			if (outNumOfMissingRequests > 0) return nullptr;
+
+			PrePrepareMsg* pp = new PrePrepareMsg(senderId(), b()->viewNum, b()->seqNum, firstPath(), false);
+
+			for (uint16_t i = 0; i < numOfRequests; i++)
+			{
+				ClientRequestMsg* req = cache.get(ref[i].clientId, ref[i].reqSeqNum, ref[i].reqDigest);
+				if (req->size() > pp->remainingSizeForRequests())
+				{
+					delete pp;
+					return nullptr;
+				}
+				pp->addRequest(req->body(), req->size());
+			}
+
+			pp->finishAddingRequests();
+
+			if (pp->digestOfRequests() != b()->digestOfRequests)
+			{
+				delete pp;
+				return nullptr;
+			}
+
+			return pp;
+		}
+
+	}
+}
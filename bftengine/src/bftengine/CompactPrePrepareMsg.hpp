@@ -0,0 +1,88 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "PrimitiveTypes.hpp"
+#include "Digest.hpp"
+#include "MessageBase.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		class PrePrepareMsg;
+		class RequestsCache;
+
+		// A PrePrepareMsg that only contains the identifiers and the digests of its requests.
+		// Used when clients multicast their requests to all replicas: each replica rebuilds the full
+		// PrePrepareMsg from its RequestsCache.
+		class CompactPrePrepareMsg : public MessageBase
+		{
+		protected:
+#pragma pack(push,1)
+			struct CompactPrePrepareMsgHeader : public MessageBase::Header
+			{
+				ViewNum viewNum;
+				SeqNum  seqNum;
+				uint16_t firstPath;
+				Digest  digestOfRequests;
+				uint16_t numberOfRequests;
+			};
+
+			struct RequestRef
+			{
+				NodeIdType clientId;
+				ReqId reqSeqNum;
+				Digest reqDigest; // see RequestsCache::computeDigestOfRequest
+			};
+#pragma pack(pop)
+			static_assert(sizeof(CompactPrePrepareMsgHeader) == (2 + 8 + 8 + 2 + DIGEST_SIZE + 2), "CompactPrePrepareMsgHeader is 54B");
+			static_assert(sizeof(RequestRef) == (2 + 8 + DIGEST_SIZE), "RequestRef is 42B");
+
+		public:
+
+			// returns nullptr if the compact message is not smaller than pp
+			static CompactPrePrepareMsg* create(const PrePrepareMsg* pp);
+
+			static bool ToActualMsgType(const ReplicasInfo& repInfo, MessageBase* inMsg, CompactPrePrepareMsg*& outMsg);
+
+			ViewNum viewNumber() const { return b()->viewNum; }
+
+			SeqNum seqNumber() const { return b()->seqNum; }
+
+			CommitPath firstPath() const { return (CommitPath)b()->firstPath; }
+
+			Digest& digestOfRequests() const { return b()->digestOfRequests; }
+
+			uint16_t numberOfRequests() const { return b()->numberOfRequests; }
+
+			// Rebuilds the full PrePrepareMsg from the requests in cache.
+			// Returns nullptr if some of the requests are not in cache (outNumOfMissingRequests > 0), or if
+			// the requests do not match digestOfRequests (outNumOfMissingRequests == 0).
+			PrePrepareMsg* createPrePrepareMsg(const RequestsCache& cache, uint16_t& outNumOfMissingRequests) const;
+
+		protected:
+
+			CompactPrePrepareMsg(ReplicaId sender, MsgSize size);
+
+			RequestRef* refs() const
+			{
+				return (RequestRef*)(body() + sizeof(CompactPrePrepareMsgHeader));
+			}
+
+			CompactPrePrepareMsgHeader* b() const
+			{
+				return (CompactPrePrepareMsgHeader*)msgBody_;
+			}
+		};
+
+	}
+}
@@ -19,6 +19,7 @@ namespace bftEngine
 	{
 
 		class PreparePartialMsg;
+		class PartialCommitProofMsg;
 
 		///////////////////////////////////////////////////////////////////////////////
 		// ControllerBase
@@ -33,6 +34,8 @@ namespace bftEngine
 
 			virtual CommitPath getCurrentFirstPath() = 0;
 			virtual uint32_t timeToStartSlowPathMilli() = 0;
+			// the time to start the slow path of sequence number n (after its fast path has started)
+			virtual uint32_t timeToStartSlowPathMilli(SeqNum n) { return timeToStartSlowPathMilli(); }
 			virtual uint32_t slowPathsTimerMilli() = 0;
 
 			// events (used to pass information to the controller)
@@ -43,6 +46,7 @@ namespace bftEngine
 			virtual void onSendingPrePrepare(SeqNum n, CommitPath commitPath) {}
 			virtual void onStartingSlowCommit(SeqNum n) {}
 			virtual void onMessage(const PreparePartialMsg* m) {}
+			virtual void onMessage(const PartialCommitProofMsg* m) {} // only if the primary is the collector
 
 			// TODO(GG): add more methods that may be useful  by controllers
 		};
@@ -60,6 +64,8 @@ namespace bftEngine
 
 			// getter methods
 
+			using ControllerBase::timeToStartSlowPathMilli;
+
 			virtual CommitPath getCurrentFirstPath() override;
 			virtual uint32_t timeToStartSlowPathMilli() override;
 			virtual uint32_t slowPathsTimerMilli() override;
@@ -33,7 +33,7 @@ namespace bftEngine
                     SeqNum initialSeq) :
                   onlyOptimisticFast(C == 0),
                   c(C), f(F), numOfReplicas(3 * F + 2 * C + 1), myId(replicaId),
-                  recentActivity(1, nullptr),
+                  recentActivity(EvaluationPeriod, 1, 1, nullptr),
                   currentFirstPath{ControllerWithSimpleHistory_debugInitialFirstPath},
                   currentView{initialView},
                   isPrimary{((currentView % numOfReplicas) == myId)},
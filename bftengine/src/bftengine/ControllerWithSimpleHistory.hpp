@@ -34,6 +34,9 @@ namespace bftEngine
                             ViewNum initialView,
                             SeqNum initialSeq);
 
+			using ControllerBase::timeToStartSlowPathMilli;
+			using ControllerBase::onMessage;
+
 			// getter methods
 
 			virtual CommitPath getCurrentFirstPath() override;
@@ -90,7 +93,7 @@ namespace bftEngine
 			const size_t numOfReplicas;
 			const ReplicaId myId;
 
-			SequenceWithActiveWindow<EvaluationPeriod, 1, SeqNum, SeqNoInfo, SeqNoInfo> recentActivity;
+			SequenceWithActiveWindow<SeqNum, SeqNoInfo, SeqNoInfo> recentActivity;
 
 			CommitPath currentFirstPath;
 			ViewNum currentView;
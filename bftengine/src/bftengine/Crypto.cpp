@@ -9,7 +9,10 @@
 //TODO(GG): clean and review this file
 
 
+#include <algorithm>
 #include <set>
+#include <stdexcept>
+#include <vector>
 
 #include "Crypto.hpp"
 
@@ -29,6 +32,7 @@
 #include "DigestType.h"
 #include <cryptopp/cryptlib.h>
 #include "cryptopp/ida.h"
+#include "Ed25519.hpp"
 
 
 using namespace CryptoPP;
@@ -124,6 +128,23 @@ namespace bftEngine
 			return true;
 		}
 
+		bool EdDSAKeysGenerator::generateKeys(string& outPublicKey, string& outPrivateKey)
+		{
+			SecByteBlock priv(concordUtil::Ed25519::kPrivateKeySize);
+			sGlobalRandGen.GenerateBlock(priv, priv.size());
+
+			byte pub[concordUtil::Ed25519::kPublicKeySize];
+			concordUtil::Ed25519::DerivePublicKey(priv, pub);
+
+			outPrivateKey.clear();
+			StringSource(priv, priv.size(), true, new HexEncoder(new StringSink(outPrivateKey)));
+
+			outPublicKey.clear();
+			StringSource(pub, sizeof(pub), true, new HexEncoder(new StringSink(outPublicKey)));
+
+			return true;
+		}
+
 
 
 
@@ -136,22 +157,76 @@ namespace bftEngine
 
 		bool DigestUtil::compute(const char* input, size_t inputLength, char* outBufferForDigest, size_t lengthOfBufferForDigest)
 		{
-			DigestType dig;
-
-			size_t size = dig.DigestSize();
+			const size_t size = digestLength();
 
 			if (lengthOfBufferForDigest < size) return false;
 
+#if defined SHA256_DIGEST
+			concordUtil::Sha256::Compute(input, inputLength, outBufferForDigest);
+#else
+			DigestType dig;
 			SecByteBlock digest(size);
 
 			dig.Update((byte*)input, inputLength);
 			dig.Final(digest);
 			const byte* h = digest;
 			memcpy(outBufferForDigest, h, size);
+#endif
 
 			return true;
 		}
 
+		void DigestUtil::computeMany(size_t n, const char* const* inputs, const size_t* lengths, char* const* outDigests)
+		{
+#if defined SHA256_DIGEST
+			concordUtil::Sha256::ComputeMany(n, (const void* const*)inputs, lengths, (void* const*)outDigests);
+#else
+			for (size_t i = 0; i < n; i++)
+				compute(inputs[i], lengths[i], outDigests[i], digestLength());
+#endif
+		}
+
+#if defined SHA256_DIGEST
+
+		DigestUtil::Context::Context() : valid(true)
+		{
+		}
+
+		void DigestUtil::Context::update(const char* data, size_t len)
+		{
+			VERIFY(valid);
+			internalState.Update(data, len);
+		}
+
+		void DigestUtil::Context::writeDigest(char* outDigest)
+		{
+			VERIFY(valid);
+			internalState.Finish(outDigest);
+			valid = false;
+		}
+
+		DigestUtil::Context::~Context()
+		{
+		}
+
+		void DigestUtil::Context::updateMany(size_t n, Context* const* contexts, const char* const* data, const size_t* lengths)
+		{
+			const size_t maxBatch = 64;
+			concordUtil::Sha256* states[maxBatch];
+			for (size_t i = 0; i < n; i += maxBatch)
+			{
+				const size_t batch = std::min(maxBatch, n - i);
+				for (size_t j = 0; j < batch; j++)
+				{
+					VERIFY(contexts[i + j]->valid);
+					states[j] = &contexts[i + j]->internalState;
+				}
+				concordUtil::Sha256::UpdateMany(batch, states, (const void* const*)(data + i), lengths + i);
+			}
+		}
+
+#else
+
 		DigestUtil::Context::Context()
 		{
 			DigestType* p = new DigestType();
@@ -188,6 +263,14 @@ namespace bftEngine
 			}
 		}
 
+		void DigestUtil::Context::updateMany(size_t n, Context* const* contexts, const char* const* data, const size_t* lengths)
+		{
+			for (size_t i = 0; i < n; i++)
+				contexts[i]->update(data[i], lengths[i]);
+		}
+
+#endif
+
 
 
 
@@ -300,6 +383,129 @@ namespace bftEngine
 		}
 
 
+		// decodes a hexadecimal key of exactly keyLength bytes
+		static SecByteBlock decodeEdDSAKey(const char* hexKey, size_t keyLength)
+		{
+			string binKey;
+			StringSource s(hexKey, true, new HexDecoder(new StringSink(binKey)));
+			if (binKey.size() != keyLength) throw std::invalid_argument("invalid EdDSA key");
+			return SecByteBlock((const byte*)binKey.data(), binKey.size());
+		}
+
+		class EdDSASignerInternal
+		{
+		public:
+			EdDSASignerInternal(const SecByteBlock& privateKey) : priv(privateKey)
+			{
+			}
+
+			bool sign(const char* inBuffer, size_t lengthOfInBuffer, char* outBuffer, size_t lengthOfOutBuffer, size_t& lengthOfReturnedData)
+			{
+				if (lengthOfOutBuffer < concordUtil::Ed25519::kSignatureSize) return false;
+				concordUtil::Ed25519::Sign(priv, inBuffer, lengthOfInBuffer, (byte*)outBuffer);
+				lengthOfReturnedData = concordUtil::Ed25519::kSignatureSize;
+				return true;
+			}
+		private:
+			SecByteBlock priv;
+		};
+
+		class EdDSAVerifierInternal
+		{
+		public:
+			EdDSAVerifierInternal(const SecByteBlock& publicKey) : pub(publicKey), batchSeed(concordUtil::Ed25519::kBatchSeedSize)
+			{
+				sGlobalRandGen.GenerateBlock(batchSeed, batchSeed.size());
+			}
+
+			bool verify(const char* data, size_t lengthOfData, const char* signature, size_t lengthOfOSignature)
+			{
+				if (lengthOfOSignature != concordUtil::Ed25519::kSignatureSize) return false;
+				return concordUtil::Ed25519::Verify(pub, data, lengthOfData, (const byte*)signature);
+			}
+
+			SecByteBlock pub;
+			SecByteBlock batchSeed; // random (unknown to the signers), for the coefficients of batch verification
+		};
+
+		EdDSASigner::EdDSASigner(const char* privateKey)
+		{
+			SecByteBlock k = decodeEdDSAKey(privateKey, concordUtil::Ed25519::kPrivateKeySize);
+			d = new EdDSASignerInternal(k);
+		}
+
+		EdDSASigner::~EdDSASigner()
+		{
+			EdDSASignerInternal* p = (EdDSASignerInternal*)d;
+			delete p;
+		}
+
+		size_t EdDSASigner::signatureLength()
+		{
+			return concordUtil::Ed25519::kSignatureSize;
+		}
+
+		bool EdDSASigner::sign(const char* inBuffer, size_t lengthOfInBuffer, char* outBuffer, size_t lengthOfOutBuffer, size_t& lengthOfReturnedData)
+		{
+			EdDSASignerInternal* p = (EdDSASignerInternal*)d;
+			return p->sign(inBuffer, lengthOfInBuffer, outBuffer, lengthOfOutBuffer, lengthOfReturnedData);
+		}
+
+		EdDSAVerifier::EdDSAVerifier(const char* publicKey)
+		{
+			SecByteBlock k = decodeEdDSAKey(publicKey, concordUtil::Ed25519::kPublicKeySize);
+			d = new EdDSAVerifierInternal(k);
+		}
+
+		EdDSAVerifier::~EdDSAVerifier()
+		{
+			EdDSAVerifierInternal* p = (EdDSAVerifierInternal*)d;
+			delete p;
+		}
+
+		size_t EdDSAVerifier::signatureLength()
+		{
+			return concordUtil::Ed25519::kSignatureSize;
+		}
+
+		bool EdDSAVerifier::verify(const char* data, size_t lengthOfData, const char* signature, size_t lengthOfOSignature)
+		{
+			EdDSAVerifierInternal* p = (EdDSAVerifierInternal*)d;
+			return p->verify(data, lengthOfData, signature, lengthOfOSignature);
+		}
+
+		bool EdDSAVerifier::verifyBatch(size_t n, const char* const* data, const size_t* lengthsOfData, const char* const* signatures, const size_t* lengthsOfSignatures)
+		{
+			std::vector<EdDSAVerifier*> verifiers(n, this);
+			return verifyBatch(n, verifiers.data(), data, lengthsOfData, signatures, lengthsOfSignatures);
+		}
+
+		bool EdDSAVerifier::verifyBatch(size_t n, EdDSAVerifier* const* verifiers, const char* const* data, const size_t* lengthsOfData, const char* const* signatures, const size_t* lengthsOfSignatures)
+		{
+			if (n == 0) return true;
+
+			std::vector<concordUtil::Ed25519::SignedMessage> msgs(n);
+			for (size_t i = 0; i < n; i++)
+			{
+				if (lengthsOfSignatures[i] != concordUtil::Ed25519::kSignatureSize) return false;
+				const EdDSAVerifierInternal* p = (const EdDSAVerifierInternal*)verifiers[i]->d;
+				msgs[i] = concordUtil::Ed25519::SignedMessage{ p->pub.BytePtr(), data[i], lengthsOfData[i], (const byte*)signatures[i] };
+			}
+
+			const EdDSAVerifierInternal* first = (const EdDSAVerifierInternal*)verifiers[0]->d;
+			return concordUtil::Ed25519::VerifyBatch(n, msgs.data(), first->batchSeed.BytePtr());
+		}
+
+		bool IVerifier::verifyBatch(size_t n, const char* const* data, const size_t* lengthsOfData, const char* const* signatures, const size_t* lengthsOfSignatures)
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				if (!verify(data[i], lengthsOfData[i], signatures[i], lengthsOfSignatures[i])) return false;
+			}
+			return true;
+		}
+
+
 
 		void SecretSharingOperations::splitBinaryString(uint16_t threshold, uint16_t nShares, string binaryData, const char *seed, string* outBinaryStringArray, uint16_t lenOutBinaryStringArray)
 		{
@@ -16,6 +16,9 @@
 #include <sstream>
 #include <string>
 
+#include "DigestType.h"
+#include "Sha256.hpp"
+
 using std::string;
 
 namespace bftEngine
@@ -32,28 +35,80 @@ namespace bftEngine
 		};
 
 
-		// TODO(GG): define generic signer/verifier (not sure we want to use RSA)
+		// generic signer/verifier (the signature schemes of SigManager)
+
+		class ISigner
+		{
+		public:
+			virtual ~ISigner() {}
+			virtual size_t signatureLength() = 0;
+			virtual bool sign(const char* inBuffer, size_t lengthOfInBuffer, char* outBuffer, size_t lengthOfOutBuffer, size_t& lengthOfReturnedData) = 0;
+		};
+
+		class IVerifier
+		{
+		public:
+			virtual ~IVerifier() {}
+			virtual size_t signatureLength() = 0;
+			virtual bool verify(const char* data, size_t lengthOfData, const char* signature, size_t lengthOfOSignature) = 0;
+
+			// returns true iff all the n signatures are valid (verify(data[i], lengthsOfData[i], signatures[i], lengthsOfSignatures[i])
+			// for 0 <= i < n). Verifies them one by one, unless the scheme supports batch verification.
+			virtual bool verifyBatch(size_t n, const char* const* data, const size_t* lengthsOfData, const char* const* signatures, const size_t* lengthsOfSignatures);
+		};
+
+		// RSA (2048 bits) with PKCS1v15 and SHA256. Keys are DER-encoded, in hexadecimal.
 
-		class RSASigner
+		class RSASigner : public ISigner
 		{
 		public:
 			RSASigner(const char* privteKey, const char* randomSeed);
 			RSASigner(const char* privateKey);
 			~RSASigner();
-			size_t signatureLength();
-			bool sign(const char* inBuffer, size_t lengthOfInBuffer, char* outBuffer, size_t lengthOfOutBuffer, size_t& lengthOfReturnedData);
+			size_t signatureLength() override;
+			bool sign(const char* inBuffer, size_t lengthOfInBuffer, char* outBuffer, size_t lengthOfOutBuffer, size_t& lengthOfReturnedData) override;
 		private:
 			void* d;
 		};
 
-		class RSAVerifier
+		class RSAVerifier : public IVerifier
 		{
 		public:
 			RSAVerifier(const char* publicKey, const char* randomSeed);
 			RSAVerifier(const char* publicKey);
 			~RSAVerifier();
-			size_t signatureLength();
-			bool verify(const char* data, size_t lengthOfData, const char* signature, size_t lengthOfOSignature);
+			size_t signatureLength() override;
+			bool verify(const char* data, size_t lengthOfData, const char* signature, size_t lengthOfOSignature) override;
+		private:
+			void* d;
+		};
+
+		// EdDSA over Curve25519 (Ed25519, see concordUtil::Ed25519): signatures of 64 bytes, and keys of 32 bytes (in
+		// hexadecimal; the private key is the secret seed). Signing and verification are much faster than with RSA,
+		// and a batch of signatures is verified about twice as fast as its signatures one by one.
+
+		class EdDSASigner : public ISigner
+		{
+		public:
+			EdDSASigner(const char* privateKey);
+			~EdDSASigner();
+			size_t signatureLength() override;
+			bool sign(const char* inBuffer, size_t lengthOfInBuffer, char* outBuffer, size_t lengthOfOutBuffer, size_t& lengthOfReturnedData) override;
+		private:
+			void* d;
+		};
+
+		class EdDSAVerifier : public IVerifier
+		{
+		public:
+			EdDSAVerifier(const char* publicKey);
+			~EdDSAVerifier();
+			size_t signatureLength() override;
+			bool verify(const char* data, size_t lengthOfData, const char* signature, size_t lengthOfOSignature) override;
+			bool verifyBatch(size_t n, const char* const* data, const size_t* lengthsOfData, const char* const* signatures, const size_t* lengthsOfSignatures) override;
+
+			// the same, for signatures of different signers (the signature i is verified by verifiers[i])
+			static bool verifyBatch(size_t n, EdDSAVerifier* const* verifiers, const char* const* data, const size_t* lengthsOfData, const char* const* signatures, const size_t* lengthsOfSignatures);
 		private:
 			void* d;
 		};
@@ -65,6 +120,9 @@ namespace bftEngine
 			static size_t digestLength();
 			static bool compute(const char* input, size_t inputLength, char* outBufferForDigest, size_t lengthOfBufferForDigest);
 
+			// outDigests[i] = digest of (inputs[i], lengths[i]) for 0 <= i < n (independent messages are hashed together when the CPU supports it)
+			static void computeMany(size_t n, const char* const* inputs, const size_t* lengths, char* const* outDigests);
+
 			class Context
 			{
 			public:
@@ -73,8 +131,16 @@ namespace bftEngine
 				void writeDigest(char* outDigest); // write digest to outDigest, and invalidate the Context object
 				~Context();
 
+				// the same as contexts[i]->update(data[i], lengths[i]) for 0 <= i < n
+				static void updateMany(size_t n, Context* const* contexts, const char* const* data, const size_t* lengths);
+
 			private:
+#if defined SHA256_DIGEST
+				concordUtil::Sha256 internalState; // no heap allocation
+				bool valid;
+#else
 				void* internalState;
+#endif
 			};
 		};
 
@@ -87,6 +153,12 @@ namespace bftEngine
 			static int getModulusBits();
 		};
 
+		class EdDSAKeysGenerator
+		{
+		public:
+			static bool generateKeys(std::string& outPublicKey, std::string& outPrivateKey);
+		};
+
 
 
 		class SecretSharingOperations
@@ -22,11 +22,18 @@
 namespace bftEngine {
 namespace impl {
 
-DebugPersistentStorage::DebugPersistentStorage(uint16_t fVal, uint16_t cVal)
+DebugPersistentStorage::DebugPersistentStorage(uint16_t fVal,
+                                               uint16_t cVal,
+                                               uint16_t checkpointWindowSize)
     : fVal_{fVal},
       cVal_{cVal},
-      seqNumWindow{1, nullptr},
-      checkWindow{0, nullptr}
+      checkpointWindowSize_{checkpointWindowSize},
+      workWindowSize_{(uint16_t)(2 * checkpointWindowSize)},
+      seqNumWindow{workWindowSize_, 1, 1, nullptr},
+      checkWindow{(uint16_t)(workWindowSize_ + checkpointWindowSize),
+                  checkpointWindowSize,
+                  0,
+                  nullptr}
 
 {}
 
@@ -95,7 +102,7 @@ void DebugPersistentStorage::setDescriptorOfLastExitFromView(
          d.view == descriptorOfLastNewView_.view);
   Assert(d.lastStable >= lastStableSeqNum_);
   Assert(d.lastExecuted >= lastExecutedSeqNum_);
-  Assert(d.elements.size() <= kWorkWindowSize);
+  Assert(d.elements.size() <= workWindowSize_);
   Assert(hasDescriptorOfLastExitFromView_ ||
          descriptorOfLastExitFromView_.elements.size() == 0);
 
@@ -105,7 +112,7 @@ void DebugPersistentStorage::setDescriptorOfLastExitFromView(
     const ViewsManager::PrevViewInfo& e = d.elements[i];
     Assert(e.prePrepare != nullptr);
     Assert(e.prePrepare->seqNumber() >= lastStableSeqNum_ + 1);
-    Assert(e.prePrepare->seqNumber() <= lastStableSeqNum_ + kWorkWindowSize);
+    Assert(e.prePrepare->seqNumber() <= lastStableSeqNum_ + workWindowSize_);
     Assert(e.prePrepare->viewNumber() == d.view);
     Assert(e.prepareFull == nullptr || e.prepareFull->viewNumber() == d.view);
     Assert(e.prepareFull == nullptr ||
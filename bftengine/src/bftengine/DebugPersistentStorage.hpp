@@ -21,7 +21,7 @@ namespace impl {
 
 class DebugPersistentStorage : public PersistentStorage {
  public:
-  DebugPersistentStorage(uint16_t fVal, uint16_t cVal);
+  DebugPersistentStorage(uint16_t fVal, uint16_t cVal, uint16_t checkpointWindowSize);
 
   // Inherited via PersistentStorage
   virtual uint8_t beginWriteTran() override;
@@ -95,6 +95,8 @@ class DebugPersistentStorage : public PersistentStorage {
 
   const uint16_t fVal_;
   const uint16_t cVal_;
+  const uint16_t checkpointWindowSize_;
+  const uint16_t workWindowSize_;  // 2 * checkpointWindowSize_
 
   uint8_t numOfNestedTransactions = 0;
 
@@ -144,17 +146,11 @@ class DebugPersistentStorage : public PersistentStorage {
     static void reset(CheckData& i);
   };
 
-  // range: lastStableSeqNum+1 <= i <= lastStableSeqNum + kWorkWindowSize
-  SequenceWithActiveWindow<kWorkWindowSize, 1, SeqNum, SeqNumData, WindowFuncs>
-      seqNumWindow;
+  // range: lastStableSeqNum+1 <= i <= lastStableSeqNum + workWindowSize_
+  SequenceWithActiveWindow<SeqNum, SeqNumData, WindowFuncs> seqNumWindow;
 
   // range: TODO(GG): !!!!!!!
-  SequenceWithActiveWindow<kWorkWindowSize + checkpointWindowSize,
-                           checkpointWindowSize,
-                           SeqNum,
-                           CheckData,
-                           WindowFuncs>
-      checkWindow;
+  SequenceWithActiveWindow<SeqNum, CheckData, WindowFuncs> checkWindow;
 };
 
 }  // namespace impl
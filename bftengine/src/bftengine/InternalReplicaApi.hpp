@@ -28,6 +28,7 @@ namespace bftEngine
 	namespace impl
 	{
 		class FullCommitProofMsg;
+		class ThresholdSigsCombiner;
 
 
 		struct RetSuggestion { ReplicaId replicaId;  uint16_t msgType; SeqNum msgSeqNum; };
@@ -56,6 +57,7 @@ namespace bftEngine
 
 			virtual IncomingMsgsStorage& getIncomingMsgsStorage() = 0;
 			virtual SimpleThreadPool& getInternalThreadPool() = 0;
+			virtual ThresholdSigsCombiner& getThresholdSigsCombiner() = 0;
 
 
 			virtual IThresholdVerifier* getThresholdVerifierForExecution() = 0;
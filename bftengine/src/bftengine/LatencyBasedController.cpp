@@ -0,0 +1,427 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License.
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include <algorithm>
+#include <cmath>
+
+#include "assertUtils.hpp"
+#include "Logger.hpp"
+#include "PartialCommitProofMsg.hpp"
+#include "SignedShareMsgs.hpp"
+#include "LatencyBasedController.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		static const uint32_t defaultTimeToStartSlowPathMilli = 150;
+		static const uint32_t minTimeToStartSlowPathMilli = 20;
+		static const uint32_t maxTimeToStartSlowPathMilli = 2000;
+		static const uint32_t maxLatencyMicro = maxTimeToStartSlowPathMilli * 1000;
+		static const uint32_t unknownLatency = UINT32_MAX;
+
+		static const float timerFactor = 1.5F;          // time to start the slow path = factor * predicted time + slack
+		static const uint32_t timerSlackMicro = 2000;
+		static const float switchFactor = 0.8F;         // a path replaces the current first path only if it is clearly faster
+		static const size_t maxMissedInARow = 8;        // after maxMissedInARow missed responses, a peer is unresponsive
+
+
+		void LatencyBasedController::ReplicaLatency::add(uint32_t latencyMicro, bool missed)
+		{
+			samples[nextSample] = std::min(latencyMicro, maxLatencyMicro);
+			nextSample = (nextSample + 1) % NumOfSamples;
+			if (numOfSamples < NumOfSamples) numOfSamples++;
+
+			if (!missed) missedInARow = 0;
+			else if (missedInARow < maxMissedInARow) missedInARow++;
+		}
+
+		uint32_t LatencyBasedController::ReplicaLatency::estimateMicro() const
+		{
+			if (missedInARow >= maxMissedInARow) return unknownLatency;
+			if (numOfSamples < MinNumOfSamples) return unknownLatency;
+
+			uint32_t s[NumOfSamples];
+			std::copy(samples, samples + numOfSamples, s);
+
+			const size_t idx = std::min((numOfSamples * 9) / 10, numOfSamples - 1);
+			std::nth_element(s, s + idx, s + numOfSamples);
+			return s[idx];
+		}
+
+		bool LatencyBasedController::ReplicaLatency::unresponsive() const
+		{
+			return (missedInARow >= maxMissedInARow);
+		}
+
+
+		LatencyBasedController::LatencyBasedController(
+			uint16_t C,
+			uint16_t F,
+			ReplicaId replicaId,
+			ViewNum initialView,
+			SeqNum initialSeq,
+			bool primaryIsCollectorForPartialProofs) :
+			onlyOptimisticFast(C == 0),
+			c(C), f(F), numOfReplicas(3 * F + 2 * C + 1), myId(replicaId),
+			primaryIsCollector(primaryIsCollectorForPartialProofs),
+			currentFirstPath{ControllerWithSimpleHistory_debugInitialFirstPath},
+			currentView{initialView},
+			isPrimary{((currentView % numOfReplicas) == myId)},
+			latencies(numOfReplicas),
+			recentActivity(NumOfTrackedSeqNums),
+			executionsSinceEvaluation(0),
+			currentTimeToStartSlowPathMilli{defaultTimeToStartSlowPathMilli},
+			minRecentTimeToStartSlowPathMilli{defaultTimeToStartSlowPathMilli}
+		{
+			Assert(numOfReplicas <= MaxNumberOfReplicas);
+
+			if (isPrimary)
+				onBecomePrimary(initialView, initialSeq);
+		}
+
+		void LatencyBasedController::onBecomePrimary(ViewNum v, SeqNum s)
+		{
+			Assert(isPrimary);
+
+			// the latencies of the replicas are kept (they do not depend on the view)
+			std::fill(recentActivity.begin(), recentActivity.end(), SeqNumActivity());
+			avgAndStdOfExecTime.reset();
+			executionsSinceEvaluation = 0;
+
+			currentTimeToStartSlowPathMilli = defaultTimeToStartSlowPathMilli;
+			minRecentTimeToStartSlowPathMilli = defaultTimeToStartSlowPathMilli;
+
+			LOG_INFO_F(GL, "currentTimeToStartSlowPathMilli = %d", (int)currentTimeToStartSlowPathMilli);
+		}
+
+
+		CommitPath LatencyBasedController::getCurrentFirstPath()
+		{
+			return currentFirstPath;
+		}
+
+
+		uint32_t LatencyBasedController::timeToStartSlowPathMilli()
+		{
+			return currentTimeToStartSlowPathMilli;
+		}
+
+
+		uint32_t LatencyBasedController::timeToStartSlowPathMilli(SeqNum n)
+		{
+			const SeqNumActivity* a = activityOf(n);
+			if (!isPrimary || a == nullptr || a->slowPath) return currentTimeToStartSlowPathMilli;
+
+			const size_t required = requiredResponses(a->path);
+
+			std::vector<uint32_t> estimates;
+			size_t missingResponses = required;
+			if (a->expectingResponses) // the primary is the collector, so it knows which peers have responded
+			{
+				if (a->numOfResponses >= required) return maxTimeToStartSlowPathMilli; // the full proof should be ready soon
+				missingResponses = required - a->numOfResponses;
+			}
+
+			if (!estimatesOfPeers(estimates, a->expectingResponses ? a : nullptr)) return currentTimeToStartSlowPathMilli;
+
+			const uint32_t predicted = kthEstimate(estimates, missingResponses);
+
+			// start the slow path now if the fast path cannot complete (too many peers are unresponsive)
+			const uint32_t retVal = (predicted == unknownLatency) ? 0 : timerFromPrediction(predicted);
+
+			if (retVal < minRecentTimeToStartSlowPathMilli) minRecentTimeToStartSlowPathMilli = retVal;
+			return retVal;
+		}
+
+
+		uint32_t LatencyBasedController::slowPathsTimerMilli()
+		{
+			const uint32_t minUsefulTimerRes = 10; // TODO(GG): ??
+
+			uint32_t retVal = (std::min(currentTimeToStartSlowPathMilli, minRecentTimeToStartSlowPathMilli) / 2);
+			if (retVal < minUsefulTimerRes) retVal = minUsefulTimerRes;
+
+			minRecentTimeToStartSlowPathMilli = currentTimeToStartSlowPathMilli;
+
+			return retVal;
+		}
+
+
+		void LatencyBasedController::onNewView(ViewNum v, SeqNum s)
+		{
+			Assert(v >= currentView);
+			currentView = v;
+			isPrimary = ((currentView % numOfReplicas) == myId);
+
+			if (isPrimary)
+				onBecomePrimary(v, s);
+		}
+
+		// Return true if currentFirstPath changed
+		bool LatencyBasedController::onNewSeqNumberExecution(SeqNum n)
+		{
+			if (!isPrimary) return false;
+
+			const SeqNumActivity* a = activityOf(n);
+			if (a != nullptr)
+			{
+				const Time now = getMonotonicTime();
+
+				uint64_t duration = 0;
+				if (now > a->prePrepareTime)
+					duration = subtract(now, a->prePrepareTime);
+
+				const uint64_t MAX_DURATION_MICRO = 2 * 1000 * 1000; // 2 sec
+				const uint64_t MIN_DURATION_MICRO = 100; // 100 micro
+
+				if (duration > MAX_DURATION_MICRO) duration = MAX_DURATION_MICRO;
+				else if (duration < MIN_DURATION_MICRO) duration = MIN_DURATION_MICRO;
+
+				if (n % 1000 == 0) avgAndStdOfExecTime.reset(); // reset every 1000 rounds
+
+				avgAndStdOfExecTime.add((double)duration);
+			}
+
+			if (++executionsSinceEvaluation < EvaluationPeriod) return false;
+
+			executionsSinceEvaluation = 0;
+			return onEndOfEvaluationPeriod();
+		}
+
+		// Return true if the currentFirstPath changed
+		bool LatencyBasedController::onEndOfEvaluationPeriod()
+		{
+			const CommitPath lastFirstPathVal = currentFirstPath;
+
+			std::vector<uint32_t> estimates;
+			const bool hasEstimates = estimatesOfPeers(estimates, nullptr);
+
+			if (hasEstimates)
+			{
+				std::sort(estimates.begin(), estimates.end());
+
+				const CommitPath paths[] = { CommitPath::OPTIMISTIC_FAST, CommitPath::FAST_WITH_THRESHOLD, CommitPath::SLOW };
+
+				CommitPath bestPath = currentFirstPath;
+				uint32_t bestTime = predictedCommitMicro(currentFirstPath, estimates);
+				for (CommitPath p : paths)
+				{
+					if (onlyOptimisticFast && p == CommitPath::FAST_WITH_THRESHOLD) continue;
+					const uint32_t t = predictedCommitMicro(p, estimates);
+					if (t == unknownLatency) continue;
+					if (bestTime == unknownLatency || t < switchFactor * bestTime)
+					{
+						bestPath = p;
+						bestTime = t;
+					}
+				}
+
+				currentFirstPath = bestPath;
+
+				LOG_INFO_F(GL, "Predicted commit time (micro) - optimistic fast=%u fast=%u slow=%u",
+					predictedCommitMicro(CommitPath::OPTIMISTIC_FAST, estimates),
+					onlyOptimisticFast ? unknownLatency : predictedCommitMicro(CommitPath::FAST_WITH_THRESHOLD, estimates),
+					predictedCommitMicro(CommitPath::SLOW, estimates));
+			}
+
+			if (lastFirstPathVal != currentFirstPath)
+				LOG_INFO_F(GL, "currentFirstPath = %d", (int)currentFirstPath);
+
+			// compute and update currentTimeToStartSlowPathMilli
+			const uint32_t predictedFast = (hasEstimates && currentFirstPath != CommitPath::SLOW) ?
+				kthEstimate(estimates, requiredResponses(currentFirstPath)) : unknownLatency;
+
+			uint32_t newSlowPathTimeMilli;
+			if (predictedFast != unknownLatency)
+			{
+				newSlowPathTimeMilli = timerFromPrediction(predictedFast);
+			}
+			else
+			{
+				const double execAvg = avgAndStdOfExecTime.avg();
+				const double execVar = avgAndStdOfExecTime.var();
+				const double execStd = ((execVar) > 0 ? sqrt(execVar) : 0);
+
+				newSlowPathTimeMilli = (avgAndStdOfExecTime.numOfElements() > 0) ?
+					(uint32_t)((execAvg + 2 * execStd) / 1000) : defaultTimeToStartSlowPathMilli;
+
+				if (newSlowPathTimeMilli < minTimeToStartSlowPathMilli) newSlowPathTimeMilli = minTimeToStartSlowPathMilli;
+				else if (newSlowPathTimeMilli > maxTimeToStartSlowPathMilli) newSlowPathTimeMilli = maxTimeToStartSlowPathMilli;
+			}
+
+			if (newSlowPathTimeMilli != currentTimeToStartSlowPathMilli)
+			{
+				currentTimeToStartSlowPathMilli = newSlowPathTimeMilli;
+				LOG_INFO_F(GL, "currentTimeToStartSlowPathMilli = %d", (int)currentTimeToStartSlowPathMilli);
+			}
+
+			return (lastFirstPathVal != currentFirstPath);
+		}
+
+		void LatencyBasedController::onSendingPrePrepare(SeqNum n, CommitPath commitPath)
+		{
+			if (!isPrimary) return;
+
+			SeqNumActivity& a = recentActivity[n % NumOfTrackedSeqNums];
+			if (a.seqNum == n) return; // not the first time we send the preprepare
+
+			const Time now = getMonotonicTime();
+
+			// the peers that did not respond for the previous sequence number of this entry are considered late
+			if (a.seqNum != 0) endRound(a, now);
+
+			a = SeqNumActivity();
+			a.seqNum = n;
+			a.path = commitPath;
+			a.prePrepareTime = now;
+
+			const bool slow = (commitPath == CommitPath::SLOW);
+			startRound(a, now, slow, slow || primaryIsCollector);
+		}
+
+		void LatencyBasedController::onStartingSlowCommit(SeqNum n)
+		{
+			if (!isPrimary) return;
+
+			SeqNumActivity* a = activityOf(n);
+			if (a == nullptr || a->slowPath) return;
+
+			const Time now = getMonotonicTime();
+			endRound(*a, now);
+			startRound(*a, now, true, true);
+		}
+
+		void LatencyBasedController::onMessage(const PreparePartialMsg* m)
+		{
+			if (!isPrimary) return;
+
+			SeqNumActivity* a = activityOf(m->seqNumber());
+			if (a == nullptr || !a->slowPath) return;
+
+			onResponse(*a, m->senderId());
+		}
+
+		void LatencyBasedController::onMessage(const PartialCommitProofMsg* m)
+		{
+			if (!isPrimary) return;
+
+			SeqNumActivity* a = activityOf(m->seqNumber());
+			if (a == nullptr || a->slowPath) return;
+
+			onResponse(*a, m->senderId());
+		}
+
+		LatencyBasedController::SeqNumActivity* LatencyBasedController::activityOf(SeqNum n)
+		{
+			SeqNumActivity& a = recentActivity[n % NumOfTrackedSeqNums];
+			return (a.seqNum == n && n != 0) ? &a : nullptr;
+		}
+
+		void LatencyBasedController::onResponse(SeqNumActivity& a, ReplicaId id)
+		{
+			if (!a.expectingResponses || id >= numOfReplicas || id == myId || a.responded[id]) return;
+
+			a.responded[id] = true;
+			a.numOfResponses++;
+
+			const Time now = getMonotonicTime();
+			const uint64_t latency = (now > a.referenceTime) ? subtract(now, a.referenceTime) : 0;
+			latencies[id].add((uint32_t)std::min<uint64_t>(latency, maxLatencyMicro), false);
+		}
+
+		void LatencyBasedController::startRound(SeqNumActivity& a, Time now, bool slowPath, bool expectingResponses)
+		{
+			a.referenceTime = now;
+			a.slowPath = slowPath;
+			a.expectingResponses = expectingResponses;
+			a.responded.reset();
+			a.numOfResponses = 0;
+		}
+
+		void LatencyBasedController::endRound(SeqNumActivity& a, Time now)
+		{
+			if (!a.expectingResponses) return;
+			a.expectingResponses = false;
+
+			if ((size_t)a.numOfResponses + 1 >= numOfReplicas) return;
+
+			// the latency of a missing response is at least the time we waited for it
+			const uint64_t waited = (now > a.referenceTime) ? subtract(now, a.referenceTime) : 0;
+			const uint32_t sample = (uint32_t)std::min<uint64_t>(waited, maxLatencyMicro);
+
+			for (ReplicaId id = 0; id < numOfReplicas; id++)
+			{
+				if (id == myId || a.responded[id]) continue;
+				latencies[id].add(sample, true);
+			}
+		}
+
+		uint32_t LatencyBasedController::kthEstimate(std::vector<uint32_t>& estimates, size_t k)
+		{
+			if (k == 0) return 0;
+			if (k > estimates.size()) return unknownLatency;
+
+			std::nth_element(estimates.begin(), estimates.begin() + (k - 1), estimates.end());
+			return estimates[k - 1];
+		}
+
+		bool LatencyBasedController::estimatesOfPeers(std::vector<uint32_t>& outEstimates, const SeqNumActivity* excludeResponded) const
+		{
+			outEstimates.clear();
+			outEstimates.reserve(numOfReplicas - 1);
+
+			for (ReplicaId id = 0; id < numOfReplicas; id++)
+			{
+				if (id == myId) continue;
+				if (excludeResponded != nullptr && excludeResponded->responded[id]) continue;
+
+				const ReplicaLatency& l = latencies[id];
+				if (!l.unresponsive() && !l.hasEstimate()) return false;
+
+				outEstimates.push_back(l.estimateMicro()); // unknownLatency if the peer is unresponsive
+			}
+
+			return true;
+		}
+
+		uint32_t LatencyBasedController::predictedCommitMicro(CommitPath path, std::vector<uint32_t>& estimates) const
+		{
+			const uint32_t t = kthEstimate(estimates, requiredResponses(path));
+			if (path != CommitPath::SLOW || t == unknownLatency) return t;
+
+			// the slow path has two rounds (prepare and commit)
+			return (uint32_t)std::min<uint64_t>(2 * (uint64_t)t, unknownLatency - 1);
+		}
+
+		size_t LatencyBasedController::requiredResponses(CommitPath path) const
+		{
+			switch (path)
+			{
+			case CommitPath::OPTIMISTIC_FAST:
+				return numOfReplicas - 1;
+			case CommitPath::FAST_WITH_THRESHOLD:
+				return 3 * f + c;
+			default:
+				return 2 * f + c;
+			}
+		}
+
+		uint32_t LatencyBasedController::timerFromPrediction(uint32_t predictedMicro) const
+		{
+			uint32_t retVal = (uint32_t)((timerFactor * predictedMicro + timerSlackMicro) / 1000);
+
+			if (retVal < minTimeToStartSlowPathMilli) retVal = minTimeToStartSlowPathMilli;
+			else if (retVal > maxTimeToStartSlowPathMilli) retVal = maxTimeToStartSlowPathMilli;
+
+			return retVal;
+		}
+
+	}
+}
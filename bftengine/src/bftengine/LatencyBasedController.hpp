@@ -0,0 +1,146 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License.
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <bitset>
+#include <vector>
+
+#include "ControllerBase.hpp"
+#include "SysConsts.hpp"
+#include "RollingAvgAndVar.hpp"
+#include "TimeUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		// A controller that selects the first commit path, and the time to start the slow path of each sequence number,
+		// from the response latencies of the peer replicas (used when ReplicaConfig::latencyBasedController is true).
+		//
+		// The primary measures the latency of a peer as the time from sending a PrePrepare message (or from starting the
+		// slow path) until the PreparePartial message of the peer arrives (or its PartialCommitProof message, when the
+		// primary is the collector of the fast path). A peer that does not respond gets a sample of the time it was
+		// waited for. For each peer, the controller estimates a high percentile of its recent samples, and predicts the
+		// time of a quorum of k peers as the k-th smallest estimate:
+		// - OPTIMISTIC_FAST needs all the peers, FAST_WITH_THRESHOLD needs 3F+C peers, and SLOW needs two rounds
+		//   of 2F+C peers. The first path is the one with the smallest predicted time (with hysteresis).
+		// - The slow path of a sequence number starts when its fast quorum is late: the prediction only uses the peers
+		//   that have not responded yet (if known), and the slow path starts immediately if they cannot form the quorum.
+		// Without enough samples, the timer is based on the execution time of recent sequence numbers.
+		class LatencyBasedController : public ControllerBase
+		{
+		public:
+
+			static const size_t EvaluationPeriod = 8;     // the first path may change every EvaluationPeriod executions
+			static const size_t NumOfSamples = 32;        // samples per replica
+			static const size_t MinNumOfSamples = 4;      // min samples per replica for an estimate
+			static const size_t NumOfTrackedSeqNums = 128;
+
+			LatencyBasedController(
+				uint16_t C,
+				uint16_t F,
+				ReplicaId replicaId,
+				ViewNum initialView,
+				SeqNum initialSeq,
+				bool primaryIsCollectorForPartialProofs);
+
+			// getter methods
+
+			virtual CommitPath getCurrentFirstPath() override;
+			virtual uint32_t timeToStartSlowPathMilli() override;
+			virtual uint32_t timeToStartSlowPathMilli(SeqNum n) override;
+			virtual uint32_t slowPathsTimerMilli() override;
+
+			// events
+
+			virtual void onNewView(ViewNum v, SeqNum s) override;
+			virtual bool onNewSeqNumberExecution(SeqNum n) override;
+
+			virtual void onSendingPrePrepare(SeqNum n, CommitPath commitPath) override;
+			virtual void onStartingSlowCommit(SeqNum n) override;
+			virtual void onMessage(const PreparePartialMsg* m) override;
+			virtual void onMessage(const PartialCommitProofMsg* m) override;
+
+		protected:
+
+			// recent latencies of a peer replica (in a circular buffer)
+			class ReplicaLatency
+			{
+			public:
+				ReplicaLatency() : numOfSamples(0), nextSample(0), missedInARow(0) {}
+
+				// missed=true, if the response did not arrive (latencyMicro is the time we waited for it)
+				void add(uint32_t latencyMicro, bool missed);
+
+				bool hasEstimate() const { return numOfSamples >= MinNumOfSamples; }
+				bool unresponsive() const;
+
+				// the 90th percentile of the samples (UINT32_MAX if unresponsive or without enough samples)
+				uint32_t estimateMicro() const;
+
+			private:
+				uint32_t samples[NumOfSamples];
+				size_t numOfSamples;
+				size_t nextSample;
+				size_t missedInARow;
+			};
+
+			struct SeqNumActivity
+			{
+				SeqNum seqNum = 0;
+				CommitPath path = CommitPath::NA;
+				Time prePrepareTime = 0;
+				Time referenceTime = 0;       // the start of the current round
+				bool expectingResponses = false; // true, if all the peers should respond in the current round
+				bool slowPath = false;           // the current round is the slow path
+				std::bitset<MaxNumberOfReplicas> responded; // peers that responded in the current round
+				uint16_t numOfResponses = 0;
+			};
+
+			const bool onlyOptimisticFast;
+			const size_t c;
+			const size_t f;
+			const size_t numOfReplicas;
+			const ReplicaId myId;
+			const bool primaryIsCollector;
+
+			CommitPath currentFirstPath;
+			ViewNum currentView;
+			bool isPrimary;
+
+			std::vector<ReplicaLatency> latencies; // indexed by replica id
+			std::vector<SeqNumActivity> recentActivity; // indexed by (sequence number % NumOfTrackedSeqNums)
+
+			RollingAvgAndVar avgAndStdOfExecTime;
+			size_t executionsSinceEvaluation;
+
+			uint32_t currentTimeToStartSlowPathMilli;
+			uint32_t minRecentTimeToStartSlowPathMilli; // since the last call to slowPathsTimerMilli
+
+			void onBecomePrimary(ViewNum v, SeqNum s);
+			bool onEndOfEvaluationPeriod();
+
+			SeqNumActivity* activityOf(SeqNum n);
+			void onResponse(SeqNumActivity& a, ReplicaId id);
+			void startRound(SeqNumActivity& a, Time now, bool slowPath, bool expectingResponses);
+			void endRound(SeqNumActivity& a, Time now);
+
+			// the k-th smallest estimate (reorders estimates); UINT32_MAX if there are less than k known estimates
+			static uint32_t kthEstimate(std::vector<uint32_t>& estimates, size_t k);
+			// returns false if a responsive peer does not have an estimate yet
+			bool estimatesOfPeers(std::vector<uint32_t>& outEstimates, const SeqNumActivity* excludeResponded) const;
+			uint32_t predictedCommitMicro(CommitPath path, std::vector<uint32_t>& estimates) const;
+			size_t requiredResponses(CommitPath path) const;
+
+			uint32_t timerFromPrediction(uint32_t predictedMicro) const;
+		};
+
+	}
+}
@@ -39,10 +39,14 @@ namespace bftEngine
 				ViewChange,
 				ReplicaStatus,
 				StateTransfer,
+				CompactPrePrepare,
+				MsgsBatch, // several messages (see MsgsCoalescer)
+				PrePrepareDigest,
 
 
 				Request = 700,
 				Reply = 800,
+				TentativeReply = 801,
 
 
 			};
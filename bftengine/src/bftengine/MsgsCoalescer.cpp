@@ -0,0 +1,87 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include <string.h>
+
+#include "MsgsCoalescer.hpp"
+#include "MsgCode.hpp"
+#include "assertUtils.hpp"
+#include "Logger.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		MsgsCoalescer::MsgsCoalescer(ICommunication* comm, uint16_t numOfReplicas, uint32_t maxBatchSize) :
+			communication_{ comm },
+			maxBatchSize_{ maxBatchSize },
+			batches_(numOfReplicas)
+		{
+			Assert(comm != nullptr);
+			Assert(maxBatchSize > headerSize + sizeFieldSize);
+		}
+
+		int MsgsCoalescer::send(ReplicaId dest, const char* msg, MsgSize size)
+		{
+			Assert(dest < batches_.size());
+			Batch& b = batches_[dest];
+
+			if (b.buf.size() + sizeFieldSize + size > maxBatchSize_)
+			{
+				// keep the order of the messages to dest
+				if (b.numOfMsgs > 0) sendBatch(dest, b);
+
+				if (headerSize + sizeFieldSize + size > maxBatchSize_)
+					return communication_->sendAsyncMessage(dest, msg, size);
+			}
+
+			if (b.numOfMsgs == 0)
+			{
+				const MsgType type = MsgCode::MsgsBatch;
+				b.buf.resize(headerSize);
+				memcpy(b.buf.data(), &type, headerSize);
+				nonEmptyBatches_.push_back(dest);
+			}
+
+			const uint32_t s = size;
+			b.buf.insert(b.buf.end(), (const char*)&s, (const char*)&s + sizeFieldSize);
+			b.buf.insert(b.buf.end(), msg, msg + size);
+			b.numOfMsgs++;
+			return 0;
+		}
+
+		void MsgsCoalescer::flush()
+		{
+			for (ReplicaId dest : nonEmptyBatches_)
+			{
+				Batch& b = batches_[dest];
+				if (b.numOfMsgs > 0) sendBatch(dest, b);
+			}
+
+			nonEmptyBatches_.clear();
+		}
+
+		int MsgsCoalescer::sendBatch(ReplicaId dest, Batch& b)
+		{
+			Assert(b.numOfMsgs > 0);
+
+			int errorCode = 0;
+			if (b.numOfMsgs == 1)
+				errorCode = communication_->sendAsyncMessage(dest, b.buf.data() + headerSize + sizeFieldSize, b.buf.size() - headerSize - sizeFieldSize);
+			else
+				errorCode = communication_->sendAsyncMessage(dest, b.buf.data(), b.buf.size());
+
+			if (errorCode != 0)
+				LOG_ERROR_F(GL, "In MsgsCoalescer::sendBatch - communication->sendAsyncMessage returned error %d", errorCode);
+
+			b.buf.clear();
+			b.numOfMsgs = 0;
+			return errorCode;
+		}
+	}
+}
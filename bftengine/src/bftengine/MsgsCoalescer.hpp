@@ -0,0 +1,93 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "PrimitiveTypes.hpp"
+#include "ICommunication.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		// Packs the messages that a replica sends to the same replica into a single message (of type
+		// MsgCode::MsgsBatch), which is sent when flush() is called (at the end of an iteration of the main
+		// loop) or when the next message does not fit in it.
+		// Format of a batch: MessageBase::Header, followed by (uint32_t size, message) for each message.
+		// A batch with a single message is sent as the message itself.
+		// Not thread safe (only used by the main thread of the replica).
+		class MsgsCoalescer
+		{
+		public:
+			MsgsCoalescer(ICommunication* comm, uint16_t numOfReplicas, uint32_t maxBatchSize);
+
+			// returns the error code of ICommunication::sendAsyncMessage (if the message is sent now)
+			int send(ReplicaId dest, const char* msg, MsgSize size);
+
+			// sends all the pending batches
+			void flush();
+
+			// calls onMsg(msg, size) for each message of the batch; returns false (before calling onMsg) if
+			// the batch is malformed
+			template<typename F>
+			static bool forEachMsgInBatch(const char* batch, size_t batchSize, F onMsg);
+
+		private:
+			struct Batch
+			{
+				std::vector<char> buf;
+				uint16_t numOfMsgs = 0;
+			};
+
+			static const uint32_t headerSize = sizeof(MsgType);
+			static const uint32_t sizeFieldSize = sizeof(uint32_t);
+
+			int sendBatch(ReplicaId dest, Batch& b);
+
+			ICommunication* const communication_;
+			const uint32_t maxBatchSize_;
+
+			std::vector<Batch> batches_; // indexed by replica id
+			std::vector<ReplicaId> nonEmptyBatches_;
+		};
+
+		template<typename F>
+		bool MsgsCoalescer::forEachMsgInBatch(const char* batch, size_t batchSize, F onMsg)
+		{
+			// validate the whole batch first
+			size_t pos = headerSize;
+			size_t numOfMsgs = 0;
+			while (pos < batchSize)
+			{
+				if (batchSize - pos < sizeFieldSize) return false;
+				uint32_t size = 0;
+				memcpy(&size, batch + pos, sizeFieldSize);
+				pos += sizeFieldSize;
+				if (size < sizeof(MsgType) || size > batchSize - pos) return false;
+				pos += size;
+				numOfMsgs++;
+			}
+			if (numOfMsgs == 0) return false;
+
+			pos = headerSize;
+			while (pos < batchSize)
+			{
+				uint32_t size = 0;
+				memcpy(&size, batch + pos, sizeFieldSize);
+				pos += sizeFieldSize;
+				onMsg(batch + pos, (MsgSize)size);
+				pos += size;
+			}
+			return true;
+		}
+	}
+}
@@ -15,6 +15,7 @@
 #include "Crypto.hpp"
 #include "assertUtils.hpp"
 #include "InternalReplicaApi.hpp"
+#include "ThresholdSigsCombiner.hpp"
 
 namespace bftEngine {
     namespace impl {
@@ -203,7 +204,8 @@ namespace bftEngine {
 
         // NB: the following class is part of a patch 
 
-        class AsynchProofCreationJob : public SimpleThreadPool::Job {
+        // combined (with the proofs of other sequence numbers) by ThresholdSigsCombiner
+        class AsynchProofCreationJob : public ThresholdSigsCombiner::Item {
         public:
 
             AsynchProofCreationJob(InternalReplicaApi* myReplica, IThresholdVerifier* verifier, IThresholdAccumulator* acc, Digest& expectedDigest, SeqNum seqNumber, ViewNum viewNumber) {
@@ -218,26 +220,31 @@ namespace bftEngine {
             virtual ~AsynchProofCreationJob() {
             };
 
-            virtual void execute() {
+            IThresholdVerifier* thresholdVerifier() const {
+                return verifier;
+            }
+
+            virtual IThresholdAccumulator* createAccumulator(IThresholdVerifier* v) override {
+                Assert(v == verifier && acc != nullptr);
                 LOG_INFO_F(GL, "PartialProofsSet::AsynchProofCreationJob::execute - begin (for seqNumber %" PRId64 ")", seqNumber);
 
-                const uint16_t bufferSize = (uint16_t) verifier->requiredLengthForSignedData();
-                char* const bufferForSigComputations = (char*) alloca(bufferSize);
+                IThresholdAccumulator* a = acc;
+                acc = nullptr; // released by the combiner
+                return a;
+            }
 
-                //char bufferForSigComputations[2048]; 
+            virtual const Digest& signedDigest() const override {
+                return expectedDigest;
+            }
 
-                size_t sigLength = verifier->requiredLengthForSignedData();
+            virtual void onCombined(IThresholdVerifier* v, const char* bufferForSigComputations, uint16_t sigLength, bool succ) override {
+                Assert(v == verifier);
 
-                //		if (sigLength > sizeof(bufferForSigComputations) || sigLength > UINT16_MAX || sigLength == 0)
-                if (sigLength > UINT16_MAX || sigLength == 0) {
+                if (sigLength == 0) {
                     LOG_WARN_F(GL, "Unable to create FullProof for seqNumber %" PRId64 "", seqNumber);
                     return;
                 }
 
-                acc->getFullSignedData(bufferForSigComputations, sigLength);
-
-                bool succ = verifier->verify((char*) &expectedDigest, sizeof (Digest), bufferForSigComputations, (uint16_t) sigLength);
-
                 if (!succ) {
                     LOG_WARN_F(GL, "Failed to create FullProof for seqNumber %" PRId64 "", seqNumber);
                     LOG_INFO_F(GL, "PartialProofsSet::AsynchProofCreationJob::execute - end (for seqNumber %" PRId64 ")", seqNumber);
@@ -246,7 +253,8 @@ namespace bftEngine {
                     unsigned char * result;
                     result = atoh((unsigned char *) bufferForSigComputations, sigLength, &result);
                     LOG_INFO_F(GL, "------>Create FullProof for seqNumber %" PRId64 " sig=%s sigLen=%d", seqNumber, result, sigLength);
-                    FullCommitProofMsg* fcpMsg = new FullCommitProofMsg(me->getReplicasInfo().myId(), view, seqNumber, bufferForSigComputations, (uint16_t) sigLength);
+                    free(result);
+                    FullCommitProofMsg* fcpMsg = new FullCommitProofMsg(me->getReplicasInfo().myId(), view, seqNumber, bufferForSigComputations, sigLength);
 
                     //			me->sendToAllOtherReplicas(fcpMsg);
 
@@ -279,7 +287,9 @@ namespace bftEngine {
 
             }
 
-            virtual void release() {
+            virtual void release() override {
+                if (acc != nullptr) verifier->release(acc);
+                delete this;
             }
 
         private:
@@ -321,7 +331,7 @@ namespace bftEngine {
 
                 AsynchProofCreationJob* j = new AsynchProofCreationJob(replica, thresholdVerifier(cPath), acc, expectedDigest, myPCP->seqNumber(), myPCP->viewNumber());
 
-                replica->getInternalThreadPool().add(j);
+                replica->getThresholdSigsCombiner().add(j->thresholdVerifier(), j);
 
                 LOG_INFO_F(GL, "PartialProofsSet - send to BK thread (for seqNumber %" PRId64 ")", seqNumber);
             }
@@ -57,7 +57,7 @@ class PersistentStorage {
     // lastExecuted >= lastStable
     SeqNum lastExecuted;
 
-    // elements.size() <= kWorkWindowSize
+    // elements.size() <= workWindowSize (see ReplicaConfig::checkpointWindowSize)
     // The messages in elements[i] may be null
     std::vector<ViewsManager::PrevViewInfo> elements;
   };
@@ -133,7 +133,7 @@ class PersistentStorage {
   
 	//
   // The window of sequence numbers is:
-  // { i | LS + 1 <= i <= LS + kWorkWindowSize }
+  // { i | LS + 1 <= i <= LS + workWindowSize }
   // where LS=lastStableSeqNum
   //
   // The window of checkpoints is:
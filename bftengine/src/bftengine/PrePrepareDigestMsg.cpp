@@ -0,0 +1,53 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+
+#include "PrePrepareDigestMsg.hpp"
+#include "PrePrepareMsg.hpp"
+#include "assertUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		PrePrepareDigestMsg::PrePrepareDigestMsg(ReplicaId senderId, const PrePrepareMsg* pp)
+			: MessageBase(senderId, MsgCode::PrePrepareDigest, sizeof(PrePrepareDigestMsgHeader))
+		{
+			b()->viewNum = pp->viewNumber();
+			b()->seqNum = pp->seqNumber();
+			b()->firstPath = (uint16_t)pp->firstPath();
+			b()->digestOfRequests = pp->digestOfRequests();
+		}
+
+		bool PrePrepareDigestMsg::matches(const PrePrepareMsg* pp) const
+		{
+			return (pp->viewNumber() == viewNumber()) &&
+				(pp->seqNumber() == seqNumber()) &&
+				(pp->firstPath() == firstPath()) &&
+				(pp->digestOfRequests() == digestOfRequests());
+		}
+
+		bool PrePrepareDigestMsg::ToActualMsgType(const ReplicasInfo& repInfo, MessageBase* inMsg, PrePrepareDigestMsg*& outMsg) {
+			Assert(inMsg->type() == MsgCode::PrePrepareDigest);
+			if (inMsg->size() < sizeof(PrePrepareDigestMsgHeader)) return false;
+
+			PrePrepareDigestMsg* t = (PrePrepareDigestMsg*)inMsg;
+
+			if (repInfo.primaryOfView(t->viewNumber()) != t->senderId()) return false;
+
+			if (t->seqNumber() == 0) return false;
+
+			if (t->b()->firstPath >= 3) return false; // invalid first path
+
+			outMsg = t;
+			return true;
+		}
+
+	}
+}
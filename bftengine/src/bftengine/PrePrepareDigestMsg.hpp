@@ -0,0 +1,58 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+
+#pragma once
+
+#include "MessageBase.hpp"
+#include "Digest.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		class PrePrepareMsg;
+
+		// Sent by the primary to all the replicas when the PrePrepareMsg is disseminated through relays (see
+		// ReplicaConfig::prePrepareFanout). A PrePrepareMsg that is received from a relay is only accepted if it
+		// matches the PrePrepareDigestMsg of the primary.
+		class PrePrepareDigestMsg : public MessageBase
+		{
+		public:
+			PrePrepareDigestMsg(ReplicaId senderId, const PrePrepareMsg* pp);
+
+			ViewNum viewNumber() const { return b()->viewNum; }
+
+			SeqNum seqNumber() const { return b()->seqNum; }
+
+			CommitPath firstPath() const { return (CommitPath)b()->firstPath; }
+
+			Digest& digestOfRequests() const { return b()->digestOfRequests; }
+
+			bool matches(const PrePrepareMsg* pp) const;
+
+			static bool ToActualMsgType(const ReplicasInfo& repInfo, MessageBase* inMsg, PrePrepareDigestMsg*& outMsg);
+
+		protected:
+#pragma pack(push,1)
+			struct PrePrepareDigestMsgHeader
+			{
+				MessageBase::Header header;
+				ViewNum viewNum;
+				SeqNum seqNum;
+				uint16_t firstPath;
+				Digest digestOfRequests;
+			};
+#pragma pack(pop)
+			static_assert(sizeof(PrePrepareDigestMsgHeader) == (2 + 8 + 8 + 2 + DIGEST_SIZE), "PrePrepareDigestMsgHeader is (20 + DIGEST_SIZE)B");
+
+			PrePrepareDigestMsgHeader* b() const { return (PrePrepareDigestMsgHeader*)msgBody_; }
+		};
+
+	}
+}
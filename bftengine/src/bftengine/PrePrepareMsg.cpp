@@ -6,6 +6,8 @@
 //
 //This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
 
+#include <new>
+
 #include "PrePrepareMsg.hpp"
 #include "SysConsts.hpp"
 #include "Crypto.hpp"
@@ -20,6 +22,8 @@ namespace bftEngine
 
 		static Digest nullDigest(0x18);
 
+		static_assert((maxExternalMessageSize - sizeof(RequestsMerkleTree::Builder)) % alignof(RequestsMerkleTree::Builder) == 0, "");
+
 		///////////////////////////////////////////////////////////////////////////////
 		// PrePrepareMsg
 		///////////////////////////////////////////////////////////////////////////////
@@ -83,11 +87,19 @@ namespace bftEngine
 			if (!tmp->checkRequests()) return false;
 
 			// digest
-			Digest d;
-			const char* requestBuffer = (char*)&(tmp->b()->numberOfRequests);
-			const uint32_t requestSize = (tmp->b()->endLocationOfLastRequest - prePrepareHeaderPrefix);
+			const uint16_t numOfRequests = tmp->b()->numberOfRequests;
+			std::vector<const char*> requests(numOfRequests);
+			std::vector<uint32_t> requestsSizes(numOfRequests);
+			uint32_t loc = sizeof(PrePrepareMsgHeader);
+			for (uint16_t i = 0; i < numOfRequests; i++)
+			{
+				requests[i] = tmp->body() + loc;
+				requestsSizes[i] = getRequestSizeTemp(requests[i]);
+				loc += requestsSizes[i];
+			}
 
-			DigestUtil::compute(requestBuffer, requestSize, (char*)&d, sizeof(Digest));
+			Digest d;
+			RequestsMerkleTree::computeRootOfRequests(requests.data(), requestsSizes.data(), numOfRequests, d);
 
 			if (d != tmp->b()->digestOfRequests) return false;
 
@@ -108,7 +120,10 @@ namespace bftEngine
 			b()->flags = computeFlagsForPrePrepareMsg(isNull, ready, firstPath);
 
 			if (!isNull) // not null
+			{
 				b()->digestOfRequests.makeZero();
+				new (digestBuilder()) RequestsMerkleTree::Builder();
+			}
 			else // null
 				b()->digestOfRequests = nullDigest;
 
@@ -123,7 +138,7 @@ namespace bftEngine
 			Assert(!isNull());
 			Assert(b()->endLocationOfLastRequest >= sizeof(PrePrepareMsgHeader));
 
-			return (internalStorageSize() - b()->endLocationOfLastRequest);
+			return (internalStorageSize() - sizeof(RequestsMerkleTree::Builder) - b()->endLocationOfLastRequest);
 		}
 
 		void PrePrepareMsg::addRequest(char* pRequest, uint32_t requestSize)
@@ -139,6 +154,10 @@ namespace bftEngine
 
 			b()->endLocationOfLastRequest = b()->endLocationOfLastRequest + requestSize;
 			b()->numberOfRequests = b()->numberOfRequests + 1;
+
+			Digest leaf;
+			RequestsMerkleTree::computeLeafDigest(insertPtr, requestSize, leaf);
+			digestBuilder()->add(leaf);
 		}
 
 
@@ -158,11 +177,10 @@ namespace bftEngine
 			b()->flags |= 0x2;
 			Assert(isReady());
 
-			// compute and set digest
+			// set digest (before the size is changed, because the builder is stored at the end of the storage)
+			Assert(digestBuilder()->numberOfLeaves() == b()->numberOfRequests);
 			Digest d;
-			const char* requestBuffer = (char*)&(b()->numberOfRequests);
-			const uint32_t requestSize = (b()->endLocationOfLastRequest - prePrepareHeaderPrefix);
-			DigestUtil::compute(requestBuffer, requestSize, (char*)&d, sizeof(Digest));
+			digestBuilder()->computeRoot(d);
 			b()->digestOfRequests = d;
 
 			// size
@@ -180,6 +198,30 @@ namespace bftEngine
 		}
 
 
+		bool PrePrepareMsg::computeInclusionProofOfRequest(uint16_t reqIndex, Digest& outLeaf, std::vector<Digest>& outProof) const
+		{
+			if (isNull() || !isReady() || reqIndex >= b()->numberOfRequests) return false;
+
+			std::vector<const char*> requests(b()->numberOfRequests);
+			std::vector<uint32_t> requestsSizes(b()->numberOfRequests);
+			RequestsIterator it(this);
+			char* req = nullptr;
+			for (uint16_t i = 0; it.getAndGoToNext(req); i++)
+			{
+				requests[i] = req;
+				requestsSizes[i] = getRequestSizeTemp(req);
+			}
+
+			std::vector<Digest> leaves(b()->numberOfRequests);
+			RequestsMerkleTree::computeLeafDigests(requests.data(), requestsSizes.data(), b()->numberOfRequests, leaves.data());
+
+			outLeaf = leaves[reqIndex];
+			RequestsMerkleTree::computeInclusionProof(leaves.data(), b()->numberOfRequests, reqIndex, outProof);
+
+			return true;
+		}
+
+
 		void PrePrepareMsg::updateView(ViewNum v, CommitPath firstPath)
 		{
 			b()->viewNum = v;
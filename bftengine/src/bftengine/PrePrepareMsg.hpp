@@ -9,11 +9,13 @@
 #pragma once
 
 #include <stdint.h>
+#include <vector>
 
 #include "PrimitiveTypes.hpp"
 #include "assertUtils.hpp"
 #include "Digest.hpp"
 #include "MessageBase.hpp"
+#include "RequestsMerkleTree.hpp"
 
 namespace bftEngine
 {
@@ -34,7 +36,7 @@ namespace bftEngine
 				ViewNum viewNum;
 				SeqNum  seqNum;
 				uint16_t flags;
-				Digest  digestOfRequests;
+				Digest  digestOfRequests; // root of RequestsMerkleTree (one leaf per request)
 
 				uint16_t numberOfRequests;
 				uint32_t endLocationOfLastRequest;
@@ -48,8 +50,6 @@ namespace bftEngine
 #pragma pack(pop)
 			static_assert(sizeof(PrePrepareMsgHeader) == (2 + 8 + 8 + 2 + DIGEST_SIZE + 2 + 4), "PrePrepareMsgHeader is 58B");
 
-			static const size_t prePrepareHeaderPrefix = sizeof(PrePrepareMsgHeader) - sizeof(PrePrepareMsgHeader::numberOfRequests) - sizeof(PrePrepareMsgHeader::endLocationOfLastRequest);
-
 		public:
 
 			// static
@@ -88,6 +88,9 @@ namespace bftEngine
 
 			uint16_t numberOfRequests() const { return b()->numberOfRequests; }
 
+			// proof that request number reqIndex is included in digestOfRequests() (see RequestsMerkleTree)
+			bool computeInclusionProofOfRequest(uint16_t reqIndex, Digest& outLeaf, std::vector<Digest>& outProof) const;
+
 			// update view and first path 
 
 			void updateView(ViewNum v, CommitPath firstPath = CommitPath::SLOW);
@@ -100,6 +103,13 @@ namespace bftEngine
 
 			bool checkRequests();
 
+			// while the message is being built (i.e. before finishAddingRequests), a RequestsMerkleTree::Builder
+			// is stored at the end of the internal storage
+			RequestsMerkleTree::Builder* digestBuilder() const
+			{
+				return (RequestsMerkleTree::Builder*)(body() + internalStorageSize() - sizeof(RequestsMerkleTree::Builder));
+			}
+
 			PrePrepareMsgHeader* b() const
 			{
 				return (PrePrepareMsgHeader*)msgBody_;
@@ -10,6 +10,9 @@
 #include "assertUtils.hpp"
 #include "ClientRequestMsg.hpp"
 #include "PrePrepareMsg.hpp"
+#include "CompactPrePrepareMsg.hpp"
+#include "PrePrepareDigestMsg.hpp"
+#include "RequestsCache.hpp"
 #include "CheckpointMsg.hpp"
 #include "ClientReplyMsg.hpp"
 #include "Logger.hpp"
@@ -17,6 +20,7 @@
 #include "FullExecProofMsg.hpp"
 #include "StartSlowCommitMsg.hpp"
 #include "ControllerWithSimpleHistory.hpp"
+#include "LatencyBasedController.hpp"
 #include "ReqMissingDataMsg.hpp"
 #include "SimpleAckMsg.hpp"
 #include "ViewChangeMsg.hpp"
@@ -129,6 +133,8 @@ namespace bftEngine {
             r[MsgCode::FullCommitProof] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<FullCommitProofMsg>;
             r[MsgCode::NewView] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<NewViewMsg>;
             r[MsgCode::PrePrepare] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<PrePrepareMsg>;
+            r[MsgCode::CompactPrePrepare] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<CompactPrePrepareMsg>;
+            r[MsgCode::PrePrepareDigest] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<PrePrepareDigestMsg>;
             r[MsgCode::PartialCommitProof] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<PartialCommitProofMsg>;
             r[MsgCode::PartialExecProof] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<PartialExecProofMsg>;
             r[MsgCode::PreparePartial] = &ReplicaImp::metaMessageHandler_IgnoreWhenCollectingState<PreparePartialMsg>;
@@ -190,16 +196,23 @@ namespace bftEngine {
         }
 
         void ReplicaImp::sendToAllOtherReplicas(MessageBase *m) {
-            for (ReplicaId dest : repsInfo->idsOfPeerReplicas())
-                sendRaw(m->body(), dest, m->type(), m->size());
+            sendRaw(m->body(), ALL_OTHER_REPLICAS, m->type(), m->size());
         }
 
         void ReplicaImp::sendRaw(char* m, NodeIdType dest, uint16_t type, MsgSize size) {
             int errorCode = 0;
 
             if (dest == ALL_OTHER_REPLICAS) {
-                for (ReplicaId d : repsInfo->idsOfPeerReplicas())
-                    sendRaw(m, d, type, size);
+#ifdef DEBUG_STATISTICS
+                for (size_t i = 0; i < peerReplicasNodes.size(); i++)
+                    DebugStatistics::onSendExMessage(type);
+#endif
+
+                errorCode = communication->sendAsyncMessageToMany(peerReplicasNodes, m, size);
+
+                if (errorCode != 0) {
+                    LOG_ERROR_F(GL, "In ReplicaImp::sendRaw - communication->sendAsyncMessageToMany returned error %d for message type %d", errorCode, (int) type);
+                }
                 return;
             }
 
@@ -207,7 +220,10 @@ namespace bftEngine {
             DebugStatistics::onSendExMessage(type);
 #endif
 
-            errorCode = communication->sendAsyncMessage(dest, m, size);
+            if (msgsCoalescer != nullptr && repsInfo->isIdOfReplica(dest))
+                errorCode = msgsCoalescer->send(dest, m, size); // sent by the next flush() (or now)
+            else
+                errorCode = communication->sendAsyncMessage(dest, m, size);
 
             if (errorCode != 0) {
                 LOG_ERROR_F(GL, "In ReplicaImp::sendRaw - communication->sendAsyncMessage returned error %d for message type %d", errorCode, (int) type);
@@ -217,6 +233,9 @@ namespace bftEngine {
         void ReplicaImp::recvMsg(void*& item, bool& external) {
             bool newMsg = false;
             while (!newMsg) {
+                // end of an iteration of the main loop (or of a timers evaluation)
+                if (msgsCoalescer != nullptr) msgsCoalescer->flush();
+
                 newMsg = incomingMsgsStorage.pop(item, external, timersResolution);
 
                 if (!newMsg) timersScheduler.evaluate(); // TODO(GG): make sure that we don't check timers too often (i.e. much faster than timersResolution)
@@ -235,12 +254,23 @@ namespace bftEngine {
             if (messageLength > maxExternalMessageSize) return;
             if (messageLength < sizeof (MessageBase::Header)) return;
 
+            NodeIdType n = (uint16_t) sourceNode; // TODO(GG): make sure that this casting is okay
+
+            if (((const MessageBase::Header*) message)->msgType == MsgCode::MsgsBatch) {
+                MsgsCoalescer::forEachMsgInBatch(message, messageLength, [this, n](const char* msg, MsgSize size) {
+                    if (((const MessageBase::Header*) msg)->msgType != MsgCode::MsgsBatch) pushExternalMsg(n, msg, size);
+                });
+                return;
+            }
+
+            pushExternalMsg(n, message, (MsgSize) messageLength);
+        }
+
+        void ReplicaImp::MsgReceiver::pushExternalMsg(NodeIdType sender, const char* const message, MsgSize messageLength) {
             MessageBase::Header* msgBody = (MessageBase::Header*)std::malloc(messageLength);
             memcpy(msgBody, message, messageLength);
 
-            NodeIdType n = (uint16_t) sourceNode; // TODO(GG): make sure that this casting is okay
-
-            MessageBase* pMsg = new MessageBase(n, msgBody, messageLength, true);
+            MessageBase* pMsg = new MessageBase(sender, msgBody, messageLength, true);
 
             // TODO(GG): TBD: do we want to verify messages in this thread (communication) ?
 
@@ -259,6 +289,8 @@ namespace bftEngine {
 
             LOG_INFO_F(GL, "Node %d received ClientRequestMsg (clientId=%d reqSeqNum=%" PRIu64 ", readOnly=%d) from Node %d", myReplicaId, clientId, reqSeqNum, readOnly ? 1 : 0, senderId);
 
+            if (m->isTraced()) RequestTracer::record(myReplicaId, clientId, reqSeqNum, ReplicaReceived);
+
             if (stateTransfer->isCollectingState()) {
                 LOG_INFO_F(GL, "ClientRequestMsg is ignored becuase this replica is collecting missing state from the other replicas");
                 delete m;
@@ -278,6 +310,12 @@ namespace bftEngine {
             }
 
             if (readOnly) {
+                if (clientsSignRequests && !validClientSignatures({m->body()})) {
+                    LOG_INFO_F(GL, "ClientRequestMsg has an invalid signature");
+                    onReportAboutInvalidMessage(m);
+                    delete m;
+                    return;
+                }
                 executeReadOnlyRequest(m);
                 delete m;
                 return;
@@ -295,12 +333,21 @@ namespace bftEngine {
                 if (isCurrentPrimary()) {
                     if (clientsManager->noPendingAndRequestCanBecomePending(clientId, reqSeqNum) && (requestsQueueOfPrimary.size() < 700)) // TODO(GG): use config/parameter
                     {
-                        requestsQueueOfPrimary.push(m);
+                        requestsQueueOfPrimary.push_back(m);
                         tryToSendPrePrepareMsg(true);
                         return;
                     } else {
                         LOG_INFO_F(GL, "ClientRequestMsg is ignored becuase: request is old, OR primary is current working on a request from the same client, OR queue contains too many requests");
                     }
+                } else if (clientsMulticastRequests) // not the current primary, and the primary receives the request directly from the client
+                {
+                    if (clientsManager->noPendingAndRequestCanBecomePending(clientId, reqSeqNum))
+                        clientsManager->addPendingRequest(clientId, reqSeqNum);
+
+                    requestsCache->add(m); // the cache is responsible for deleting m
+
+                    LOG_INFO_F(GL, "ClientRequestMsg is added to the requests cache");
+                    return;
                 } else // not the current primary
                 {
                     if (clientsManager->noPendingAndRequestCanBecomePending(clientId, reqSeqNum)) {
@@ -308,6 +355,8 @@ namespace bftEngine {
 
                         send(m, currentPrimary()); // TODO(GG): add a mechanism that retransmits (otherwise we may start unnecessary view-change )
 
+                        if (m->isTraced()) RequestTracer::record(myReplicaId, clientId, reqSeqNum, ForwardedToPrimary);
+
                         LOG_INFO_F(GL, "Sending ClientRequestMsg to current primary");
                     } else {
                         LOG_INFO_F(GL, "ClientRequestMsg is ignored becuase request is old or replica has another pending request from the same client");
@@ -332,7 +381,7 @@ namespace bftEngine {
         void ReplicaImp::tryToSendPrePrepareMsg(bool batchingLogic) {
             Assert(isCurrentPrimary() && currentViewIsActive());
 
-            if (primaryLastUsedSeqNum + 1 > lastStableSeqNum + kWorkWindowSize) return;
+            if (primaryLastUsedSeqNum + 1 > lastStableSeqNum + workWindowSize) return;
 
             if (primaryLastUsedSeqNum + 1 > lastExecutedSeqNum + maxConcurrentAgreementsByPrimary) return; // TODO(GG): should also be checked by the non-primary replicas
 
@@ -342,7 +391,8 @@ namespace bftEngine {
             ClientRequestMsg* first = requestsQueueOfPrimary.front();
             while (first != nullptr && !clientsManager->noPendingAndRequestCanBecomePending(first->clientProxyId(), first->requestSeqNum())) {
                 delete first;
-                requestsQueueOfPrimary.pop();
+                requestsQueueOfPrimary.pop_front();
+                if (verifiedRequestsInQueueOfPrimary > 0) verifiedRequestsInQueueOfPrimary--;
                 first = (!requestsQueueOfPrimary.empty() ? requestsQueueOfPrimary.front() : nullptr);
             }
 
@@ -365,14 +415,22 @@ namespace bftEngine {
                 const size_t maxReasonableMinBatchSize = 350; // TODO(GG): use param from configuration
 
                 if (minBatchSize > maxReasonableMinBatchSize) minBatchSize = maxReasonableMinBatchSize;
+
+                if (minBatchSize > maxBatchSize) minBatchSize = maxBatchSize;
             }
 
             if (requestsInQueue < minBatchSize) return;
 
+            // only requests with valid signatures are added to the PrePrepare message
+            if (clientsSignRequests) {
+                verifyClientSignaturesInQueueOfPrimary();
+                if (verifiedRequestsInQueueOfPrimary == 0) return;
+            }
+
             primaryLastUsedSeqNum++;
 
             // update batchingFactor
-            if ((primaryLastUsedSeqNum % kWorkWindowSize) == 0) // TODO(GG): do we want to update batchingFactor when the view is changed
+            if ((primaryLastUsedSeqNum % workWindowSize) == 0) // TODO(GG): do we want to update batchingFactor when the view is changed
             {
                 const size_t aa = 4; // TODO(GG): read from configuration
                 batchingFactor = (maxNumberOfPendingRequestsInRecentHistory / aa);
@@ -380,7 +438,7 @@ namespace bftEngine {
                 maxNumberOfPendingRequestsInRecentHistory = 0;
             }
 
-            Assert(primaryLastUsedSeqNum <= lastExecutedSeqNum + MaxConcurrentFastPaths); // because maxConcurrentAgreementsByPrimary <  MaxConcurrentFastPaths
+            Assert(primaryLastUsedSeqNum <= lastExecutedSeqNum + maxConcurrentFastPaths); // because maxConcurrentAgreementsByPrimary <  maxConcurrentFastPaths
 
             CommitPath firstPath = controller->getCurrentFirstPath();
 
@@ -391,13 +449,17 @@ namespace bftEngine {
             PrePrepareMsg *pp = new PrePrepareMsg(myReplicaId, curView, primaryLastUsedSeqNum, firstPath, false);
 
             ClientRequestMsg* nextRequest = requestsQueueOfPrimary.front();
-            while (nextRequest != nullptr && nextRequest->size() <= pp->remainingSizeForRequests()) {
+            while (nextRequest != nullptr && nextRequest->size() <= pp->remainingSizeForRequests() && pp->numberOfRequests() < maxBatchSize &&
+                    (!clientsSignRequests || verifiedRequestsInQueueOfPrimary > 0)) {
                 if (clientsManager->noPendingAndRequestCanBecomePending(nextRequest->clientProxyId(), nextRequest->requestSeqNum())) {
                     pp->addRequest(nextRequest->body(), nextRequest->size());
                     clientsManager->addPendingRequest(nextRequest->clientProxyId(), nextRequest->requestSeqNum());
+                    if (nextRequest->isTraced())
+                        RequestTracer::record(myReplicaId, nextRequest->clientProxyId(), nextRequest->requestSeqNum(), AddedToPrePrepare);
                 }
                 delete nextRequest;
-                requestsQueueOfPrimary.pop();
+                requestsQueueOfPrimary.pop_front();
+                if (verifiedRequestsInQueueOfPrimary > 0) verifiedRequestsInQueueOfPrimary--;
                 nextRequest = (requestsQueueOfPrimary.size() > 0 ? requestsQueueOfPrimary.front() : nullptr);
             }
 
@@ -408,10 +470,31 @@ namespace bftEngine {
             LOG_INFO_F(GL, "Sending PrePrepareMsg (seqNumber=%" PRId64 ", requests=%d, size=%d",
                     pp->seqNumber(), (int) pp->numberOfRequests(), (int) requestsQueueOfPrimary.size());
 
-            for (ReplicaId x : repsInfo->idsOfPeerReplicas()) {
-                sendRetransmittableMsgToReplica(pp, x, primaryLastUsedSeqNum);
+            // if the replicas have the requests, only their identifiers and digests are sent
+            CompactPrePrepareMsg* compactPP = (clientsMulticastRequests ? CompactPrePrepareMsg::create(pp) : nullptr);
+
+            if (prePrepareFanout > 0) {
+                // the replicas get the digest from the primary, and the PrePrepareMsg from the relays
+                PrePrepareDigestMsg ppDigest(myReplicaId, pp);
+                sendToAllOtherReplicas(&ppDigest);
+
+                std::vector<ReplicaId> relays;
+                repsInfo->getChildrenInPrePrepareTree(myReplicaId, curView, primaryLastUsedSeqNum, prePrepareFanout, relays);
+                for (ReplicaId x : relays) sendRetransmittableMsgToReplica(pp, x, primaryLastUsedSeqNum);
+            } else {
+                for (ReplicaId x : repsInfo->idsOfPeerReplicas()) {
+                    if (compactPP != nullptr) {
+                        send(compactPP, x);
+                        // NB: retransmissions (if enabled) send the full PrePrepareMsg
+                        if (retransmissionsLogicEnabled) retransmissionsManager->onSend(x, primaryLastUsedSeqNum, MsgCode::PrePrepare);
+                    } else {
+                        sendRetransmittableMsgToReplica(pp, x, primaryLastUsedSeqNum);
+                    }
+                }
             }
 
+            delete compactPP;
+
             SeqNumInfo& seqNumInfo = mainLog->get(primaryLastUsedSeqNum);
             seqNumInfo.addSelfMsg(pp);
 
@@ -434,7 +517,7 @@ namespace bftEngine {
                     (msgSeqNum > strictLowerBoundOfSeqNums) &&
                     (mainLog->insideActiveWindow(msgSeqNum))) {
                 Assert(msgSeqNum > lastStableSeqNum);
-                Assert(msgSeqNum <= lastStableSeqNum + kWorkWindowSize);
+                Assert(msgSeqNum <= lastStableSeqNum + workWindowSize);
 
                 return true;
             } else {
@@ -442,7 +525,7 @@ namespace bftEngine {
                 if (myReplicaMayBeBehind) {
                     onReportAboutAdvancedReplica(msg->senderId(), msgSeqNum, msgViewNum);
                 } else {
-                    const bool msgReplicaMayBeBehind = (curView > msgViewNum) || (msgSeqNum + kWorkWindowSize < mainLog->currentActiveWindow().first);
+                    const bool msgReplicaMayBeBehind = (curView > msgViewNum) || (msgSeqNum + workWindowSize < mainLog->currentActiveWindow().first);
 
                     if (msgReplicaMayBeBehind) onReportAboutLateReplica(msg->senderId(), msgSeqNum, msgViewNum);
                 }
@@ -473,14 +556,36 @@ namespace bftEngine {
 
             bool msgAdded = false;
 
-            if (relevantMsgForActiveView(msg) && (msg->senderId() == currentPrimary())) {
-                sendAckIfNeeded(msg, msg->senderId(), msgSeqNum);
+            // when prePrepareFanout > 0, the message may also be received from a relay
+            const bool fromPrimary = (msg->senderId() == currentPrimary());
+
+            if (relevantMsgForActiveView(msg) && (fromPrimary || prePrepareFanout > 0)) {
+                if (fromPrimary) sendAckIfNeeded(msg, msg->senderId(), msgSeqNum);
 
                 SeqNumInfo& seqNumInfo = mainLog->get(msgSeqNum);
+                const PrePrepareDigestMsg* digestMsg = seqNumInfo.getPrePrepareDigestMsg();
 
-                if (seqNumInfo.addMsg(msg)) {
+                if (!fromPrimary && digestMsg == nullptr && seqNumInfo.getPrePrepareMsg() == nullptr) {
+                    // wait for the digest from the primary (see onMessage(PrePrepareDigestMsg*))
+                    seqNumInfo.holdRelayedPrePrepareMsg(msg);
+                    return;
+                }
+
+                if (!fromPrimary && digestMsg != nullptr && !digestMsg->matches(msg)) {
+                    LOG_WARN_F(GL, "Node %d received PrePrepareMsg from node %d that does not match the digest of the primary (seqNumber %" PRId64 ")",
+                            (int) myReplicaId, (int) msg->senderId(), msgSeqNum);
+                    onReportAboutInvalidMessage(msg);
+                } else if (clientsSignRequests && seqNumInfo.getPrePrepareMsg() == nullptr && !validClientSignatures(msg)) {
+                    LOG_WARN_F(GL, "Node %d received PrePrepareMsg from node %d with an invalid signature of a client (seqNumber %" PRId64 ")",
+                            (int) myReplicaId, (int) msg->senderId(), msgSeqNum);
+                    onReportAboutInvalidMessage(msg);
+                } else if (seqNumInfo.addMsg(msg)) {
                     msgAdded = true;
 
+                    traceRequestsOf(msg, PrePrepareReceived);
+
+                    if (prePrepareFanout > 0) relayPrePrepareMsg(msg);
+
                     if (msg->firstPath() != CommitPath::SLOW && !seqNumInfo.slowPathStarted()) // TODO(GG): make sure we correctly handle a situation where StartSlowCommitMsg is handled before PrePrepareMsg
                     {
                         sendPartialProof(seqNumInfo);
@@ -496,20 +601,100 @@ namespace bftEngine {
             if (!msgAdded) delete msg;
         }
 
+        void ReplicaImp::onMessage(CompactPrePrepareMsg* msg) {
+            metric_received_compact_pre_prepares_.Get().Inc();
+            const SeqNum msgSeqNum = msg->seqNumber();
+
+            LOG_INFO_F(GL, "Node %d received CompactPrePrepareMsg from node %d for seqNumber %" PRId64 " (requests=%d)",
+                    (int) myReplicaId, (int) msg->senderId(), msgSeqNum, (int) msg->numberOfRequests());
+
+            if (!clientsMulticastRequests) {
+                onReportAboutInvalidMessage(msg);
+                delete msg;
+                return;
+            }
+
+            uint16_t numOfMissingRequests = 0;
+            PrePrepareMsg* pp = msg->createPrePrepareMsg(*requestsCache, numOfMissingRequests);
+
+            if (pp != nullptr) {
+                delete msg;
+                onMessage(pp);
+                return;
+            }
+
+            if (numOfMissingRequests == 0) { // the requests do not match the digest
+                onReportAboutInvalidMessage(msg);
+                delete msg;
+                return;
+            }
+
+            // ask the primary for the full PrePrepareMsg
+            if (relevantMsgForActiveView(msg) && (msg->senderId() == currentPrimary())) {
+                SeqNumInfo& seqNumInfo = mainLog->get(msgSeqNum);
+
+                if (seqNumInfo.getPrePrepareMsg() == nullptr) {
+                    LOG_INFO_F(GL, "Node %d misses %d requests of seqNumber %" PRId64 " - asks the primary for the full PrePrepareMsg",
+                            (int) myReplicaId, (int) numOfMissingRequests, msgSeqNum);
+
+                    ReqMissingDataMsg reqData(myReplicaId, curView, msgSeqNum);
+                    reqData.setPrePrepareIsMissing();
+                    send(&reqData, currentPrimary());
+
+                    seqNumInfo.setTimeOfLastInfoRequest(getMonotonicTime());
+                }
+            }
+
+            delete msg;
+        }
+
+        void ReplicaImp::onMessage(PrePrepareDigestMsg* msg) {
+            metric_received_pre_prepare_digests_.Get().Inc();
+            const SeqNum msgSeqNum = msg->seqNumber();
+
+            LOG_INFO_F(GL, "Node %d received PrePrepareDigestMsg from node %d for seqNumber %" PRId64 "",
+                    (int) myReplicaId, (int) msg->senderId(), msgSeqNum);
+
+            if (prePrepareFanout == 0) {
+                onReportAboutInvalidMessage(msg);
+                delete msg;
+                return;
+            }
+
+            if (relevantMsgForActiveView(msg)) {
+                SeqNumInfo& seqNumInfo = mainLog->get(msgSeqNum);
+
+                if (seqNumInfo.addMsg(msg)) {
+                    PrePrepareMsg* relayedPP = seqNumInfo.takeRelayedPrePrepareMsg();
+                    if (relayedPP != nullptr) onMessage(relayedPP);
+                    return;
+                }
+            }
+
+            delete msg;
+        }
+
+        void ReplicaImp::relayPrePrepareMsg(PrePrepareMsg* pp) {
+            std::vector<ReplicaId> children;
+            repsInfo->getChildrenInPrePrepareTree(myReplicaId, curView, pp->seqNumber(), prePrepareFanout, children);
+
+            for (ReplicaId x : children) send(pp, x);
+        }
+
         void ReplicaImp::tryToStartSlowPaths() {
             if (!isCurrentPrimary() || stateTransfer->isCollectingState() || !currentViewIsActive())
                 return; // TODO(GG): consider to stop the related timer when this method is not needed (to avoid useless invocations)
 
             const SeqNum minSeqNum = lastExecutedSeqNum + 1;
 
-            if (minSeqNum > lastStableSeqNum + kWorkWindowSize) {
-                LOG_INFO_F(GL, "Replica::tryToStartSlowPaths() : minSeqNum > lastStableSeqNum + kWorkWindowSize");
+            if (minSeqNum > lastStableSeqNum + workWindowSize) {
+                LOG_INFO_F(GL, "Replica::tryToStartSlowPaths() : minSeqNum > lastStableSeqNum + workWindowSize");
                 return;
             }
 
             const SeqNum maxSeqNum = primaryLastUsedSeqNum;
 
-            Assert(maxSeqNum <= lastStableSeqNum + kWorkWindowSize);
+            Assert(maxSeqNum <= lastStableSeqNum + workWindowSize);
             Assert(minSeqNum <= maxSeqNum + 1);
 
             if (minSeqNum > maxSeqNum)
@@ -522,17 +707,20 @@ namespace bftEngine {
             for (SeqNum i = minSeqNum; i <= maxSeqNum; i++) {
                 SeqNumInfo& seqNumInfo = mainLog->get(i);
 
-                if (seqNumInfo.partialProofs().hasFullProof() || // already has a full proof
+                if ((!seqNumInfo.hasPrePrepareMsg()) || // (checked first: the collectors of the SeqNum may not be allocated)
                         seqNumInfo.slowPathStarted() || // slow path has already  started 
-                        seqNumInfo.partialProofs().getSelfPartialCommitProof() == nullptr || // did not start a fast path
-                        (!seqNumInfo.hasPrePrepareMsg())
+                        seqNumInfo.partialProofs().hasFullProof() || // already has a full proof
+                        seqNumInfo.partialProofs().getSelfPartialCommitProof() == nullptr // did not start a fast path
                         )
                     continue; // slow path is not needed 
 
                 const Time timeOfPartProof = seqNumInfo.partialProofs().getTimeOfSelfPartialProof();
 
-                if (absDifference(currTime, timeOfPartProof) < controller->timeToStartSlowPathMilli() * 1000)
+                if (absDifference(currTime, timeOfPartProof) < controller->timeToStartSlowPathMilli(i) * 1000) {
+                    if (latencyBasedController)
+                        continue; // the time to start the slow path depends on the seq number (a later one may be late)
                     break; // don't try the next seq numbers
+                }
 
                 LOG_INFO_F(GL, "Primary initiates slow path for seqNum=%" PRId64 " (currTime=%lld timeOfPartProof=%lld", i, currTime, timeOfPartProof);
 
@@ -558,7 +746,7 @@ namespace bftEngine {
         void ReplicaImp::tryToAskForMissingInfo() {
             if (!currentViewIsActive() || stateTransfer->isCollectingState()) return;
 
-            Assert(maxSeqNumTransferredFromPrevViews <= lastStableSeqNum + kWorkWindowSize);
+            Assert(maxSeqNumTransferredFromPrevViews <= lastStableSeqNum + workWindowSize);
 
             const bool recentViewChange = (maxSeqNumTransferredFromPrevViews > lastStableSeqNum);
 
@@ -568,19 +756,19 @@ namespace bftEngine {
             if (!recentViewChange) {
                 const int16_t searchWindow = 4; // TODO(GG): TBD - read from configuration
                 minSeqNum = lastExecutedSeqNum + 1;
-                maxSeqNum = std::min(minSeqNum + searchWindow - 1, lastStableSeqNum + kWorkWindowSize);
+                maxSeqNum = std::min(minSeqNum + searchWindow - 1, lastStableSeqNum + workWindowSize);
             } else {
                 const int16_t searchWindow = 32; // TODO(GG): TBD - read from configuration
                 minSeqNum = lastStableSeqNum + 1;
-                while (minSeqNum <= lastStableSeqNum + kWorkWindowSize) {
+                while (minSeqNum <= lastStableSeqNum + workWindowSize) {
                     SeqNumInfo& seqNumInfo = mainLog->get(minSeqNum);
                     if (!seqNumInfo.isCommitted__gg()) break;
                     minSeqNum++;
                 }
-                maxSeqNum = std::min(minSeqNum + searchWindow - 1, lastStableSeqNum + kWorkWindowSize);
+                maxSeqNum = std::min(minSeqNum + searchWindow - 1, lastStableSeqNum + workWindowSize);
             }
 
-            if (minSeqNum > lastStableSeqNum + kWorkWindowSize) return;
+            if (minSeqNum > lastStableSeqNum + workWindowSize) return;
 
             const Time curTime = getMonotonicTime();
 
@@ -670,12 +858,13 @@ namespace bftEngine {
 
                     part = new PartialCommitProofMsg(myReplicaId, curView, seqNum, commitPath, tmpDigest, commitSigner);
                     partialProofs.addSelfMsgAndPPDigest(part, tmpDigest);
+                    traceRequestsOf(pp, PartialCommitProofSent);
                 }
 
                 partialProofs.setTimeOfSelfPartialProof(getMonotonicTime());
 
-                // send PartialCommitProofMsg (only if, from my point of view, at most MaxConcurrentFastPaths are in progress)
-                if (seqNum <= lastExecutedSeqNum + MaxConcurrentFastPaths) {
+                // send PartialCommitProofMsg (only if, from my point of view, at most maxConcurrentFastPaths are in progress)
+                if (seqNum <= lastExecutedSeqNum + maxConcurrentFastPaths) {
                     // TODO(GG): improve the following code (use iterators instead of a simple array)
                     int8_t numOfRouters = 0;
                     ReplicaId routersArray[2];
@@ -695,6 +884,7 @@ namespace bftEngine {
                 commitAndSendFullCommitProof(seqNum, seqNumInfo, partialProofs);
             }
 
+            tryToExecuteSpeculatively();
         }
 
         void ReplicaImp::sendPreparePartial(SeqNumInfo& seqNumInfo) {
@@ -711,6 +901,8 @@ namespace bftEngine {
                 seqNumInfo.addSelfMsg(p);
 
                 if (!isCurrentPrimary()) sendRetransmittableMsgToReplica(p, currentPrimary(), pp->seqNumber());
+
+                traceRequestsOf(pp, PreparePartialSent);
             }
         }
 
@@ -754,6 +946,8 @@ namespace bftEngine {
             if (relevantMsgForActiveView(msg)) {
                 sendAckIfNeeded(msg, msgSender, msgSeqNum);
 
+                if (isCurrentPrimary()) controller->onMessage(msg);
+
                 if (msgSeqNum > lastExecutedSeqNum) {
                     SeqNumInfo& seqNumInfo = mainLog->get(msgSeqNum);
                     PartialProofsSet& pps = seqNumInfo.partialProofs();
@@ -1090,6 +1284,8 @@ namespace bftEngine {
 
             Assert(seqNumInfo.isCommitted__gg());
 
+            traceRequestsOf(seqNumInfo.getPrePrepareMsg(), Committed);
+
             bool askForMissingInfoAboutCommittedItems = (seqNumber > lastExecutedSeqNum + maxConcurrentAgreementsByPrimary);
 
             executeReadWriteRequests(askForMissingInfoAboutCommittedItems);
@@ -1116,6 +1312,8 @@ namespace bftEngine {
 
             Assert(seqNumInfo.isCommitted__gg());
 
+            traceRequestsOf(seqNumInfo.getPrePrepareMsg(), Committed);
+
             bool askForMissingInfoAboutCommittedItems = (seqNumber > lastExecutedSeqNum + maxConcurrentAgreementsByPrimary);
 
             executeReadWriteRequests(askForMissingInfoAboutCommittedItems);
@@ -1131,7 +1329,7 @@ namespace bftEngine {
             LOG_INFO_F(GL, "Node %d received Checkpoint message from node %d for seqNumber %" PRId64 " (size=%d, stable=%s, digestPrefix=%d)",
                     (int) myReplicaId, (int) msgSenderId, msgSeqNum, (int) msg->size(), (int) msgIsStable ? "true" : "false", *((int*) (&msgDigest)));
 
-            if ((msgSeqNum > lastStableSeqNum) && (msgSeqNum <= lastStableSeqNum + kWorkWindowSize)) {
+            if ((msgSeqNum > lastStableSeqNum) && (msgSeqNum <= lastStableSeqNum + workWindowSize)) {
                 Assert(mainLog->insideActiveWindow(msgSeqNum));
                 CheckpointInfo& checkInfo = checkpointsLog->get(msgSeqNum);
                 bool msgAdded = checkInfo.addCheckpointMsg(msg, msg->senderId());
@@ -1170,7 +1368,7 @@ namespace bftEngine {
                                 tableItrator = tableOfStableCheckpoints.erase(tableItrator);
                             } else {
                                 numRelevant++;
-                                if (tableItrator->second->seqNumber() > lastStableSeqNum + kWorkWindowSize)
+                                if (tableItrator->second->seqNumber() > lastStableSeqNum + workWindowSize)
                                     numRelevantAboveWindow++;
                                 tableItrator++;
                             }
@@ -1193,10 +1391,11 @@ namespace bftEngine {
 
             if (askForStateTransfer) {
                 LOG_INFO_F(GL, "call to startCollectingState()");
+                rollbackSpeculativeExecutions();
                 stateTransfer->startCollectingState();
-            } else if (msgSeqNum > lastStableSeqNum + kWorkWindowSize) {
+            } else if (msgSeqNum > lastStableSeqNum + workWindowSize) {
                 onReportAboutAdvancedReplica(msgSenderId, msgSeqNum);
-            } else if (msgSeqNum + kWorkWindowSize < lastStableSeqNum) {
+            } else if (msgSeqNum + workWindowSize < lastStableSeqNum) {
                 onReportAboutLateReplica(msgSenderId, msgSeqNum);
             }
         }
@@ -1261,13 +1460,13 @@ namespace bftEngine {
             Assert(retransmissionsLogicEnabled);
 
             if (stateTransfer->isCollectingState() || (relatedViewNumber != curView) || (!currentViewIsActive())) return;
-            if (relatedLastStableSeqNum + kWorkWindowSize <= lastStableSeqNum) return;
+            if (relatedLastStableSeqNum + workWindowSize <= lastStableSeqNum) return;
 
             const uint16_t myId = myReplicaId;
             const uint16_t primaryId = currentPrimary();
 
             for (const RetSuggestion& s : *suggestedRetransmissions) {
-                if ((s.msgSeqNum <= lastStableSeqNum) || (s.msgSeqNum > lastStableSeqNum + kWorkWindowSize)) continue;
+                if ((s.msgSeqNum <= lastStableSeqNum) || (s.msgSeqNum > lastStableSeqNum + workWindowSize)) continue;
 
                 Assert(s.replicaId != myId);
 
@@ -1363,7 +1562,7 @@ namespace bftEngine {
             // Checkpoints
             /////////////////////////////////////////////////////////////////////////
 
-            if (lastStableSeqNum > msgLastStable + kWorkWindowSize) {
+            if (lastStableSeqNum > msgLastStable + workWindowSize) {
                 CheckpointMsg* checkMsg = checkpointsLog->get(lastStableSeqNum).selfCheckpointMsg();
 
                 if (checkMsg == nullptr || !checkMsg->isStableState()) {
@@ -1374,17 +1573,17 @@ namespace bftEngine {
 
                 delete msg;
                 return;
-            } else if (msgLastStable > lastStableSeqNum + kWorkWindowSize) {
+            } else if (msgLastStable > lastStableSeqNum + workWindowSize) {
                 tryToSendStatusReport(); // ask for help
             } else {
                 // Send checkpoints that may be useful for msgSenderId
                 const SeqNum beginRange = std::max(checkpointsLog->currentActiveWindow().first, msgLastStable + checkpointWindowSize);
-                const SeqNum endRange = std::min(checkpointsLog->currentActiveWindow().second, msgLastStable + kWorkWindowSize);
+                const SeqNum endRange = std::min(checkpointsLog->currentActiveWindow().second, msgLastStable + workWindowSize);
 
                 Assert(beginRange % checkpointWindowSize == 0);
 
                 if (beginRange <= endRange) {
-                    Assert(endRange - beginRange <= kWorkWindowSize);
+                    Assert(endRange - beginRange <= workWindowSize);
 
                     for (SeqNum i = beginRange; i <= endRange; i = i + checkpointWindowSize) {
                         CheckpointMsg* checkMsg = checkpointsLog->get(i).selfCheckpointMsg();
@@ -1439,7 +1638,7 @@ namespace bftEngine {
 
                     if (viewsManager->viewIsActive(curView)) {
                         if (msg->hasListOfMissingPrePrepareMsgForViewChange()) {
-                            for (SeqNum i = msgLastStable + 1; i <= msgLastStable + kWorkWindowSize; i++) {
+                            for (SeqNum i = msgLastStable + 1; i <= msgLastStable + workWindowSize; i++) {
                                 if (mainLog->insideActiveWindow(i) && msg->isMissingPrePrepareMsgForViewChange(i)) {
                                     PrePrepareMsg* prePrepareMsg = mainLog->get(i).getPrePrepareMsg();
                                     if (prePrepareMsg != nullptr) send(prePrepareMsg, msgSenderId);
@@ -1449,7 +1648,7 @@ namespace bftEngine {
                     } else // if I am also not in curView --- In this case we take messages from viewsManager 
                     {
                         if (msg->hasListOfMissingPrePrepareMsgForViewChange()) {
-                            for (SeqNum i = msgLastStable + 1; i <= msgLastStable + kWorkWindowSize; i++) {
+                            for (SeqNum i = msgLastStable + 1; i <= msgLastStable + workWindowSize; i++) {
                                 if (msg->isMissingPrePrepareMsgForViewChange(i)) {
                                     PrePrepareMsg* prePrepareMsg = viewsManager->getPrePrepare(i); // TODO(GG): we can avoid sending misleading message by using the digest of the expected pre prepare message
                                     if (prePrepareMsg != nullptr) send(prePrepareMsg, msgSenderId);
@@ -1466,7 +1665,7 @@ namespace bftEngine {
                 if (isCurrentPrimary()) {
                     if (viewsManager->viewIsActive(curView)) {
                         SeqNum beginRange = std::max(lastStableSeqNum + 1, msg->getLastExecutedSeqNum() + 1); // Notice that after a view change, we don't have to pass the PrePrepare messages from the previous view. TODO(GG): verify
-                        SeqNum endRange = std::min(lastStableSeqNum + kWorkWindowSize, msgLastStable + kWorkWindowSize);
+                        SeqNum endRange = std::min(lastStableSeqNum + workWindowSize, msgLastStable + workWindowSize);
 
                         for (SeqNum i = beginRange; i <= endRange; i++) {
                             if (msg->isPrePrepareInActiveWindow(i)) continue;
@@ -1516,12 +1715,12 @@ namespace bftEngine {
             const bool listOfMissingVCMsg = !viewIsActive && !viewsManager->viewIsPending(curView);
             const bool listOfMissingPPMsg = !viewIsActive && viewsManager->viewIsPending(curView);
 
-            ReplicaStatusMsg msg(myReplicaId, curView, lastStableSeqNum, lastExecutedSeqNum,
+            ReplicaStatusMsg msg(myReplicaId, checkpointWindowSize, curView, lastStableSeqNum, lastExecutedSeqNum,
                     viewIsActive, hasNewChangeMsg, listOfPPInActiveWindow, listOfMissingVCMsg, listOfMissingPPMsg);
 
             if (listOfPPInActiveWindow) {
                 const SeqNum start = lastStableSeqNum + 1;
-                const SeqNum end = lastStableSeqNum + kWorkWindowSize;
+                const SeqNum end = lastStableSeqNum + workWindowSize;
 
                 for (SeqNum i = start; i <= end; i++) {
                     if (mainLog->get(i).hasPrePrepareMsg())
@@ -1538,7 +1737,7 @@ namespace bftEngine {
                 std::vector<SeqNum> missPP;
                 if (viewsManager->getNumbersOfMissingPP(lastStableSeqNum, &missPP)) {
                     for (SeqNum i : missPP) {
-                        Assert((i > lastStableSeqNum) && (i <= lastStableSeqNum + kWorkWindowSize));
+                        Assert((i > lastStableSeqNum) && (i <= lastStableSeqNum + workWindowSize));
                         msg.setMissingPrePrepareMsgForViewChange(i);
                     }
                 }
@@ -1631,6 +1830,8 @@ namespace bftEngine {
 
             Assert(curView < nextView);
 
+            rollbackSpeculativeExecutions();
+
             const bool wasInPrevViewNumber = viewsManager->viewIsActive(curView);
 
             LOG_INFO_F(GL, "**************** In MoveToHigherView (curView=%" PRId64 ", nextView=%" PRId64 ", wasInPrevViewNumber=%d)",
@@ -1645,7 +1846,7 @@ namespace bftEngine {
             } else {
 
                 std::vector<ViewsManager::PrevViewInfo> prevViewInfo;
-                for (SeqNum i = lastStableSeqNum + 1; i <= lastStableSeqNum + kWorkWindowSize; i++) {
+                for (SeqNum i = lastStableSeqNum + 1; i <= lastStableSeqNum + workWindowSize; i++) {
                     SeqNumInfo& seqNumInfo = mainLog->get(i);
 
                     if (seqNumInfo.getPrePrepareMsg() != nullptr) {
@@ -1772,8 +1973,9 @@ namespace bftEngine {
             // clear requestsQueueOfPrimary
             while (!requestsQueueOfPrimary.empty()) {
                 delete requestsQueueOfPrimary.front();
-                requestsQueueOfPrimary.pop();
+                requestsQueueOfPrimary.pop_front();
             }
+            verifiedRequestsInQueueOfPrimary = 0;
 
             LOG_INFO_F(GL, "**************** Start working in view %" PRId64 "", curView);
 
@@ -1813,7 +2015,7 @@ namespace bftEngine {
             //LOG_INFO_F(GL, "Debug - sendCheckpointIfNeeded - 3");
 
 
-            const SeqNum refSeqNumberForCheckpoint = lastCheckpointNumber + MaxConcurrentFastPaths;
+            const SeqNum refSeqNumberForCheckpoint = lastCheckpointNumber + maxConcurrentFastPaths;
 
             if (lastExecutedSeqNum < refSeqNumberForCheckpoint) return;
 
@@ -1861,13 +2063,14 @@ namespace bftEngine {
             if (newStateCheckpoint > lastExecutedSeqNum) {
                 //				const SeqNum prevLastExecutedSeqNum = lastExecutedSeqNum;
 
+                rollbackSpeculativeExecutions();
                 lastExecutedSeqNum = newStateCheckpoint;
                 metric_last_executed_seq_num_.Get().Set(lastExecutedSeqNum);
 
                 clientsManager->loadInfoFromReservedPages();
 
-                if (newStateCheckpoint > lastStableSeqNum + kWorkWindowSize) {
-                    const SeqNum refPoint = newStateCheckpoint - kWorkWindowSize;
+                if (newStateCheckpoint > lastStableSeqNum + workWindowSize) {
+                    const SeqNum refPoint = newStateCheckpoint - workWindowSize;
                     const bool withRefCheckpoint = (checkpointsLog->insideActiveWindow(refPoint) && (checkpointsLog->get(refPoint).selfCheckpointMsg() != nullptr));
 
                     if (withRefCheckpoint)
@@ -1921,6 +2124,7 @@ namespace bftEngine {
 
             if (askAnotherStateTransfer) {
                 LOG_INFO_F(GL, "call to startCollectingState()");
+                rollbackSpeculativeExecutions();
                 stateTransfer->startCollectingState();
             }
         }
@@ -1963,6 +2167,7 @@ namespace bftEngine {
                 strictLowerBoundOfSeqNums = lastStableSeqNum;
 
             if (lastStableSeqNum > lastExecutedSeqNum) {
+                rollbackSpeculativeExecutions();
                 lastExecutedSeqNum = lastStableSeqNum;
                 metric_last_executed_seq_num_.Get().Set(lastExecutedSeqNum);
 
@@ -2280,6 +2485,8 @@ namespace bftEngine {
         void ReplicaImp::commitFullCommitProof(SeqNum seqNum, SeqNumInfo& seqNumInfo) {
             seqNumInfo.forceComplete();
 
+            traceRequestsOf(seqNumInfo.getPrePrepareMsg(), Committed);
+
             const bool askForMissingInfoAboutCommittedItems = (seqNum > lastExecutedSeqNum + maxConcurrentAgreementsByPrimary); // TODO(GG): check this logic
 
             executeReadWriteRequests(askForMissingInfoAboutCommittedItems);
@@ -2404,10 +2611,21 @@ namespace bftEngine {
         numOfClientProxies{ config.numOfClientProxies},
         viewChangeProtocolEnabled{((!forceViewChangeProtocolEnabled && !forceViewChangeProtocolDisabled) ? config.autoViewChangeEnabled : forceViewChangeProtocolEnabled)},
         supportDirectProofs{ false},
+        clientsMulticastRequests{ config.clientsMulticastRequests},
+        clientsSignRequests{ !config.publicKeysOfClients.empty()},
+        maxBatchSize{ (config.maxBatchSize > 0) ? config.maxBatchSize : maxNumOfRequestsInBatch},
+        prePrepareFanout{ (!config.clientsMulticastRequests && config.prePrepareFanout < numOfReplicas - 1) ? config.prePrepareFanout : (uint16_t) 0},
+        speculativeExecution{ config.speculativeExecution},
+        checkpointWindowSize{ config.checkpointWindowSize},
+        workWindowSize{ (uint16_t) (2 * config.checkpointWindowSize)},
+        maxConcurrentFastPaths{ config.maxConcurrentFastPaths},
+        latencyBasedController{ config.latencyBasedController},
+        maxReplySize{ (config.maxReplySize > 0 && config.maxReplySize < maxReplyMessageSize - sizeof (ClientReplyMsgHeader)) ? config.maxReplySize : (uint32_t) (maxReplyMessageSize - sizeof (ClientReplyMsgHeader))},
         metaMsgHandlers{ createMapOfMetaMsgHandlers()},
         incomingMsgsStorage{ 20000}, // TODO(GG): use configuration
         msgReceiver{ nullptr},
-        communication{ communication}
+        communication{ communication},
+        msgsCoalescer{ nullptr}
 
         ,
         mainThread(),
@@ -2429,9 +2647,10 @@ namespace bftEngine {
         strictLowerBoundOfSeqNums{ 0},
         maxSeqNumTransferredFromPrevViews{ 0},
         mainLog{ nullptr},
+        seqNumInfoCollectorsPool{ nullptr},
         checkpointsLog{ nullptr},
         clientsManager{ nullptr},
-        replyBuffer{ (char*) std::malloc(maxReplyMessageSize - sizeof (ClientReplyMsgHeader))},
+        replyBuffer{ (char*) std::malloc(maxReplySize)},
         stateTransfer{ (stateTransferr != nullptr ? stateTransferr : new NullStateTransfer())},
         maxNumberOfPendingRequestsInRecentHistory{ 0},
         batchingFactor{ 1},
@@ -2485,6 +2704,10 @@ namespace bftEngine {
             metrics_.RegisterCounter("receivedClientRequestMsgs")},
         metric_received_pre_prepares_{
             metrics_.RegisterCounter("receivedPrePrepareMsgs")},
+        metric_received_compact_pre_prepares_{
+            metrics_.RegisterCounter("receivedCompactPrePrepareMsgs")},
+        metric_received_pre_prepare_digests_{
+            metrics_.RegisterCounter("receivedPrePrepareDigestMsgs")},
         metric_received_start_slow_commits_{
             metrics_.RegisterCounter("receivedStartSlowCommitMsgs")},
         metric_received_partial_commit_proofs_{
@@ -2534,24 +2757,43 @@ namespace bftEngine {
                 replicasSigPublicKeys.insert(keyDesc);
             }
 
-            sigManager = new SigManager(myReplicaId, numOfReplicas + numOfClientProxies, config.replicaPrivateKey, replicasSigPublicKeys);
+            std::set<SigManager::PublicKeyDesc> clientsSigPublicKeys;
+
+            for (auto e : config.publicKeysOfClients) {
+                SigManager::PublicKeyDesc keyDesc = {e.first, e.second};
+                clientsSigPublicKeys.insert(keyDesc);
+            }
+
+            sigManager = new SigManager(myReplicaId, numOfReplicas + numOfClientProxies, config.replicaPrivateKey, replicasSigPublicKeys,
+                    config.replicaSignatureScheme, clientsSigPublicKeys);
 
             msgReceiver = new MsgReceiver(incomingMsgsStorage);
 
             communication->setReceiver(myReplicaId, msgReceiver);
+
+            if (config.coalesceMessages) {
+                uint32_t maxSizeOfBatch = maxSizeOfMsgsBatch;
+                const int maxMsgSize = communication->getMaxMessageSize();
+                if (maxMsgSize > 0 && (uint32_t) maxMsgSize < maxSizeOfBatch) maxSizeOfBatch = (uint32_t) maxMsgSize;
+                msgsCoalescer = new MsgsCoalescer(communication, numOfReplicas, maxSizeOfBatch);
+            }
             int comStatus = communication->Start();
             Assert(comStatus == 0);
 
             std::set<NodeIdType> clientsSet;
             for (uint16_t i = numOfReplicas; i < numOfReplicas + numOfClientProxies; i++) clientsSet.insert(i);
 
-            clientsManager = new ClientsManager(myReplicaId, clientsSet, sizeOfReservedPage);
+            clientsManager = new ClientsManager(myReplicaId, clientsSet, sizeOfReservedPage, maxReplySize);
 
-            stateTransfer->init(kWorkWindowSize / checkpointWindowSize + 1, clientsManager->numberOfRequiredReservedPages(), sizeOfReservedPage);
+            stateTransfer->init(workWindowSize / checkpointWindowSize + 1, clientsManager->numberOfRequiredReservedPages(), sizeOfReservedPage);
             clientsManager->init(stateTransfer);
 
             clientsManager->clearReservedPages();
 
+            if (clientsMulticastRequests) requestsCache = new RequestsCache(maxNumOfRequestsInCache);
+
+            if (speculativeExecution) speculativeExecutions = new SpeculativeExecutions(userRequestsHandler);
+
             int statusReportTimerMilli = (sendStatusPeriodMilli > 0) ? sendStatusPeriodMilli : config.statusReportTimerMillisec;
             ;
             Assert(statusReportTimerMilli > 0);
@@ -2561,24 +2803,44 @@ namespace bftEngine {
 
             int concurrencyLevel = config.concurrencyLevel;
             Assert(concurrencyLevel > 0);
-            Assert(concurrencyLevel < MaxConcurrentFastPaths);
+            Assert(concurrencyLevel < maxConcurrentFastPaths);
 
             fprintf(stderr, "\nConcurrency Level: %d\n", concurrencyLevel); // TODO(GG): all configuration should be displayed
 
-            Assert(concurrencyLevel <= maxLegalConcurrentAgreementsByPrimary);
+            // the work window should hold the fast paths in progress after the last stable SeqNum (workWindowSize > maxConcurrentFastPaths + checkpointWindowSize)
+            Assert(checkpointWindowSize >= minCheckpointWindowSize && checkpointWindowSize <= maxCheckpointWindowSize);
+            Assert(maxConcurrentFastPaths < checkpointWindowSize);
+
+            // a ViewChangeMsg with a prepared certificate for each SeqNum in the work window should fit in maxExternalMessageSize
+            const uint16_t maxWindowForViewChange = ViewChangeMsg::maxNumOfElements(
+                    (uint16_t) thresholdVerifierForSlowPathCommit->requiredLengthForSignedData(), sigManager->getMySigLength()) / 2;
+
+            LOG_INFO_F(GL, "Checkpoint Window Size: %d (at most %d), Max Concurrent Fast Paths: %d",
+                    (int) checkpointWindowSize, (int) maxWindowForViewChange, (int) maxConcurrentFastPaths);
+
+            Assert(checkpointWindowSize <= maxWindowForViewChange);
+
+            Assert(maxBatchSize > 0 && maxBatchSize <= maxNumOfRequestsInBatch);
             maxConcurrentAgreementsByPrimary = (uint16_t) concurrencyLevel;
 
             // TODO(GG): use config ...
             dynamicUpperLimitOfRounds = new DynamicUpperLimitWithSimpleFilter<int64_t>(400, 2, 2500, 70, 32, 1000, 2, 2);
 
-            repsInfo = new ReplicasInfo(myReplicaId, *sigManager, numOfReplicas, fVal, cVal, dynamicCollectorForPartialProofs, dynamicCollectorForExecutionProofs);
+            repsInfo = new ReplicasInfo(myReplicaId, *sigManager, numOfReplicas, fVal, cVal, dynamicCollectorForPartialProofs, dynamicCollectorForExecutionProofs, checkpointWindowSize);
+            peerReplicasNodes.insert(repsInfo->idsOfPeerReplicas().begin(), repsInfo->idsOfPeerReplicas().end());
+
+            // in the normal case, the collectors are used by the SeqNums in (lastStableSeqNum, lastExecutedSeqNum + maxConcurrentFastPaths]
+            seqNumInfoCollectorsPool = new SeqNumInfo::CollectorsPool((InternalReplicaApi*)this, checkpointWindowSize + maxConcurrentFastPaths);
 
-            mainLog = new SequenceWithActiveWindow<kWorkWindowSize, 1, SeqNum, SeqNumInfo, SeqNumInfo>(1, (InternalReplicaApi*)this);
+            mainLog = new SequenceWithActiveWindow<SeqNum, SeqNumInfo, SeqNumInfo>(workWindowSize, 1, 1, seqNumInfoCollectorsPool);
 
-            checkpointsLog = new SequenceWithActiveWindow < kWorkWindowSize + checkpointWindowSize, checkpointWindowSize, SeqNum, CheckpointInfo, CheckpointInfo > (0, (InternalReplicaApi*)this);
+            checkpointsLog = new SequenceWithActiveWindow<SeqNum, CheckpointInfo, CheckpointInfo>(workWindowSize + checkpointWindowSize, checkpointWindowSize, 0, (InternalReplicaApi*)this);
 
             // create controller . TODO(GG): do we want to pass the controller as a parameter ?
-            controller = new ControllerWithSimpleHistory(cVal, fVal, myReplicaId, curView, primaryLastUsedSeqNum);
+            if (latencyBasedController)
+                controller = new LatencyBasedController(cVal, fVal, myReplicaId, curView, primaryLastUsedSeqNum, !dynamicCollectorForPartialProofs);
+            else
+                controller = new ControllerWithSimpleHistory(cVal, fVal, myReplicaId, curView, primaryLastUsedSeqNum);
 
             statusReportTimer = new Timer(timersScheduler, (uint16_t) statusReportTimerMilli, statusTimerHandlerFunc, (InternalReplicaApi*)this);
 
@@ -2610,10 +2872,12 @@ namespace bftEngine {
 
             metricsTimer_ = new Timer(timersScheduler, 100, metricsTimerHandlerFunc, (InternalReplicaApi*)this);
 
-            viewsManager = new ViewsManager(repsInfo, thresholdVerifierForSlowPathCommit);
+            viewsManager = new ViewsManager(repsInfo, thresholdVerifierForSlowPathCommit, &internalThreadPool);
+
+            sigsCombiner = new ThresholdSigsCombiner(internalThreadPool, maxNumOfSigsInCombiningBatch);
 
             if (retransmissionsLogicEnabled)
-                retransmissionsManager = new RetransmissionsManager(this, &internalThreadPool, &incomingMsgsStorage, kWorkWindowSize, 0);
+                retransmissionsManager = new RetransmissionsManager(this, &internalThreadPool, &incomingMsgsStorage, workWindowSize, 0);
             else
                 retransmissionsManager = nullptr;
 
@@ -2625,6 +2889,7 @@ namespace bftEngine {
             // TODO(GG): don't delete objects that are passed as params (TBD)
 
             internalThreadPool.stop();
+            delete sigsCombiner;
             delete thresholdSignerForCommit;
             delete thresholdVerifierForCommit;
             delete thresholdSignerForExecution;
@@ -2640,13 +2905,20 @@ namespace bftEngine {
 
             delete mainLog;
 
+            delete seqNumInfoCollectorsPool; // after mainLog (its items return their collectors to the pool)
+
             delete checkpointsLog;
 
+            delete requestsCache;
+
+            delete speculativeExecutions;
+
 
             DebugStatistics::freeDebugStatisticsData();
             //			freeAllocator();
 
             delete msgReceiver;
+            delete msgsCoalescer;
             delete communication;
         }
 
@@ -2778,11 +3050,93 @@ namespace bftEngine {
 #endif
         }
 
+        void ReplicaImp::traceRequestsOf(const PrePrepareMsg* pp, TraceStage stage) {
+            if (pp == nullptr || !RequestTracer::enabled()) return;
+
+            RequestsIterator reqIter(pp);
+            char* requestBody = nullptr;
+            while (reqIter.getAndGoToNext(requestBody)) {
+                ClientRequestMsg req((ClientRequestMsgHeader*) requestBody);
+                if (req.isTraced()) RequestTracer::record(myReplicaId, req.clientProxyId(), req.requestSeqNum(), stage);
+            }
+        }
+
+        // returns true iff each request of a client with a public key (see ReplicaConfig::publicKeysOfClients) has a
+        // valid signature of its client. The signatures are verified in a single batch.
+        bool ReplicaImp::validClientSignatures(const std::vector<char*>& requests) const {
+            std::vector<ReplicaId> ids;
+            std::vector<const char*> data;
+            std::vector<size_t> dataLengths;
+            std::vector<const char*> sigs;
+            std::vector<size_t> sigLengths;
+
+            for (char* requestBody : requests) {
+                ClientRequestMsg req((ClientRequestMsgHeader*) requestBody);
+                if (!sigManager->hasPublicKeyOf(req.clientProxyId())) continue;
+                if (!req.isSigned()) return false;
+
+                ids.push_back(req.clientProxyId());
+                data.push_back(req.body());
+                dataLengths.push_back(req.signedDataLength());
+                sigs.push_back(req.signature());
+                sigLengths.push_back(ClientRequestMsg::signatureLength);
+            }
+
+            return sigManager->verifySigs(ids.size(), ids.data(), data.data(), dataLengths.data(), sigs.data(), sigLengths.data());
+        }
+
+        bool ReplicaImp::validClientSignatures(const PrePrepareMsg* pp) const {
+            std::vector<char*> requests;
+            RequestsIterator reqIter(pp);
+            char* requestBody = nullptr;
+            while (reqIter.getAndGoToNext(requestBody)) requests.push_back(requestBody);
+
+            return validClientSignatures(requests);
+        }
+
+        // verifies the signatures of the requests that may be added to the next PrePrepare message (at most
+        // maxBatchSize requests at the head of requestsQueueOfPrimary), and removes the invalid requests
+        void ReplicaImp::verifyClientSignaturesInQueueOfPrimary() {
+            const size_t end = std::min(requestsQueueOfPrimary.size(), (size_t) maxBatchSize);
+            if (verifiedRequestsInQueueOfPrimary >= end) return;
+
+            std::vector<char*> requests;
+            for (size_t i = verifiedRequestsInQueueOfPrimary; i < end; i++) requests.push_back(requestsQueueOfPrimary[i]->body());
+
+            if (!validClientSignatures(requests)) {
+                // find the invalid requests
+                auto it = requestsQueueOfPrimary.begin() + verifiedRequestsInQueueOfPrimary;
+                for (char* requestBody : requests) {
+                    if (validClientSignatures({requestBody})) {
+                        it++;
+                    } else {
+                        LOG_WARN_F(GL, "Node %d drops ClientRequestMsg (clientId=%d reqSeqNum=%" PRIu64 ") with an invalid signature",
+                                (int) myReplicaId, (int) (*it)->clientProxyId(), (*it)->requestSeqNum());
+                        delete *it;
+                        it = requestsQueueOfPrimary.erase(it);
+                    }
+                }
+                verifiedRequestsInQueueOfPrimary = it - requestsQueueOfPrimary.begin();
+            } else {
+                verifiedRequestsInQueueOfPrimary = end;
+            }
+        }
+
         void ReplicaImp::executeRequestsInPrePrepareMsg(PrePrepareMsg* ppMsg) {
             Assert(!stateTransfer->isCollectingState() && currentViewIsActive());
             Assert(ppMsg != nullptr);
             Assert(ppMsg->viewNumber() == curView);
 
+            // if ppMsg was executed speculatively, its replies are used (the requests are not executed again)
+            const std::vector<SpeculativeExecutions::Reply>* specReplies = nullptr;
+            size_t nextSpecReply = 0;
+            if (speculativeExecutions != nullptr && !speculativeExecutions->empty()) {
+                specReplies = speculativeExecutions->repliesOf(lastExecutedSeqNum + 1, ppMsg->digestOfRequests());
+                if (specReplies == nullptr)
+                    LOG_INFO_F(GL, "Replica %d rolled back its speculative executions (seqNumber %" PRId64 " was executed speculatively with other requests)",
+                            (int) myReplicaId, lastExecutedSeqNum + 1);
+            }
+
             RequestsIterator reqIter(ppMsg);
             char* requestBody = nullptr;
             while (reqIter.getAndGoToNext(requestBody)) {
@@ -2795,6 +3149,8 @@ namespace bftEngine {
                     continue;
                 }
 
+                if (requestsCache != nullptr) requestsCache->onRequestExecuted(clientId, req.requestSeqNum());
+
                 if (clientsManager->seqNumberOfLastReplyToClient(clientId) >= req.requestSeqNum()) {
                     ClientReplyMsg* replyMsg = clientsManager->allocateMsgWithLatestReply(clientId, currentPrimary());
                     send(replyMsg, clientId);
@@ -2836,15 +3192,27 @@ namespace bftEngine {
                 
                 //Send the sigBuf as replyBuffer. Instead of modifying the clientReplyMsg struct, the outputReply can contain the signature as well as the output
                 actualReplyLength = sigLen*2;
+                Assert(actualReplyLength <= maxReplySize);
                 memcpy(replyBuffer, result, sigLen*2);
                 //Done
                 
-                //Stephen:: the up call implemented by the app
-                int error = userRequestsHandler->execute(
-                        clientId, lastExecutedSeqNum + 1, req.isReadOnly(),
-                        req.requestLength(), req.requestBuf(),
-                        maxReplyMessageSize - sizeof (ClientReplyMsgHeader),
-                        replyBuffer, actualReplyLength);
+                int error = 0;
+                if (specReplies != nullptr) {
+                    // the same requests are skipped by executeSpeculatively
+                    Assert(nextSpecReply < specReplies->size());
+                    const SpeculativeExecutions::Reply& specReply = (*specReplies)[nextSpecReply++];
+                    Assert(specReply.clientId == clientId && specReply.reqSeqNum == req.requestSeqNum());
+
+                    memcpy(replyBuffer, specReply.reply.data(), specReply.reply.size());
+                    actualReplyLength = (uint32_t) specReply.reply.size();
+                } else {
+                    //Stephen:: the up call implemented by the app
+                    error = userRequestsHandler->execute(
+                            clientId, lastExecutedSeqNum + 1, req.isReadOnly(),
+                            req.requestLength(), req.requestBuf(),
+                            maxReplySize,
+                            replyBuffer, actualReplyLength);
+                }
 
                 Assert(error == 0); // TODO(GG): TBD
 
@@ -2860,10 +3228,18 @@ namespace bftEngine {
                 delete replyMsg;
 
                 clientsManager->removePendingRequestOfClient(clientId);
+
+                if (req.isTraced()) RequestTracer::record(myReplicaId, clientId, req.requestSeqNum(), Executed);
+            }
+
+            if (specReplies != nullptr) {
+                Assert(nextSpecReply == specReplies->size());
+                speculativeExecutions->commit(lastExecutedSeqNum + 1); // before the checkpoint of the state is created
             }
 
             if ((lastExecutedSeqNum + 1) % checkpointWindowSize == 0) {
                 const uint64_t checkpointNum = (lastExecutedSeqNum + 1) / checkpointWindowSize;
+                clientsManager->flushRepliesToReservedPages(); // the replies are part of the checkpoint
                 stateTransfer->createCheckpointOfCurrentState(checkpointNum);
             }
 
@@ -2952,7 +3328,7 @@ namespace bftEngine {
 
             LOG_INFO_F(GL, "Calling to executeReadWriteRequests(requestMissingInfo=%d)", (int) requestMissingInfo);
 
-            while (lastExecutedSeqNum < lastStableSeqNum + kWorkWindowSize) {
+            while (lastExecutedSeqNum < lastStableSeqNum + workWindowSize) {
                 SeqNumInfo& seqNumInfo = mainLog->get(lastExecutedSeqNum + 1);
 
                 PrePrepareMsg* prePrepareMsg = seqNumInfo.getPrePrepareMsg();
@@ -2975,6 +3351,124 @@ namespace bftEngine {
 
             if (isCurrentPrimary() && requestsQueueOfPrimary.size() > 0)
                 tryToSendPrePrepareMsg(true);
+
+            tryToExecuteSpeculatively();
+        }
+
+        void ReplicaImp::tryToExecuteSpeculatively() {
+            if (speculativeExecutions == nullptr || stateTransfer->isCollectingState() || !currentViewIsActive())
+                return;
+
+            SeqNum s = lastExecutedSeqNum + (SeqNum) speculativeExecutions->size() + 1;
+            const SeqNum maxSpeculative = std::min(maxSpeculativeSeqNums, maxConcurrentFastPaths);
+
+            // the history digests start at the last checkpoint, so a SeqNum is executed speculatively only if
+            // all the SeqNums before its checkpoint window were committed
+            const SeqNum maxInCheckpointWindow = (lastExecutedSeqNum / checkpointWindowSize + 1) * checkpointWindowSize;
+
+            while (s <= lastExecutedSeqNum + maxSpeculative && s <= lastStableSeqNum + workWindowSize && s <= maxInCheckpointWindow) {
+                SeqNumInfo& seqNumInfo = mainLog->get(s);
+                PrePrepareMsg* pp = seqNumInfo.getPrePrepareMsg();
+
+                // only SeqNums on the fast path are executed speculatively
+                if (pp == nullptr || pp->viewNumber() != curView || pp->firstPath() == CommitPath::SLOW || seqNumInfo.slowPathStarted())
+                    break;
+
+                Digest prevHistoryDigest;
+                if (!historyDigestBefore(s, prevHistoryDigest))
+                    break;
+
+                if (!executeSpeculatively(pp, prevHistoryDigest))
+                    break;
+
+                s++;
+            }
+        }
+
+        bool ReplicaImp::historyDigestBefore(SeqNum seqNum, Digest& outDigest) const {
+            Assert(seqNum == lastExecutedSeqNum + (SeqNum) speculativeExecutions->size() + 1);
+
+            if (!speculativeExecutions->empty()) {
+                outDigest = speculativeExecutions->lastHistoryDigest();
+                return true;
+            }
+
+            // the history of the committed SeqNums since the last checkpoint
+            const SeqNum lastCheckpoint = ((seqNum - 1) / checkpointWindowSize) * checkpointWindowSize;
+            outDigest.makeZero();
+            for (SeqNum s = lastCheckpoint + 1; s < seqNum; s++) {
+                if (!mainLog->insideActiveWindow(s)) return false;
+                PrePrepareMsg* pp = mainLog->get(s).getPrePrepareMsg();
+                if (pp == nullptr) return false;
+
+                Digest d;
+                SpeculativeExecutions::calcHistoryDigest(outDigest, s, pp->digestOfRequests(), d);
+                outDigest = d;
+            }
+            return true;
+        }
+
+        bool ReplicaImp::executeSpeculatively(PrePrepareMsg* ppMsg, const Digest& prevHistoryDigest) {
+            const SeqNum seqNum = ppMsg->seqNumber();
+            Assert(seqNum == lastExecutedSeqNum + (SeqNum) speculativeExecutions->size() + 1);
+
+            Digest historyDigest;
+            SpeculativeExecutions::calcHistoryDigest(prevHistoryDigest, seqNum, ppMsg->digestOfRequests(), historyDigest);
+
+            std::vector<SpeculativeExecutions::Reply> replies;
+
+            RequestsIterator reqIter(ppMsg);
+            char* requestBody = nullptr;
+            while (reqIter.getAndGoToNext(requestBody)) {
+                ClientRequestMsg req((ClientRequestMsgHeader*) requestBody);
+                const NodeIdType clientId = req.clientProxyId();
+
+                // skip the requests that executeRequestsInPrePrepareMsg will skip (the speculative replies are committed by then)
+                if (!clientsManager->isValidClient(clientId)) continue;
+
+                ReqId lastReqSeqNum = std::max(clientsManager->seqNumberOfLastReplyToClient(clientId), speculativeExecutions->lastReqSeqNumOf(clientId));
+                for (const SpeculativeExecutions::Reply& r : replies)
+                    if (r.clientId == clientId && r.reqSeqNum > lastReqSeqNum) lastReqSeqNum = r.reqSeqNum;
+
+                if (lastReqSeqNum >= req.requestSeqNum()) continue;
+
+                uint32_t actualReplyLength = 0;
+                const int error = userRequestsHandler->executeSpeculatively(
+                        clientId, seqNum, req.isReadOnly(),
+                        req.requestLength(), req.requestBuf(),
+                        std::min(maxReplySize, (uint32_t) (maxReplyMessageSize - sizeof (ClientTentativeReplyMsgHeader))),
+                        replyBuffer, actualReplyLength);
+
+                if (error != 0 || actualReplyLength == 0) {
+                    // this SeqNum will be executed when it is committed
+                    userRequestsHandler->rollbackSpeculative(seqNum - 1);
+                    return false;
+                }
+
+                replies.push_back(SpeculativeExecutions::Reply{clientId, req.requestSeqNum(), std::string(replyBuffer, actualReplyLength)});
+            }
+
+            // the tentative replies are sent only after all the requests of seqNum were executed. The client accepts a
+            // tentative reply if 3F+C+1 replicas send it with the same <view, seqNum, history digest>.
+            for (const SpeculativeExecutions::Reply& r : replies) {
+                ClientReplyMsg reply(myReplicaId, r.reqSeqNum, (char*) r.reply.data(), (uint32_t) r.reply.size(), curView, seqNum, historyDigest);
+                reply.setPrimaryId(currentPrimary());
+                send(&reply, r.clientId);
+            }
+
+            LOG_INFO_F(GL, "Replica %d executed seqNumber %" PRId64 " speculatively (%d replies)", (int) myReplicaId, seqNum, (int) replies.size());
+
+            speculativeExecutions->add(seqNum, ppMsg->digestOfRequests(), historyDigest, std::move(replies));
+            return true;
+        }
+
+        void ReplicaImp::rollbackSpeculativeExecutions() {
+            if (speculativeExecutions == nullptr || speculativeExecutions->empty()) return;
+
+            LOG_INFO_F(GL, "Replica %d rolls back the speculative execution of %d seqNumbers (lastExecutedSeqNum=%" PRId64 ")",
+                    (int) myReplicaId, (int) speculativeExecutions->size(), lastExecutedSeqNum);
+
+            speculativeExecutions->rollback(lastExecutedSeqNum);
         }
 
         void ReplicaImp::SetAggregator(
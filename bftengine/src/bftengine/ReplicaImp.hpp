@@ -18,6 +18,7 @@
 #include "Crypto.hpp"
 #include "DebugStatistics.hpp"
 #include "SimpleThreadPool.hpp"
+#include "ThresholdSigsCombiner.hpp"
 #include "ControllerBase.hpp"
 #include "CheckpointMsg.hpp"
 #include "RetransmissionsManager.hpp"
@@ -33,8 +34,14 @@
 #include "Replica.hpp"
 #include "Threading.h"
 #include "Metrics.hpp"
+#include "RequestTracer.hpp"
+#include "MsgsCoalescer.hpp"
+#include "SpeculativeExecutions.hpp"
 
+#include <deque>
+#include <string>
 #include <thread>
+#include <vector>
 
 
 
@@ -57,6 +64,9 @@ namespace bftEngine
 		class SimpleAckMsg;
 		class StateTransferMsg;
 		class ReplicaStatusMsg;
+		class CompactPrePrepareMsg;
+		class PrePrepareDigestMsg;
+		class RequestsCache;
 
 		class ReplicaImp;
 
@@ -74,6 +84,16 @@ namespace bftEngine
 			const uint16_t numOfClientProxies;
 			const bool viewChangeProtocolEnabled;
 			const bool supportDirectProofs; // TODO(GG): add support
+			const bool clientsMulticastRequests;
+			const bool clientsSignRequests; // see ReplicaConfig::publicKeysOfClients
+			const uint32_t maxBatchSize; // max number of requests in a PrePrepare message
+			const uint16_t prePrepareFanout; // 0 if the primary sends the PrePrepare messages directly to all the replicas
+			const bool speculativeExecution; // see ReplicaConfig::speculativeExecution
+			const uint16_t checkpointWindowSize; // see ReplicaConfig::checkpointWindowSize
+			const uint16_t workWindowSize; // 2 * checkpointWindowSize
+			const uint16_t maxConcurrentFastPaths; // see ReplicaConfig::maxConcurrentFastPaths
+			const bool latencyBasedController; // see ReplicaConfig::latencyBasedController
+			const uint32_t maxReplySize; // see ReplicaConfig::maxReplySize
 
 			// pointers to message handlers
 			const std::unordered_map<uint16_t, PtrToMetaMsgHandler> metaMsgHandlers;
@@ -83,6 +103,7 @@ namespace bftEngine
 			IncomingMsgsStorage incomingMsgsStorage;
 			MsgReceiver* msgReceiver;
 			ICommunication* communication;
+			MsgsCoalescer* msgsCoalescer; // nullptr if messages are not coalesced
 
 			// main thread of the this replica
 			std::thread mainThread;
@@ -92,6 +113,9 @@ namespace bftEngine
 			// thread pool of this replica
 			SimpleThreadPool internalThreadPool; // TODO(GG): !!!! rename
 
+			// combines threshold signatures of several sequence numbers (uses internalThreadPool)
+			ThresholdSigsCombiner* sigsCombiner = nullptr;
+
 			// retransmissions manager (can be disabled)
 			RetransmissionsManager* retransmissionsManager = nullptr;
 
@@ -105,6 +129,9 @@ namespace bftEngine
 			// general information about the replicas
 			ReplicasInfo* repsInfo;
 
+			// repsInfo->idsOfPeerReplicas(), as destinations of ICommunication::sendAsyncMessageToMany
+			std::set<NodeNum> peerReplicasNodes;
+
 			// digital signatures
 			SigManager* sigManager;
 
@@ -133,13 +160,22 @@ namespace bftEngine
 			SeqNum maxSeqNumTransferredFromPrevViews;
 
 			// requests queue (used by the primary)
-			std::queue<ClientRequestMsg*> requestsQueueOfPrimary; // only used by the primary
+			std::deque<ClientRequestMsg*> requestsQueueOfPrimary; // only used by the primary
+
+			// number of requests at the head of requestsQueueOfPrimary whose client signatures were verified
+			size_t verifiedRequestsInQueueOfPrimary = 0;
+
+			// requests received directly from clients (only used when clientsMulticastRequests==true)
+			RequestsCache* requestsCache = nullptr;
 
-			// bounded log used to store information about SeqNums in the range (lastStableSeqNum,lastStableSeqNum + kWorkWindowSize]
-			SequenceWithActiveWindow<kWorkWindowSize, 1, SeqNum, SeqNumInfo, SeqNumInfo>* mainLog;
+			// bounded log used to store information about SeqNums in the range (lastStableSeqNum,lastStableSeqNum + workWindowSize]
+			SequenceWithActiveWindow<SeqNum, SeqNumInfo, SeqNumInfo>* mainLog;
 
-			// bounded log used to store information about checkpoints in the range [lastStableSeqNum,lastStableSeqNum + kWorkWindowSize]
-			SequenceWithActiveWindow<kWorkWindowSize + checkpointWindowSize, checkpointWindowSize, SeqNum, CheckpointInfo, CheckpointInfo>* checkpointsLog;
+			// the collectors of signed messages that are not used by the items of mainLog
+			SeqNumInfo::CollectorsPool* seqNumInfoCollectorsPool;
+
+			// bounded log used to store information about checkpoints in the range [lastStableSeqNum,lastStableSeqNum + workWindowSize]
+			SequenceWithActiveWindow<SeqNum, CheckpointInfo, CheckpointInfo>* checkpointsLog;
 
 
 			// last known stable checkpoint of each peer replica. 
@@ -152,6 +188,9 @@ namespace bftEngine
 			// buffer used to store replies
 			char* replyBuffer;
 
+			// results of speculative executions (only used when speculativeExecution==true)
+			SpeculativeExecutions* speculativeExecutions = nullptr;
+
 			// pointer to a state transfer module
 			bftEngine::IStateTransfer* stateTransfer = nullptr;
 
@@ -216,7 +255,8 @@ namespace bftEngine
 				virtual void onConnectionStatusChanged(const NodeNum node, const ConnectionStatus newStatus) override;
 
 			private:
-				
+				void pushExternalMsg(NodeIdType sender, const char* const message, MsgSize messageLength);
+
 				IncomingMsgsStorage& incomingMsgs;
 			};
 
@@ -259,6 +299,8 @@ namespace bftEngine
                         CounterHandle metric_received_internal_msgs_;
                         CounterHandle metric_received_client_requests_;
                         CounterHandle metric_received_pre_prepares_;
+                        CounterHandle metric_received_compact_pre_prepares_;
+                        CounterHandle metric_received_pre_prepare_digests_;
                         CounterHandle metric_received_start_slow_commits_;
                         CounterHandle metric_received_partial_commit_proofs_;
                         CounterHandle metric_received_full_commit_proofs_;
@@ -336,6 +378,8 @@ namespace bftEngine
 
 			void onMessage(ClientRequestMsg*);
 			void onMessage(PrePrepareMsg*);
+			void onMessage(CompactPrePrepareMsg*);
+			void onMessage(PrePrepareDigestMsg*);
 			void onMessage(StartSlowCommitMsg*);
 			void onMessage(PartialCommitProofMsg*);
 			void onMessage(FullCommitProofMsg*);
@@ -358,6 +402,7 @@ namespace bftEngine
 			void sendAckIfNeeded(MessageBase* msg, const NodeIdType sourceNode, const SeqNum seqNum);
 
 			void tryToSendPrePrepareMsg(bool batchingLogic = false);
+			void relayPrePrepareMsg(PrePrepareMsg* pp);
 
 			void sendPartialProof(SeqNumInfo&);
 
@@ -374,6 +419,17 @@ namespace bftEngine
 
 			void executeRequestsInPrePrepareMsg(PrePrepareMsg *pp);
 
+			void tryToExecuteSpeculatively();
+			bool executeSpeculatively(PrePrepareMsg *pp, const Digest& prevHistoryDigest);
+			bool historyDigestBefore(SeqNum seqNum, Digest& outDigest) const;
+			void rollbackSpeculativeExecutions();
+
+			void traceRequestsOf(const PrePrepareMsg* pp, TraceStage stage);
+
+			bool validClientSignatures(const std::vector<char*>& requests) const;
+			bool validClientSignatures(const PrePrepareMsg* pp) const;
+			void verifyClientSignaturesInQueueOfPrimary();
+
 			void onSeqNumIsStable(SeqNum);
 
 			void onSeqNumIsStableWithoutRefCheckpoint(SeqNum);
@@ -409,6 +465,11 @@ namespace bftEngine
 				return internalThreadPool;
 			}
 
+			virtual ThresholdSigsCombiner& getThresholdSigsCombiner() override
+			{
+				return *sigsCombiner;
+			}
+
 			virtual IThresholdVerifier* getThresholdVerifierForExecution() override
 			{
 				return thresholdVerifierForExecution;
@@ -18,25 +18,25 @@ namespace bftEngine
 
 		// TODO(GG): here we assume that replica Ids are between 0 and MaxNumberOfReplicas-1 (should be changed to support dynamic reconfiguration)
 
-		MsgSize ReplicaStatusMsg::calcSizeOfReplicaStatusMsg(bool listOfPrePrepareMsgsInActiveWindow, bool listOfMissingViewChangeMsgForViewChange, bool listOfMissingPrePrepareMsgForViewChange)
+		MsgSize ReplicaStatusMsg::calcSizeOfReplicaStatusMsg(uint16_t workWindowSize, bool listOfPrePrepareMsgsInActiveWindow, bool listOfMissingViewChangeMsgForViewChange, bool listOfMissingPrePrepareMsgForViewChange)
 		{
 			if (listOfPrePrepareMsgsInActiveWindow)
-				return sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader) + (kWorkWindowSize + 7) / 8;
+				return sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader) + (workWindowSize + 7) / 8;
 			else if (listOfMissingViewChangeMsgForViewChange)
 				return sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader) + (MaxNumberOfReplicas + 7) / 8;
 			else if (listOfMissingPrePrepareMsgForViewChange)
-				return sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader) + (kWorkWindowSize + 7) / 8;
+				return sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader) + (workWindowSize + 7) / 8;
 			else
 				return sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader);
 		}
 
-		ReplicaStatusMsg::ReplicaStatusMsg(ReplicaId senderId, ViewNum viewNumber,
+		ReplicaStatusMsg::ReplicaStatusMsg(ReplicaId senderId, uint16_t checkpointWindowSize, ViewNum viewNumber,
 										   SeqNum lastStableSeqNum, SeqNum lastExecutedSeqNum,
 										   bool viewIsActive, bool hasNewChangeMsg,
 								 		   bool listOfPPInActiveWindow,
 										   bool listOfMissingVCForVC,
 										   bool listOfMissingPPForVC)
-			: MessageBase(senderId, MsgCode::ReplicaStatus, calcSizeOfReplicaStatusMsg(listOfPPInActiveWindow, listOfMissingVCForVC, listOfMissingPPForVC))
+			: MessageBase(senderId, MsgCode::ReplicaStatus, calcSizeOfReplicaStatusMsg(2 * checkpointWindowSize, listOfPPInActiveWindow, listOfMissingVCForVC, listOfMissingPPForVC))
 		{
 			Assert(lastExecutedSeqNum >= lastStableSeqNum);
 			Assert(lastStableSeqNum % checkpointWindowSize == 0);
@@ -86,7 +86,7 @@ namespace bftEngine
 
 			if (!repInfo.isIdOfReplica(t->senderId())) return false;
 
-			if (t->getLastStableSeqNum() % checkpointWindowSize != 0) return false;
+			if (t->getLastStableSeqNum() % repInfo.checkpointWindowSize() != 0) return false;
 
 			if(t->getLastExecutedSeqNum() < t->getLastStableSeqNum()) return false;
 
@@ -111,7 +111,7 @@ namespace bftEngine
 			if ( ((listOfPPInActiveWindow ? 1 : 0) + (listOfMissingVCForVC ? 1 : 0) + (listOfMissingPPForVC ? 1 : 0)) >= 2)
 				return false;
 
-			if (t->size() != calcSizeOfReplicaStatusMsg(listOfPPInActiveWindow, listOfMissingVCForVC, listOfMissingPPForVC))
+			if (t->size() != calcSizeOfReplicaStatusMsg(repInfo.workWindowSize(), listOfPPInActiveWindow, listOfMissingVCForVC, listOfMissingPPForVC))
 				return false;
 
 			outMsg = t;
@@ -119,6 +119,11 @@ namespace bftEngine
 			return true;
 		}
 
+		size_t ReplicaStatusMsg::numOfBitsInList() const
+		{
+			return (size() - sizeof(ReplicaStatusMsg::ReplicaStatusMsgHeader)) * 8;
+		}
+
 		ViewNum ReplicaStatusMsg::getViewNumber() const
 		{
 			return b()->viewNumber;
@@ -163,7 +168,7 @@ namespace bftEngine
 		{
 			Assert(hasListOfPrePrepareMsgsInActiveWindow());
 			Assert(seqNum > b()->lastStableSeqNum);
-			Assert(seqNum <= b()->lastStableSeqNum + kWorkWindowSize);
+			Assert(seqNum <= b()->lastStableSeqNum + (SeqNum)numOfBitsInList());
 
 			size_t index = (size_t)(seqNum - b()->lastStableSeqNum - 1);
 			size_t byteIndex = index / 8;
@@ -189,7 +194,7 @@ namespace bftEngine
 		{
 			Assert(hasListOfMissingPrePrepareMsgForViewChange());
 			Assert(seqNum > b()->lastStableSeqNum);
-			Assert(seqNum <= b()->lastStableSeqNum + kWorkWindowSize);
+			Assert(seqNum <= b()->lastStableSeqNum + (SeqNum)numOfBitsInList());
 
 			size_t index = (size_t)(seqNum - b()->lastStableSeqNum - 1);
 			size_t byteIndex = index / 8;
@@ -202,7 +207,7 @@ namespace bftEngine
 		{
 			Assert(hasListOfPrePrepareMsgsInActiveWindow());
 			Assert(seqNum > b()->lastStableSeqNum);
-			Assert(seqNum <= b()->lastStableSeqNum + kWorkWindowSize);
+			Assert(seqNum <= b()->lastStableSeqNum + (SeqNum)numOfBitsInList());
 			size_t index = (size_t)(seqNum - b()->lastStableSeqNum - 1);
 			size_t byteIndex = index / 8;
 			size_t bitIndex = index % 8;
@@ -225,7 +230,7 @@ namespace bftEngine
 		{
 			Assert(hasListOfMissingPrePrepareMsgForViewChange());
 			Assert(seqNum > b()->lastStableSeqNum);
-			Assert(seqNum <= b()->lastStableSeqNum + kWorkWindowSize);
+			Assert(seqNum <= b()->lastStableSeqNum + (SeqNum)numOfBitsInList());
 			size_t index = (size_t)(seqNum - b()->lastStableSeqNum - 1);
 			size_t byteIndex = index / 8;
 			size_t bitIndex = index % 8;
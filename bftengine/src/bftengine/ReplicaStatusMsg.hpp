@@ -17,7 +17,7 @@ namespace bftEngine
 		{
 
 		public:
-			ReplicaStatusMsg(ReplicaId senderId, ViewNum viewNumber, 
+			ReplicaStatusMsg(ReplicaId senderId, uint16_t checkpointWindowSize, ViewNum viewNumber, 
 				             SeqNum lastStableSeqNum, SeqNum lastExecutedSeqNum,
 							 bool viewIsActive, bool hasNewChangeMsg,
 							 bool listOfPrePrepareMsgsInActiveWindow,
@@ -75,7 +75,10 @@ namespace bftEngine
 #pragma pack(pop)
 			static_assert(sizeof(ReplicaStatusMsgHeader) == (2 + 8 + 8 + 8 + 1), "ReplicaStatusMsgHeader is 27B");
 
-			static MsgSize calcSizeOfReplicaStatusMsg(bool listOfPrePrepareMsgsInActiveWindow, bool listOfMissingViewChangeMsgForViewChange, bool listOfMissingPrePrepareMsgForViewChange);
+			// the size of a list of PrePrepareMsgs depends on the size of the work window (i.e. 2 * checkpointWindowSize)
+			static MsgSize calcSizeOfReplicaStatusMsg(uint16_t workWindowSize, bool listOfPrePrepareMsgsInActiveWindow, bool listOfMissingViewChangeMsgForViewChange, bool listOfMissingPrePrepareMsgForViewChange);
+
+			size_t numOfBitsInList() const;
 
 			ReplicaStatusMsgHeader* b() const
 			{
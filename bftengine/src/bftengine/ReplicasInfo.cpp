@@ -34,7 +34,8 @@ namespace bftEngine
 
 		ReplicasInfo::ReplicasInfo(ReplicaId myId, const SigManager& sigManager,
 			int16_t numberOfReplicas, int16_t fVal, int16_t cVal,
-			bool dynamicCollectorForPartialProofs, bool dynamicCollectorForExecutionProofs) :
+			bool dynamicCollectorForPartialProofs, bool dynamicCollectorForExecutionProofs,
+			uint16_t checkpointWindowSize) :
 			_myId{ myId },
 			_sigManager{ sigManager },
 			_numberOfReplicas{ numberOfReplicas },
@@ -42,10 +43,12 @@ namespace bftEngine
 			_cVal{ cVal },
 			_dynamicCollectorForPartialProofs{ dynamicCollectorForPartialProofs },
 			_dynamicCollectorForExecutionProofs{ dynamicCollectorForExecutionProofs },
+			_checkpointWindowSize{ checkpointWindowSize },
 			_idsOfReplicas{ generateSetOfReplicas_helpFunc(numberOfReplicas) },
 			_idsOfPeerReplicas{ generateSetOfPeerReplicas_helpFunc(myId, numberOfReplicas) }
 		{
 			Assert(numberOfReplicas == (3 * fVal + 2 * cVal + 1));
+			Assert(checkpointWindowSize > 0);
 		}
 
 		bool ReplicasInfo::getCollectorsForPartialProofs(const ReplicaId refReplica, const ViewNum v, const SeqNum seq, int8_t* outNumOfCollectors, ReplicaId* outCollectorsArray) const
@@ -141,5 +144,35 @@ namespace bftEngine
 			}
 		}
 
+		void ReplicasInfo::getChildrenInPrePrepareTree(const ReplicaId refReplica, const ViewNum v, const SeqNum seq, const uint16_t fanout, std::vector<ReplicaId>& outChildren) const
+		{
+			Assert(fanout > 0);
+			Assert(isIdOfReplica(refReplica));
+
+			outChildren.clear();
+
+			const int32_t n = _numberOfReplicas;
+			const int32_t m = n - 1; // number of nodes (other than the primary)
+			const int32_t k = fanout;
+			const ReplicaId primary = primaryOfView(v);
+			const int32_t rotation = (int32_t)(seq % m);
+
+			// the nodes at positions 0,1,...,k-1 are the children of the primary, and the children of the node at position i
+			// are at positions k*(i+1),...,k*(i+1)+k-1
+			int32_t firstChildPos = 0;
+			if (refReplica != primary)
+			{
+				const int32_t offset = (refReplica - primary - 1 + n) % n;
+				const int32_t pos = (offset - rotation + m) % m;
+				firstChildPos = k * (pos + 1);
+			}
+
+			for (int32_t c = firstChildPos; (c < firstChildPos + k) && (c < m); c++)
+			{
+				const int32_t offset = (c + rotation) % m;
+				outChildren.push_back((ReplicaId)((primary + 1 + offset) % n));
+			}
+		}
+
 	}
 }
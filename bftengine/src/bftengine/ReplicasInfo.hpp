@@ -9,6 +9,7 @@
 #pragma once
 #include "PrimitiveTypes.hpp"
 #include "SigManager.hpp"
+#include <vector>
 
 namespace bftEngine
 {
@@ -20,7 +21,8 @@ namespace bftEngine
 		public:
 			ReplicasInfo(ReplicaId myId, const SigManager& sigManager,
 				int16_t numberOfReplicas, int16_t fVal, int16_t cVal,
-				bool dynamicCollectorForPartialProofs, bool dynamicCollectorForExecutionProofs);
+				bool dynamicCollectorForPartialProofs, bool dynamicCollectorForExecutionProofs,
+				uint16_t checkpointWindowSize);
 
 
 			ReplicaId myId() const
@@ -37,6 +39,10 @@ namespace bftEngine
 			int16_t fVal() const { return _fVal; }
 			int16_t cVal() const { return _cVal; }
 
+			// see ReplicaConfig::checkpointWindowSize (the same for all the replicas)
+			uint16_t checkpointWindowSize() const { return _checkpointWindowSize; }
+			uint16_t workWindowSize() const { return 2 * _checkpointWindowSize; }
+
 			bool isIdOfReplica(NodeIdType id) const
 			{
 				return (id < _numberOfReplicas);
@@ -82,6 +88,11 @@ namespace bftEngine
 				return getExecutionCollectors(v, n, nullptr, nullptr);
 			}
 
+			// the replicas to which refReplica sends the PrePrepareMsg of sequence number n, when the PrePrepareMsg is
+			// disseminated through a tree whose root is the primary of view v and whose nodes have up to fanout children.
+			// The order of the other replicas is rotated by n, so the relaying load is spread among them.
+			void getChildrenInPrePrepareTree(const ReplicaId refReplica, const ViewNum v, const SeqNum n, const uint16_t fanout, std::vector<ReplicaId>& outChildren) const;
+
 		protected:
 
 			const ReplicaId _myId;
@@ -93,6 +104,8 @@ namespace bftEngine
 			const bool _dynamicCollectorForPartialProofs;
 			const bool _dynamicCollectorForExecutionProofs;
 
+			const uint16_t _checkpointWindowSize;
+
 
 			const std::set<ReplicaId> _idsOfReplicas;
 			const std::set<ReplicaId> _idsOfPeerReplicas;
@@ -0,0 +1,221 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "RequestTracer.hpp"
+#include "RequestTracing.hpp"
+#include "TimeUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		namespace
+		{
+			const char* const stageNames[NumOfTraceStages] =
+			{
+				"ClientSent",
+				"ReplicaReceived",
+				"ForwardedToPrimary",
+				"AddedToPrePrepare",
+				"PrePrepareReceived",
+				"PreparePartialSent",
+				"PartialCommitProofSent",
+				"Committed",
+				"Executed",
+				"ClientReplyReceived"
+			};
+
+			struct TraceEvent
+			{
+				uint64_t timeMicros;
+				ReqId reqSeqNum;
+				NodeIdType node;
+				NodeIdType clientId;
+				uint8_t stage;
+			};
+
+			struct TraceRing
+			{
+				std::atomic<uint64_t> next{ 0 };
+				std::atomic<bool> inUse{ true };
+				TraceEvent events[RequestTracer::kRingSize];
+			};
+
+			std::mutex ringsLock;
+			std::vector<TraceRing*> rings; // protected by ringsLock
+
+			TraceRing* acquireRing()
+			{
+				std::lock_guard<std::mutex> lock(ringsLock);
+				for (TraceRing* r : rings)
+				{
+					bool expected = false;
+					if (r->inUse.compare_exchange_strong(expected, true)) return r;
+				}
+				TraceRing* r = new TraceRing();
+				rings.push_back(r);
+				return r;
+			}
+
+			struct LocalRing
+			{
+				TraceRing* ring = nullptr;
+
+				~LocalRing()
+				{
+					if (ring != nullptr) ring->inUse = false;
+				}
+			};
+
+			thread_local LocalRing localRing;
+			thread_local uint32_t numOfSampledRequests = 0;
+
+			bool sameTrace(const TraceEvent& a, const TraceEvent& b)
+			{
+				return (a.clientId == b.clientId) && (a.reqSeqNum == b.reqSeqNum) && (a.node == b.node);
+			}
+
+			void writeEvent(FILE* f, bool& first, const char* name, const char* ph, const TraceEvent& e)
+			{
+				fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"request\",\"ph\":\"%s\",\"ts\":%" PRIu64 ","
+						   "\"pid\":%u,\"tid\":%u,\"id\":\"%u-%" PRIu64 "\"}",
+						first ? "" : ",", name, ph, e.timeMicros, (unsigned)e.node, (unsigned)e.clientId,
+						(unsigned)e.clientId, e.reqSeqNum);
+				first = false;
+			}
+		}
+
+		std::atomic<uint32_t> RequestTracer::samplingPeriod_{ 0 };
+
+		bool RequestTracer::sample()
+		{
+			const uint32_t period = samplingPeriod_.load(std::memory_order_relaxed);
+			if (period == 0) return false;
+			return (++numOfSampledRequests % period) == 0;
+		}
+
+		void RequestTracer::record(NodeIdType node, NodeIdType clientId, ReqId reqSeqNum, TraceStage stage)
+		{
+			if (!enabled()) return;
+
+			TraceRing* r = localRing.ring;
+			if (r == nullptr)
+			{
+				r = acquireRing();
+				localRing.ring = r;
+			}
+
+			const uint64_t i = r->next.load(std::memory_order_relaxed);
+			TraceEvent& e = r->events[i & (kRingSize - 1)];
+			e.timeMicros = getMonotonicTime();
+			e.reqSeqNum = reqSeqNum;
+			e.node = node;
+			e.clientId = clientId;
+			e.stage = stage;
+			r->next.store(i + 1, std::memory_order_release);
+		}
+
+		// The events are grouped by request and node. For each group, the time between two consecutive stages is
+		// written as an async span (named after the first stage), and the whole group as a "request" span.
+		// Events that are recorded while the buffers are read may be partially written; such events are rare
+		// and only affect the dump.
+		bool RequestTracer::dump(const char* fileName)
+		{
+			std::vector<TraceEvent> events;
+			{
+				std::lock_guard<std::mutex> lock(ringsLock);
+				for (TraceRing* r : rings)
+				{
+					const uint64_t n = r->next.load(std::memory_order_acquire);
+					const uint64_t begin = (n > kRingSize) ? (n - kRingSize + 1) : 0;
+					for (uint64_t i = begin; i < n; i++)
+					{
+						const TraceEvent& e = r->events[i & (kRingSize - 1)];
+						if (e.stage < NumOfTraceStages) events.push_back(e);
+					}
+				}
+			}
+
+			// (the events of a thread are in the order they were recorded, which is kept for events with the same time)
+			std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b)
+			{
+				if (a.clientId != b.clientId) return a.clientId < b.clientId;
+				if (a.reqSeqNum != b.reqSeqNum) return a.reqSeqNum < b.reqSeqNum;
+				if (a.node != b.node) return a.node < b.node;
+				return a.timeMicros < b.timeMicros;
+			});
+
+			FILE* f = fopen(fileName, "w");
+			if (f == nullptr) return false;
+
+			fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+			bool first = true;
+			std::set<NodeIdType> nodes;
+
+			size_t groupBegin = 0;
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				const TraceEvent& e = events[i];
+				nodes.insert(e.node);
+
+				const bool lastInGroup = (i + 1 == events.size()) || !sameTrace(e, events[i + 1]);
+
+				if (i == groupBegin) writeEvent(f, first, "request", "b", e);
+				writeEvent(f, first, stageNames[e.stage], "n", e);
+				if (!lastInGroup)
+				{
+					writeEvent(f, first, stageNames[e.stage], "b", e);
+					writeEvent(f, first, stageNames[e.stage], "e", events[i + 1]);
+				}
+				else
+				{
+					writeEvent(f, first, "request", "e", e);
+					groupBegin = i + 1;
+				}
+			}
+
+			for (NodeIdType n : nodes)
+			{
+				fprintf(f, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"node %u\"}}",
+						first ? "" : ",", (unsigned)n, (unsigned)n);
+				first = false;
+			}
+
+			fprintf(f, "\n]}\n");
+			const bool ok = (ferror(f) == 0);
+			return (fclose(f) == 0) && ok;
+		}
+	}
+
+	void RequestTracing::enable(uint32_t samplingPeriod)
+	{
+		impl::RequestTracer::setSamplingPeriod(samplingPeriod);
+	}
+
+	void RequestTracing::disable()
+	{
+		impl::RequestTracer::setSamplingPeriod(0);
+	}
+
+	bool RequestTracing::isEnabled()
+	{
+		return impl::RequestTracer::enabled();
+	}
+
+	bool RequestTracing::dump(const std::string& fileName)
+	{
+		return impl::RequestTracer::dump(fileName.c_str());
+	}
+}
@@ -0,0 +1,56 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <atomic>
+#include "PrimitiveTypes.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		enum TraceStage : uint8_t
+		{
+			ClientSent = 0,
+			ReplicaReceived,
+			ForwardedToPrimary,
+			AddedToPrePrepare,
+			PrePrepareReceived,
+			PreparePartialSent,
+			PartialCommitProofSent,
+			Committed,
+			Executed,
+			ClientReplyReceived,
+			NumOfTraceStages
+		};
+
+		// Records the stages of traced requests (see RequestTracing.hpp).
+		// Each thread writes to its own ring buffer, so record() takes no locks. The rings are never freed: the
+		// ring of a thread that exits is reused by the next thread that records an event.
+		class RequestTracer
+		{
+		public:
+			static const uint32_t kRingSize = 64 * 1024; // a power of 2
+
+			static bool enabled() { return samplingPeriod_.load(std::memory_order_relaxed) != 0; }
+
+			// used by clients to decide if a new request is traced
+			static bool sample();
+
+			static void record(NodeIdType node, NodeIdType clientId, ReqId reqSeqNum, TraceStage stage);
+
+			static void setSamplingPeriod(uint32_t samplingPeriod) { samplingPeriod_ = samplingPeriod; }
+
+			static bool dump(const char* fileName);
+
+		private:
+			static std::atomic<uint32_t> samplingPeriod_;
+		};
+	}
+}
@@ -0,0 +1,108 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include <iterator>
+
+#include "RequestsCache.hpp"
+#include "RequestsMerkleTree.hpp"
+#include "ClientRequestMsg.hpp"
+#include "assertUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		RequestsCache::RequestsCache(uint32_t maxNumOfRequests) : maxNumOfRequests{ maxNumOfRequests }
+		{
+			Assert(maxNumOfRequests > 0);
+		}
+
+		RequestsCache::~RequestsCache()
+		{
+			clear();
+		}
+
+		void RequestsCache::computeDigestOfRequest(const ClientRequestMsg* m, Digest& outDigest)
+		{
+			RequestsMerkleTree::computeLeafDigest(m->body(), m->size(), outDigest);
+		}
+
+		void RequestsCache::add(ClientRequestMsg* m)
+		{
+			RequestKey key;
+			key.clientId = m->clientProxyId();
+			key.reqSeqNum = m->requestSeqNum();
+			computeDigestOfRequest(m, key.reqDigest);
+
+			if (requests.count(key) > 0)
+			{
+				delete m;
+				return;
+			}
+
+			if (requests.size() >= maxNumOfRequests)
+			{
+				auto oldest = requests.find(insertionOrder.front());
+				Assert(oldest != requests.end());
+				remove(oldest);
+			}
+
+			insertionOrder.push_back(key);
+
+			CachedRequest r;
+			r.msg = m;
+			r.posInInsertionOrder = std::prev(insertionOrder.end());
+			requests.insert({ key, r });
+		}
+
+		ClientRequestMsg* RequestsCache::get(NodeIdType clientId, ReqId reqSeqNum, const Digest& reqDigest) const
+		{
+			RequestKey key;
+			key.clientId = clientId;
+			key.reqSeqNum = reqSeqNum;
+			key.reqDigest = reqDigest;
+
+			auto it = requests.find(key);
+			if (it == requests.end()) return nullptr;
+
+			return it->second.msg;
+		}
+
+		void RequestsCache::onRequestExecuted(NodeIdType clientId, ReqId reqSeqNum)
+		{
+			RequestKey first;
+			first.clientId = clientId;
+			first.reqSeqNum = 0;
+			first.reqDigest.makeZero();
+
+			auto it = requests.lower_bound(first);
+			while (it != requests.end() && it->first.clientId == clientId && it->first.reqSeqNum <= reqSeqNum)
+			{
+				auto next = std::next(it);
+				remove(it);
+				it = next;
+			}
+		}
+
+		void RequestsCache::clear()
+		{
+			for (auto& r : requests) delete r.second.msg;
+			requests.clear();
+			insertionOrder.clear();
+		}
+
+		void RequestsCache::remove(std::map<RequestKey, CachedRequest>::iterator it)
+		{
+			delete it->second.msg;
+			insertionOrder.erase(it->second.posInInsertionOrder);
+			requests.erase(it);
+		}
+
+	}
+}
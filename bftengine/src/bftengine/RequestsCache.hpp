@@ -0,0 +1,83 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <map>
+#include <list>
+
+#include "PrimitiveTypes.hpp"
+#include "Digest.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		class ClientRequestMsg;
+
+		// Requests received directly from clients (used when clients multicast their requests to all replicas).
+		// A request is identified by (clientId, reqSeqNum, digest), where the digest is the leaf digest
+		// of the request in RequestsMerkleTree. The same (clientId, reqSeqNum) may be stored with different
+		// digests (e.g., if a faulty client sends different requests to different replicas).
+		// The cache is bounded: when it is full, the oldest request is removed.
+		class RequestsCache
+		{
+		public:
+			RequestsCache(uint32_t maxNumOfRequests);
+			~RequestsCache();
+
+			// the cache takes ownership of m
+			void add(ClientRequestMsg* m);
+
+			// returns nullptr if the request is not in the cache
+			ClientRequestMsg* get(NodeIdType clientId, ReqId reqSeqNum, const Digest& reqDigest) const;
+
+			// removes all requests of clientId with sequence number <= reqSeqNum
+			void onRequestExecuted(NodeIdType clientId, ReqId reqSeqNum);
+
+			void clear();
+
+			size_t numOfRequests() const { return requests.size(); }
+
+			static void computeDigestOfRequest(const ClientRequestMsg* m, Digest& outDigest);
+
+		protected:
+			struct RequestKey
+			{
+				NodeIdType clientId;
+				ReqId reqSeqNum;
+				Digest reqDigest;
+
+				bool operator<(const RequestKey& other) const
+				{
+					if (clientId != other.clientId) return (clientId < other.clientId);
+					if (reqSeqNum != other.reqSeqNum) return (reqSeqNum < other.reqSeqNum);
+					return (memcmp(reqDigest.content(), other.reqDigest.content(), sizeof(Digest)) < 0);
+				}
+			};
+
+			struct CachedRequest
+			{
+				ClientRequestMsg* msg;
+				std::list<RequestKey>::iterator posInInsertionOrder;
+			};
+
+			void remove(std::map<RequestKey, CachedRequest>::iterator it);
+
+			const uint32_t maxNumOfRequests;
+
+			std::map<RequestKey, CachedRequest> requests;
+
+			// keys of the cached requests (oldest first)
+			std::list<RequestKey> insertionOrder;
+		};
+
+	}
+}
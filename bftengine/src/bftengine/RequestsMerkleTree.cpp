@@ -0,0 +1,362 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "RequestsMerkleTree.hpp"
+#include "SysConsts.hpp"
+#include "Crypto.hpp"
+#include "assertUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		static const char leafPrefix = 0x00;
+		static const char parentPrefix = 0x01;
+
+		// largest power of two that is smaller than n (n > 1)
+		static uint32_t splitPoint(uint32_t n)
+		{
+			uint32_t k = 1;
+			while ((k << 1) < n) k = k << 1;
+			return k;
+		}
+
+		///////////////////////////////////////////////////////////////////////////////
+		// Workers used to compute digests in parallel
+		///////////////////////////////////////////////////////////////////////////////
+
+		class DigestWorkers
+		{
+		public:
+			static DigestWorkers& instance()
+			{
+				static DigestWorkers workers(numOfThreadsForRequestsDigest);
+				return workers;
+			}
+
+			// executes func(0),...,func(numOfTasks-1); the calling thread also executes tasks
+			void parallelFor(uint32_t numOfTasks, const std::function<void(uint32_t)>& func)
+			{
+				std::unique_lock<std::mutex> callerLock(callerMutex);
+				std::unique_lock<std::mutex> lock(m);
+
+				currFunc = &func;
+				nextTask = 0;
+				totalTasks = numOfTasks;
+				pendingTasks = numOfTasks;
+				workCond.notify_all();
+
+				while (executeNextTask(lock)) {}
+
+				doneCond.wait(lock, [this] { return pendingTasks == 0; });
+				currFunc = nullptr;
+			}
+
+			~DigestWorkers()
+			{
+				{
+					std::unique_lock<std::mutex> lock(m);
+					stopped = true;
+				}
+				workCond.notify_all();
+				for (std::thread& t : threads) t.join();
+			}
+
+		protected:
+			DigestWorkers(uint16_t numOfThreads)
+			{
+				for (uint16_t i = 0; i < numOfThreads; i++)
+					threads.emplace_back(&DigestWorkers::workerLoop, this);
+			}
+
+			void workerLoop()
+			{
+				std::unique_lock<std::mutex> lock(m);
+				while (true)
+				{
+					workCond.wait(lock, [this] { return stopped || (currFunc != nullptr && nextTask < totalTasks); });
+					if (stopped) return;
+					while (executeNextTask(lock)) {}
+				}
+			}
+
+			// should be called when m is locked (m is released while the task is executed)
+			bool executeNextTask(std::unique_lock<std::mutex>& lock)
+			{
+				if (currFunc == nullptr || nextTask >= totalTasks) return false;
+
+				const uint32_t task = nextTask++;
+				const std::function<void(uint32_t)>* func = currFunc;
+
+				lock.unlock();
+				(*func)(task);
+				lock.lock();
+
+				if (--pendingTasks == 0) doneCond.notify_all();
+
+				return true;
+			}
+
+			std::mutex callerMutex;
+			std::mutex m;
+			std::condition_variable workCond;
+			std::condition_variable doneCond;
+
+			const std::function<void(uint32_t)>* currFunc = nullptr;
+			uint32_t nextTask = 0;
+			uint32_t totalTasks = 0;
+			uint32_t pendingTasks = 0;
+			bool stopped = false;
+
+			std::vector<std::thread> threads;
+		};
+
+		///////////////////////////////////////////////////////////////////////////////
+		// RequestsMerkleTree
+		///////////////////////////////////////////////////////////////////////////////
+
+		void RequestsMerkleTree::computeLeafDigest(const char* request, uint32_t requestSize, Digest& outDigest)
+		{
+			DigestUtil::Context c;
+			c.update(&leafPrefix, sizeof(leafPrefix));
+			c.update(request, requestSize);
+			c.writeDigest(outDigest.content());
+		}
+
+		void RequestsMerkleTree::computeLeafDigests(const char* const* requests, const uint32_t* requestsSizes, uint32_t numOfRequests, Digest* outDigests)
+		{
+			const uint32_t maxBatch = 8;
+			for (uint32_t first = 0; first < numOfRequests; first += maxBatch)
+			{
+				const uint32_t batch = std::min(maxBatch, numOfRequests - first);
+				DigestUtil::Context contexts[maxBatch];
+				DigestUtil::Context* contextPtrs[maxBatch];
+				size_t sizes[maxBatch];
+				for (uint32_t i = 0; i < batch; i++)
+				{
+					contexts[i].update(&leafPrefix, sizeof(leafPrefix));
+					contextPtrs[i] = &contexts[i];
+					sizes[i] = requestsSizes[first + i];
+				}
+
+				DigestUtil::Context::updateMany(batch, contextPtrs, requests + first, sizes);
+
+				for (uint32_t i = 0; i < batch; i++)
+					contexts[i].writeDigest(outDigests[first + i].content());
+			}
+		}
+
+		void RequestsMerkleTree::computeParentDigest(const Digest& left, const Digest& right, Digest& outDigest)
+		{
+			// NB: outDigest may be one of the inputs
+			DigestUtil::Context c;
+			c.update(&parentPrefix, sizeof(parentPrefix));
+			c.update(left.content(), sizeof(Digest));
+			c.update(right.content(), sizeof(Digest));
+			c.writeDigest(outDigest.content());
+		}
+
+		void RequestsMerkleTree::computeRoot(const Digest* leaves, uint32_t numOfLeaves, Digest& outRoot)
+		{
+			Assert(numOfLeaves > 0);
+
+			if (numOfLeaves == 1)
+			{
+				outRoot = leaves[0];
+				return;
+			}
+
+			const uint32_t k = splitPoint(numOfLeaves);
+			Digest left;
+			Digest right;
+			computeRoot(leaves, k, left);
+			computeRoot(leaves + k, numOfLeaves - k, right);
+			computeParentDigest(left, right, outRoot);
+		}
+
+		// root of the subtree of leaves [first, first+num); subtrees of size blockSize that start at a multiple of
+		// blockSize are taken from blockRoots
+		static void computeRootFromBlocks(const Digest* leaves, uint32_t first, uint32_t num,
+			const Digest* blockRoots, uint32_t blockSize, Digest& outRoot)
+		{
+			if (num == blockSize && (first % blockSize) == 0)
+			{
+				outRoot = blockRoots[first / blockSize];
+				return;
+			}
+			if (num == 1)
+			{
+				outRoot = leaves[first];
+				return;
+			}
+
+			const uint32_t k = splitPoint(num);
+			Digest left;
+			Digest right;
+			computeRootFromBlocks(leaves, first, k, blockRoots, blockSize, left);
+			computeRootFromBlocks(leaves, first + k, num - k, blockRoots, blockSize, right);
+			RequestsMerkleTree::computeParentDigest(left, right, outRoot);
+		}
+
+		void RequestsMerkleTree::computeRootOfRequests(const char* const* requests, const uint32_t* requestsSizes, uint32_t numOfRequests, Digest& outRoot)
+		{
+			Assert(numOfRequests > 0);
+
+			std::vector<Digest> leaves(numOfRequests);
+
+			if (numOfThreadsForRequestsDigest == 0 || numOfRequests < minNumOfRequestsForParallelDigest)
+			{
+				computeLeafDigests(requests, requestsSizes, numOfRequests, leaves.data());
+
+				computeRoot(leaves.data(), numOfRequests, outRoot);
+				return;
+			}
+
+			// Each task computes the leaves of one block, and (for full blocks) the root of the block.
+			// Since blockSize is a power of two, every full block is a subtree of the tree.
+			const uint32_t numOfThreads = numOfThreadsForRequestsDigest + 1;
+			uint32_t blockSize = 1;
+			while (blockSize * 2 * 4 * numOfThreads <= numOfRequests) blockSize = blockSize * 2;
+
+			const uint32_t numOfFullBlocks = numOfRequests / blockSize;
+			const uint32_t numOfBlocks = numOfFullBlocks + ((numOfRequests % blockSize) ? 1 : 0);
+			std::vector<Digest> blockRoots(numOfFullBlocks);
+
+			DigestWorkers::instance().parallelFor(numOfBlocks, [&](uint32_t block)
+			{
+				const uint32_t first = block * blockSize;
+				const uint32_t last = std::min(first + blockSize, numOfRequests);
+				computeLeafDigests(requests + first, requestsSizes + first, last - first, leaves.data() + first);
+
+				if (block < numOfFullBlocks) computeRoot(leaves.data() + first, blockSize, blockRoots[block]);
+			});
+
+			computeRootFromBlocks(leaves.data(), 0, numOfRequests, blockRoots.data(), blockSize, outRoot);
+		}
+
+		// returns the path from the root to leafIndex (true = the node is a left child)
+		static std::vector<bool> pathToLeaf(uint32_t leafIndex, uint32_t numOfLeaves)
+		{
+			std::vector<bool> path;
+			while (numOfLeaves > 1)
+			{
+				const uint32_t k = splitPoint(numOfLeaves);
+				if (leafIndex < k)
+				{
+					path.push_back(true);
+					numOfLeaves = k;
+				}
+				else
+				{
+					path.push_back(false);
+					leafIndex -= k;
+					numOfLeaves -= k;
+				}
+			}
+			return path;
+		}
+
+		void RequestsMerkleTree::computeInclusionProof(const Digest* leaves, uint32_t numOfLeaves, uint32_t leafIndex, std::vector<Digest>& outProof)
+		{
+			Assert(leafIndex < numOfLeaves);
+
+			outProof.clear();
+
+			uint32_t first = 0;
+			uint32_t num = numOfLeaves;
+			while (num > 1)
+			{
+				const uint32_t k = splitPoint(num);
+				Digest sibling;
+				if (leafIndex < first + k)
+				{
+					computeRoot(leaves + first + k, num - k, sibling);
+					num = k;
+				}
+				else
+				{
+					computeRoot(leaves + first, k, sibling);
+					first += k;
+					num -= k;
+				}
+				outProof.push_back(sibling);
+			}
+
+			// from the leaf up to the root
+			std::reverse(outProof.begin(), outProof.end());
+		}
+
+		bool RequestsMerkleTree::verifyInclusionProof(const Digest& leaf, uint32_t leafIndex, uint32_t numOfLeaves, const std::vector<Digest>& proof, const Digest& root)
+		{
+			if (leafIndex >= numOfLeaves) return false;
+
+			const std::vector<bool> path = pathToLeaf(leafIndex, numOfLeaves);
+			if (path.size() != proof.size()) return false;
+
+			Digest node = leaf;
+			for (size_t i = 0; i < proof.size(); i++)
+			{
+				const bool isLeftChild = path[path.size() - 1 - i];
+				if (isLeftChild)
+					computeParentDigest(node, proof[i], node);
+				else
+					computeParentDigest(proof[i], node, node);
+			}
+
+			return (node == root);
+		}
+
+		///////////////////////////////////////////////////////////////////////////////
+		// RequestsMerkleTree::Builder
+		///////////////////////////////////////////////////////////////////////////////
+
+		void RequestsMerkleTree::Builder::add(const Digest& leaf)
+		{
+			Assert(numOfLeaves < (1U << MaxHeight));
+
+			Digest node = leaf;
+			uint32_t level = 0;
+			while ((numOfLeaves >> level) & 0x1)
+			{
+				computeParentDigest(subtrees[level], node, node);
+				level++;
+			}
+			subtrees[level] = node;
+			numOfLeaves++;
+		}
+
+		void RequestsMerkleTree::Builder::computeRoot(Digest& outRoot) const
+		{
+			Assert(numOfLeaves > 0);
+
+			bool hasNode = false;
+			for (uint32_t level = 0; level <= MaxHeight; level++)
+			{
+				if (((numOfLeaves >> level) & 0x1) == 0) continue;
+
+				if (!hasNode)
+				{
+					outRoot = subtrees[level];
+					hasNode = true;
+				}
+				else
+				{
+					computeParentDigest(subtrees[level], outRoot, outRoot);
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,72 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "Digest.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		// Merkle tree over the requests of a PrePrepareMsg (one leaf per request).
+		// The shape of the tree is defined as in RFC 6962: for n > 1 leaves, the left subtree holds the
+		// largest power of two that is smaller than n.
+		// leaf   = H(0x00 || request)
+		// parent = H(0x01 || left || right)
+		class RequestsMerkleTree
+		{
+		public:
+
+			// max height of a tree (numberOfRequests in PrePrepareMsg is a 16 bit number)
+			static const uint32_t MaxHeight = 16;
+
+			static void computeLeafDigest(const char* request, uint32_t requestSize, Digest& outDigest);
+
+			// the same as computeLeafDigest(requests[i], requestsSizes[i], outDigests[i]) for 0 <= i < numOfRequests
+			// (several leaves are hashed together when the CPU supports it)
+			static void computeLeafDigests(const char* const* requests, const uint32_t* requestsSizes, uint32_t numOfRequests, Digest* outDigests);
+
+			static void computeParentDigest(const Digest& left, const Digest& right, Digest& outDigest);
+
+			static void computeRoot(const Digest* leaves, uint32_t numOfLeaves, Digest& outRoot);
+
+			// computes the leaf digests of all requests (in parallel, if there are enough requests), and returns the root
+			static void computeRootOfRequests(const char* const* requests, const uint32_t* requestsSizes, uint32_t numOfRequests, Digest& outRoot);
+
+			// proof that leaf number leafIndex is included in the tree (siblings, from the leaf up to the root)
+			static void computeInclusionProof(const Digest* leaves, uint32_t numOfLeaves, uint32_t leafIndex, std::vector<Digest>& outProof);
+
+			static bool verifyInclusionProof(const Digest& leaf, uint32_t leafIndex, uint32_t numOfLeaves, const std::vector<Digest>& proof, const Digest& root);
+
+			// Incremental computation of the root (leaves are added one by one).
+			// Only O(log n) digests are kept, and the object does not allocate memory (it can be placed in a message buffer).
+			class Builder
+			{
+			public:
+				Builder() : numOfLeaves{ 0 } {}
+
+				void add(const Digest& leaf);
+
+				uint32_t numberOfLeaves() const { return numOfLeaves; }
+
+				void computeRoot(Digest& outRoot) const;
+
+			protected:
+				// subtrees[i] is the root of a full subtree with 2^i leaves (valid IFF bit i of numOfLeaves is set)
+				Digest subtrees[MaxHeight + 1];
+				uint32_t numOfLeaves;
+			};
+		};
+
+	}
+}
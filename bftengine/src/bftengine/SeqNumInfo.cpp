@@ -18,10 +18,8 @@ namespace bftEngine
 		SeqNumInfo::SeqNumInfo() :
 			replica(nullptr),
 			prePrepareMsg(nullptr),
-			prepareSigCollector(nullptr),
-			commitMsgsCollector(nullptr),
-			partialProofsSet(nullptr),
-			partialExecProofsSet(nullptr),
+			prePrepareDigestMsg(nullptr),
+			activeCollectors(nullptr),
 			primary(false),
 			forcedCompleted(false),
 			slowPathHasStarted(false),
@@ -34,11 +32,6 @@ namespace bftEngine
 		SeqNumInfo::~SeqNumInfo()
 		{
 			resetAndFree();
-
-			delete prepareSigCollector;
-			delete commitMsgsCollector;
-			delete partialProofsSet;
-			delete partialExecProofsSet;
 		}
 
 
@@ -47,10 +40,17 @@ namespace bftEngine
 			delete prePrepareMsg;
 			prePrepareMsg = nullptr;
 
-			prepareSigCollector->resetAndFree();
-			commitMsgsCollector->resetAndFree();
-			partialProofsSet->resetAndFree();
-			partialExecProofsSet->resetAndFree();
+			delete prePrepareDigestMsg;
+			prePrepareDigestMsg = nullptr;
+
+			freeRelayedPrePrepareMsgs();
+
+			if (activeCollectors != nullptr)
+			{
+				activeCollectors->resetAndFree();
+				pool->release(activeCollectors);
+				activeCollectors = nullptr;
+			}
 
 			primary = false;
 
@@ -68,7 +68,9 @@ namespace bftEngine
 			outPrePrepare = prePrepareMsg;
 			prePrepareMsg = nullptr;
 
-			prepareSigCollector->getAndReset(outcombinedValidSignatureMsg);
+			outcombinedValidSignatureMsg = nullptr;
+			if (activeCollectors != nullptr)
+				activeCollectors->prepareSigCollector.getAndReset(outcombinedValidSignatureMsg);
 
 			resetAndFree();
 		}
@@ -80,14 +82,14 @@ namespace bftEngine
 
 			Assert(primary == false);
 			Assert(!forcedCompleted);
-			Assert(!prepareSigCollector->hasPartialMsgFromReplica(replica->getReplicasInfo().myId()));
+			Assert(!collectors().prepareSigCollector.hasPartialMsgFromReplica(replica->getReplicasInfo().myId()));
 
 			prePrepareMsg = m;
 
 			// set expected
 			Digest tmpDigest;
 			Digest::calcCombination(m->digestOfRequests(), m->viewNumber(), m->seqNumber(), tmpDigest);
-			prepareSigCollector->setExpected(m->seqNumber(), m->viewNumber(), tmpDigest);
+			collectors().prepareSigCollector.setExpected(m->seqNumber(), m->viewNumber(), tmpDigest);
 
 			if (firstSeenFromPrimary == MinTime) // TODO(GG): remove condition - TBD
 				firstSeenFromPrimary = getMonotonicTime();
@@ -96,6 +98,64 @@ namespace bftEngine
 		}
 
 
+		bool SeqNumInfo::addMsg(PrePrepareDigestMsg* m)
+		{
+			if (prePrepareDigestMsg != nullptr) return false;
+
+			prePrepareDigestMsg = m;
+
+			// if the PrePrepareMsg does not arrive in time, it is requested from the primary (see ReplicaImp::tryToAskForMissingInfo)
+			if (firstSeenFromPrimary == MinTime)
+				firstSeenFromPrimary = getMonotonicTime();
+
+			return true;
+		}
+
+
+		void SeqNumInfo::holdRelayedPrePrepareMsg(PrePrepareMsg* m)
+		{
+			Assert(prePrepareDigestMsg == nullptr);
+
+			for (PrePrepareMsg* held : relayedPrePrepareMsgs)
+			{
+				if (held->senderId() == m->senderId())
+				{
+					delete m;
+					return;
+				}
+			}
+
+			relayedPrePrepareMsgs.push_back(m);
+		}
+
+
+		PrePrepareMsg* SeqNumInfo::takeRelayedPrePrepareMsg()
+		{
+			Assert(prePrepareDigestMsg != nullptr);
+
+			PrePrepareMsg* m = nullptr;
+			for (PrePrepareMsg*& held : relayedPrePrepareMsgs)
+			{
+				if (prePrepareDigestMsg->matches(held))
+				{
+					m = held;
+					held = nullptr;
+					break;
+				}
+			}
+
+			freeRelayedPrePrepareMsgs();
+			return m;
+		}
+
+
+		void SeqNumInfo::freeRelayedPrePrepareMsgs()
+		{
+			for (PrePrepareMsg* held : relayedPrePrepareMsgs) delete held;
+			relayedPrePrepareMsgs.clear();
+		}
+
+
 		bool SeqNumInfo::addSelfMsg(PrePrepareMsg* m)
 		{
 
@@ -113,7 +173,7 @@ namespace bftEngine
 			// set expected
 			Digest tmpDigest;
 			Digest::calcCombination(m->digestOfRequests(), m->viewNumber(), m->seqNumber(), tmpDigest);
-			prepareSigCollector->setExpected(m->seqNumber(), m->viewNumber(), tmpDigest);
+			collectors().prepareSigCollector.setExpected(m->seqNumber(), m->viewNumber(), tmpDigest);
 
 			if (firstSeenFromPrimary == MinTime) // TODO(GG): remove condition - TBD
 				firstSeenFromPrimary = getMonotonicTime();
@@ -127,7 +187,7 @@ namespace bftEngine
 			Assert(replica->getReplicasInfo().myId() != m->senderId());
 			Assert(!forcedCompleted);
 
-			bool retVal = prepareSigCollector->addMsgWithPartialSignature(m, m->senderId());
+			bool retVal = collectors().prepareSigCollector.addMsgWithPartialSignature(m, m->senderId());
 
 			return retVal;
 		}
@@ -137,7 +197,7 @@ namespace bftEngine
 			Assert(replica->getReplicasInfo().myId() == m->senderId());
 			Assert(!forcedCompleted);
 
-			bool r = prepareSigCollector->addMsgWithPartialSignature(m, m->senderId());
+			bool r = collectors().prepareSigCollector.addMsgWithPartialSignature(m, m->senderId());
 			Assert(r);
 
 			return true;
@@ -149,7 +209,7 @@ namespace bftEngine
 			Assert(replica->getReplicasInfo().myId() != m->senderId()); // TODO(GG): TBD
 			Assert(!forcedCompleted);
 
-			bool retVal = prepareSigCollector->addMsgWithCombinedSignature(m);
+			bool retVal = collectors().prepareSigCollector.addMsgWithCombinedSignature(m);
 
 			return retVal;
 		}
@@ -160,7 +220,7 @@ namespace bftEngine
 			Assert(replica->getReplicasInfo().myId() != m->senderId()); // TODO(GG): TBD
 			Assert(!forcedCompleted);
 
-			bool r = commitMsgsCollector->addMsgWithPartialSignature(m, m->senderId());
+			bool r = collectors().commitMsgsCollector.addMsgWithPartialSignature(m, m->senderId());
 
 			if (r) commitUpdateTime = getMonotonicTime();
 
@@ -176,10 +236,10 @@ namespace bftEngine
 			// set expected
 			Digest tmpDigest;
 			Digest::calcCombination(commitDigest, m->viewNumber(), m->seqNumber(), tmpDigest);
-			commitMsgsCollector->setExpected(m->seqNumber(), m->viewNumber(), tmpDigest);
+			collectors().commitMsgsCollector.setExpected(m->seqNumber(), m->viewNumber(), tmpDigest);
 
 			// add msg
-			bool r = commitMsgsCollector->addMsgWithPartialSignature(m, m->senderId());
+			bool r = collectors().commitMsgsCollector.addMsgWithPartialSignature(m, m->senderId());
 			Assert(r);
 
 			commitUpdateTime = getMonotonicTime();
@@ -193,7 +253,7 @@ namespace bftEngine
 			Assert(replica->getReplicasInfo().myId() != m->senderId()); // TODO(GG): TBD
 			Assert(!forcedCompleted);
 
-			bool r = commitMsgsCollector->addMsgWithCombinedSignature(m);
+			bool r = collectors().commitMsgsCollector.addMsgWithCombinedSignature(m);
 
 			if (r) commitUpdateTime = getMonotonicTime();
 
@@ -205,7 +265,7 @@ namespace bftEngine
 		{
 			Assert(!forcedCompleted);
 			Assert(hasPrePrepareMsg());
-			Assert(this->partialProofsSet->hasFullProof());
+			Assert(activeCollectors != nullptr && activeCollectors->partialProofsSet.hasFullProof());
 
 			forcedCompleted = true;
 			commitUpdateTime = getMonotonicTime();
@@ -227,7 +287,8 @@ namespace bftEngine
 
 		PreparePartialMsg* SeqNumInfo::getSelfPreparePartialMsg() const
 		{
-			PreparePartialMsg* p = prepareSigCollector->getPartialMsgFromReplica(replica->getReplicasInfo().myId());
+			if (activeCollectors == nullptr) return nullptr;
+			PreparePartialMsg* p = activeCollectors->prepareSigCollector.getPartialMsgFromReplica(replica->getReplicasInfo().myId());
 			return p;
 		}
 
@@ -235,19 +296,22 @@ namespace bftEngine
 
 		PrepareFullMsg* SeqNumInfo::getValidPrepareFullMsg() const
 		{
-			return prepareSigCollector->getMsgWithValidCombinedSignature();
+			if (activeCollectors == nullptr) return nullptr;
+			return activeCollectors->prepareSigCollector.getMsgWithValidCombinedSignature();
 		}
 
 
 		CommitPartialMsg* SeqNumInfo::getSelfCommitPartialMsg() const
 		{
-			CommitPartialMsg* p = commitMsgsCollector->getPartialMsgFromReplica(replica->getReplicasInfo().myId());
+			if (activeCollectors == nullptr) return nullptr;
+			CommitPartialMsg* p = activeCollectors->commitMsgsCollector.getPartialMsgFromReplica(replica->getReplicasInfo().myId());
 			return p;
 		}
 
 		CommitFullMsg* SeqNumInfo::getValidCommitFullMsg() const
 		{
-			return commitMsgsCollector->getMsgWithValidCombinedSignature();
+			if (activeCollectors == nullptr) return nullptr;
+			return activeCollectors->commitMsgsCollector.getMsgWithValidCombinedSignature();
 		}
 
 
@@ -258,7 +322,7 @@ namespace bftEngine
 
 
 		bool SeqNumInfo::isPrepared() const {
-			return forcedCompleted || ((prePrepareMsg != nullptr) && prepareSigCollector->isComplete());
+			return forcedCompleted || ((prePrepareMsg != nullptr) && (activeCollectors != nullptr) && activeCollectors->prepareSigCollector.isComplete());
 		}
 
 
@@ -266,20 +330,20 @@ namespace bftEngine
 		{
 			// TODO(GG): TBD - asserts on 'prepared'  
 
-			bool retVal = forcedCompleted || commitMsgsCollector->isComplete();
+			bool retVal = forcedCompleted || ((activeCollectors != nullptr) && activeCollectors->commitMsgsCollector.isComplete());
 			return retVal;
 		}
 
 
 		bool SeqNumInfo::preparedOrHasPreparePartialFromReplica(ReplicaId repId) const
 		{
-			return isPrepared() || prepareSigCollector->hasPartialMsgFromReplica(repId);
+			return isPrepared() || ((activeCollectors != nullptr) && activeCollectors->prepareSigCollector.hasPartialMsgFromReplica(repId));
 		}
 
 
 		bool SeqNumInfo::committedOrHasCommitPartialFromReplica(ReplicaId repId) const
 		{
-			return isCommitted__gg() || commitMsgsCollector->hasPartialMsgFromReplica(repId);
+			return isCommitted__gg() || ((activeCollectors != nullptr) && activeCollectors->commitMsgsCollector.hasPartialMsgFromReplica(repId));
 		}
 
 
@@ -295,12 +359,12 @@ namespace bftEngine
 
 		PartialProofsSet& SeqNumInfo::partialProofs()
 		{
-			return *partialProofsSet;
+			return collectors().partialProofsSet;
 		}
 
 		PartialExecProofsSet& SeqNumInfo::partialExecProofs()
 		{
-			return *partialExecProofsSet;
+			return collectors().partialExecProofsSet;
 		}
 
 
@@ -319,19 +383,42 @@ namespace bftEngine
 		}
 
 
+		// the results of background processing are ignored if the collectors were returned to the pool
+
 		void SeqNumInfo::onCompletionOfPrepareSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const std::set<ReplicaId>& replicasWithBadSigs)
 		{
-			prepareSigCollector->onCompletionOfSignaturesProcessing(seqNumber, viewNumber, replicasWithBadSigs);
+			if (activeCollectors == nullptr) return;
+			activeCollectors->prepareSigCollector.onCompletionOfSignaturesProcessing(seqNumber, viewNumber, replicasWithBadSigs);
 		}
 
 		void SeqNumInfo::onCompletionOfPrepareSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const char* combinedSig, uint16_t combinedSigLen)
 		{
-			prepareSigCollector->onCompletionOfSignaturesProcessing(seqNumber, viewNumber, combinedSig, combinedSigLen);
+			if (activeCollectors == nullptr) return;
+			activeCollectors->prepareSigCollector.onCompletionOfSignaturesProcessing(seqNumber, viewNumber, combinedSig, combinedSigLen);
 		}
 
 		void SeqNumInfo::onCompletionOfCombinedPrepareSigVerification(SeqNum seqNumber, ViewNum  viewNumber, bool isValid)
 		{
-			prepareSigCollector->onCompletionOfCombinedSigVerification(seqNumber, viewNumber, isValid);
+			if (activeCollectors == nullptr) return;
+			activeCollectors->prepareSigCollector.onCompletionOfCombinedSigVerification(seqNumber, viewNumber, isValid);
+		}
+
+		void SeqNumInfo::onCompletionOfCommitSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const std::set<uint16_t>& replicasWithBadSigs)
+		{
+			if (activeCollectors == nullptr) return;
+			activeCollectors->commitMsgsCollector.onCompletionOfSignaturesProcessing(seqNumber, viewNumber, replicasWithBadSigs);
+		}
+
+		void SeqNumInfo::onCompletionOfCommitSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const char* combinedSig, uint16_t combinedSigLen)
+		{
+			if (activeCollectors == nullptr) return;
+			activeCollectors->commitMsgsCollector.onCompletionOfSignaturesProcessing(seqNumber, viewNumber, combinedSig, combinedSigLen);
+		}
+
+		void SeqNumInfo::onCompletionOfCombinedCommitSigVerification(SeqNum seqNumber, ViewNum  viewNumber, bool isValid)
+		{
+			if (activeCollectors == nullptr) return;
+			activeCollectors->commitMsgsCollector.onCompletionOfCombinedSigVerification(seqNumber, viewNumber, isValid);
 		}
 
 
@@ -522,6 +609,12 @@ namespace bftEngine
 			return r->getInternalThreadPool();
 		}
 
+		ThresholdSigsCombiner& SeqNumInfo::ExFuncForPrepareCollector::sigsCombiner(void* context)
+		{
+			InternalReplicaApi* r = (InternalReplicaApi*)context;
+			return r->getThresholdSigsCombiner();
+		}
+
 		IncomingMsgsStorage& SeqNumInfo::ExFuncForPrepareCollector::incomingMsgsStorage(void* context)
 		{
 			InternalReplicaApi* r = (InternalReplicaApi*)context;
@@ -574,6 +667,12 @@ namespace bftEngine
 			return r->getInternalThreadPool();
 		}
 
+		ThresholdSigsCombiner& SeqNumInfo::ExFuncForCommitCollector::sigsCombiner(void* context)
+		{
+			InternalReplicaApi* r = (InternalReplicaApi*)context;
+			return r->getThresholdSigsCombiner();
+		}
+
 		IncomingMsgsStorage& SeqNumInfo::ExFuncForCommitCollector::incomingMsgsStorage(void* context)
 		{
 			InternalReplicaApi* r = (InternalReplicaApi*)context;
@@ -586,15 +685,67 @@ namespace bftEngine
 
 		void SeqNumInfo::init(SeqNumInfo& i, void* d)
 		{
-			void* context = d;
-			InternalReplicaApi* r = (InternalReplicaApi*)context;
+			CollectorsPool* p = (CollectorsPool*)d;
+
+			i.replica = p->replica();
+			i.pool = p;
+		}
 
-			i.replica = r;
 
-			i.prepareSigCollector = new CollectorOfThresholdSignatures<PreparePartialMsg, PrepareFullMsg, ExFuncForPrepareCollector>(context);
-			i.commitMsgsCollector = new CollectorOfThresholdSignatures<CommitPartialMsg, CommitFullMsg, ExFuncForCommitCollector>(context);
-			i.partialProofsSet = new PartialProofsSet((InternalReplicaApi*)r);
-			i.partialExecProofsSet = new PartialExecProofsSet((InternalReplicaApi*)r);
+		///////////////////////////////////////////////////////////////////////////////
+		// struct SeqNumInfo::Collectors and class SeqNumInfo::CollectorsPool
+		///////////////////////////////////////////////////////////////////////////////
+
+		SeqNumInfo::Collectors& SeqNumInfo::collectors()
+		{
+			if (activeCollectors == nullptr)
+				activeCollectors = pool->acquire();
+
+			return *activeCollectors;
+		}
+
+		SeqNumInfo::Collectors::Collectors(InternalReplicaApi* replica) :
+			prepareSigCollector(replica),
+			commitMsgsCollector(replica),
+			partialProofsSet(replica),
+			partialExecProofsSet(replica)
+		{
+		}
+
+		void SeqNumInfo::Collectors::resetAndFree()
+		{
+			prepareSigCollector.resetAndFree();
+			commitMsgsCollector.resetAndFree();
+			partialProofsSet.resetAndFree();
+			partialExecProofsSet.resetAndFree();
+		}
+
+		SeqNumInfo::CollectorsPool::CollectorsPool(InternalReplicaApi* replica, uint16_t initialSize) : r(replica)
+		{
+			freeCollectors.reserve(initialSize);
+			for (uint16_t i = 0; i < initialSize; i++)
+				freeCollectors.push_back(new Collectors(r));
+		}
+
+		SeqNumInfo::CollectorsPool::~CollectorsPool()
+		{
+			for (Collectors* c : freeCollectors)
+				delete c;
+		}
+
+		SeqNumInfo::Collectors* SeqNumInfo::CollectorsPool::acquire()
+		{
+			if (freeCollectors.empty())
+				return new Collectors(r);
+
+			Collectors* c = freeCollectors.back(); // the most recently released (probably in the cache)
+			freeCollectors.pop_back();
+			return c;
+		}
+
+		void SeqNumInfo::CollectorsPool::release(Collectors* c)
+		{
+			freeCollectors.push_back(c);
 		}
 
 	}
@@ -9,11 +9,13 @@
 #pragma once
 
 #include<set>
+#include<vector>
 
 // TODO(GG): clean/move 'include' statements
 #include "PrimitiveTypes.hpp"
 #include "SysConsts.hpp"
 #include "PrePrepareMsg.hpp"
+#include "PrePrepareDigestMsg.hpp"
 #include "SignedShareMsgs.hpp"
 #include "PartialProofsSet.hpp"
 #include "PartialExecProofsSet.hpp"
@@ -26,10 +28,35 @@ namespace bftEngine
 	namespace impl
 	{
 
+		// Information about a sequence number in the work window of the replica (an item of ReplicaImp::mainLog).
+		// A SeqNumInfo object only holds the state that is read when the window is scanned (flags, timestamps and
+		// pointers to messages), so the items of the window are compact. The collectors of the signed messages of the
+		// sequence number are allocated (from a CollectorsPool) only when they are used, and they are returned to the
+		// pool when the item is reset.
 		class SeqNumInfo
 		{
+		protected:
+			struct Collectors; // forward declaration
+
 		public:
 
+			// the collectors that are not used by the items of a window (initData of SequenceWithActiveWindow)
+			class CollectorsPool
+			{
+			public:
+				CollectorsPool(InternalReplicaApi* replica, uint16_t initialSize);
+				~CollectorsPool();
+
+				InternalReplicaApi* replica() const { return r; }
+
+				Collectors* acquire();
+				void release(Collectors* c); // c should be empty
+
+			private:
+				InternalReplicaApi* const r;
+				std::vector<Collectors*> freeCollectors;
+			};
+
 			SeqNumInfo();
 			~SeqNumInfo();
 
@@ -40,6 +67,14 @@ namespace bftEngine
 			bool addMsg(PrePrepareMsg* m);
 			bool addSelfMsg(PrePrepareMsg* m);
 
+			// used when the PrePrepareMsg is disseminated through relays (see ReplicaConfig::prePrepareFanout)
+			bool addMsg(PrePrepareDigestMsg* m);
+			// Holds m until the PrePrepareDigestMsg is added. Only the first message of each relay is held (so
+			// a faulty relay cannot replace the message of a correct one).
+			void holdRelayedPrePrepareMsg(PrePrepareMsg* m);
+			// returns a held message that matches the PrePrepareDigestMsg (or nullptr), and frees the others
+			PrePrepareMsg* takeRelayedPrePrepareMsg();
+
 			bool addMsg(PreparePartialMsg* m);
 			bool addSelfMsg(PreparePartialMsg* m);
 
@@ -54,6 +89,7 @@ namespace bftEngine
 
 			PrePrepareMsg* getPrePrepareMsg() const;
 			PrePrepareMsg* getSelfPrePrepareMsg() const;
+			PrePrepareDigestMsg* getPrePrepareDigestMsg() const { return prePrepareDigestMsg; }
 
 			PreparePartialMsg* getSelfPreparePartialMsg() const;
 			PrepareFullMsg* getValidPrepareFullMsg() const;
@@ -85,20 +121,9 @@ namespace bftEngine
 			void onCompletionOfPrepareSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const char* combinedSig, uint16_t combinedSigLen);
 			void onCompletionOfCombinedPrepareSigVerification(SeqNum seqNumber, ViewNum  viewNumber, bool isValid);
 
-			void onCompletionOfCommitSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const std::set<uint16_t>& replicasWithBadSigs)
-			{
-				commitMsgsCollector->onCompletionOfSignaturesProcessing(seqNumber, viewNumber, replicasWithBadSigs);
-			}
-
-			void onCompletionOfCommitSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const char* combinedSig, uint16_t combinedSigLen)
-			{
-				commitMsgsCollector->onCompletionOfSignaturesProcessing(seqNumber, viewNumber, combinedSig, combinedSigLen);
-			}
-
-			void onCompletionOfCombinedCommitSigVerification(SeqNum seqNumber, ViewNum  viewNumber, bool isValid)
-			{
-				commitMsgsCollector->onCompletionOfCombinedSigVerification(seqNumber, viewNumber, isValid);
-			}
+			void onCompletionOfCommitSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const std::set<uint16_t>& replicasWithBadSigs);
+			void onCompletionOfCommitSignaturesProcessing(SeqNum seqNumber, ViewNum  viewNumber, const char* combinedSig, uint16_t combinedSigLen);
+			void onCompletionOfCombinedCommitSigVerification(SeqNum seqNumber, ViewNum  viewNumber, bool isValid);
 
 
 		protected:
@@ -118,6 +143,7 @@ namespace bftEngine
 				static uint16_t numberOfRequiredSignatures(void* context);
 				static IThresholdVerifier* thresholdVerifier(void* context);
 				static SimpleThreadPool& threadPool(void* context);
+				static ThresholdSigsCombiner& sigsCombiner(void* context);
 				static IncomingMsgsStorage& incomingMsgsStorage(void* context);
 
 
@@ -138,18 +164,37 @@ namespace bftEngine
 				static uint16_t numberOfRequiredSignatures(void* context);
 				static IThresholdVerifier* thresholdVerifier(void* context);
 				static SimpleThreadPool& threadPool(void* context);
+				static ThresholdSigsCombiner& sigsCombiner(void* context);
 				static IncomingMsgsStorage& incomingMsgsStorage(void* context);
 			};
 
+			struct Collectors
+			{
+				Collectors(InternalReplicaApi* replica);
+
+				void resetAndFree();
+
+				CollectorOfThresholdSignatures<PreparePartialMsg, PrepareFullMsg, ExFuncForPrepareCollector> prepareSigCollector;
+				CollectorOfThresholdSignatures<CommitPartialMsg, CommitFullMsg, ExFuncForCommitCollector> commitMsgsCollector;
+
+				PartialProofsSet partialProofsSet; // TODO(GG): replace with an instance of CollectorOfThresholdSignatures
+				PartialExecProofsSet partialExecProofsSet; // TODO(GG): replace with an instance of CollectorOfThresholdSignatures
+			};
+
+			// the collectors of this item (acquired from the pool if needed)
+			Collectors& collectors();
+
 			InternalReplicaApi* replica = nullptr;
+			CollectorsPool* pool = nullptr;
 
 			PrePrepareMsg* prePrepareMsg;
 
-			CollectorOfThresholdSignatures<PreparePartialMsg, PrepareFullMsg, ExFuncForPrepareCollector>* prepareSigCollector;
-			CollectorOfThresholdSignatures<CommitPartialMsg, CommitFullMsg, ExFuncForCommitCollector>* commitMsgsCollector;
+			PrePrepareDigestMsg* prePrepareDigestMsg;
+			std::vector<PrePrepareMsg*> relayedPrePrepareMsgs; // received before prePrepareDigestMsg (from different relays)
+
+			void freeRelayedPrePrepareMsgs();
 
-			PartialProofsSet* partialProofsSet; // TODO(GG): replace with an instance of CollectorOfThresholdSignatures
-			PartialExecProofsSet* partialExecProofsSet; // TODO(GG): replace with an instance of CollectorOfThresholdSignatures
+			Collectors* activeCollectors; // nullptr if no signed message (or proof) was added
 
 			bool primary; // true iff PrePrepareMsg was added with addSelfMsg
 
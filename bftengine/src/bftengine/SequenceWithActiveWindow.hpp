@@ -19,30 +19,55 @@ namespace bftEngine
 	namespace impl
 	{
 
-		template <uint16_t WindowSize, uint16_t Resolution, typename NumbersType, typename ItemType, typename ItemFuncs>
+		// An active window of windowSize consecutive numbers (set at run time), with an item for every resolution
+		// numbers. The items are stored in a single array that is used as a ring buffer: its size is a power of two,
+		// so the item of a number is found with a mask (the items that are not in the active window are always reset).
+		template <typename NumbersType, typename ItemType, typename ItemFuncs>
 		class SequenceWithActiveWindow
 		{
-			static_assert(WindowSize >= 8, "");
-			static_assert(WindowSize < UINT16_MAX, "");
-			static_assert(Resolution >= 1, "");
-			static_assert(Resolution < WindowSize, "");
-			static_assert(WindowSize % Resolution == 0, "");
-
 		protected:
 
-			static const uint16_t numItems = WindowSize / Resolution;
+			const uint16_t windowSize;
+			const uint16_t resolution;
+			const uint16_t numItems;    // items in the active window
+			const uint32_t numSlots;    // size of activeWindow (a power of two, numSlots >= numItems)
+			const uint32_t slotsMask;
 
 			NumbersType beginningOfActiveWindow;
-			ItemType activeWindow[numItems];
+			ItemType* const activeWindow;
+
+			static uint32_t calcNumOfSlots(uint16_t numItems)
+			{
+				uint32_t n = 1;
+				while (n < numItems) n = n << 1;
+				return n;
+			}
+
+			uint32_t slotOf(NumbersType n) const
+			{
+				const NumbersType i = (resolution == 1) ? n : (n / resolution);
+				return (uint32_t)(i & slotsMask);
+			}
 
 		public:
-			SequenceWithActiveWindow(NumbersType windowFirst, void* initData)
+			SequenceWithActiveWindow(uint16_t windowSz, uint16_t res, NumbersType windowFirst, void* initData) :
+				windowSize{ windowSz },
+				resolution{ res },
+				numItems{ (uint16_t)(windowSz / res) },
+				numSlots{ calcNumOfSlots(windowSz / res) },
+				slotsMask{ calcNumOfSlots(windowSz / res) - 1 },
+				activeWindow{ new ItemType[calcNumOfSlots(windowSz / res)] }
 			{
-				Assert(windowFirst % Resolution == 0);
+				Assert(windowSize >= 8);
+				Assert(windowSize < UINT16_MAX);
+				Assert(resolution >= 1);
+				Assert(resolution < windowSize);
+				Assert(windowSize % resolution == 0);
+				Assert(windowFirst % resolution == 0);
 
 				beginningOfActiveWindow = windowFirst;
 
-				for (uint16_t i = 0; i < numItems; i++)
+				for (uint32_t i = 0; i < numSlots; i++)
 				{
 					ItemFuncs::init(activeWindow[i], initData);
 					ItemFuncs::reset(activeWindow[i]);
@@ -51,38 +76,41 @@ namespace bftEngine
 
 			~SequenceWithActiveWindow()
 			{
-				for (uint16_t i = 0; i < numItems; i++)
+				for (uint32_t i = 0; i < numSlots; i++)
 					ItemFuncs::free(activeWindow[i]);
+
+				delete[] activeWindow;
 			}
 
+			SequenceWithActiveWindow(const SequenceWithActiveWindow&) = delete;
+			SequenceWithActiveWindow& operator=(const SequenceWithActiveWindow&) = delete;
+
 			bool insideActiveWindow(NumbersType n) const
 			{
-				return((n >= beginningOfActiveWindow) && (n < (beginningOfActiveWindow + WindowSize)));
+				return((n >= beginningOfActiveWindow) && (n < (beginningOfActiveWindow + windowSize)));
 			}
 
 			ItemType& get(NumbersType n)
 			{
-				Assert(n % Resolution == 0);
+				Assert(n % resolution == 0);
 				Assert(insideActiveWindow(n));
 
-				uint16_t i = ((n / Resolution) % numItems);
-
-				return activeWindow[i];
+				return activeWindow[slotOf(n)];
 			}
 
 			std::pair<NumbersType, NumbersType> currentActiveWindow() const
 			{
 				std::pair<NumbersType, NumbersType> win;
 				win.first = beginningOfActiveWindow;
-				win.second = beginningOfActiveWindow + WindowSize - 1;
+				win.second = beginningOfActiveWindow + windowSize - 1;
 				return win;
 			}
 
 			void resetAll(NumbersType windowFirst)
 			{
-				Assert(windowFirst % Resolution == 0);
+				Assert(windowFirst % resolution == 0);
 
-				for (uint16_t i = 0; i < numItems; i++)
+				for (uint32_t i = 0; i < numSlots; i++)
 					ItemFuncs::reset(activeWindow[i]);
 
 				beginningOfActiveWindow = windowFirst;
@@ -91,36 +119,25 @@ namespace bftEngine
 
 			void advanceActiveWindow(NumbersType newFirstIndexOfActiveWindow)
 			{
-				Assert(newFirstIndexOfActiveWindow % Resolution == 0);
+				Assert(newFirstIndexOfActiveWindow % resolution == 0);
 				Assert(newFirstIndexOfActiveWindow >= beginningOfActiveWindow);
 
 				if (newFirstIndexOfActiveWindow == beginningOfActiveWindow)
 					return;
 
-				if (newFirstIndexOfActiveWindow - beginningOfActiveWindow >= WindowSize)
+				if (newFirstIndexOfActiveWindow - beginningOfActiveWindow >= windowSize)
 				{
 					resetAll(newFirstIndexOfActiveWindow);
 					return;
 				}
 
-				const uint16_t inactiveBegin = ((beginningOfActiveWindow / Resolution) % numItems);
-
-				const uint16_t activeBegin = ((newFirstIndexOfActiveWindow / Resolution) % numItems);
-
-				const uint16_t inactiveEnd = ((activeBegin > 0) ? (activeBegin - 1) : (numItems - 1));
-
-				const uint16_t resetSize = (inactiveBegin <= inactiveEnd) ? (inactiveEnd - inactiveBegin + 1) : (inactiveEnd + 1 + numItems - inactiveBegin);
+				// reset the items that leave the active window (the slots of the items that enter the active window
+				// were reset when their previous items left it)
+				const uint16_t resetSize = (uint16_t)((newFirstIndexOfActiveWindow - beginningOfActiveWindow) / resolution);
 				Assert(resetSize > 0 && resetSize < numItems);
 
-				uint16_t debugNumOfReset = 0;
-
-				for (uint16_t i = inactiveBegin; i != activeBegin; (i = ((i + 1) % numItems)))
-				{
-					ItemFuncs::reset(activeWindow[i]);
-					debugNumOfReset++;
-				}
-
-				Assert(debugNumOfReset == resetSize);
+				for (NumbersType n = beginningOfActiveWindow; n < newFirstIndexOfActiveWindow; n = n + resolution)
+					ItemFuncs::reset(activeWindow[slotOf(n)]);
 
 				beginningOfActiveWindow = newFirstIndexOfActiveWindow;
 			}
@@ -9,37 +9,77 @@
 #include "SigManager.hpp"
 #include "Crypto.hpp"
 #include "assertUtils.hpp"
+
+#include <vector>
  
 namespace bftEngine
 {
 	namespace impl
 	{
 
+		static ISigner* createSigner(SignatureScheme scheme, const char* privateKey)
+		{
+			switch (scheme)
+			{
+			case SignatureScheme::RSA:
+				return new RSASigner(privateKey);
+			case SignatureScheme::EdDSA:
+				return new EdDSASigner(privateKey);
+			}
+			Assert(false);
+			return nullptr;
+		}
+
+		static IVerifier* createVerifier(SignatureScheme scheme, const char* publicKey)
+		{
+			switch (scheme)
+			{
+			case SignatureScheme::RSA:
+				return new RSAVerifier(publicKey);
+			case SignatureScheme::EdDSA:
+				return new EdDSAVerifier(publicKey);
+			}
+			Assert(false);
+			return nullptr;
+		}
+
 		SigManager::SigManager(ReplicaId myId,
 			int16_t numberOfReplicasAndClients,
-			PrivateKeyDesc mySigPrivateKey, std::set<PublicKeyDesc> replicasSigPublicKeys)
+			PrivateKeyDesc mySigPrivateKey, std::set<PublicKeyDesc> replicasSigPublicKeys,
+			SignatureScheme scheme,
+			std::set<PublicKeyDesc> clientsSigPublicKeys)
 			: _myId{ myId }
 		{
 			//Assert(replicasSigPublicKeys.size() == numberOfReplicasAndClients); TODO(GG): change - here we don't care about client signatures
 
-			_mySigner = new RSASigner(mySigPrivateKey.c_str());
+			_mySigner = createSigner(scheme, mySigPrivateKey.c_str());
 
 			for (const PublicKeyDesc& p : replicasSigPublicKeys)
 			{
 				Assert(_replicasVerifiers.count(p.first) == 0);
 
-				RSAVerifier* verifier = new RSAVerifier(p.second.c_str());
+				IVerifier* verifier = createVerifier(scheme, p.second.c_str());
 				_replicasVerifiers[p.first] = verifier;
+				if (scheme == SignatureScheme::EdDSA) _eddsaVerifiers[p.first] = (EdDSAVerifier*)verifier;
 
 				Assert(p.first != myId || _mySigner->signatureLength() == verifier->signatureLength());
 			}
 
+			for (const PublicKeyDesc& p : clientsSigPublicKeys)
+			{
+				Assert(_replicasVerifiers.count(p.first) == 0);
+
+				EdDSAVerifier* verifier = new EdDSAVerifier(p.second.c_str());
+				_replicasVerifiers[p.first] = verifier;
+				_eddsaVerifiers[p.first] = verifier;
+			}
+
 		}
 
 		SigManager::~SigManager()
 		{
 			delete _mySigner;
-			for (std::pair<ReplicaId, RSAVerifier*> v : _replicasVerifiers)
+			for (std::pair<ReplicaId, IVerifier*> v : _replicasVerifiers)
 				delete v.second;
 		}
 
@@ -54,7 +94,7 @@ namespace bftEngine
 				auto pos = _replicasVerifiers.find(replicaId);
 				Assert(pos != _replicasVerifiers.end());
 
-				RSAVerifier* verifier = pos->second;
+				IVerifier* verifier = pos->second;
 
 				return (uint16_t)verifier->signatureLength();
 			}
@@ -65,13 +105,39 @@ namespace bftEngine
 			auto pos = _replicasVerifiers.find(replicaId);
 			Assert(pos != _replicasVerifiers.end());
 
-			RSAVerifier* verifier = pos->second;
+			IVerifier* verifier = pos->second;
 
 			bool res = verifier->verify(data, dataLength, sig, sigLength);
 
 			return res;
 		}
 
+		bool SigManager::verifySigs(size_t n, const ReplicaId* ids, const char* const* data, const size_t* dataLengths,
+			const char* const* sigs, const size_t* sigLengths) const
+		{
+			std::vector<EdDSAVerifier*> verifiers(n);
+			bool allEdDSA = true;
+			for (size_t i = 0; i < n && allEdDSA; i++)
+			{
+				auto pos = _eddsaVerifiers.find(ids[i]);
+				if (pos != _eddsaVerifiers.end())
+					verifiers[i] = pos->second;
+				else
+					allEdDSA = false;
+			}
+
+			if (allEdDSA) return EdDSAVerifier::verifyBatch(n, verifiers.data(), data, dataLengths, sigs, sigLengths);
+
+			for (size_t i = 0; i < n; i++)
+			{
+				auto pos = _replicasVerifiers.find(ids[i]);
+				Assert(pos != _replicasVerifiers.end());
+
+				if (!pos->second->verify(data[i], dataLengths[i], sigs[i], sigLengths[i])) return false;
+			}
+			return true;
+		}
+
 		void SigManager::sign(const char* data, size_t dataLength, char* outSig, uint16_t outSigLength)  const
 		{
 			size_t actualSigSize = 0;
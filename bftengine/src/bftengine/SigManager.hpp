@@ -8,6 +8,7 @@
 
 #pragma once
 #include "PrimitiveTypes.hpp"
+#include "ReplicaConfig.hpp"
 
 #include <utility>
 #include <set>
@@ -18,8 +19,9 @@ namespace bftEngine
 	namespace impl
 	{
 
-		class RSASigner;
-		class RSAVerifier;
+		class ISigner;
+		class IVerifier;
+		class EdDSAVerifier;
 
 		class SigManager
 		{
@@ -30,13 +32,22 @@ namespace bftEngine
 
 			SigManager(ReplicaId myId,
 				int16_t numberOfReplicasAndClients,
-				PrivateKeyDesc mySigPrivateKey, std::set<PublicKeyDesc> replicasSigPublicKeys);
+				PrivateKeyDesc mySigPrivateKey, std::set<PublicKeyDesc> replicasSigPublicKeys,
+				SignatureScheme scheme = SignatureScheme::RSA,
+				std::set<PublicKeyDesc> clientsSigPublicKeys = {}); // the keys of the clients are EdDSA keys
 
 			~SigManager();
 
 			uint16_t getSigLength(ReplicaId replicaId) const;
 			bool verifySig(ReplicaId replicaId, const char* data, size_t dataLength, const char* sig, uint16_t sigLength)  const;
 
+			// returns true iff the n signatures are valid (the signature i is verifySig(ids[i], data[i], ...)).
+			// EdDSA signatures are verified in a single batch.
+			bool verifySigs(size_t n, const ReplicaId* ids, const char* const* data, const size_t* dataLengths,
+				const char* const* sigs, const size_t* sigLengths) const;
+
+			bool hasPublicKeyOf(ReplicaId id) const { return (_replicasVerifiers.count(id) > 0); }
+
 			void sign(const char* data, size_t dataLength, char* outSig, uint16_t outSigLength)  const;
 			uint16_t getMySigLength()  const;
 
@@ -46,8 +57,10 @@ namespace bftEngine
 
 			const ReplicaId _myId;
 
-			RSASigner* _mySigner;
-			std::map<ReplicaId, RSAVerifier*> _replicasVerifiers;
+			ISigner* _mySigner;
+			std::map<ReplicaId, IVerifier*> _replicasVerifiers; // the verifiers of the replicas and of the clients
+
+			std::map<ReplicaId, EdDSAVerifier*> _eddsaVerifiers; // the verifiers of _replicasVerifiers that are EdDSA verifiers
 
 		};
 
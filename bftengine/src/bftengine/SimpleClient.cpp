@@ -24,6 +24,8 @@
 #include "DynamicUpperLimitWithSimpleFilter2.hpp"
 #include "Logger.hpp"
 #include "Digest.hpp"
+#include "RequestTracer.hpp"
+#include "Crypto.hpp"
 
 namespace bftEngine
 {
@@ -53,20 +55,10 @@ namespace bftEngine
 			virtual void onConnectionStatusChanged(const NodeNum node, const ConnectionStatus newStatus) override;
 
 			// used by  MsgsCertificate
+			// (tentative replies must also have the same view, SeqNum and history, see ClientReplyMsg::equivalent)
 			static bool equivalent(ClientReplyMsg *r1, ClientReplyMsg* r2) 
 			{
-				if (r1->reqSeqNum() != r2->reqSeqNum()) return false;
-
-				if (r1->currentPrimaryId() != r2->currentPrimaryId()) return false;
-
-				if (r1->replyLength() != r2->replyLength()) return false;
-
-				char* p1 = r1->replyBuf();
-				char* p2 = r2->replyBuf();
-
-				if (memcmp(p1, p2, r1->replyLength()) != 0) return false;
-
-				return true;
+				return ClientReplyMsg::equivalent(r1, r2);
 			}
 
 		protected:
@@ -81,6 +73,9 @@ namespace bftEngine
 
 			MsgsCertificate<ClientReplyMsg, false, false, true, SimpleClientImp> replysCertificate;
 
+			// replies of speculative executions (see SimpleClientParams::clientAcceptsTentativeReplies)
+			MsgsCertificate<ClientReplyMsg, false, false, true, SimpleClientImp> tentativeReplysCertificate;
+
 			std::mutex _lock; // protects _msgQueue and pendingRequest
 			std::condition_variable _condVar;
 
@@ -99,6 +94,11 @@ namespace bftEngine
 		  uint16_t clientSendsRequestToAllReplicasFirstThresh;
 		  uint16_t clientSendsRequestToAllReplicasPeriodThresh;
 		  uint16_t clientPeriodicResetThresh;
+		  bool clientSendsRequestToAllReplicas;
+		  bool clientAcceptsTentativeReplies;
+
+			// signs the requests (see SimpleClientParams::clientPrivateKey), or nullptr
+			EdDSASigner* _signer = nullptr;
 
 			void sendPendingRequest();
 
@@ -108,6 +108,8 @@ namespace bftEngine
 
 			void reset();
 
+			bool replyIsComplete() const { return replysCertificate.isComplete() || tentativeReplysCertificate.isComplete(); }
+
 		};
 
 		void SimpleClientImp::onMessageFromReplica(MessageBase* msg)
@@ -120,7 +122,7 @@ namespace bftEngine
 				return;
 			}
 			Assert(replyMsg != nullptr);
-			Assert(replyMsg->type() == REPLY_MSG_TYPE);
+			Assert(replyMsg->type() == REPLY_MSG_TYPE || replyMsg->type() == TENTATIVE_REPLY_MSG_TYPE);
 
  			LOG_INFO_F(GL, "Client %d received ClientReplyMsg with seqNum=%"
 			PRIu64
@@ -134,12 +136,14 @@ namespace bftEngine
 				return;
 			}
                        
-			replysCertificate.addMsg(replyMsg, replyMsg->senderId());
+			auto& certificate = replyMsg->isTentative() ? tentativeReplysCertificate : replysCertificate;
 
-			if (replysCertificate.isInconsistent())
+			certificate.addMsg(replyMsg, replyMsg->senderId());
+
+			if (certificate.isInconsistent())
 			{
 				// TODO(GG): print .....
-				replysCertificate.resetAndFree();
+				certificate.resetAndFree();
 			}
 		}
 
@@ -166,12 +170,15 @@ namespace bftEngine
 			_replicas{ generateSetOfReplicas_helpFunc(3 * fVal + 2 * cVal + 1) },
 			_communication{ communication },
 			replysCertificate(3 * fVal + 2 * cVal + 1, fVal, 2 * fVal + cVal + 1, clientId),
+			tentativeReplysCertificate(3 * fVal + 2 * cVal + 1, fVal, 3 * fVal + cVal + 1, clientId),
 			limitOfExpectedOperationTime(p.clientInitialRetryTimeoutMilli, 2,
 					p.clientMaxRetryTimeoutMilli, p.clientMinRetryTimeoutMilli,
 					32, 1000, 2, 2),
 			clientSendsRequestToAllReplicasFirstThresh{p.clientSendsRequestToAllReplicasFirstThresh},
 			clientSendsRequestToAllReplicasPeriodThresh{p.clientSendsRequestToAllReplicasPeriodThresh},
-			clientPeriodicResetThresh{p.clientPeriodicResetThresh}
+			clientPeriodicResetThresh{p.clientPeriodicResetThresh},
+			clientSendsRequestToAllReplicas{p.clientSendsRequestToAllReplicas},
+			clientAcceptsTentativeReplies{p.clientAcceptsTentativeReplies}
 		{
 				Assert(_fVal >= 1);
 				//Assert(!_communication->isRunning());
@@ -185,16 +192,21 @@ namespace bftEngine
 				_primaryReplicaIsKnown = false;
 				_knownPrimaryReplica = 0;
 
+				if (!p.clientPrivateKey.empty()) _signer = new EdDSASigner(p.clientPrivateKey.c_str());
+
 				_communication->setReceiver(_clientId, this);
 		}
 
 		SimpleClientImp::~SimpleClientImp() 
 		{
 			Assert(replysCertificate.isEmpty());
+			Assert(tentativeReplysCertificate.isEmpty());
 			Assert(_msgQueue.empty());
 			Assert(pendingRequest == nullptr);
 			Assert(timeOfLastTransmission == MinTime);
 			Assert(numberOfTransmissions == 0);
+
+			delete _signer;
 		}
 
 		int SimpleClientImp::sendRequest(bool isReadOnly, const char* request, uint32_t lengthOfRequest, uint64_t reqSeqNum, uint64_t timeoutMilli, uint32_t lengthOfReplyBuffer, char* replyBuffer, uint32_t& actualReplyLength)
@@ -211,6 +223,7 @@ namespace bftEngine
 			}
 
 			Assert(replysCertificate.isEmpty());
+			Assert(tentativeReplysCertificate.isEmpty());
 			Assert(_msgQueue.empty());
 			Assert(pendingRequest == nullptr);
 			Assert(timeOfLastTransmission == MinTime);
@@ -220,9 +233,17 @@ namespace bftEngine
 
 			const Time beginTime = getMonotonicTime();
 
-			ClientRequestMsg* reqMsg = new ClientRequestMsg(_clientId, isReadOnly, reqSeqNum, lengthOfRequest, request);
+			ClientRequestMsg* reqMsg = new ClientRequestMsg(_clientId, isReadOnly, reqSeqNum, lengthOfRequest, request, _signer != nullptr);
 			pendingRequest = reqMsg;
-			
+
+			if (RequestTracer::sample())
+			{
+				reqMsg->setAsTraced();
+				RequestTracer::record(_clientId, _clientId, reqSeqNum, ClientSent);
+			}
+
+			if (_signer != nullptr) reqMsg->sign(*_signer);
+
 			sendPendingRequest();
 
 			bool requestTimeout = false;
@@ -239,7 +260,7 @@ namespace bftEngine
 				
 				while (!newMsgs.empty())
 				{
-					if (replysCertificate.isComplete())
+					if (replyIsComplete())
 					{
 						delete newMsgs.front();
 					}
@@ -251,7 +272,7 @@ namespace bftEngine
 					newMsgs.pop();
 				}
 
-				if (replysCertificate.isComplete())
+				if (replyIsComplete())
 				{
 					requestCommitted = true;
 					break;
@@ -275,7 +296,9 @@ namespace bftEngine
 
 			if (requestCommitted)
 			{
-				Assert(replysCertificate.isComplete());
+				Assert(replyIsComplete());
+
+				if (pendingRequest->isTraced()) RequestTracer::record(_clientId, _clientId, reqSeqNum, ClientReplyReceived);
 
 				uint64_t durationMilli = ((uint64_t)absDifference(getMonotonicTime(), beginTime)) / 1000;
 				limitOfExpectedOperationTime.add(durationMilli);
@@ -284,7 +307,8 @@ namespace bftEngine
 										  "(isRO=%d, request size=%zu,  retransmissionMilli=%d) ",
 					_clientId, reqSeqNum, (int)isReadOnly, (size_t)lengthOfRequest,  (int)limitOfExpectedOperationTime.upperLimit());
 
-				ClientReplyMsg* correctReply = replysCertificate.bestCorrectMsg();
+				ClientReplyMsg* correctReply = replysCertificate.isComplete() ?
+					replysCertificate.bestCorrectMsg() : tentativeReplysCertificate.bestCorrectMsg();
 
 				_primaryReplicaIsKnown = true;
 				_knownPrimaryReplica = correctReply->currentPrimaryId();
@@ -331,6 +355,7 @@ namespace bftEngine
 		void SimpleClientImp::reset()
 		{
 			replysCertificate.resetAndFree();
+			tentativeReplysCertificate.resetAndFree();
 
 			queue<MessageBase*> newMsgs;
 			{
@@ -371,7 +396,8 @@ namespace bftEngine
 			MessageBase::Header* msgHeader = (MessageBase::Header*)message;
 
 			// check type
-			if (msgHeader->msgType != REPLY_MSG_TYPE) return;
+			if (msgHeader->msgType != REPLY_MSG_TYPE &&
+				(msgHeader->msgType != TENTATIVE_REPLY_MSG_TYPE || !clientAcceptsTentativeReplies)) return;
 
 			std::unique_lock<std::mutex> mlock(_lock);
 			{
@@ -400,7 +426,7 @@ namespace bftEngine
 
 			const bool resetReplies = (numberOfTransmissions % clientPeriodicResetThresh == 0);
 
-			const bool sendToAll = pendingRequest->isReadOnly() || !_primaryReplicaIsKnown || 
+			const bool sendToAll = clientSendsRequestToAllReplicas || pendingRequest->isReadOnly() || !_primaryReplicaIsKnown || 
 				                   (numberOfTransmissions == clientSendsRequestToAllReplicasFirstThresh) ||
 								   (numberOfTransmissions > clientSendsRequestToAllReplicasFirstThresh && (numberOfTransmissions % clientSendsRequestToAllReplicasPeriodThresh == 0)) ||
 								   resetReplies;
@@ -417,6 +443,7 @@ namespace bftEngine
 			if (resetReplies)
 			{
 				replysCertificate.resetAndFree();
+				tentativeReplysCertificate.resetAndFree();
 				// TODO(GG): print ....
 			}
 
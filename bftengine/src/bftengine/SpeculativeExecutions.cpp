@@ -0,0 +1,88 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License.
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include "SpeculativeExecutions.hpp"
+#include "Crypto.hpp"
+#include "assertUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		SpeculativeExecutions::SpeculativeExecutions(RequestsHandler* handler) : handler(handler)
+		{
+			Assert(handler != nullptr);
+		}
+
+		const Digest& SpeculativeExecutions::lastHistoryDigest() const
+		{
+			Assert(!executions.empty());
+			return executions.back().historyDigest;
+		}
+
+		ReqId SpeculativeExecutions::lastReqSeqNumOf(NodeIdType clientId) const
+		{
+			ReqId retVal = 0;
+			for (const Execution& e : executions)
+				for (const Reply& r : e.replies)
+					if (r.clientId == clientId && r.reqSeqNum > retVal) retVal = r.reqSeqNum;
+			return retVal;
+		}
+
+		void SpeculativeExecutions::add(SeqNum seqNum, const Digest& digestOfRequests, const Digest& historyDigest, std::vector<Reply>&& replies)
+		{
+			Assert(executions.empty() || executions.back().seqNum + 1 == seqNum);
+
+			executions.push_back(Execution{ seqNum, digestOfRequests, historyDigest, std::move(replies) });
+		}
+
+		const std::vector<SpeculativeExecutions::Reply>* SpeculativeExecutions::repliesOf(SeqNum seqNum, const Digest& digestOfRequests)
+		{
+			if (executions.empty()) return nullptr;
+
+			Assert(executions.front().seqNum == seqNum);
+
+			if (executions.front().digestOfRequests != digestOfRequests)
+			{
+				rollback(seqNum - 1);
+				return nullptr;
+			}
+
+			return &executions.front().replies;
+		}
+
+		void SpeculativeExecutions::commit(SeqNum seqNum)
+		{
+			Assert(!executions.empty() && executions.front().seqNum == seqNum);
+
+			handler->commitSpeculative(seqNum);
+			executions.pop_front();
+		}
+
+		void SpeculativeExecutions::rollback(SeqNum lastExecutedSeqNum)
+		{
+			if (executions.empty()) return;
+
+			Assert(executions.front().seqNum == lastExecutedSeqNum + 1);
+
+			handler->rollbackSpeculative(lastExecutedSeqNum);
+			executions.clear();
+		}
+
+		void SpeculativeExecutions::calcHistoryDigest(const Digest& prevHistoryDigest, SeqNum seqNum, const Digest& digestOfRequests, Digest& outDigest)
+		{
+			DigestUtil::Context c;
+			c.update(prevHistoryDigest.content(), sizeof(Digest));
+			c.update(reinterpret_cast<const char*>(&seqNum), sizeof(seqNum));
+			c.update(digestOfRequests.content(), sizeof(Digest));
+			c.writeDigest(outDigest.content());
+		}
+
+	}
+}
@@ -0,0 +1,83 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License.
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "PrimitiveTypes.hpp"
+#include "Digest.hpp"
+#include "Replica.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+		// The results of the speculative executions of the SeqNums (lastExecutedSeqNum, lastExecutedSeqNum + size()]
+		// (see ReplicaConfig::speculativeExecution). The speculative versions of the state are kept by the RequestsHandler;
+		// this class commits or discards them.
+		//
+		// Each speculative SeqNum s has a history digest: h(cp) is the zero digest, where cp is the last checkpoint
+		// before s, and h(k) = H(h(k-1) || k || digestOfRequests(k)) for cp < k <= s. A tentative reply carries
+		// <view, s, h(s)>, so replicas that send equivalent tentative replies executed the same requests at the same
+		// SeqNums since the last checkpoint.
+		class SpeculativeExecutions
+		{
+		public:
+			struct Reply
+			{
+				NodeIdType clientId;
+				ReqId reqSeqNum;
+				std::string reply;
+			};
+
+			explicit SpeculativeExecutions(RequestsHandler* handler);
+
+			bool empty() const { return executions.empty(); }
+
+			size_t size() const { return executions.size(); }
+
+			// the history digest of the last speculative SeqNum (only if !empty())
+			const Digest& lastHistoryDigest() const;
+
+			// the largest request sequence number of clientId that was executed speculatively (0 if none)
+			ReqId lastReqSeqNumOf(NodeIdType clientId) const;
+
+			// adds the speculative execution of seqNum (the SeqNum after the last speculative SeqNum)
+			void add(SeqNum seqNum, const Digest& digestOfRequests, const Digest& historyDigest, std::vector<Reply>&& replies);
+
+			// returns the replies of seqNum (the next SeqNum to commit) if it was executed speculatively with the same
+			// requests. Otherwise, all the speculative executions are rolled back and nullptr is returned.
+			const std::vector<Reply>* repliesOf(SeqNum seqNum, const Digest& digestOfRequests);
+
+			// commits the speculative execution of seqNum (after repliesOf(seqNum, ...) returned its replies)
+			void commit(SeqNum seqNum);
+
+			// discards all the speculative executions (e.g. after a view change)
+			void rollback(SeqNum lastExecutedSeqNum);
+
+			// h(seqNum), given h(seqNum - 1)
+			static void calcHistoryDigest(const Digest& prevHistoryDigest, SeqNum seqNum, const Digest& digestOfRequests, Digest& outDigest);
+
+		protected:
+			struct Execution
+			{
+				SeqNum seqNum;
+				Digest digestOfRequests;
+				Digest historyDigest;
+				std::vector<Reply> replies; // of the requests that were executed, in their order in the PrePrepareMsg
+			};
+
+			RequestsHandler* const handler;
+			std::deque<Execution> executions;
+		};
+	}
+}
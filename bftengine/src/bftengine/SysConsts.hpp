@@ -38,37 +38,63 @@ constexpr int MaxNumberOfReplicas = 128;
 constexpr int MaxNumberOfReplicas = 64;
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// Messages
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr uint32_t maxExternalMessageSize = 64 * 1000; // TODO(GG): some message types may need different values  
+
+constexpr uint32_t maxReplyMessageSize = 8 * 1024;
+
+constexpr uint32_t maxSizeOfMsgsBatch = 8 * 1024; // used if ReplicaConfig::coalesceMessages is true
+
 ///////////////////////////////////////////////////////////////////////////////
 // Work windows and intervals
 ///////////////////////////////////////////////////////////////////////////////
 
-constexpr uint16_t kWorkWindowSize = 300;
+// The work window of a replica has 2 * checkpointWindowSize sequence numbers (see ReplicaConfig::checkpointWindowSize
+// and ReplicaConfig::maxConcurrentFastPaths)
 
-constexpr uint16_t checkpointWindowSize = 150;
-static_assert(kWorkWindowSize == 2 * checkpointWindowSize, "kWorkWindowSize != 2 * checkpointWindowSize");
+constexpr uint16_t minCheckpointWindowSize = 8;
 
-constexpr uint16_t maxLegalConcurrentAgreementsByPrimary = 16; // TODO(GG): check the value in config (maxConcurrentAgreementsByPrimary should be <= maxLegalConcurrentAgreementsByPrimary)
+// a ViewChangeMsg may have an element with a prepared certificate for each SeqNum in the work window: a header
+// (24B), and 2 * checkpointWindowSize elements of 49B + 10B (and the signature of the certificate), followed by
+// the signature of the replica, should fit in maxExternalMessageSize. This is the limit without the signatures;
+// the actual limit depends on their sizes, and is checked when the replica starts (see ViewChangeMsg::maxNumOfElements)
+constexpr uint16_t maxCheckpointWindowSize = (maxExternalMessageSize - 24) / (2 * (49 + 10));
 
+constexpr uint16_t maxSpeculativeSeqNums = 16; // max number of SeqNums that are executed speculatively (if ReplicaConfig::speculativeExecution is true, and at most maxConcurrentFastPaths)
 
-// Maximum number of fast paths that are simultaneously in progress.
-constexpr uint16_t MaxConcurrentFastPaths = 75;
-static_assert(kWorkWindowSize > MaxConcurrentFastPaths + checkpointWindowSize, "Violation of kWorkWindowSize > MaxConcurrentFastPaths + checkpointWindowSize");
-static_assert(maxLegalConcurrentAgreementsByPrimary < MaxConcurrentFastPaths, "Violation of maxConcurrentAgreementsByPrimary < MaxConcurrentFastPaths");
 
+///////////////////////////////////////////////////////////////////////////////
+// Batching
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr uint32_t maxNumOfRequestsInBatch = 1024;
 
 ///////////////////////////////////////////////////////////////////////////////
-// Messages
+// Digest of requests (see RequestsMerkleTree)
 ///////////////////////////////////////////////////////////////////////////////
 
-constexpr uint32_t maxExternalMessageSize = 64 * 1000; // TODO(GG): some message types may need different values  
+// number of threads (in addition to the calling thread) used to validate the digest of requests in a PrePrepareMsg
+constexpr uint16_t numOfThreadsForRequestsDigest = 3;
 
-constexpr uint32_t maxReplyMessageSize = 8 * 1024;
+// the digest of requests is computed in parallel only if a PrePrepareMsg has at least this number of requests
+constexpr uint32_t minNumOfRequestsForParallelDigest = 64;
 
 ///////////////////////////////////////////////////////////////////////////////
-// Batching
+// Combining of threshold signatures (see ThresholdSigsCombiner)
 ///////////////////////////////////////////////////////////////////////////////
 
-constexpr uint32_t maxNumOfRequestsInBatch = 1024;
+// max number of threshold signatures (of different sequence numbers) that are combined and verified in one batch
+constexpr uint16_t maxNumOfSigsInCombiningBatch = 32;
+
+///////////////////////////////////////////////////////////////////////////////
+// Requests multicast by clients (see RequestsCache and CompactPrePrepareMsg)
+///////////////////////////////////////////////////////////////////////////////
+
+// max number of client requests that are cached by a replica
+constexpr uint32_t maxNumOfRequestsInCache = 4096;
 
 ///////////////////////////////////////////////////////////////////////////////
 // Requests for missing information 
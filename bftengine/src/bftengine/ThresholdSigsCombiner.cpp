@@ -0,0 +1,120 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#include <algorithm>
+
+#include "ThresholdSigsCombiner.hpp"
+#include "Crypto.hpp"
+#include "assertUtils.hpp"
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		class ThresholdSigsCombiner::CombiningJob : public SimpleThreadPool::Job
+		{
+		public:
+			CombiningJob(ThresholdSigsCombiner* c, IThresholdVerifier* v) : combiner{ c }, verifier{ v } {}
+
+			virtual void execute() override
+			{
+				combiner->combineBatch(verifier);
+			}
+
+			virtual void release() override
+			{
+				delete this;
+			}
+
+		protected:
+			virtual ~CombiningJob() {}
+
+			ThresholdSigsCombiner* const combiner;
+			IThresholdVerifier* const verifier;
+		};
+
+		ThresholdSigsCombiner::ThresholdSigsCombiner(SimpleThreadPool& pool, uint16_t maxSize) :
+			threadPool(pool), maxBatchSize{ maxSize }
+		{
+			Assert(maxBatchSize > 0);
+		}
+
+		ThresholdSigsCombiner::~ThresholdSigsCombiner()
+		{
+			for (auto& p : pendingItems)
+				for (Item* item : p.second.items) item->release();
+		}
+
+		void ThresholdSigsCombiner::add(IThresholdVerifier* verifier, Item* item)
+		{
+			Assert(verifier != nullptr && item != nullptr);
+
+			bool addJob = false;
+			{
+				std::lock_guard<std::mutex> g(lock);
+				PendingItems& p = pendingItems[verifier];
+				p.items.push_back(item);
+				if (!p.jobInThreadPool)
+				{
+					p.jobInThreadPool = true;
+					addJob = true;
+				}
+			}
+
+			if (addJob) threadPool.add(new CombiningJob(this, verifier));
+		}
+
+		void ThresholdSigsCombiner::combineBatch(IThresholdVerifier* verifier)
+		{
+			std::vector<Item*> batch;
+			bool addJob = false;
+			{
+				std::lock_guard<std::mutex> g(lock);
+				PendingItems& p = pendingItems[verifier];
+				const size_t n = std::min(p.items.size(), (size_t)maxBatchSize);
+				batch.assign(p.items.begin(), p.items.begin() + n);
+				p.items.erase(p.items.begin(), p.items.begin() + n);
+				if (p.items.empty())
+					p.jobInThreadPool = false;
+				else
+					addJob = true; // the remaining items can be processed by another thread
+			}
+
+			if (addJob) threadPool.add(new CombiningJob(this, verifier));
+
+			if (batch.empty()) return;
+
+			const int num = (int)batch.size();
+			const uint16_t sigLen = (uint16_t)verifier->requiredLengthForSignedData();
+
+			std::vector<IThresholdAccumulator*> accs(num);
+			std::vector<const char*> msgs(num);
+			std::vector<int> msgLens(num, (int)sizeof(Digest));
+			std::vector<char> sigsBuffer((size_t)num * sigLen);
+			std::vector<char*> sigs(num);
+			for (int i = 0; i < num; i++)
+			{
+				accs[i] = batch[i]->createAccumulator(verifier);
+				msgs[i] = (const char*)&batch[i]->signedDigest();
+				sigs[i] = sigsBuffer.data() + (size_t)i * sigLen;
+			}
+
+			std::vector<bool> valid;
+			verifier->combineAndVerify(accs.data(), msgs.data(), msgLens.data(), num, sigs.data(), valid);
+
+			for (int i = 0; i < num; i++)
+			{
+				verifier->release(accs[i]);
+				batch[i]->onCombined(verifier, sigs[i], sigLen, valid[i]);
+				batch[i]->release();
+			}
+		}
+
+	}
+}
@@ -0,0 +1,82 @@
+//Concord
+//
+//Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+//This product is licensed to you under the Apache 2.0 license (the "License").  You may not use this product except in compliance with the Apache 2.0 License. 
+//
+//This product may include a number of subcomponents with separate copyright notices and license terms. Your use of these subcomponents is subject to the terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Digest.hpp"
+#include "SimpleThreadPool.hpp"
+
+class IThresholdVerifier;
+class IThresholdAccumulator;
+
+namespace bftEngine
+{
+	namespace impl
+	{
+
+		// Combines the threshold signatures of several sequence numbers in batches.
+		// Items whose shares are ready are queued per verifier, and a single job of the thread pool takes all the
+		// items of its verifier (up to maxNumOfSigsInCombiningBatch) and passes them to
+		// IThresholdVerifier::combineAndVerify (which shares the Lagrange coefficients of identical sets of signers and
+		// verifies all the signatures together).
+		// Items are only accumulated while the pool is busy, so an idle replica does not wait for a batch.
+		class ThresholdSigsCombiner
+		{
+		public:
+
+			class Item
+			{
+			public:
+				// returns an accumulator that has all the required shares and the expected digest
+				// (called from a thread of the pool; the accumulator is released by the combiner)
+				virtual IThresholdAccumulator* createAccumulator(IThresholdVerifier* verifier) = 0;
+
+				// the digest that is signed by the shares
+				virtual const Digest& signedDigest() const = 0;
+
+				// called from a thread of the pool, with the assembled signature
+				virtual void onCombined(IThresholdVerifier* verifier, const char* sig, uint16_t sigLen, bool isValid) = 0;
+
+				virtual void release() = 0;
+
+			protected:
+				~Item() {} // should not be deleted directly - use release()
+			};
+
+			ThresholdSigsCombiner(SimpleThreadPool& threadPool, uint16_t maxBatchSize);
+
+			~ThresholdSigsCombiner(); // releases the items that were not processed
+
+			// the combiner takes ownership of item (thread-safe)
+			void add(IThresholdVerifier* verifier, Item* item);
+
+		protected:
+			class CombiningJob;
+
+			struct PendingItems
+			{
+				std::vector<Item*> items;
+				bool jobInThreadPool = false;
+			};
+
+			void combineBatch(IThresholdVerifier* verifier);
+
+			SimpleThreadPool& threadPool;
+			const uint16_t maxBatchSize;
+
+			std::mutex lock;
+			std::map<IThresholdVerifier*, PendingItems> pendingItems;
+		};
+
+	}
+}
@@ -8,6 +8,7 @@
 
 
 #include <string.h>
+#include <algorithm>
   
 #include "assertUtils.hpp"
 #include "ViewChangeMsg.hpp"
@@ -44,10 +45,10 @@ namespace bftEngine
 			bool   hasPreparedCertificate, ViewNum     certificateView,
 			uint16_t certificateSigLength, const char* certificateSig)
 		{
-			Assert(b()->numberOfElements < kWorkWindowSize);
+			Assert(b()->numberOfElements < repInfo.workWindowSize());
 			Assert(b()->numberOfElements > 0 || b()->locationAfterLast == 0);
 			Assert(seqNum > b()->lastStable);
-			Assert(seqNum <= b()->lastStable + kWorkWindowSize);
+			Assert(seqNum <= b()->lastStable + repInfo.workWindowSize());
 
 			if (b()->locationAfterLast == 0) // if this is the first element
 			{
@@ -59,7 +60,7 @@ namespace bftEngine
 			if (hasPreparedCertificate)
 				requiredSpace += (sizeof(PreparedCertificate) + certificateSigLength);
 
-			// TODO(GG): we should make sure that this assert will never be violated (by calculating the maximum  size of a ViewChangeMsg message required for the actual configuration)
+			// the signature sizes are checked when the replica starts (see maxNumOfElements)
 			Assert((size_t)(requiredSpace + repInfo.mySigManager().getMySigLength()) <= (size_t)internalStorageSize());
 
 			Element* pElement = (Element*)(body() + b()->locationAfterLast);
@@ -96,7 +97,7 @@ namespace bftEngine
 
 			repInfo.mySigManager().sign(body(), bodySize, body() + bodySize, sigSize);
 
-			bool b = checkElements((uint16_t)sigSize);
+			bool b = checkElements(repInfo, (uint16_t)sigSize);
 
 			Assert(b);
 		}
@@ -126,7 +127,7 @@ namespace bftEngine
 			if (!sigOkay) return false;
 
 				// check elements in message
-			bool elementsOkay = t->checkElements(sigLen);
+			bool elementsOkay = t->checkElements(repInfo, sigLen);
 			if (!elementsOkay) return false;
 
 			// TODO(GG): TBD -  more?
@@ -136,7 +137,7 @@ namespace bftEngine
 		}
 
 
-		bool ViewChangeMsg::checkElements(uint16_t sigSize) const
+		bool ViewChangeMsg::checkElements(const ReplicasInfo& repInfo, uint16_t sigSize) const
 		{
 			SeqNum lastSeqNumInMsg = lastStable();
 			uint16_t numOfActualElements = 0;
@@ -150,7 +151,7 @@ namespace bftEngine
 				if (pElement->seqNum <= lastSeqNumInMsg) return false; // elements should be sorted by seq number
 				lastSeqNumInMsg = pElement->seqNum;
 
-				if (lastSeqNumInMsg > lastStable() + kWorkWindowSize) return false;
+				if (lastSeqNumInMsg > lastStable() + repInfo.workWindowSize()) return false;
 
 				if (pElement->originView >= newView()) return false;
 
@@ -305,5 +306,14 @@ namespace bftEngine
 			return maxSizeOfViewChangeMsg() + sizeof(RawHeaderOfObjAndMsg);
 		}
 
+		uint16_t ViewChangeMsg::maxNumOfElements(uint16_t certificateSigLength, uint16_t replicaSigLength)
+		{
+			const size_t fixedSize = sizeof(ViewChangeMsgHeader) + replicaSigLength;
+			if (fixedSize >= maxExternalMessageSize) return 0;
+
+			const size_t elementSize = sizeof(Element) + sizeof(PreparedCertificate) + certificateSigLength;
+			return (uint16_t)std::min((size_t)UINT16_MAX, (maxExternalMessageSize - fixedSize) / elementSize);
+		}
+
 	}
 }
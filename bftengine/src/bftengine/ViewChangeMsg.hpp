@@ -46,6 +46,10 @@ namespace bftEngine
 			static MsgSize maxSizeOfViewChangeMsg();
 			static MsgSize maxSizeOfViewChangeMsgInLocalBuffer();
 
+			// the maximum number of elements with prepared certificates that fit in a ViewChangeMsg, for the given sizes
+			// of the certificate signature and the signature of the replica
+			static uint16_t maxNumOfElements(uint16_t certificateSigLength, uint16_t replicaSigLength);
+
 			void setNewViewNumber(ViewNum newView);
 
 			uint16_t idOfGeneratedReplica() const { return b()->genReplicaId; } // TODO(GG): !!!! change meaning/add similar method - this msg may be sent by a different replica (otherwise, the view-change may not completed)
@@ -105,10 +109,12 @@ namespace bftEngine
 			};
 #pragma pack(pop)
 			static_assert(sizeof(ViewChangeMsgHeader) == (2 + 2 + 8 + 8 + 2 + 2), "ViewChangeMsgHeader is 24B");
+			static_assert(sizeof(ViewChangeMsgHeader) + 2 * (size_t)maxCheckpointWindowSize * (sizeof(Element) + sizeof(PreparedCertificate)) <= maxExternalMessageSize,
+				"maxCheckpointWindowSize is too large");
 
 			ViewChangeMsgHeader* b() const { return ((ViewChangeMsgHeader*)msgBody_); }
 
-			bool checkElements(uint16_t sigSize) const;
+			bool checkElements(const ReplicasInfo& repInfo, uint16_t sigSize) const;
 		};
 
 
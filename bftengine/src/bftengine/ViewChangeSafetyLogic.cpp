@@ -8,12 +8,19 @@
 
 
 #include "ViewChangeSafetyLogic.hpp"
+#include "SimpleThreadPool.hpp"
 #include "threshsign/IThresholdVerifier.h"
 #include "assertUtils.hpp"
 #include "Logger.hpp"
 
 #include <set>
+#include <map>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 namespace bftEngine
 {
@@ -144,16 +151,126 @@ namespace bftEngine
 		}
 
 
+		///////////////////////////////////////////////////////////////////////////////
+		// Parallel verification of prepared certificates
+		///////////////////////////////////////////////////////////////////////////////
+
+		struct CertificateCandidate
+		{
+			ViewChangeSafetyLogic::PreparedCertificateKey key;
+			bool alreadyVerified;
+			std::vector<SlowElem> elems; // elements that contain this certificate (with different signatures)
+		};
+
+		struct CertificatesOfSeqNum
+		{
+			std::vector<CertificateCandidate> candidates; // sorted by view (highest first)
+			int selected = -1; // index of the first valid candidate
+		};
+
+		class PreparedCertificatesVerification
+		{
+		public:
+			PreparedCertificatesVerification(IThresholdVerifier* const v, std::vector<CertificatesOfSeqNum>& t) :
+				tasks(t.data()), numOfTasks(t.size()), verifier(v), nextTask{ 0 }, completedTasks{ 0 }
+			{
+			}
+
+			// verifies the certificates of one sequence number. Returns false if there are no more tasks
+			bool verifyNext()
+			{
+				const size_t i = nextTask++;
+				if (i >= numOfTasks) return false;
+
+				verify(tasks[i]);
+
+				std::unique_lock<std::mutex> lock(m);
+				completedTasks++;
+				if (completedTasks == numOfTasks) cond.notify_all();
+
+				return true;
+			}
+
+			void waitForAllTasks()
+			{
+				std::unique_lock<std::mutex> lock(m);
+				cond.wait(lock, [this] { return completedTasks == numOfTasks; });
+			}
+
+		protected:
+			void verify(CertificatesOfSeqNum& t) const
+			{
+				for (size_t i = 0; i < t.candidates.size(); i++)
+				{
+					const CertificateCandidate& c = t.candidates[i];
+
+					if (c.alreadyVerified)
+					{
+						t.selected = (int)i;
+						return;
+					}
+
+					Digest d;
+					Digest::calcCombination(c.key.digest, c.key.view, c.key.seqNum, d);
+
+					for (const SlowElem& e : c.elems)
+					{
+						if (verifier->verify(d.content(), DIGEST_SIZE, e.certificateSig(), e.certificateSigLength()))
+						{
+							t.selected = (int)i;
+							return;
+						}
+					}
+				}
+			}
+
+			// NB: jobs may be executed after the calling thread returns (then they only see that there are no more tasks)
+			CertificatesOfSeqNum* const tasks;
+			const size_t numOfTasks;
+			IThresholdVerifier* const verifier;
+
+			std::atomic<size_t> nextTask;
+
+			std::mutex m;
+			std::condition_variable cond;
+			size_t completedTasks;
+		};
+
+		class PreparedCertificatesVerificationJob final : public SimpleThreadPool::Job
+		{
+		public:
+			PreparedCertificatesVerificationJob(const std::shared_ptr<PreparedCertificatesVerification>& v) : verification(v)
+			{
+			}
+
+			virtual void execute() override
+			{
+				while (verification->verifyNext()) {}
+			}
+
+			virtual void release() override
+			{
+				delete this;
+			}
+
+		protected:
+			std::shared_ptr<PreparedCertificatesVerification> verification;
+		};
+
+
 		///////////////////////////////////////////////////////////////////////////////
 		// ViewChangeSafetyLogic
 		///////////////////////////////////////////////////////////////////////////////
 
-		ViewChangeSafetyLogic::ViewChangeSafetyLogic(const uint16_t n, const uint16_t f, const uint16_t c, IThresholdVerifier* const preparedCertificateVerifier, const Digest& digestOfNull) :
+		ViewChangeSafetyLogic::ViewChangeSafetyLogic(const uint16_t n, const uint16_t f, const uint16_t c, const uint16_t checkpointWindowSize, IThresholdVerifier* const preparedCertificateVerifier, const Digest& digestOfNull, SimpleThreadPool* const threadPool) :
 			N(n),
 			F(f),
 			C(c),
+			checkpointWindowSize(checkpointWindowSize),
+			workWindowSize(2 * checkpointWindowSize),
 			preparedCertVerifier(preparedCertificateVerifier),
-			nullDigest(digestOfNull)
+			nullDigest(digestOfNull),
+			threadPool(threadPool)
 		{
 			Assert(N == (3 * F + 2 * C + 1));
 		}
@@ -204,7 +321,7 @@ namespace bftEngine
 			Restriction* outSafetyRestrictionsArray) const
 		{
 			const SeqNum lowerBound = inLBStableForView + 1;
-			const SeqNum upperBound = inLBStableForView + kWorkWindowSize;
+			const SeqNum upperBound = inLBStableForView + workWindowSize;
 
 			SeqNum lastRestcitionNum = 0;
 
@@ -232,6 +349,8 @@ namespace bftEngine
 
 			const bool noElements = VCIterators.empty(); // (useful when we don't have requests, and we still need to change view)
 
+			if (!noElements) verifyPreparedCertificates(inViewChangeMsgsOfCurrentView, lowerBound, upperBound);
+
 			// look for safety restrictions
 			SeqNum currSeqNum = lowerBound;
 			for (; currSeqNum <= upperBound && !VCIterators.empty(); currSeqNum++)
@@ -266,7 +385,7 @@ namespace bftEngine
 				outMinRestrictedSeqNum = lowerBound;
 				outMaxRestrictedSeqNum = upperBound;
 
-				// TODO(GG): patch (we should fix the "stable point bug" (and this patch will not be needed)). TODO(GG): for simplicity, the patch assumes that: kWorkWindowSize == 2 * checkpointWindowSize
+				// TODO(GG): patch (we should fix the "stable point bug" (and this patch will not be needed)). the patch uses: workWindowSize == 2 * checkpointWindowSize
 				if (lastRestcitionNum > 0 &&
 					lastRestcitionNum <= (upperBound - checkpointWindowSize))
 				{
@@ -316,10 +435,10 @@ namespace bftEngine
 			for (SlowElem slow : slowPathCertificates)
 			{
 				Assert(s == slow.seqNum());
-				Digest d;
-				Digest::calcCombination(slow.prePrepreDigest(), slow.certificateView(), slow.seqNum(), d);
 
-				bool valid = preparedCertVerifier->verify(d.content(), DIGEST_SIZE, slow.certificateSig(), slow.certificateSigLength());
+				// certificates were verified by verifyPreparedCertificates
+				const PreparedCertificateKey key{ slow.seqNum(), slow.certificateView(), slow.prePrepreDigest() };
+				const bool valid = (validCertificates.count(key) > 0);
 
 				if (valid) {
 					selectedSlow = slow;
@@ -422,5 +541,92 @@ namespace bftEngine
 			}
 		}
 
+		void ViewChangeSafetyLogic::verifyPreparedCertificates(ViewChangeMsg** const viewChangeMsgs, const SeqNum lowerBound, const SeqNum upperBound) const
+		{
+			// certificates of older sequence numbers are no longer needed
+			while (!validCertificates.empty() && validCertificates.begin()->seqNum < lowerBound)
+				validCertificates.erase(validCertificates.begin());
+
+			// collect the certificates of each sequence number
+			std::vector<CertificatesOfSeqNum> tasks;
+			std::map<SeqNum, size_t> taskOfSeqNum;
+
+			for (uint16_t i = 0; i < N; i++)
+			{
+				const ViewChangeMsg* vc = viewChangeMsgs[i];
+
+				if (vc == nullptr || vc->numberOfElements() == 0) continue;
+
+				ViewChangeMsg::ElementsIterator iter(vc);
+				iter.goToAtLeast(lowerBound);
+
+				ViewChangeMsg::Element* elem = nullptr;
+				while (iter.getAndGoToNext(elem) && elem->seqNum <= upperBound)
+				{
+					if (!elem->hasPreparedCertificate) continue;
+
+					SlowElem slow{ elem };
+					const PreparedCertificateKey key{ slow.seqNum(), slow.certificateView(), slow.prePrepreDigest() };
+
+					auto t = taskOfSeqNum.find(key.seqNum);
+					if (t == taskOfSeqNum.end())
+					{
+						t = taskOfSeqNum.insert({ key.seqNum, tasks.size() }).first;
+						tasks.push_back(CertificatesOfSeqNum());
+					}
+
+					std::vector<CertificateCandidate>& candidates = tasks[t->second].candidates;
+
+					auto c = std::find_if(candidates.begin(), candidates.end(),
+						[&key](const CertificateCandidate& x) { return !(x.key < key) && !(key < x.key); });
+
+					if (c == candidates.end())
+					{
+						CertificateCandidate newCandidate;
+						newCandidate.key = key;
+						newCandidate.alreadyVerified = (validCertificates.count(key) > 0);
+						candidates.push_back(newCandidate);
+						c = candidates.end() - 1;
+					}
+
+					if (c->alreadyVerified) continue;
+
+					// ignore identical signatures
+					const bool sameSig = std::any_of(c->elems.begin(), c->elems.end(), [&slow](const SlowElem& x) {
+						return (x.certificateSigLength() == slow.certificateSigLength()) &&
+							(memcmp(x.certificateSig(), slow.certificateSig(), slow.certificateSigLength()) == 0);
+					});
+
+					if (!sameSig) c->elems.push_back(slow);
+				}
+			}
+
+			if (tasks.empty()) return;
+
+			for (CertificatesOfSeqNum& t : tasks)
+			{
+				std::sort(t.candidates.begin(), t.candidates.end(),
+					[](const CertificateCandidate& x, const CertificateCandidate& y) { return (x.key < y.key); });
+			}
+
+			// verify (the calling thread also verifies certificates)
+			std::shared_ptr<PreparedCertificatesVerification> verification = std::make_shared<PreparedCertificatesVerification>(preparedCertVerifier, tasks);
+
+			if (threadPool != nullptr)
+			{
+				const size_t numOfJobs = std::min((size_t)threadPool->numberOfThreads, tasks.size() - 1);
+				for (size_t i = 0; i < numOfJobs; i++) threadPool->add(new PreparedCertificatesVerificationJob(verification));
+			}
+
+			while (verification->verifyNext()) {}
+
+			verification->waitForAllTasks();
+
+			for (const CertificatesOfSeqNum& t : tasks)
+			{
+				if (t.selected >= 0) validCertificates.insert(t.candidates[t.selected].key);
+			}
+		}
+
 	}
 }
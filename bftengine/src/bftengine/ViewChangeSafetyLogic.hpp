@@ -11,6 +11,7 @@
 
 #include "ViewChangeMsg.hpp"
 #include <vector>
+#include <set>
 
 using std::vector;
 
@@ -20,12 +21,30 @@ namespace bftEngine
 {
 	namespace impl
 	{
+		class SimpleThreadPool;
 
 		class ViewChangeSafetyLogic
 		{
 		public:
 
-			ViewChangeSafetyLogic(const uint16_t n, const uint16_t f, const uint16_t c, IThresholdVerifier* const preparedCertificateVerifier, const Digest& digestOfNull);
+			// if threadPool!=nullptr, its threads are used to verify prepared certificates
+			ViewChangeSafetyLogic(const uint16_t n, const uint16_t f, const uint16_t c, const uint16_t checkpointWindowSize, IThresholdVerifier* const preparedCertificateVerifier, const Digest& digestOfNull, SimpleThreadPool* const threadPool = nullptr);
+
+			// identifies the statement of a prepared certificate (the PrePrepare digest was prepared in view 'view' for 'seqNum')
+			struct PreparedCertificateKey
+			{
+				SeqNum seqNum;
+				ViewNum view;
+				Digest digest;
+
+				// by seqNum, then by view (highest first), then by digest
+				bool operator<(const PreparedCertificateKey& other) const
+				{
+					if (seqNum != other.seqNum) return (seqNum < other.seqNum);
+					if (view != other.view) return (view > other.view);
+					return (memcmp(digest.content(), other.digest.content(), sizeof(Digest)) < 0);
+				}
+			};
 
 			struct Restriction
 			{
@@ -42,7 +61,7 @@ namespace bftEngine
 				Restriction* outSafetyRestrictionsArray
 			) const;
 			// Notes about outSafetyRestrictionsArray:
-			// - It should have kWorkWindowSize elements.
+			// - It should have workWindowSize elements.
 			// - If at the end of this method outMaxRestrictedSeqNum==0, then outSafetyRestrictionsArray is 'empty'
 			// - Otherwise, its first (outMaxRestrictedSeqNum-outMinRestrictedSeqNum+1) elements are valid : they represents the restrictions between outMinRestrictedSeqNum and outMaxRestrictedSeqNum
 
@@ -51,13 +70,27 @@ namespace bftEngine
 
 			bool computeRestrictionsForSeqNum(SeqNum s, vector<ViewChangeMsg::ElementsIterator*>& VCIterators, const SeqNum upperBound, Digest& outRestrictedDigest) const;
 
+			// For each sequence number in [lowerBound,upperBound], verifies the prepared certificates in the
+			// ViewChangeMsg messages (highest view first) until a valid certificate is found. Sequence numbers
+			// are verified in parallel, and the results are added to validCertificates.
+			void verifyPreparedCertificates(ViewChangeMsg** const viewChangeMsgs, const SeqNum lowerBound, const SeqNum upperBound) const;
+
 			const uint16_t N;         // number of replicas
 			const uint16_t F;
 			const uint16_t C;
 
+			const uint16_t checkpointWindowSize; // see ReplicaConfig::checkpointWindowSize
+			const uint16_t workWindowSize;       // 2 * checkpointWindowSize
+
 			IThresholdVerifier* const preparedCertVerifier;
 
 			const Digest nullDigest;
+
+			SimpleThreadPool* const threadPool;
+
+			// prepared certificates that were already verified. The same certificate is usually sent by several
+			// replicas (and for several views), so each certificate is verified once.
+			mutable std::set<PreparedCertificateKey> validCertificates;
 		};
 
 	}
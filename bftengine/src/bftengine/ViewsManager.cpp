@@ -29,19 +29,24 @@ namespace impl {
 
 ViewsManager::ViewsManager(
   const ReplicasInfo* const r,
-  IThresholdVerifier* const preparedCertificateVerifier) :
+  IThresholdVerifier* const preparedCertificateVerifier,
+  SimpleThreadPool* const threadPool) :
   replicasInfo(r),
   N(r->numberOfReplicas()),
   F(r->fVal()),
   C(r->cVal()),
-  myId(r->myId()) {
+  myId(r->myId()),
+  workWindowSize(r->workWindowSize()),
+  restrictionsOfPendingView(r->workWindowSize()),
+  prePrepareMsgsOfRestrictions(r->workWindowSize(), nullptr) {
   Assert(preparedCertificateVerifier != nullptr);
   Assert(N == (3 * F + 2 * C + 1));
 
   viewChangeSafetyLogic =
-    new ViewChangeSafetyLogic(N, F, C,
+    new ViewChangeSafetyLogic(N, F, C, r->checkpointWindowSize(),
                               preparedCertificateVerifier,
-                              PrePrepareMsg::digestOfNullPrePrepareMsg());
+                              PrePrepareMsg::digestOfNullPrePrepareMsg(),
+                              threadPool);
 
   stat = Stat::IN_VIEW;
 
@@ -62,7 +67,7 @@ ViewsManager::ViewsManager(
   minRestrictionOfPendingView = 0;
   maxRestrictionOfPendingView = 0;
 
-  for (uint16_t i = 0; i < kWorkWindowSize; i++) {
+  for (uint16_t i = 0; i < workWindowSize; i++) {
     restrictionsOfPendingView[i].isNull = true;
     restrictionsOfPendingView[i].digest.makeZero();
     prePrepareMsgsOfRestrictions[i] = nullptr;
@@ -319,7 +324,7 @@ ViewChangeMsg* ViewsManager::exitFromCurrentView(
   const std::vector<PrevViewInfo>& prevViewInfo) {
   Assert(stat == Stat::IN_VIEW);
   Assert(myLatestActiveView == myLatestPendingView);
-  Assert(prevViewInfo.size() <= kWorkWindowSize);
+  Assert(prevViewInfo.size() <= workWindowSize);
   Assert(collectionOfPrePrepareMsgs.empty());
 
   Assert((currentLastStable >= debugHighestKnownStable));
@@ -439,7 +444,7 @@ ViewChangeMsg* ViewsManager::exitFromCurrentView(
       delete pp;
   }
 
-  Assert((debugExpected - currentLastStable) <= kWorkWindowSize);
+  Assert((debugExpected - currentLastStable) <= workWindowSize);
 
   resetDataOfLatestPendingAndKeepMyViewChange();
 
@@ -745,7 +750,7 @@ void ViewsManager::computeRestrictionsOfNewView(ViewNum v) {
     lowerBoundStableForPendingView,
     // Outputs
     minRestrictionOfPendingView, maxRestrictionOfPendingView,
-    restrictionsOfPendingView);
+    restrictionsOfPendingView.data());
 
   // add items to prePrepareMsgsOfRestrictions
   // if we have restrictions
@@ -755,7 +760,7 @@ void ViewsManager::computeRestrictionsOfNewView(ViewNum v) {
          i++) {
       const int64_t idx = (i - minRestrictionOfPendingView);
 
-      Assert(idx < kWorkWindowSize);
+      Assert(idx < workWindowSize);
 
       Assert(prePrepareMsgsOfRestrictions[idx] == nullptr);
 
@@ -835,7 +840,7 @@ void ViewsManager::resetDataOfLatestPendingAndKeepMyViewChange() {
          i <= maxRestrictionOfPendingView;
          i++) {
       int64_t idx = i - minRestrictionOfPendingView;
-      Assert(idx < kWorkWindowSize);
+      Assert(idx < workWindowSize);
       auto pos = collectionOfPrePrepareMsgs.find(i);
       if (pos == collectionOfPrePrepareMsgs.end() ||
           pos->second != prePrepareMsgsOfRestrictions[idx])
@@ -868,7 +873,7 @@ bool ViewsManager::addPotentiallyMissingPP(PrePrepareMsg* p,
 
   if (hasRelevantRestriction) {
     const int64_t idx = s - minRestrictionOfPendingView;
-    Assert(idx < kWorkWindowSize);
+    Assert(idx < workWindowSize);
 
     ViewChangeSafetyLogic::Restriction& r = restrictionsOfPendingView[idx];
 
@@ -897,7 +902,7 @@ PrePrepareMsg*  ViewsManager::getPrePrepare(SeqNum s) {
     if (!hasRelevantRestriction) return nullptr;
 
     const int64_t idx = s - minRestrictionOfPendingView;
-    Assert(idx < kWorkWindowSize);
+    Assert(idx < workWindowSize);
 
     ViewChangeSafetyLogic::Restriction& r = restrictionsOfPendingView[idx];
 
@@ -29,13 +29,15 @@ class PrepareFullMsg;
 class ViewChangeMsg;
 class NewViewMsg;
 class ViewChangeSafetyLogic;
+class SimpleThreadPool;
 
 using std::vector;
 
 class ViewsManager {
  public:
   ViewsManager(const ReplicasInfo* const r,
-               IThresholdVerifier* const preparedCertificateVerifier);
+               IThresholdVerifier* const preparedCertificateVerifier,
+               SimpleThreadPool* const threadPool = nullptr);
   ~ViewsManager();
 
   ViewNum latestActiveView() const { return myLatestActiveView; }
@@ -131,6 +133,7 @@ class ViewsManager {
   const uint16_t F;  // f
   const uint16_t C;  // c
   const uint16_t myId;
+  const uint16_t workWindowSize;  // see ReplicasInfo::workWindowSize
 
   const ViewChangeSafetyLogic* viewChangeSafetyLogic;
 
@@ -179,8 +182,9 @@ class ViewsManager {
 
   SeqNum minRestrictionOfPendingView;
   SeqNum maxRestrictionOfPendingView;
-  ViewChangeSafetyLogic::Restriction restrictionsOfPendingView[kWorkWindowSize];
-  PrePrepareMsg* prePrepareMsgsOfRestrictions[kWorkWindowSize];
+  // both have workWindowSize elements
+  std::vector<ViewChangeSafetyLogic::Restriction> restrictionsOfPendingView;
+  std::vector<PrePrepareMsg*> prePrepareMsgsOfRestrictions;
 
 
 
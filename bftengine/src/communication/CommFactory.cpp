@@ -22,6 +22,7 @@ using bftEngine::CommType;
 using bftEngine::ICommunication;
 using bftEngine::PlainTcpConfig;
 using bftEngine::PlainUdpConfig;
+using bftEngine::SharedMemoryConfig;
 using bftEngine::TlsTcpConfig;
 
 concordlogger::Logger CommFactory::_logger =
@@ -57,6 +58,12 @@ CommFactory::create(const BaseCommConfig &config) {
       dynamic_cast<const TlsTcpConfig&>(config));
 #endif
     break;
+  case CommType::SharedMemory:
+    LOG_INFO(_logger, "Using SharedMemory: " << "Path=" <<
+        dynamic_cast<const SharedMemoryConfig&>(config).pathPrefix);
+    res = SharedMemoryCommunication::create(
+      dynamic_cast<const SharedMemoryConfig&>(config));
+    break;
   }
 
   return res;
@@ -18,6 +18,8 @@
 #include <string.h>
 #include <chrono>
 #include <mutex>
+#include <array>
+#include <set>
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -541,18 +543,23 @@ class AsyncTcpConnection :
     LOG_TRACE(_logger, "exit, node " << _selfId << ", dest: " << _destId);
   }
 
-  void write_async(const char *data, uint32_t length) {
+  template<typename ConstBufferSequence>
+  void write_async(const ConstBufferSequence &buffers) {
     if (!connected)
       return;
 
     B_ERROR_CODE ec;
-    write(socket, buffer(data, length), ec);
+    write(socket, buffers, ec);
     auto err = was_error(ec, __func__);
     if (err) {
       handle_error(ec);
     }
   }
 
+  void write_async(const char *data, uint32_t length) {
+    write_async(buffer(data, length));
+  }
+
   void init() {
     _connectTimer.async_wait(
         boost::bind(&AsyncTcpConnection::connect_timer_tick,
@@ -598,10 +605,19 @@ class AsyncTcpConnection :
     LOG_TRACE(_logger, "enter, node " << _selfId << ", dest: " << _destId);
 
     lock_guard<recursive_mutex> lock(_connectionsGuard);
-    auto offset = prepare_output_buffer(MessageType::Regular,
-                                        length);
-    memcpy(_outBuffer + offset, data, length);
-    write_async(_outBuffer, offset + length);
+
+    // the header and the data are written with a single gather write, so the
+    // data is not copied (and the same data can be sent to many connections)
+    char header[LENGTH_FIELD_SIZE + MSGTYPE_FIELD_SIZE];
+    const uint16_t msgType = MessageType::Regular;
+    const uint32_t size = sizeof(msgType) + length;
+    memcpy(header, &size, LENGTH_FIELD_SIZE);
+    memcpy(header + LENGTH_FIELD_SIZE, &msgType, MSGTYPE_FIELD_SIZE);
+    const uint16_t offset = sizeof(header);
+
+    const std::array<const_buffer, 2> buffers =
+        {{buffer(header, offset), buffer(data, length)}};
+    write_async(buffers);
 
     if (_statusCallback && _isReplica) {
       PeerConnectivityStatus pcs{};
@@ -912,6 +928,29 @@ class PlainTCPCommunication::PlainTcpImpl {
     return 0;
   }
 
+  /**
+  * Sends the same message to each of the given destination nodes. The
+  * message is not copied: it is written directly to each connection.
+  * Returns 0 on success.
+  */
+  int sendAsyncMessageToMany(const std::set<NodeNum> &destNodes,
+                             const char *const message,
+                             const size_t messageLength) {
+    lock_guard<recursive_mutex> lock(_connectionsGuard);
+    for (NodeNum destNode : destNodes) {
+      auto temp = _connections.find(destNode);
+      if (temp != _connections.end() && temp->second->connected) {
+        temp->second->send(message, messageLength);
+      } else {
+        LOG_TRACE(_logger,
+           "conncection not found or disconnected, from: " << _selfId
+           << ", to: " << destNode);
+      }
+    }
+
+    return 0;
+  }
+
   /// TODO(IG): return real max message size... what is should be for TCP?
   int getMaxMessageSize() {
     return -1;
@@ -983,6 +1022,13 @@ PlainTCPCommunication::sendAsyncMessage(const NodeNum destNode,
   return _ptrImpl->sendAsyncMessage(destNode, message, messageLength);
 }
 
+int
+PlainTCPCommunication::sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                                              const char *const message,
+                                              const size_t messageLength) {
+  return _ptrImpl->sendAsyncMessageToMany(destNodes, message, messageLength);
+}
+
 void
 PlainTCPCommunication::setReceiver(NodeNum receiverNum, IReceiver *receiver) {
   _ptrImpl->setReceiver(receiverNum, receiver);
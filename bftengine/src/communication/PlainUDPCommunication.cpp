@@ -17,6 +17,8 @@
 #include <sstream>
 #include <cstring>
 #include <unordered_map>
+#include <set>
+#include <vector>
 #include "CommDefs.hpp"
 #include "Threading.h"
 #include "Logging.hpp"
@@ -300,18 +302,84 @@ class PlainUDPCommunication::PlainUdpImpl {
     }
 
     if (error == (ssize_t) messageLength) {
-      if (statusCallback) {
-        PeerConnectivityStatus pcs{};
-        pcs.peerId = selfId;
-        pcs.statusType = StatusType::MessageSent;
+      reportMessageSent();
+    }
 
-        // pcs.statusTime = we dont set it since it is set by the aggregator
-        // in the upcoming version timestamps should be reviewed
-        statusCallback(pcs);
+    return 0;
+  }
+
+  int
+  sendAsyncMessageToMany(const std::set<NodeNum> &destNodes,
+                         const char *const message,
+                         const size_t &messageLength) {
+#if defined(__linux__)
+    Assert(running == true, "The communication layer is not running!");
+    Assert(messageLength > 0, "The message length must be positive!");
+    Assert(message != NULL, "No message provided!");
+
+    // one datagram per destination, all of them pointing to the same buffer,
+    // are sent with a single system call
+    struct iovec iov;
+    iov.iov_base = const_cast<char *>(message);
+    iov.iov_len = messageLength;
+
+    vector<struct mmsghdr> msgs(destNodes.size());
+    size_t numOfMsgs = 0;
+    for (NodeNum d : destNodes) {
+      auto to = nodes2adresses.find(d);
+      Assert(to != nodes2adresses.end(),
+             "The destination endpoint does not exist!");
+      if (to == nodes2adresses.end()) continue;
+
+      struct mmsghdr &m = msgs[numOfMsgs++];
+      memset(&m, 0, sizeof(m));
+      m.msg_hdr.msg_name = (void *) &to->second;
+      m.msg_hdr.msg_namelen = sizeof(Addr);
+      m.msg_hdr.msg_iov = &iov;
+      m.msg_hdr.msg_iovlen = 1;
+    }
+
+    LOG_DEBUG(_logger, " Sending " << messageLength
+                          << " bytes to " << numOfMsgs << " nodes");
+
+    size_t numOfSent = 0;
+    while (numOfSent < numOfMsgs) {
+      int res = sendmmsg(udpSockFd, &msgs[numOfSent],
+                         numOfMsgs - numOfSent, 0);
+      if (res < 0 && errno == EINTR) continue;
+      if (res <= 0) {
+        LOG_DEBUG(_logger, "Error while sending: " << strerror(errno));
+        Assert(false, "Failure occurred while sending!");
+        /** Fail-fast. */
+        break;
       }
+      numOfSent += res;
+    }
+
+    for (size_t i = 0; i < numOfSent; i++) {
+      Assert(msgs[i].msg_len == messageLength, "Send error occurred!");
+      if (msgs[i].msg_len == messageLength) reportMessageSent();
     }
 
     return 0;
+#else
+    for (NodeNum d : destNodes)
+      sendAsyncMessage(d, message, messageLength);
+    return 0;
+#endif
+  }
+
+  void
+  reportMessageSent() {
+    if (statusCallback) {
+      PeerConnectivityStatus pcs{};
+      pcs.peerId = selfId;
+      pcs.statusType = StatusType::MessageSent;
+
+      // pcs.statusTime = we dont set it since it is set by the aggregator
+      // in the upcoming version timestamps should be reviewed
+      statusCallback(pcs);
+    }
   }
 
   void
@@ -470,6 +538,13 @@ PlainUDPCommunication::sendAsyncMessage(const NodeNum destNode,
   return _ptrImpl->sendAsyncMessage(destNode, message, messageLength);
 }
 
+int
+PlainUDPCommunication::sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                                              const char *const message,
+                                              const size_t messageLength) {
+  return _ptrImpl->sendAsyncMessageToMany(destNodes, message, messageLength);
+}
+
 void
 PlainUDPCommunication::setReceiver(NodeNum receiverNum, IReceiver *receiver) {
   _ptrImpl->setReceiver(receiverNum, receiver);
@@ -0,0 +1,535 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0 License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "CommDefs.hpp"
+#include "Logging.hpp"
+
+#define Assert(cond, txtMsg) assert(cond && (txtMsg))
+
+using namespace std;
+using namespace bftEngine;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "the rings require address-free (lock-free) atomics");
+
+namespace {
+
+/*
+ * Layout of the file of a node (the receiver):
+ *   NodeHeader
+ *   for each possible sender: RingHeader, followed by ringSize bytes of data
+ *
+ * Each ring has a single producer (the sender) and a single consumer (the
+ * receiving thread of the node). writePos and readPos are byte counters that
+ * only grow; a message is stored as a 4 byte length followed by the message,
+ * padded to 8 bytes. A message is never split: if it does not fit before the
+ * end of the ring, a kWrapMarker is written and the message starts at the
+ * beginning of the ring.
+ */
+
+const uint64_t kMagic = 0x434F4E43534D3031ULL;  // "CONCSM01"
+const uint32_t kWrapMarker = 0xFFFFFFFF;
+const size_t kCacheLine = 64;
+
+// number of empty polls of all the rings before the receiving thread sleeps
+const uint32_t kSpinsBeforeSleep = 2000;
+const long kMaxSleepMilli = 100;
+const int64_t kReconnectIntervalMilli = 100;
+
+struct NodeHeader {
+  std::atomic<uint64_t> magic;
+  uint32_t numOfSlots;
+  uint32_t ringSize;
+  alignas(kCacheLine) std::atomic<uint32_t> running;
+  std::atomic<uint32_t> sleeping;
+  alignas(kCacheLine) std::atomic<uint32_t> doorbell;
+};
+
+struct RingHeader {
+  alignas(kCacheLine) std::atomic<uint64_t> writePos;
+  alignas(kCacheLine) std::atomic<uint64_t> readPos;
+};
+
+inline size_t align8(size_t n) {
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+inline size_t headerSize() {
+  return align8(sizeof(NodeHeader));
+}
+
+inline size_t slotSize(uint32_t ringSize) {
+  return align8(sizeof(RingHeader)) + ringSize;
+}
+
+inline size_t fileSize(uint32_t numOfSlots, uint32_t ringSize) {
+  return headerSize() + numOfSlots * slotSize(ringSize);
+}
+
+inline RingHeader *ringHeader(char *base, uint32_t ringSize, NodeNum slot) {
+  return reinterpret_cast<RingHeader *>(
+      base + headerSize() + slot * slotSize(ringSize));
+}
+
+inline char *ringData(char *base, uint32_t ringSize, NodeNum slot) {
+  return reinterpret_cast<char *>(ringHeader(base, ringSize, slot)) +
+      align8(sizeof(RingHeader));
+}
+
+// the futex is shared between processes (i.e. not FUTEX_PRIVATE)
+void futexWait(std::atomic<uint32_t> *addr, uint32_t val, long timeoutMilli) {
+  struct timespec ts;
+  ts.tv_sec = timeoutMilli / 1000;
+  ts.tv_nsec = (timeoutMilli % 1000) * 1000000;
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT, val,
+          &ts, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<uint32_t> *addr) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE,
+          INT32_MAX, nullptr, nullptr, 0);
+}
+
+}  // namespace
+
+class SharedMemoryCommunication::SharedMemoryImpl {
+ private:
+  /* A node that we send messages to (its file is mapped lazily). */
+  struct Peer {
+    std::mutex lock;  // serializes the senders of this process
+    char *base = nullptr;
+    size_t mapSize = 0;
+    std::chrono::steady_clock::time_point lastAttempt;
+    bool attempted = false;
+  };
+
+  const std::string pathPrefix;
+  const uint32_t maxMsgSize;
+  const uint32_t ringSize;
+  const NodeNum selfId;
+  uint32_t numOfSlots = 0;
+
+  std::unordered_map<NodeNum, NodeInfo> endpoints;
+  std::vector<std::unique_ptr<Peer>> peers;
+
+  /** Our own file (the incoming rings). */
+  char *selfBase = nullptr;
+  size_t selfMapSize = 0;
+
+  /** Prevents concurrent Start()/Stop() invocations. */
+  std::mutex runningLock;
+  std::atomic<bool> running;
+  std::thread recvThread;
+
+  IReceiver *receiverRef = nullptr;
+  UPDATE_CONNECTIVITY_FN statusCallback = nullptr;
+
+  concordlogger::Logger _logger =
+      concordlogger::Logger::getLogger("shared-memory");
+
+  std::string fileName(NodeNum node) const {
+    return pathPrefix + "." + std::to_string(node);
+  }
+
+  NodeHeader *header(char *base) const {
+    return reinterpret_cast<NodeHeader *>(base);
+  }
+
+  /*
+   * Maps the file of this node. A file that was left by a previous run (with
+   * the same geometry) is reused, because other processes may still have it
+   * mapped; its stale messages are dropped by Start().
+   */
+  bool mapSelf() {
+    const std::string name = fileName(selfId);
+    int fd = open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+      LOG_ERROR(_logger, "Cannot open " << name << ": " << strerror(errno));
+      return false;
+    }
+
+    const size_t size = fileSize(numOfSlots, ringSize);
+    struct stat st;
+    bool reuse = (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == size);
+    if (!reuse && ftruncate(fd, size) != 0) {
+      LOG_ERROR(_logger, "Cannot resize " << name << ": " << strerror(errno));
+      close(fd);
+      return false;
+    }
+
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+      LOG_ERROR(_logger, "Cannot map " << name << ": " << strerror(errno));
+      return false;
+    }
+    selfBase = static_cast<char *>(p);
+    selfMapSize = size;
+
+    NodeHeader *h = header(selfBase);
+    reuse = reuse && h->magic.load() == kMagic &&
+        h->numOfSlots == numOfSlots && h->ringSize == ringSize;
+    if (!reuse) {
+      h->magic.store(0);
+      memset(selfBase + sizeof(h->magic), 0, size - sizeof(h->magic));
+      h->numOfSlots = numOfSlots;
+      h->ringSize = ringSize;
+      h->magic.store(kMagic);
+    }
+    return true;
+  }
+
+  /* Maps the file of a peer; should be called with peer.lock held. */
+  bool mapPeer(NodeNum node, Peer &peer) {
+    if (peer.base != nullptr) return true;
+
+    // don't retry too often if the peer did not create its file yet
+    auto now = std::chrono::steady_clock::now();
+    if (peer.attempted &&
+        now - peer.lastAttempt <
+            std::chrono::milliseconds(kReconnectIntervalMilli))
+      return false;
+    peer.attempted = true;
+    peer.lastAttempt = now;
+
+    const std::string name = fileName(node);
+    int fd = open(name.c_str(), O_RDWR);
+    if (fd < 0) return false;
+
+    const size_t size = fileSize(numOfSlots, ringSize);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != size) {
+      close(fd);
+      return false;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+
+    NodeHeader *h = header(static_cast<char *>(p));
+    if (h->magic.load() != kMagic || h->numOfSlots != numOfSlots ||
+        h->ringSize != ringSize) {
+      munmap(p, size);
+      return false;
+    }
+
+    peer.base = static_cast<char *>(p);
+    peer.mapSize = size;
+    LOG_DEBUG(_logger, "Node " << selfId << " mapped the file of node " << node);
+    return true;
+  }
+
+  bool hasMessages() {
+    for (uint32_t s = 0; s < numOfSlots; s++) {
+      RingHeader *r = ringHeader(selfBase, ringSize, s);
+      if (r->readPos.load(std::memory_order_relaxed) !=
+          r->writePos.load(std::memory_order_acquire))
+        return true;
+    }
+    return false;
+  }
+
+  /* Delivers the messages of one ring; returns true if there were any. */
+  bool drainRing(NodeNum sender) {
+    RingHeader *r = ringHeader(selfBase, ringSize, sender);
+    char *data = ringData(selfBase, ringSize, sender);
+
+    uint64_t readPos = r->readPos.load(std::memory_order_relaxed);
+    const uint64_t writePos = r->writePos.load(std::memory_order_acquire);
+    if (readPos == writePos) return false;
+
+    while (readPos < writePos) {
+      const size_t offset = readPos % ringSize;
+      uint32_t len;
+      memcpy(&len, data + offset, sizeof(len));
+
+      if (len == kWrapMarker) {
+        readPos += ringSize - offset;
+        continue;
+      }
+
+      const size_t recordSize = align8(sizeof(len) + len);
+      if (len == 0 || len > maxMsgSize || offset + recordSize > ringSize ||
+          readPos + recordSize > writePos) {
+        // a corrupted ring (e.g. the sender crashed): drop its content
+        LOG_ERROR(_logger, "Corrupted ring of node " << sender <<
+                           ", dropping " << (writePos - readPos) << " bytes");
+        readPos = writePos;
+        break;
+      }
+
+      // the message is delivered directly from the shared memory, and the
+      // space is released only after onNewMessage returns
+      if (receiverRef != nullptr)
+        receiverRef->onNewMessage(sender, data + offset + sizeof(len), len);
+
+      readPos += recordSize;
+      r->readPos.store(readPos, std::memory_order_release);
+    }
+    r->readPos.store(readPos, std::memory_order_release);
+    return true;
+  }
+
+  void recvThreadRoutine() {
+    NodeHeader *h = header(selfBase);
+    uint32_t idle = 0;
+    while (running) {
+      bool any = false;
+      for (uint32_t s = 0; s < numOfSlots; s++) any |= drainRing(s);
+
+      if (any) {
+        idle = 0;
+        continue;
+      }
+      if (++idle < kSpinsBeforeSleep) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      // pairs with the fence in sendAsyncMessage: either the sender sees
+      // that we sleep (and rings the doorbell), or we see its message
+      const uint32_t bell = h->doorbell.load();
+      h->sleeping.store(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (running && !hasMessages())
+        futexWait(&h->doorbell, bell, kMaxSleepMilli);
+      h->sleeping.store(0);
+      idle = 0;
+    }
+  }
+
+ public:
+  explicit SharedMemoryImpl(const SharedMemoryConfig &config)
+      : pathPrefix{config.pathPrefix},
+        maxMsgSize{config.bufferLength},
+        ringSize{config.ringSize},
+        selfId{config.selfId},
+        endpoints{config.nodes},
+        running{false},
+        statusCallback{config.statusCallback} {
+    Assert(!config.pathPrefix.empty(), "No path prefix specified!");
+    Assert(config.nodes.size() > 0, "No communication endpoints specified!");
+    Assert(ringSize % 8 == 0, "The ring size should be a multiple of 8!");
+    Assert(align8(sizeof(uint32_t) + maxMsgSize) * 2 <= ringSize,
+           "The ring should fit at least two messages!");
+
+    for (auto &n : endpoints)
+      if (n.first + 1 > numOfSlots) numOfSlots = n.first + 1;
+    Assert(selfId < numOfSlots, "selfId is not in the nodes map!");
+
+    for (uint32_t i = 0; i < numOfSlots; i++) peers.emplace_back(new Peer());
+
+    LOG_DEBUG(_logger, "Node " << selfId << ", path prefix: " << pathPrefix <<
+                       ", ring size: " << ringSize <<
+                       ", #endpoints: " << endpoints.size());
+  }
+
+  ~SharedMemoryImpl() {
+    if (running) Stop();
+    for (auto &p : peers)
+      if (p->base != nullptr) munmap(p->base, p->mapSize);
+    if (selfBase != nullptr) munmap(selfBase, selfMapSize);
+  }
+
+  int getMaxMessageSize() {
+    return maxMsgSize;
+  }
+
+  int Start() {
+    if (!receiverRef) {
+      LOG_DEBUG(_logger, "Cannot Start(): Receiver not set");
+      return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(runningLock);
+    if (running) {
+      LOG_DEBUG(_logger, "Cannot Start(): already running!");
+      return -1;
+    }
+    if (selfBase == nullptr && !mapSelf()) return -1;
+
+    // drop the messages that were sent while this node was not running
+    for (uint32_t s = 0; s < numOfSlots; s++) {
+      RingHeader *r = ringHeader(selfBase, ringSize, s);
+      r->readPos.store(r->writePos.load());
+    }
+
+    running = true;
+    header(selfBase)->running.store(1);
+    recvThread = std::thread(&SharedMemoryImpl::recvThreadRoutine, this);
+    return 0;
+  }
+
+  int Stop() {
+    std::lock_guard<std::mutex> lock(runningLock);
+    if (!running) {
+      LOG_DEBUG(_logger, "Cannot Stop(): not running!");
+      return -1;
+    }
+
+    running = false;
+    NodeHeader *h = header(selfBase);
+    h->running.store(0);
+    h->doorbell.fetch_add(1);
+    futexWakeAll(&h->doorbell);
+
+    if (recvThread.joinable()) recvThread.join();
+    return 0;
+  }
+
+  bool isRunning() const {
+    return running;
+  }
+
+  void setReceiver(NodeNum receiverNum, IReceiver *pRcv) {
+    receiverRef = pRcv;
+  }
+
+  ConnectionStatus getCurrentConnectionStatus(const NodeNum node) const {
+    if (node >= numOfSlots) return ConnectionStatus::Unknown;
+    Peer &peer = *peers[node];
+    std::lock_guard<std::mutex> lock(peer.lock);
+    if (peer.base == nullptr) return ConnectionStatus::Disconnected;
+    return header(peer.base)->running.load() ? ConnectionStatus::Connected
+                                             : ConnectionStatus::Disconnected;
+  }
+
+  /*
+   * Messages to a node that did not create its file yet, or is not running,
+   * or whose ring is full, are dropped (as a UDP datagram may be dropped).
+   */
+  int sendAsyncMessage(const NodeNum destNode,
+                       const char *const message,
+                       const size_t messageLength) {
+    Assert(running == true, "The communication layer is not running!");
+    Assert(message != NULL, "No message provided!");
+
+    if (destNode >= numOfSlots || messageLength == 0 ||
+        messageLength > maxMsgSize)
+      return -1;
+
+    Peer &peer = *peers[destNode];
+    std::lock_guard<std::mutex> lock(peer.lock);
+    if (!mapPeer(destNode, peer)) return 0;
+
+    NodeHeader *h = header(peer.base);
+    if (!h->running.load(std::memory_order_relaxed)) return 0;
+
+    RingHeader *r = ringHeader(peer.base, ringSize, selfId);
+    char *data = ringData(peer.base, ringSize, selfId);
+
+    const uint32_t len = static_cast<uint32_t>(messageLength);
+    const size_t recordSize = align8(sizeof(len) + len);
+    uint64_t writePos = r->writePos.load(std::memory_order_relaxed);
+    const uint64_t readPos = r->readPos.load(std::memory_order_acquire);
+
+    size_t offset = writePos % ringSize;
+    const size_t contiguous = ringSize - offset;
+    const size_t needed = recordSize + (recordSize > contiguous ? contiguous : 0);
+    if (writePos + needed - readPos > ringSize) {
+      LOG_DEBUG(_logger, "The ring of node " << destNode <<
+                         " is full, dropping a message");
+      return 0;
+    }
+
+    if (recordSize > contiguous) {
+      memcpy(data + offset, &kWrapMarker, sizeof(kWrapMarker));
+      writePos += contiguous;
+      offset = 0;
+    }
+    memcpy(data + offset, &len, sizeof(len));
+    memcpy(data + offset + sizeof(len), message, len);
+    r->writePos.store(writePos + recordSize, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (h->sleeping.load(std::memory_order_relaxed)) {
+      h->doorbell.fetch_add(1);
+      futexWakeAll(&h->doorbell);
+    }
+
+    if (statusCallback) {
+      PeerConnectivityStatus pcs{};
+      pcs.peerId = selfId;
+      pcs.statusType = StatusType::MessageSent;
+      statusCallback(pcs);
+    }
+    return 0;
+  }
+};
+
+SharedMemoryCommunication::~SharedMemoryCommunication() {
+  if (_ptrImpl)
+    delete _ptrImpl;
+}
+
+SharedMemoryCommunication::SharedMemoryCommunication(
+    const SharedMemoryConfig &config) {
+  _ptrImpl = new SharedMemoryImpl(config);
+}
+
+SharedMemoryCommunication *SharedMemoryCommunication::create(
+    const SharedMemoryConfig &config) {
+  return new SharedMemoryCommunication(config);
+}
+
+int SharedMemoryCommunication::getMaxMessageSize() {
+  return _ptrImpl->getMaxMessageSize();
+}
+
+int SharedMemoryCommunication::Start() {
+  return _ptrImpl->Start();
+}
+
+int SharedMemoryCommunication::Stop() {
+  if (!_ptrImpl)
+    return 0;
+
+  return _ptrImpl->Stop();
+}
+
+bool SharedMemoryCommunication::isRunning() const {
+  return _ptrImpl->isRunning();
+}
+
+ConnectionStatus
+SharedMemoryCommunication::getCurrentConnectionStatus(const NodeNum node) const {
+  return _ptrImpl->getCurrentConnectionStatus(node);
+}
+
+int
+SharedMemoryCommunication::sendAsyncMessage(const NodeNum destNode,
+                                            const char *const message,
+                                            const size_t messageLength) {
+  return _ptrImpl->sendAsyncMessage(destNode, message, messageLength);
+}
+
+void
+SharedMemoryCommunication::setReceiver(NodeNum receiverNum,
+                                       IReceiver *receiver) {
+  _ptrImpl->setReceiver(receiverNum, receiver);
+}
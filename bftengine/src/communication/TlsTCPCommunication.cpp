@@ -33,6 +33,7 @@
 #include <regex>
 #include <cassert>
 #include <deque>
+#include <set>
 
 #include "boost/bind.hpp"
 #include <boost/asio.hpp>
@@ -86,41 +87,17 @@ class AsyncTlsConnection : public
 
  private:
 
+  // the buffer (message header and data) may be shared by the out queues of
+  // several connections (see TlsTcpImpl::sendAsyncMessageToMany)
   struct OutMessage {
-    char* data = nullptr;
+    std::shared_ptr<const char> data;
     size_t length = 0;
 
-    OutMessage(char* msg, uint32_t msgLength) :
-        data{msg},
+    OutMessage(std::shared_ptr<const char> msg, size_t msgLength) :
+        data{std::move(msg)},
         length{msgLength}
     {
     }
-
-    OutMessage& operator=(OutMessage&& other) {
-      if (this != &other) {
-        if(data) {
-          delete[] data;
-        }
-        data = other.data;
-        length = other.length;
-        other.data = nullptr;
-        other.length = 0;
-      }
-      return *this;
-    }
-
-    OutMessage(OutMessage&& other) : data{nullptr}, length{0} {
-      *this = std::move(other);
-    };
-
-    OutMessage& operator=(const OutMessage&) = delete;
-    OutMessage(const OutMessage& other) = delete;
-
-    ~OutMessage() {
-      if(data) {
-        delete[] data;
-      }
-    }
   };
 
   // msg header: 4 bytes msg length
@@ -851,7 +828,7 @@ class AsyncTlsConnection : public
   /// are in the out queue - if true, start another async_write with timer.
   /// 4. if timer ticks - the write hasn't completed, close the connection.
 
-  void put_message_header(char *data, uint32_t dataLength) {
+  static void put_message_header(char *data, uint32_t dataLength) {
     memcpy(data, &dataLength, MSG_LENGTH_FIELD_SIZE);
   }
 
@@ -875,7 +852,7 @@ class AsyncTlsConnection : public
   void start_async_write() {
     asio::async_write(
         *_socket,
-        asio::buffer(_outQueue.front().data, _outQueue.front().length),
+        asio::buffer(_outQueue.front().data.get(), _outQueue.front().length),
         boost::bind(
             &AsyncTlsConnection::async_write_complete,
             shared_from_this(),
@@ -983,18 +960,36 @@ class AsyncTlsConnection : public
     assert(data);
     assert(length > 0 && length <= _maxMessageLength - MSG_HEADER_SIZE);
 
+    send_buffer(create_out_buffer(data, length), length);
+  }
+
+  /**
+   * builds a buffer with the message header and the data, that can be passed
+   * to send_buffer() of one or more connections
+   */
+  static std::shared_ptr<const char> create_out_buffer(const char *data,
+                                                       uint32_t length) {
     char *buf = new char[length + MSG_HEADER_SIZE];
-    memset(buf, 0, length + MSG_HEADER_SIZE);
     put_message_header(buf, length);
     memcpy(buf + MSG_HEADER_SIZE, data, length);
+    return std::shared_ptr<const char>(buf, std::default_delete<char[]>());
+  }
+
+  /**
+   * same as send(data, length), for a buffer from create_out_buffer()
+   * @param buf header and data
+   * @param length data length (without the header)
+   */
+  void send_buffer(std::shared_ptr<const char> buf, uint32_t length) {
+    assert(buf);
+    assert(length > 0 && length <= _maxMessageLength - MSG_HEADER_SIZE);
 
     // here we lock to protect multiple thread access and to synch with callback
     // queue access
     lock_guard<mutex> l(_writeLock);
 
     // push to the output queue
-    OutMessage out = OutMessage(buf, length + MSG_HEADER_SIZE);
-    _outQueue.push_back(std::move(out));
+    _outQueue.emplace_back(std::move(buf), length + MSG_HEADER_SIZE);
 
     // if there is only one message in the queue there are no pending writes
     // - we can start one
@@ -1386,6 +1381,35 @@ class TlsTCPCommunication::TlsTcpImpl :
     return 0;
   }
 
+  /**
+  * Sends the same message to each of the given destination nodes. The message
+  * is copied once, to a buffer that is shared by the out queues of the
+  * connections.
+  * Returns 0 on success.
+  */
+  int sendAsyncMessageToMany(const std::set<NodeNum> &destNodes,
+                             const char *const message,
+                             const size_t messageLength) {
+    std::shared_ptr<const char> buf;
+    lock_guard<mutex> lock(_connectionsGuard);
+    for (NodeNum destNode : destNodes) {
+      auto temp = _connections.find(destNode);
+      if (temp == _connections.end()) {
+        LOG_DEBUG(_logger,
+                  "connection NOT found, from: " << _selfId
+                                                 << ", to: " << destNode);
+        continue;
+      }
+
+      if (!buf) {
+        buf = AsyncTlsConnection::create_out_buffer(message, messageLength);
+      }
+      temp->second->send_buffer(buf, messageLength);
+    }
+
+    return 0;
+  }
+
   ~TlsTcpImpl() {
     LOG_DEBUG(_logger, "TlsTCPDtor");
     _pIoThread = nullptr;
@@ -1444,6 +1468,13 @@ TlsTCPCommunication::sendAsyncMessage(const NodeNum destNode,
   return _ptrImpl->sendAsyncMessage(destNode, message, messageLength);
 }
 
+int
+TlsTCPCommunication::sendAsyncMessageToMany(const std::set<NodeNum>& destNodes,
+                                            const char *const message,
+                                            const size_t messageLength) {
+  return _ptrImpl->sendAsyncMessageToMany(destNodes, message, messageLength);
+}
+
 void
 TlsTCPCommunication::setReceiver(NodeNum receiverNum, IReceiver *receiver) {
   _ptrImpl->setReceiver(receiverNum, receiver);
@@ -0,0 +1,243 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include "DirtyPagesTracker.hpp"
+
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+
+namespace bftEngine {
+namespace SimpleInMemoryStateTransfer {
+namespace impl {
+
+#ifdef __linux__
+
+static const uint64_t kSoftDirtyBit = (1ULL << 55);  // of a pagemap entry
+static const size_t kEntriesPerRead = 512;
+
+// the state of the SIGSEGV handler (at most one tracker uses WriteProtection)
+static std::atomic<bool> writeProtectionInUse{false};
+static struct {
+  volatile uint8_t* writtenPages;
+  uintptr_t firstPage;  // the protected pages are [firstPage, endPage)
+  uintptr_t endPage;
+  uint32_t pageSize;
+  struct sigaction previousAction;
+} wpState;
+
+static void onWriteFault(int sig, siginfo_t* info, void* context) {
+  const uintptr_t page =
+      reinterpret_cast<uintptr_t>(info->si_addr) / wpState.pageSize;
+
+  if (wpState.writtenPages != nullptr && info->si_code == SEGV_ACCERR &&
+      page >= wpState.firstPage && page < wpState.endPage) {
+    wpState.writtenPages[page - wpState.firstPage] = 1;
+    void* addr = reinterpret_cast<void*>(page * wpState.pageSize);
+    if (mprotect(addr, wpState.pageSize, PROT_READ | PROT_WRITE) == 0) return;
+  }
+
+  // not a write to the tracked region
+  const struct sigaction& prev = wpState.previousAction;
+  if (prev.sa_flags & SA_SIGINFO) {
+    prev.sa_sigaction(sig, info, context);
+  } else if (prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN) {
+    prev.sa_handler(sig);
+  } else {
+    // the faulting instruction is executed again, with the default action
+    struct sigaction dfl = {};
+    dfl.sa_handler = SIG_DFL;
+    sigaction(SIGSEGV, &dfl, nullptr);
+  }
+}
+
+DirtyPagesTracker::DirtyPagesTracker(char* begin, uint32_t size,
+                                     bool useSoftDirtyBits)
+    : begin_(begin), size_(size) {
+  osPageSize_ = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+  if (size_ == 0) return;
+
+  firstPage_ = reinterpret_cast<uintptr_t>(begin_) / osPageSize_;
+  lastPage_ = (reinterpret_cast<uintptr_t>(begin_) + size_ - 1) / osPageSize_;
+
+  // the pages that only partially belong to the region are never protected
+  firstProtectedPage_ =
+      (reinterpret_cast<uintptr_t>(begin_) + osPageSize_ - 1) / osPageSize_;
+  endProtectedPage_ =
+      (reinterpret_cast<uintptr_t>(begin_) + size_) / osPageSize_;
+  if (endProtectedPage_ < firstProtectedPage_)
+    endProtectedPage_ = firstProtectedPage_;
+
+  if (useSoftDirtyBits && initSoftDirtyBits())
+    method_ = SoftDirtyBits;
+  else if (initWriteProtection())
+    method_ = WriteProtection;
+}
+
+DirtyPagesTracker::~DirtyPagesTracker() {
+  if (pagemapFd_ >= 0) close(pagemapFd_);
+  if (clearRefsFd_ >= 0) close(clearRefsFd_);
+
+  if (method_ == WriteProtection) {
+    if (endProtectedPage_ > firstProtectedPage_)
+      mprotect(reinterpret_cast<void*>(firstProtectedPage_ * osPageSize_),
+               (endProtectedPage_ - firstProtectedPage_) * osPageSize_,
+               PROT_READ | PROT_WRITE);
+    sigaction(SIGSEGV, &wpState.previousAction, nullptr);
+    wpState.writtenPages = nullptr;
+    writeProtectionInUse = false;
+  }
+}
+
+bool DirtyPagesTracker::reset() {
+  switch (method_) {
+    case SoftDirtyBits:
+      // "4" clears the soft-dirty bits (and write-protects the pages in the
+      // kernel, so the next write to each page sets its bit)
+      return (pwrite(clearRefsFd_, "4", 1, 0) == 1);
+    case WriteProtection:
+      for (uintptr_t p = 0; p < endProtectedPage_ - firstProtectedPage_; p++)
+        writtenPages_[p] = 0;
+      if (endProtectedPage_ == firstProtectedPage_) return true;
+      return (mprotect(
+                  reinterpret_cast<void*>(firstProtectedPage_ * osPageSize_),
+                  (endProtectedPage_ - firstProtectedPage_) * osPageSize_,
+                  PROT_READ) == 0);
+    default:
+      return false;
+  }
+}
+
+bool DirtyPagesTracker::getDirtyPages(std::vector<int64_t>& outOffsets) const {
+  outOffsets.clear();
+  const intptr_t begin = reinterpret_cast<intptr_t>(begin_);
+
+  if (method_ == WriteProtection) {
+    for (uintptr_t p = firstPage_; p <= lastPage_; p++) {
+      const bool isProtected =
+          (p >= firstProtectedPage_ && p < endProtectedPage_);
+      if (!isProtected || writtenPages_[p - firstProtectedPage_] != 0)
+        outOffsets.push_back(static_cast<int64_t>(p * osPageSize_) - begin);
+    }
+    return true;
+  }
+
+  if (method_ != SoftDirtyBits) return false;
+
+  uint64_t entries[kEntriesPerRead];
+  for (uintptr_t p = firstPage_; p <= lastPage_; p += kEntriesPerRead) {
+    size_t n = lastPage_ - p + 1;
+    if (n > kEntriesPerRead) n = kEntriesPerRead;
+
+    const ssize_t bytes = static_cast<ssize_t>(n * sizeof(uint64_t));
+    if (pread(pagemapFd_, entries, bytes,
+              static_cast<off_t>(p * sizeof(uint64_t))) != bytes)
+      return false;
+
+    for (size_t i = 0; i < n; i++) {
+      if ((entries[i] & kSoftDirtyBit) != 0)
+        outOffsets.push_back(static_cast<int64_t>((p + i) * osPageSize_) -
+                             begin);
+    }
+  }
+  return true;
+}
+
+bool DirtyPagesTracker::initSoftDirtyBits() {
+  pagemapFd_ = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+  clearRefsFd_ = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+
+  // check that a write to a page sets its soft-dirty bit (after a reset)
+  void* probe = nullptr;
+  bool ok = (pagemapFd_ >= 0) && (clearRefsFd_ >= 0) &&
+            (posix_memalign(&probe, osPageSize_, osPageSize_) == 0);
+  if (ok) {
+    const off_t entryOffset = static_cast<off_t>(
+        (reinterpret_cast<uintptr_t>(probe) / osPageSize_) * sizeof(uint64_t));
+    uint64_t before = 0;
+    uint64_t after = 0;
+
+    static_cast<volatile char*>(probe)[0] = 1;
+    ok = (pwrite(clearRefsFd_, "4", 1, 0) == 1) &&
+         (pread(pagemapFd_, &before, sizeof(before), entryOffset) ==
+          sizeof(before));
+    static_cast<volatile char*>(probe)[0] = 2;
+    ok = ok &&
+         (pread(pagemapFd_, &after, sizeof(after), entryOffset) ==
+          sizeof(after)) &&
+         ((before & kSoftDirtyBit) == 0) && ((after & kSoftDirtyBit) != 0);
+  }
+  free(probe);
+
+  if (!ok) {
+    if (pagemapFd_ >= 0) close(pagemapFd_);
+    if (clearRefsFd_ >= 0) close(clearRefsFd_);
+    pagemapFd_ = -1;
+    clearRefsFd_ = -1;
+  }
+  return ok;
+}
+
+bool DirtyPagesTracker::initWriteProtection() {
+  if (writeProtectionInUse.exchange(true)) return false;
+
+  writtenPages_.reset(
+      new volatile uint8_t[endProtectedPage_ - firstProtectedPage_ + 1]());
+
+  wpState.firstPage = firstProtectedPage_;
+  wpState.endPage = endProtectedPage_;
+  wpState.pageSize = osPageSize_;
+  wpState.writtenPages = writtenPages_.get();
+
+  struct sigaction action = {};
+  action.sa_sigaction = &onWriteFault;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGSEGV, &action, &wpState.previousAction) != 0) {
+    wpState.writtenPages = nullptr;
+    writeProtectionInUse = false;
+    return false;
+  }
+  return true;
+}
+
+#else
+
+DirtyPagesTracker::DirtyPagesTracker(char* begin, uint32_t size, bool)
+    : begin_(begin), size_(size) {}
+
+DirtyPagesTracker::~DirtyPagesTracker() {}
+
+bool DirtyPagesTracker::reset() { return false; }
+
+bool DirtyPagesTracker::getDirtyPages(std::vector<int64_t>& outOffsets) const {
+  outOffsets.clear();
+  return false;
+}
+
+bool DirtyPagesTracker::initSoftDirtyBits() { return false; }
+
+bool DirtyPagesTracker::initWriteProtection() { return false; }
+
+#endif
+
+}  // namespace impl
+}  // namespace SimpleInMemoryStateTransfer
+}  // namespace bftEngine
@@ -0,0 +1,91 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#ifndef BFTENGINE_SRC_SIMPLESTATETRANSFER_DIRTYPAGESTRACKER_HPP_
+#define BFTENGINE_SRC_SIMPLESTATETRANSFER_DIRTYPAGESTRACKER_HPP_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+namespace bftEngine {
+namespace SimpleInMemoryStateTransfer {
+namespace impl {
+
+// Finds the OS pages of a memory region that were written since the last call
+// to reset(), without any help from the code that writes to the region.
+// Two methods are supported (Linux only):
+// - SoftDirtyBits: the soft-dirty bits that the kernel keeps for each page
+//   (see Documentation/admin-guide/mm/soft-dirty.rst). reset() clears the bits
+//   of the whole process. Requires CONFIG_MEM_SOFT_DIRTY.
+// - WriteProtection (used if soft-dirty bits are not supported): reset()
+//   write-protects the region, and the first write to each page is caught by a
+//   SIGSEGV handler, which records the page and unprotects it. Only one
+//   tracker per process can use this method. System calls that write to a
+//   protected page fail with EFAULT instead of faulting, so the region should
+//   only be written by user code. Only the pages that are fully inside the
+//   region are protected (other data may share the first and last pages), and
+//   the partial pages are always reported as dirty.
+class DirtyPagesTracker {
+ public:
+  enum Method { None, SoftDirtyBits, WriteProtection };
+
+  // if useSoftDirtyBits is false, only WriteProtection is tried
+  DirtyPagesTracker(char* begin, uint32_t size, bool useSoftDirtyBits = true);
+  ~DirtyPagesTracker();
+
+  Method method() const { return method_; }
+
+  // size of the pages that are reported by getDirtyPages
+  uint32_t osPageSize() const { return osPageSize_; }
+
+  bool reset();
+
+  // the offsets (relative to the beginning of the region, in increasing order)
+  // of the OS pages that were written since the last reset(). The first
+  // offset is negative if the region is not aligned to osPageSize().
+  // Returns false if the pages cannot be read (the caller should then treat
+  // the whole region as dirty).
+  bool getDirtyPages(std::vector<int64_t>& outOffsets) const;
+
+ private:
+  bool initSoftDirtyBits();
+  bool initWriteProtection();
+
+  char* const begin_;
+  const uint32_t size_;
+  uint32_t osPageSize_ = 0;
+  uintptr_t firstPage_ = 0;  // OS page numbers of the region
+  uintptr_t lastPage_ = 0;
+  Method method_ = None;
+
+  // the pages in [firstProtectedPage_, endProtectedPage_) are write-protected
+  // by reset() (WriteProtection only)
+  uintptr_t firstProtectedPage_ = 0;
+  uintptr_t endProtectedPage_ = 0;
+
+  // SoftDirtyBits
+  int pagemapFd_ = -1;
+  int clearRefsFd_ = -1;
+
+  // WriteProtection (written by the SIGSEGV handler, one entry per protected
+  // page)
+  std::unique_ptr<volatile uint8_t[]> writtenPages_;
+};
+
+}  // namespace impl
+}  // namespace SimpleInMemoryStateTransfer
+}  // namespace bftEngine
+
+#endif  // BFTENGINE_SRC_SIMPLESTATETRANSFER_DIRTYPAGESTRACKER_HPP_
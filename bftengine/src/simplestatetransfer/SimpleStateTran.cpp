@@ -13,13 +13,16 @@
 
 
 #include <string.h>
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "SimpleStateTransfer.hpp"
 #include "SimpleBCStateTransfer.hpp"
+#include "DirtyPagesTracker.hpp"
 #include "Logging.hpp"
 
 #define Assert(expr) {                                             \
@@ -43,7 +46,7 @@ class SimpleStateTran : public ISimpleInMemoryStateTransfer {
  public:
   SimpleStateTran(char* ptrToState, uint32_t sizeOfState,
     uint16_t myReplicaId, uint16_t fVal,
-    uint16_t cVal, bool pedanticChecks);
+    uint16_t cVal, bool pedanticChecks, bool trackDirtyPages);
 
   virtual ~SimpleStateTran();
 
@@ -103,6 +106,10 @@ class SimpleStateTran : public ISimpleInMemoryStateTransfer {
   void markUpdate(void* ptrToUpdatedRegion,
     uint32_t sizeOfUpdatedRegion) override;
 
+  bool tracksDirtyPages() const override {
+    return (dirtyPagesTracker_ != nullptr);
+  }
+
  protected:
   //////////////////////////////////////////////////////////////////////////
   // DummyBDState
@@ -217,6 +224,13 @@ class SimpleStateTran : public ISimpleInMemoryStateTransfer {
 
   std::set<uint32_t> updateAppPages_;
 
+  // finds the updated pages automatically (nullptr if not used)
+  DirtyPagesTracker* dirtyPagesTracker_ = nullptr;
+
+  // true if the last reset of dirtyPagesTracker_ failed (then all the pages
+  // are treated as updated in the next checkpoint)
+  bool allPagesDirty_ = false;
+
   // information about checkpoints
 
   uint64_t lastKnownCheckpoint = 0;
@@ -291,6 +305,10 @@ class SimpleStateTran : public ISimpleInMemoryStateTransfer {
     return idx;
   }
 
+  void addDirtyPagesToUpdateAppPages();
+
+  void resetDirtyPagesTracker();
+
   void onComplete(int64_t checkpointNumberOfNewState);
 };
 
@@ -299,12 +317,12 @@ class SimpleStateTran : public ISimpleInMemoryStateTransfer {
 ISimpleInMemoryStateTransfer* create(
   void* ptrToState, uint32_t sizeOfState,
   uint16_t myReplicaId, uint16_t fVal,
-  uint16_t cVal, bool pedanticChecks) {
+  uint16_t cVal, bool pedanticChecks, bool trackDirtyPages) {
   // TODO(GG): check arguments
 
   ISimpleInMemoryStateTransfer* retVal =
     new impl::SimpleStateTran(reinterpret_cast<char*>(ptrToState), sizeOfState,
-      myReplicaId, fVal, cVal, pedanticChecks);
+      myReplicaId, fVal, cVal, pedanticChecks, trackDirtyPages);
 
   return retVal;
 }
@@ -316,7 +334,8 @@ SimpleStateTran::SimpleStateTran(char* ptrToState,
   uint16_t myReplicaId,
   uint16_t fVal,
     uint16_t cVal,
-    bool pedanticChecks)
+    bool pedanticChecks,
+    bool trackDirtyPages)
   :
   ptrToState_{ ptrToState },
   sizeOfState_{ sizeOfState }
@@ -334,6 +353,17 @@ SimpleStateTran::SimpleStateTran(char* ptrToState,
   Assert(internalST_ != nullptr);
 
   replicaWrapper_.stObject = this;
+
+  if (trackDirtyPages) {
+    dirtyPagesTracker_ = new DirtyPagesTracker(ptrToState_, sizeOfState_);
+
+    if (dirtyPagesTracker_->method() == DirtyPagesTracker::None) {
+      LOG_WARN(STLogger, "SimpleStateTran - dirty pages cannot be tracked "
+        "on this platform (markUpdate should be used)");
+      delete dirtyPagesTracker_;
+      dirtyPagesTracker_ = nullptr;
+    }
+  }
 }
 
 SimpleStateTran::~SimpleStateTran() {
@@ -341,6 +371,8 @@ SimpleStateTran::~SimpleStateTran() {
 
   delete internalST_;
 
+  delete dirtyPagesTracker_;
+
   if (tempBuffer_ != nullptr) std::free(tempBuffer_);
 }
 
@@ -426,6 +458,9 @@ void SimpleStateTran::startRunning(IReplicaForStateTransfer* r) {
   Assert(replicaWrapper_.realInterface_ == nullptr);
   replicaWrapper_.realInterface_ = r;
 
+  // the initial state is not transferred
+  if (dirtyPagesTracker_ != nullptr) resetDirtyPagesTracker();
+
   internalST_->startRunning(&replicaWrapper_);
 }
 
@@ -450,6 +485,8 @@ void SimpleStateTran::createCheckpointOfCurrentState(
 
   lastKnownCheckpoint = checkpointNumber;
 
+  if (dirtyPagesTracker_ != nullptr) addDirtyPagesToUpdateAppPages();
+
   //  map from a metadata page to its set of updated app pages
   std::map<uint32_t, std::set<uint32_t> > pagesMap;
 
@@ -609,9 +646,48 @@ void SimpleStateTran::markUpdate(void* ptrToUpdatedRegion,
 
   Assert(startLocation < ((size_t)sizeOfState_));
 
-  uint32_t p = (((uint32_t)startLocation) / pageSize_);
+  size_t endLocation = startLocation + sizeOfUpdatedRegion;
+  if (endLocation > ((size_t)sizeOfState_)) endLocation = sizeOfState_;
 
-  updateAppPages_.insert(p);
+  // all the pages of the region
+  const uint32_t firstPage = (((uint32_t)startLocation) / pageSize_);
+  uint32_t lastPage = firstPage;
+  if (endLocation > startLocation)
+    lastPage = (((uint32_t)(endLocation - 1)) / pageSize_);
+
+  for (uint32_t p = firstPage; p <= lastPage; p++) updateAppPages_.insert(p);
+}
+
+void SimpleStateTran::addDirtyPagesToUpdateAppPages() {
+  std::vector<int64_t> dirtyOsPages;
+  if (allPagesDirty_ || !dirtyPagesTracker_->getDirtyPages(dirtyOsPages)) {
+    LOG_WARN(STLogger, "SimpleStateTran - dirty pages are not available "
+      "(all the pages are treated as updated)");
+    for (uint32_t p = 0; p < numberOfAppPages_; p++) updateAppPages_.insert(p);
+    dirtyOsPages.clear();
+  }
+
+  const int64_t osPageSize = dirtyPagesTracker_->osPageSize();
+
+  for (int64_t offset : dirtyOsPages) {
+    const int64_t begin = std::max<int64_t>(offset, 0);
+    const int64_t end = std::min<int64_t>(offset + osPageSize, sizeOfState_);
+    if (begin >= end) continue;
+
+    const uint32_t firstPage = (uint32_t)(begin / pageSize_);
+    const uint32_t lastPage = (uint32_t)((end - 1) / pageSize_);
+
+    for (uint32_t p = firstPage; p <= lastPage; p++) updateAppPages_.insert(p);
+  }
+
+  // the next checkpoint only includes the pages that are written from now on
+  resetDirtyPagesTracker();
+}
+
+void SimpleStateTran::resetDirtyPagesTracker() {
+  allPagesDirty_ = !dirtyPagesTracker_->reset();
+  if (allPagesDirty_)
+    LOG_WARN(STLogger, "SimpleStateTran - failed to reset the dirty pages");
 }
 
 void SimpleStateTran::onComplete(int64_t checkpointNumberOfNewState) {
@@ -644,6 +720,9 @@ void SimpleStateTran::onComplete(int64_t checkpointNumberOfNewState) {
     }
   }
 
+  // the loaded pages are already part of the new checkpoint
+  if (dirtyPagesTracker_ != nullptr) resetDirtyPagesTracker();
+
   lastKnownCheckpoint = checkpointNumberOfNewState;
 }
 
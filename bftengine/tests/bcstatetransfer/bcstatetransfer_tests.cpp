@@ -15,6 +15,7 @@
 #include "SimpleBCStateTransfer.hpp"
 #include "InMemoryDataStore.hpp"
 #include "BCStateTran.hpp"
+#include "Compression.hpp"
 #include "test_app_state.hpp"
 #include "test_replica.hpp"
 
@@ -90,5 +91,96 @@ TEST_F(BcStTest, FetchMissingData) {
 
 }
 
+// Create a chunk that looks like a simpleKVBC block: repeated keys and values
+std::string kv_like_chunk(size_t size) {
+  std::string chunk;
+  for (size_t i = 0; chunk.size() < size; i++) {
+    chunk += "key-" + std::to_string(i % 17) + "=value-" + std::to_string(i % 5);
+  }
+  chunk.resize(size);
+  return chunk;
+}
+
+TEST(CompressionTest, RoundTrip) {
+  for (size_t size : {1, 11, 12, 13, 128, 2048, 70000}) {
+    std::string raw = kv_like_chunk(size);
+    std::vector<char> compressed(raw.size() + 16);
+    uint32_t compressed_size = compressChunk(raw.data(), raw.size(),
+                                             compressed.data(),
+                                             compressed.size());
+    ASSERT_GT(compressed_size, 0);
+
+    std::string decompressed(raw.size(), '\0');
+    ASSERT_TRUE(decompressChunk(compressed.data(), compressed_size,
+                                &decompressed[0], decompressed.size()));
+    ASSERT_EQ(raw, decompressed);
+
+    if (size >= 2048) {
+      ASSERT_LT(compressed_size * 3, raw.size());
+    }
+  }
+}
+
+TEST(CompressionTest, IncompressibleDataDoesNotFit) {
+  std::string raw(2048, '\0');
+  uint32_t x = 12345;
+  for (auto& c : raw) {
+    x = x * 1103515245 + 12345;
+    c = static_cast<char>(x >> 24);
+  }
+  std::vector<char> compressed(raw.size() - 1);
+  ASSERT_EQ(0, compressChunk(raw.data(), raw.size(),
+                             compressed.data(), compressed.size()));
+}
+
+TEST(CompressionTest, RejectsMalformedData) {
+  std::string raw = kv_like_chunk(2048);
+  std::vector<char> compressed(raw.size());
+  uint32_t compressed_size = compressChunk(raw.data(), raw.size(),
+                                           compressed.data(),
+                                           compressed.size());
+  ASSERT_GT(compressed_size, 0);
+
+  std::string out(raw.size(), '\0');
+
+  // wrong expected size
+  ASSERT_FALSE(decompressChunk(compressed.data(), compressed_size,
+                               &out[0], raw.size() - 1));
+  // truncated input
+  ASSERT_FALSE(decompressChunk(compressed.data(), compressed_size - 1,
+                               &out[0], raw.size()));
+  // match offset pointing before the beginning of the output
+  const char bad_offset[] = { 0x10, 'a', 0x02, 0x00 };
+  ASSERT_FALSE(decompressChunk(bad_offset, sizeof(bad_offset),
+                               &out[0], 5));
+}
+
+TEST(CompressionTest, ChunkCompressorCompressesAllItems) {
+  ChunkCompressor compressor(3);
+  std::vector<std::string> raws;
+  std::vector<std::vector<char>> outs;
+  for (int i = 0; i < 24; i++) {
+    raws.push_back(kv_like_chunk(2048 - i));
+    outs.emplace_back(raws.back().size());
+  }
+
+  std::vector<ChunkCompressor::Item> items;
+  for (size_t i = 0; i < raws.size(); i++) {
+    items.push_back({ raws[i].data(), static_cast<uint32_t>(raws[i].size()),
+                      outs[i].data(), static_cast<uint32_t>(outs[i].size()),
+                      0 });
+  }
+
+  compressor.compress(items);
+
+  for (size_t i = 0; i < items.size(); i++) {
+    ASSERT_GT(items[i].outSize, 0);
+    std::string decompressed(raws[i].size(), '\0');
+    ASSERT_TRUE(decompressChunk(outs[i].data(), items[i].outSize,
+                                &decompressed[0], decompressed.size()));
+    ASSERT_EQ(raws[i], decompressed);
+  }
+}
+
 } // namespace SimpleBlockchainStateTransfer
 } // namespace bftEngine
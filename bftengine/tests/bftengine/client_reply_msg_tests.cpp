@@ -0,0 +1,124 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "ClientReplyMsg.hpp"
+#include "MsgsCertificate.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+// the client certificate of tentative replies (F=1, C=0)
+typedef MsgsCertificate<ClientReplyMsg, false, false, true, ClientReplyMsg>
+    TentativeCertificate;
+const uint16_t kF = 1;
+const uint16_t kNumOfReplicas = 3 * kF + 1;
+const uint16_t kRequired = 3 * kF + 1;
+
+ClientReplyMsg* tentativeReply(ReplicaId sender, const std::string& reply,
+                               ViewNum view, SeqNum seqNum,
+                               const Digest& history) {
+  ClientReplyMsg* m = new ClientReplyMsg(sender, 7, (char*)reply.data(),
+                                         reply.size(), view, seqNum, history);
+  m->setPrimaryId(0);
+  return m;
+}
+
+TEST(ClientReplyMsgTest, tentative_reply) {
+  const std::string reply = "result";
+  const Digest history(5);
+  ClientReplyMsg m(2, 7, (char*)reply.data(), reply.size(), 3, 42, history);
+
+  EXPECT_TRUE(m.isTentative());
+  EXPECT_EQ(MsgCode::TentativeReply, m.type());
+  EXPECT_EQ(7u, m.reqSeqNum());
+  EXPECT_EQ(3, m.viewNumber());
+  EXPECT_EQ(42, m.seqNumber());
+  EXPECT_EQ(history, m.historyDigest());
+  EXPECT_EQ(reply.size(), m.replyLength());
+  EXPECT_EQ(0, memcmp(reply.data(), m.replyBuf(), reply.size()));
+  EXPECT_EQ(sizeof(ClientTentativeReplyMsgHeader) + reply.size(), m.size());
+
+  ClientReplyMsg* out = nullptr;
+  EXPECT_TRUE(ClientReplyMsg::ToActualMsgType(0, &m, out));
+  EXPECT_EQ(&m, out);
+
+  // a message that is too short for the tentative header
+  ClientReplyMsg plain(2, 7, (char*)reply.data(), reply.size());
+  EXPECT_FALSE(plain.isTentative());
+  EXPECT_EQ(sizeof(ClientReplyMsgHeader) + reply.size(), plain.size());
+  plain.b()->msgType = MsgCode::TentativeReply;
+  EXPECT_FALSE(ClientReplyMsg::ToActualMsgType(0, &plain, out));
+}
+
+TEST(ClientReplyMsgTest, tentative_replies_are_equivalent) {
+  const Digest history(5);
+  ClientReplyMsg* r1 = tentativeReply(1, "result", 3, 42, history);
+
+  ClientReplyMsg* same = tentativeReply(2, "result", 3, 42, history);
+  ClientReplyMsg* otherReply = tentativeReply(2, "other!", 3, 42, history);
+  ClientReplyMsg* otherView = tentativeReply(2, "result", 4, 42, history);
+  ClientReplyMsg* otherSeqNum = tentativeReply(2, "result", 3, 43, history);
+  ClientReplyMsg* otherHistory =
+      tentativeReply(2, "result", 3, 42, Digest(6));
+
+  const std::string reply = "result";
+  ClientReplyMsg committed(2, 7, (char*)reply.data(), reply.size());
+  committed.setPrimaryId(0);
+
+  EXPECT_TRUE(ClientReplyMsg::equivalent(r1, same));
+  EXPECT_FALSE(ClientReplyMsg::equivalent(r1, otherReply));
+  EXPECT_FALSE(ClientReplyMsg::equivalent(r1, otherView));
+  EXPECT_FALSE(ClientReplyMsg::equivalent(r1, otherSeqNum));
+  EXPECT_FALSE(ClientReplyMsg::equivalent(r1, otherHistory));
+  EXPECT_FALSE(ClientReplyMsg::equivalent(r1, &committed));
+
+  for (ClientReplyMsg* m : {r1, same, otherReply, otherView, otherSeqNum,
+                            otherHistory})
+    delete m;
+}
+
+TEST(ClientReplyMsgTest, certificate_of_tentative_replies) {
+  const Digest history(5);
+
+  TentativeCertificate certificate(kNumOfReplicas, kF, kRequired, 100);
+  for (ReplicaId id = 0; id < kNumOfReplicas; id++) {
+    EXPECT_FALSE(certificate.isComplete());
+    certificate.addMsg(tentativeReply(id, "result", 0, 11, history), id);
+  }
+  EXPECT_TRUE(certificate.isComplete());
+
+  // the same reply, executed at different SeqNums (e.g. by an equivocating
+  // primary) or after different histories, does not complete the certificate
+  TentativeCertificate seqNums(kNumOfReplicas, kF, kRequired, 100);
+  seqNums.addMsg(tentativeReply(0, "result", 0, 11, history), 0);
+  seqNums.addMsg(tentativeReply(1, "result", 0, 11, history), 1);
+  seqNums.addMsg(tentativeReply(2, "result", 0, 11, history), 2);
+  seqNums.addMsg(tentativeReply(3, "result", 0, 12, history), 3);
+  EXPECT_FALSE(seqNums.isComplete());
+
+  TentativeCertificate histories(kNumOfReplicas, kF, kRequired, 100);
+  histories.addMsg(tentativeReply(0, "result", 0, 11, history), 0);
+  histories.addMsg(tentativeReply(1, "result", 0, 11, history), 1);
+  histories.addMsg(tentativeReply(2, "result", 0, 11, Digest(6)), 2);
+  histories.addMsg(tentativeReply(3, "result", 0, 11, history), 3);
+  EXPECT_FALSE(histories.isComplete());
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,158 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stddef.h>
+#include <string.h>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ClientRequestMsg.hpp"
+#include "Crypto.hpp"
+#include "SigManager.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+const ReplicaId kFirstClient = 4;
+const int kNumOfClients = 5;
+
+class ClientRequestSignaturesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string replicaPublicKey;
+    std::string replicaPrivateKey;
+    ASSERT_TRUE(
+        EdDSAKeysGenerator::generateKeys(replicaPublicKey, replicaPrivateKey));
+
+    std::set<SigManager::PublicKeyDesc> clientKeys;
+    for (int i = 0; i < kNumOfClients; i++) {
+      std::string publicKey;
+      std::string privateKey;
+      ASSERT_TRUE(EdDSAKeysGenerator::generateKeys(publicKey, privateKey));
+      clientKeys.insert({(ReplicaId)(kFirstClient + i), publicKey});
+      signers.emplace_back(new EdDSASigner(privateKey.c_str()));
+    }
+
+    sigManager.reset(new SigManager(0, kFirstClient + kNumOfClients,
+                                    replicaPrivateKey, {{0, replicaPublicKey}},
+                                    SignatureScheme::EdDSA, clientKeys));
+  }
+
+  // a signed request of client i (a copy, as received by a replica)
+  std::vector<char> SignedRequest(int i, ReqId reqSeqNum,
+                                  const std::string& request) {
+    ClientRequestMsg m(kFirstClient + i, false, reqSeqNum,
+                       (uint32_t)request.size(), request.data(), true);
+    m.setAsTraced();
+    m.sign(*signers[i]);
+    return std::vector<char>(m.body(), m.body() + m.size());
+  }
+
+  // verifies the signatures of the requests in a single call
+  bool VerifyAll(const std::vector<std::vector<char>>& requests) {
+    std::vector<ReplicaId> ids;
+    std::vector<const char*> data;
+    std::vector<size_t> dataLengths;
+    std::vector<const char*> sigs;
+    std::vector<size_t> sigLengths;
+    for (const std::vector<char>& r : requests) {
+      ClientRequestMsg m((ClientRequestMsgHeader*)r.data());
+      ids.push_back(m.clientProxyId());
+      data.push_back(m.body());
+      dataLengths.push_back(m.signedDataLength());
+      sigs.push_back(m.signature());
+      sigLengths.push_back(ClientRequestMsg::signatureLength);
+    }
+    return sigManager->verifySigs(ids.size(), ids.data(), data.data(),
+                                  dataLengths.data(), sigs.data(),
+                                  sigLengths.data());
+  }
+
+  std::vector<std::unique_ptr<EdDSASigner>> signers;
+  std::unique_ptr<SigManager> sigManager;
+};
+
+TEST_F(ClientRequestSignaturesTest, signed_request) {
+  const std::string request = "request";
+  std::vector<char> buf = SignedRequest(2, 17, request);
+  ASSERT_EQ(sizeof(ClientRequestMsgHeader) + request.size() +
+                ClientRequestMsg::signatureLength,
+            buf.size());
+
+  ClientRequestMsg m((ClientRequestMsgHeader*)buf.data());
+  EXPECT_EQ(buf.size(), m.size());
+  EXPECT_TRUE(m.isSigned());
+  EXPECT_TRUE(m.isTraced());
+  EXPECT_FALSE(m.isReadOnly());
+  EXPECT_EQ(kFirstClient + 2, m.clientProxyId());
+  EXPECT_EQ(17u, m.requestSeqNum());
+  EXPECT_EQ(request.size(), m.requestLength());
+  EXPECT_EQ(0, memcmp(request.data(), m.requestBuf(), request.size()));
+
+  EXPECT_TRUE(sigManager->hasPublicKeyOf(kFirstClient + 2));
+  EXPECT_FALSE(sigManager->hasPublicKeyOf(kFirstClient + kNumOfClients));
+  EXPECT_TRUE(sigManager->verifySig(m.clientProxyId(), m.body(),
+                                    m.signedDataLength(), m.signature(),
+                                    ClientRequestMsg::signatureLength));
+  EXPECT_FALSE(sigManager->verifySig(kFirstClient + 1, m.body(),
+                                     m.signedDataLength(), m.signature(),
+                                     ClientRequestMsg::signatureLength));
+
+  // unsigned requests have no signature
+  ClientRequestMsg unsignedRequest(kFirstClient, false, 18,
+                                   (uint32_t)request.size(), request.data());
+  EXPECT_FALSE(unsignedRequest.isSigned());
+  EXPECT_EQ(sizeof(ClientRequestMsgHeader) + request.size(),
+            unsignedRequest.size());
+}
+
+TEST_F(ClientRequestSignaturesTest, batches_of_requests) {
+  std::vector<std::vector<char>> requests;
+  EXPECT_TRUE(VerifyAll(requests));
+
+  for (int i = 0; i < 3 * kNumOfClients; i++) {
+    const std::string request(1 + i * 7, 'r');
+    requests.push_back(SignedRequest(i % kNumOfClients, 100 + i, request));
+    EXPECT_TRUE(VerifyAll(requests));
+  }
+
+  // a request, its flags, or its signature are modified
+  const size_t flagsOffset = offsetof(ClientRequestMsgHeader, flags);
+  for (size_t i = 0; i < requests.size(); i++) {
+    std::vector<std::vector<char>> modified = requests;
+    modified[i][modified[i].size() - ClientRequestMsg::signatureLength - 1] ^=
+        1;
+    EXPECT_FALSE(VerifyAll(modified));
+
+    modified = requests;
+    modified[i][flagsOffset] ^= 0x1;
+    EXPECT_FALSE(VerifyAll(modified));
+
+    modified = requests;
+    modified[i].back() ^= 0x10;
+    EXPECT_FALSE(VerifyAll(modified));
+  }
+
+  // a request of one client with the signature of another client
+  std::vector<std::vector<char>> forged = requests;
+  ((ClientRequestMsgHeader*)forged[0].data())->idOfClientProxy =
+      kFirstClient + 1;
+  EXPECT_FALSE(VerifyAll(forged));
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,336 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ClientsManager.hpp"
+#include "ClientReplyMsg.hpp"
+#include "IStateTransfer.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+const ReplicaId kMyId = 1;
+const uint32_t kPageSize = 4096;
+const NodeIdType kClient0 = 4;
+const NodeIdType kClient1 = 5;
+const uint16_t kNumOfClients = 2;
+const ReplicaId kPrimary = 2;
+const ReplicaId kOtherPrimary = 3;
+const uint32_t kMaxReplySize = maxReplyMessageSize - sizeof(ClientReplyMsgHeader);
+
+// Keeps the reserved pages in memory, and counts the saved pages
+class InMemoryReservedPages : public IStateTransfer {
+ public:
+  void init(uint64_t, uint32_t, uint32_t) override {}
+  void startRunning(IReplicaForStateTransfer*) override {}
+  void stopRunning() override {}
+  bool isRunning() const override { return true; }
+  void createCheckpointOfCurrentState(uint64_t) override {}
+  void markCheckpointAsStable(uint64_t) override {}
+  void getDigestOfCheckpoint(uint64_t, uint16_t, char*) override {}
+  void startCollectingState() override {}
+  bool isCollectingState() const override { return false; }
+  uint32_t numberOfReservedPages() const override { return 1000; }
+  uint32_t sizeOfReservedPage() const override { return kPageSize; }
+  void onTimer() override {}
+  void handleStateTransferMessage(char*, uint32_t, uint16_t) override {}
+
+  bool loadReservedPage(uint32_t reservedPageId, uint32_t copyLength,
+                        char* outReservedPage) const override {
+    numOfLoads++;
+    auto it = pages.find(reservedPageId);
+    if (it == pages.end()) {
+      memset(outReservedPage, 0, copyLength);
+    } else {
+      memcpy(outReservedPage, it->second.data(), copyLength);
+    }
+    return true;
+  }
+
+  void saveReservedPage(uint32_t reservedPageId, uint32_t copyLength,
+                        const char* inReservedPage) override {
+    numOfSaves++;
+    std::string& page = pages[reservedPageId];
+    page.assign(kPageSize, 0);
+    memcpy(&page[0], inReservedPage, copyLength);
+  }
+
+  void zeroReservedPage(uint32_t reservedPageId) override {
+    pages[reservedPageId].assign(kPageSize, 0);
+  }
+
+  std::map<uint32_t, std::string> pages;
+  mutable int numOfLoads = 0;
+  int numOfSaves = 0;
+};
+
+class ClientsManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { Init({kClient0, kClient1}, kMaxReplySize); }
+
+  void Init(std::set<NodeIdType> clients, uint32_t maxReplySize) {
+    clientsManager.reset(
+        new ClientsManager(kMyId, clients, kPageSize, maxReplySize));
+    clientsManager->init(&stateTransfer);
+    clientsManager->clearReservedPages();
+  }
+
+  // executes a request of clientId, and returns the content of the reply
+  std::string AddReply(NodeIdType clientId, ReqId reqSeqNum,
+                       uint32_t replyLength = 100) {
+    std::string reply(replyLength, 'a' + (reqSeqNum % 26));
+    std::unique_ptr<ClientReplyMsg> r(
+        clientsManager->allocateNewReplyMsgAndWriteToStorage(
+            clientId, reqSeqNum, kPrimary, &reply[0], replyLength));
+    EXPECT_EQ(reqSeqNum, r->reqSeqNum());
+    EXPECT_EQ(kPrimary, r->currentPrimaryId());
+    return reply;
+  }
+
+  // the reply of a client, as it appears in the reserved pages
+  std::string ReplyInReservedPages(uint16_t clientIdx) {
+    const uint32_t pagesPerClient =
+        clientsManager->numberOfRequiredReservedPages() / kNumOfClients;
+    std::string pages;
+    for (uint32_t i = 0; i < pagesPerClient; i++)
+      pages += stateTransfer.pages[clientIdx * pagesPerClient + i];
+    const ClientReplyMsgHeader* h = (const ClientReplyMsgHeader*)pages.data();
+    return pages.substr(0, sizeof(ClientReplyMsgHeader) + h->replyLength);
+  }
+
+  // the reply in the slot at offset in a reserved page (if the replies of
+  // several clients share the page)
+  std::string ReplyInSlot(uint32_t pageId, uint32_t offset) {
+    const std::string& page = stateTransfer.pages[pageId];
+    const ClientReplyMsgHeader* h =
+        (const ClientReplyMsgHeader*)(page.data() + offset);
+    return page.substr(offset, sizeof(ClientReplyMsgHeader) + h->replyLength);
+  }
+
+  void CheckReplyInReservedPages(uint16_t clientIdx, ReqId reqSeqNum,
+                                 const std::string& reply) {
+    CheckReplyMsg(ReplyInReservedPages(clientIdx), reqSeqNum, reply);
+  }
+
+  void CheckReplyMsg(const std::string& msg, ReqId reqSeqNum,
+                     const std::string& reply) {
+    ASSERT_GE(msg.size(), sizeof(ClientReplyMsgHeader));
+    const ClientReplyMsgHeader* h = (const ClientReplyMsgHeader*)msg.data();
+    ASSERT_EQ(MsgCode::Reply, h->msgType);
+    ASSERT_EQ(0, h->currentPrimaryId);
+    ASSERT_EQ(reqSeqNum, h->reqSeqNum);
+    ASSERT_EQ(reply, msg.substr(sizeof(ClientReplyMsgHeader)));
+  }
+
+  void CheckLatestReply(NodeIdType clientId, ReqId reqSeqNum,
+                        const std::string& reply) {
+    std::unique_ptr<ClientReplyMsg> r(
+        clientsManager->allocateMsgWithLatestReply(clientId, kOtherPrimary));
+    ASSERT_EQ(reqSeqNum, r->reqSeqNum());
+    ASSERT_EQ(kOtherPrimary, r->currentPrimaryId());
+    ASSERT_EQ(reply, std::string(r->replyBuf(), r->replyLength()));
+  }
+
+  InMemoryReservedPages stateTransfer;
+  std::unique_ptr<ClientsManager> clientsManager;
+};
+
+TEST_F(ClientsManagerTest, replies_are_written_by_flush) {
+  const std::string reply = AddReply(kClient0, 10);
+  ASSERT_EQ(0, stateTransfer.numOfSaves);
+  ASSERT_EQ(10u, clientsManager->seqNumberOfLastReplyToClient(kClient0));
+
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(1, stateTransfer.numOfSaves);
+  CheckReplyInReservedPages(0, 10, reply);
+
+  // nothing is dirty
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(1, stateTransfer.numOfSaves);
+}
+
+TEST_F(ClientsManagerTest, only_the_latest_reply_is_flushed) {
+  AddReply(kClient1, 10);
+  AddReply(kClient1, 11);
+  const std::string reply = AddReply(kClient1, 12);
+
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(1, stateTransfer.numOfSaves);
+  CheckReplyInReservedPages(1, 12, reply);
+  ASSERT_EQ(std::string(kPageSize, 0), stateTransfer.pages[0]);
+}
+
+TEST_F(ClientsManagerTest, reply_that_spans_pages_is_flushed) {
+  const uint32_t length = kPageSize + 100;
+  const std::string reply = AddReply(kClient0, 7, length);
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(2, stateTransfer.numOfSaves);
+  CheckReplyInReservedPages(0, 7, reply);
+}
+
+TEST_F(ClientsManagerTest, latest_reply_is_served_from_memory) {
+  const std::string reply = AddReply(kClient0, 10);
+  const int loads = stateTransfer.numOfLoads;
+
+  // before and after the flush
+  CheckLatestReply(kClient0, 10, reply);
+  clientsManager->flushRepliesToReservedPages();
+  CheckLatestReply(kClient0, 10, reply);
+  ASSERT_EQ(loads, stateTransfer.numOfLoads);
+}
+
+TEST_F(ClientsManagerTest, load_from_reserved_pages_drops_the_cache) {
+  AddReply(kClient0, 10);
+  clientsManager->flushRepliesToReservedPages();
+
+  // A newer reply arrives with the reserved pages (e.g., by state transfer)
+  InMemoryReservedPages other;
+  std::set<NodeIdType> clients{kClient0, kClient1};
+  ClientsManager otherManager(kMyId + 1, clients, kPageSize, kMaxReplySize);
+  otherManager.init(&other);
+  std::string newReply(50, 'z');
+  delete otherManager.allocateNewReplyMsgAndWriteToStorage(
+      kClient0, 20, kPrimary, &newReply[0], newReply.size());
+  otherManager.flushRepliesToReservedPages();
+  stateTransfer.pages = other.pages;
+
+  clientsManager->loadInfoFromReservedPages();
+  ASSERT_EQ(20u, clientsManager->seqNumberOfLastReplyToClient(kClient0));
+
+  const int loads = stateTransfer.numOfLoads;
+  CheckLatestReply(kClient0, 20, newReply);
+  ASSERT_LT(loads, stateTransfer.numOfLoads);
+
+  // the reply is cached again
+  const int loadsAfterReload = stateTransfer.numOfLoads;
+  CheckLatestReply(kClient0, 20, newReply);
+  ASSERT_EQ(loadsAfterReload, stateTransfer.numOfLoads);
+}
+
+TEST_F(ClientsManagerTest, load_from_reserved_pages_drops_dirty_replies) {
+  const std::string reply = AddReply(kClient0, 10);
+  clientsManager->flushRepliesToReservedPages();
+  AddReply(kClient0, 11);
+
+  clientsManager->loadInfoFromReservedPages();
+  ASSERT_EQ(10u, clientsManager->seqNumberOfLastReplyToClient(kClient0));
+
+  const int saves = stateTransfer.numOfSaves;
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(saves, stateTransfer.numOfSaves);
+  CheckReplyInReservedPages(0, 10, reply);
+  CheckLatestReply(kClient0, 10, reply);
+}
+
+TEST_F(ClientsManagerTest, clear_reserved_pages_drops_dirty_replies) {
+  AddReply(kClient0, 10);
+  AddReply(kClient1, 10);
+  clientsManager->clearReservedPages();
+
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(0, stateTransfer.numOfSaves);
+  for (const auto& page : stateTransfer.pages)
+    ASSERT_EQ(std::string(kPageSize, 0), page.second);
+}
+
+TEST_F(ClientsManagerTest, number_of_reserved_pages) {
+  std::set<NodeIdType> clients;
+  for (NodeIdType c = 4; c < 4 + 10000; c++) clients.insert(c);
+
+  // a slot of 16 + 1000 bytes: 4 clients per page
+  Init(clients, 1000);
+  EXPECT_EQ(2500u, clientsManager->numberOfRequiredReservedPages());
+
+  // a slot of a page: a page per client
+  Init(clients, kPageSize - sizeof(ClientReplyMsgHeader));
+  EXPECT_EQ(10000u, clientsManager->numberOfRequiredReservedPages());
+
+  // replies that span pages: 2 pages per client
+  Init(clients, kPageSize - sizeof(ClientReplyMsgHeader) + 1);
+  EXPECT_EQ(20000u, clientsManager->numberOfRequiredReservedPages());
+  Init(clients, kMaxReplySize);
+  EXPECT_EQ(20000u, clientsManager->numberOfRequiredReservedPages());
+
+  // the last page is not full
+  Init({kClient0, kClient1, 6, 7, 8}, 1000);
+  EXPECT_EQ(2u, clientsManager->numberOfRequiredReservedPages());
+}
+
+const uint32_t kSmallMaxReplySize = 1000;
+const uint32_t kSlotSize = sizeof(ClientReplyMsgHeader) + kSmallMaxReplySize;
+
+// the replies of 4 clients share a reserved page
+class ClientsManagerSharedPagesTest : public ClientsManagerTest {
+ protected:
+  void SetUp() override {
+    Init({kClient0, kClient1, 6, 7, 8, 9}, kSmallMaxReplySize);
+  }
+};
+
+TEST_F(ClientsManagerSharedPagesTest, replies_in_a_page_are_flushed_together) {
+  ASSERT_EQ(2u, clientsManager->numberOfRequiredReservedPages());
+
+  const std::string reply0 = AddReply(kClient0, 10);
+  const std::string reply1 = AddReply(kClient1, 10, kSmallMaxReplySize);
+  const std::string reply8 = AddReply(8, 10, 1);
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(2, stateTransfer.numOfSaves);
+
+  CheckReplyMsg(ReplyInSlot(0, 0), 10, reply0);
+  CheckReplyMsg(ReplyInSlot(0, kSlotSize), 10, reply1);
+  CheckReplyMsg(ReplyInSlot(1, 0), 10, reply8);
+  ASSERT_EQ(std::string(kSlotSize, 0),
+            stateTransfer.pages[0].substr(2 * kSlotSize, kSlotSize));
+
+  // a shorter reply zeroes the rest of its slot, and keeps the other slots
+  const std::string shorter = AddReply(kClient1, 11, 10);
+  clientsManager->flushRepliesToReservedPages();
+  ASSERT_EQ(3, stateTransfer.numOfSaves);
+  CheckReplyMsg(ReplyInSlot(0, 0), 10, reply0);
+  CheckReplyMsg(ReplyInSlot(0, kSlotSize), 11, shorter);
+  const size_t endOfShorter =
+      kSlotSize + sizeof(ClientReplyMsgHeader) + shorter.size();
+  ASSERT_EQ(std::string(2 * kSlotSize - endOfShorter, 0),
+            stateTransfer.pages[0].substr(endOfShorter,
+                                          2 * kSlotSize - endOfShorter));
+}
+
+TEST_F(ClientsManagerSharedPagesTest, replies_are_loaded_from_shared_pages) {
+  const std::string reply0 = AddReply(kClient0, 10);
+  const std::string reply7 = AddReply(7, 12, kSmallMaxReplySize);
+  const std::string reply9 = AddReply(9, 13, 1);
+  clientsManager->flushRepliesToReservedPages();
+
+  // drops the cached replies
+  const int loads = stateTransfer.numOfLoads;
+  clientsManager->loadInfoFromReservedPages();
+  ASSERT_EQ(loads + 2, stateTransfer.numOfLoads);
+  ASSERT_EQ(10u, clientsManager->seqNumberOfLastReplyToClient(kClient0));
+  ASSERT_EQ(0u, clientsManager->seqNumberOfLastReplyToClient(kClient1));
+  ASSERT_EQ(12u, clientsManager->seqNumberOfLastReplyToClient(7));
+  ASSERT_EQ(13u, clientsManager->seqNumberOfLastReplyToClient(9));
+
+  CheckLatestReply(kClient0, 10, reply0);
+  CheckLatestReply(7, 12, reply7);
+  CheckLatestReply(9, 13, reply9);
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,254 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "LatencyBasedController.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+const uint32_t kUnknown = UINT32_MAX;
+const uint32_t kDefaultTimerMilli = 150;
+const uint32_t kMinTimerMilli = 20;
+const uint32_t kMaxTimerMilli = 2000;
+
+// a controller (of replica id, in view 0) that gets synthetic latency samples
+class TestController : public LatencyBasedController {
+ public:
+  TestController(uint16_t c, uint16_t f, ReplicaId id)
+      : LatencyBasedController(c, f, id, 0, 0, true) {}
+
+  using LatencyBasedController::kthEstimate;
+
+  // replaces all the samples of a peer
+  void setLatency(ReplicaId id, uint32_t latencyMicro) {
+    for (size_t i = 0; i < NumOfSamples; i++)
+      latencies[id].add(latencyMicro, false);
+  }
+
+  void miss(ReplicaId id, size_t times) {
+    for (size_t i = 0; i < times; i++) latencies[id].add(50000, true);
+  }
+
+  void respond(SeqNum n, ReplicaId id) {
+    SeqNumActivity* a = activityOf(n);
+    ASSERT_NE(nullptr, a);
+    onResponse(*a, id);
+  }
+
+  // executes a full evaluation period (of sequence numbers without activity),
+  // and returns true if the first path changed
+  bool evaluate() {
+    bool changed = false;
+    for (size_t i = 0; i < EvaluationPeriod; i++)
+      changed = onNewSeqNumberExecution(nextExecuted_++);
+    return changed;
+  }
+
+  // the estimate of a peer with the given samples
+  static uint32_t estimateOf(const std::vector<uint32_t>& samples,
+                             size_t missedAtEnd = 0) {
+    ReplicaLatency l;
+    for (uint32_t s : samples) l.add(s, false);
+    for (size_t i = 0; i < missedAtEnd; i++) l.add(1000, true);
+    return l.estimateMicro();
+  }
+
+ private:
+  SeqNum nextExecuted_ = 10001;
+};
+
+std::vector<uint32_t> range(uint32_t from, uint32_t to, uint32_t step) {
+  std::vector<uint32_t> v;
+  for (uint32_t x = from; x <= to; x += step) v.push_back(x);
+  return v;
+}
+
+TEST(LatencyBasedControllerTest, estimate_is_the_90th_percentile) {
+  EXPECT_EQ(kUnknown, TestController::estimateOf({100, 200, 300}));
+  EXPECT_EQ(400u, TestController::estimateOf({400, 100, 300, 200}));
+  EXPECT_EQ(1000u, TestController::estimateOf(range(100, 1000, 100)));
+  EXPECT_EQ(1900u, TestController::estimateOf(range(100, 2000, 100)));
+
+  // only the last NumOfSamples samples are used
+  std::vector<uint32_t> samples(LatencyBasedController::NumOfSamples, 9000);
+  samples.insert(samples.end(), LatencyBasedController::NumOfSamples, 300);
+  EXPECT_EQ(300u, TestController::estimateOf(samples));
+
+  // the samples are capped (by the max time to start the slow path)
+  EXPECT_EQ(kMaxTimerMilli * 1000,
+            TestController::estimateOf({3000000000u, 3000000000u,
+                                        3000000000u, 3000000000u}));
+}
+
+TEST(LatencyBasedControllerTest, missed_responses_make_a_peer_unresponsive) {
+  const std::vector<uint32_t> samples(10, 500);
+  EXPECT_EQ(1000u, TestController::estimateOf(samples, 7));
+  EXPECT_EQ(kUnknown, TestController::estimateOf(samples, 8));
+
+  // a response makes the peer responsive again
+  TestController controller(0, 1, 0);
+  controller.setLatency(1, 500);
+  controller.setLatency(2, 500);
+  controller.setLatency(3, 500);
+  controller.miss(3, 8);
+  EXPECT_TRUE(controller.evaluate());
+  EXPECT_EQ(CommitPath::SLOW, controller.getCurrentFirstPath());
+
+  controller.setLatency(3, 500);
+  EXPECT_TRUE(controller.evaluate());
+  EXPECT_EQ(CommitPath::OPTIMISTIC_FAST, controller.getCurrentFirstPath());
+}
+
+TEST(LatencyBasedControllerTest, kth_estimate) {
+  std::vector<uint32_t> estimates = {30, 10, kUnknown, 20};
+  EXPECT_EQ(0u, TestController::kthEstimate(estimates, 0));
+  EXPECT_EQ(10u, TestController::kthEstimate(estimates, 1));
+  EXPECT_EQ(20u, TestController::kthEstimate(estimates, 2));
+  EXPECT_EQ(30u, TestController::kthEstimate(estimates, 3));
+  EXPECT_EQ(kUnknown, TestController::kthEstimate(estimates, 4));
+  EXPECT_EQ(kUnknown, TestController::kthEstimate(estimates, 5));
+}
+
+TEST(LatencyBasedControllerTest, first_path_switches_with_hysteresis) {
+  // F=1, C=0: optimistic fast needs the 3 peers, slow needs 2 rounds of 2 peers
+  TestController controller(0, 1, 0);
+  EXPECT_EQ(CommitPath::OPTIMISTIC_FAST, controller.getCurrentFirstPath());
+  controller.setLatency(1, 1000);
+  controller.setLatency(2, 1000);
+
+  // optimistic 2300, slow 2000: not faster by enough to switch
+  controller.setLatency(3, 2300);
+  EXPECT_FALSE(controller.evaluate());
+  EXPECT_EQ(CommitPath::OPTIMISTIC_FAST, controller.getCurrentFirstPath());
+
+  // optimistic 5000, slow 2000
+  controller.setLatency(3, 5000);
+  EXPECT_TRUE(controller.evaluate());
+  EXPECT_EQ(CommitPath::SLOW, controller.getCurrentFirstPath());
+
+  // optimistic 2300 is not faster by enough to switch back
+  controller.setLatency(3, 2300);
+  EXPECT_FALSE(controller.evaluate());
+  EXPECT_EQ(CommitPath::SLOW, controller.getCurrentFirstPath());
+
+  // optimistic 1500 < 0.8 * 2000
+  controller.setLatency(3, 1500);
+  EXPECT_TRUE(controller.evaluate());
+  EXPECT_EQ(CommitPath::OPTIMISTIC_FAST, controller.getCurrentFirstPath());
+}
+
+TEST(LatencyBasedControllerTest, fast_with_threshold_tolerates_a_slow_peer) {
+  // F=1, C=1: 5 peers, fast with threshold needs 4 of them
+  TestController controller(1, 1, 0);
+  for (ReplicaId id = 1; id <= 4; id++) controller.setLatency(id, 1000);
+  controller.setLatency(5, 10000);
+
+  EXPECT_TRUE(controller.evaluate());
+  EXPECT_EQ(CommitPath::FAST_WITH_THRESHOLD, controller.getCurrentFirstPath());
+
+  // the timer of the first path: 1.5 * 20000 + 2000 micro
+  controller.setLatency(5, 1000);
+  for (ReplicaId id = 1; id <= 4; id++) controller.setLatency(id, 20000);
+  EXPECT_FALSE(controller.evaluate());
+  EXPECT_EQ(CommitPath::FAST_WITH_THRESHOLD, controller.getCurrentFirstPath());
+  EXPECT_EQ(32u, controller.timeToStartSlowPathMilli());
+}
+
+TEST(LatencyBasedControllerTest, no_estimates_keep_the_defaults) {
+  TestController controller(0, 1, 0);
+  controller.setLatency(1, 1000);
+  controller.setLatency(2, 1000);  // peer 3 has no samples
+
+  EXPECT_FALSE(controller.evaluate());
+  EXPECT_EQ(CommitPath::OPTIMISTIC_FAST, controller.getCurrentFirstPath());
+  EXPECT_EQ(kDefaultTimerMilli, controller.timeToStartSlowPathMilli());
+  EXPECT_EQ(kDefaultTimerMilli, controller.timeToStartSlowPathMilli(5));
+}
+
+TEST(LatencyBasedControllerTest, timer_of_a_seq_num) {
+  TestController controller(0, 1, 0);
+  controller.setLatency(1, 40000);
+  controller.setLatency(2, 20000);
+  controller.setLatency(3, 20000);
+
+  // without activity, the timer is the current one
+  EXPECT_EQ(kDefaultTimerMilli, controller.timeToStartSlowPathMilli(1));
+
+  // all 3 peers are needed: 1.5 * 40000 + 2000 micro
+  controller.onSendingPrePrepare(1, CommitPath::OPTIMISTIC_FAST);
+  EXPECT_EQ(62u, controller.timeToStartSlowPathMilli(1));
+
+  // only the peers that did not respond are used: 1.5 * 20000 + 2000 micro
+  controller.respond(1, 1);
+  EXPECT_EQ(32u, controller.timeToStartSlowPathMilli(1));
+
+  // the quorum is complete
+  controller.respond(1, 2);
+  controller.respond(1, 3);
+  EXPECT_EQ(kMaxTimerMilli, controller.timeToStartSlowPathMilli(1));
+
+  // the slow path of the seq num has started
+  controller.onStartingSlowCommit(1);
+  EXPECT_EQ(kDefaultTimerMilli, controller.timeToStartSlowPathMilli(1));
+
+  // the timer is at least kMinTimerMilli
+  controller.setLatency(1, 100);
+  controller.setLatency(2, 100);
+  controller.setLatency(3, 100);
+  controller.onSendingPrePrepare(2, CommitPath::OPTIMISTIC_FAST);
+  EXPECT_EQ(kMinTimerMilli, controller.timeToStartSlowPathMilli(2));
+}
+
+TEST(LatencyBasedControllerTest, timer_is_zero_when_the_quorum_cannot_form) {
+  TestController controller(0, 1, 0);
+  controller.setLatency(1, 1000);
+  controller.setLatency(2, 1000);
+  controller.setLatency(3, 1000);
+  controller.miss(3, 8);
+
+  controller.onSendingPrePrepare(1, CommitPath::OPTIMISTIC_FAST);
+  EXPECT_EQ(0u, controller.timeToStartSlowPathMilli(1));
+
+  controller.respond(1, 1);
+  controller.respond(1, 2);
+  EXPECT_EQ(0u, controller.timeToStartSlowPathMilli(1));
+
+  // the slow paths timer is not longer than half of the shortest recent timer
+  // (but at least 10 milliseconds)
+  EXPECT_EQ(10u, controller.slowPathsTimerMilli());
+}
+
+TEST(LatencyBasedControllerTest, only_the_primary_measures) {
+  TestController controller(0, 1, 1);  // replica 1 is not the primary of view 0
+  controller.setLatency(0, 1000);
+  controller.setLatency(2, 1000);
+  controller.setLatency(3, 5000);
+
+  controller.onSendingPrePrepare(1, CommitPath::OPTIMISTIC_FAST);
+  EXPECT_EQ(kDefaultTimerMilli, controller.timeToStartSlowPathMilli(1));
+  EXPECT_FALSE(controller.evaluate());
+  EXPECT_EQ(CommitPath::OPTIMISTIC_FAST, controller.getCurrentFirstPath());
+
+  // replica 1 is the primary of view 1 (the latencies are kept)
+  controller.onNewView(1, 100);
+  EXPECT_TRUE(controller.evaluate());
+  EXPECT_EQ(CommitPath::SLOW, controller.getCurrentFirstPath());
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,249 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "MsgsCoalescer.hpp"
+#include "MsgCode.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+const uint32_t kMaxBatchSize = 256;
+const uint16_t kNumOfReplicas = 4;
+
+class RecordingCommunication : public ICommunication {
+ public:
+  int getMaxMessageSize() override { return -1; }
+  int Start() override { return 0; }
+  int Stop() override { return 0; }
+  bool isRunning() const override { return true; }
+  ConnectionStatus getCurrentConnectionStatus(const NodeNum) const override {
+    return ConnectionStatus::Unknown;
+  }
+  int sendAsyncMessage(const NodeNum destNode, const char* const message,
+                       const size_t messageLength) override {
+    sent.push_back({destNode, std::string(message, messageLength)});
+    return errorCode;
+  }
+  void setReceiver(NodeNum, IReceiver*) override {}
+
+  std::vector<std::pair<NodeNum, std::string>> sent;
+  int errorCode = 0;
+};
+
+// a message of the given type and size (the content depends on id)
+std::string Msg(MsgType type, size_t size, char id) {
+  std::string m(size, id);
+  memcpy(&m[0], &type, sizeof(MsgType));
+  return m;
+}
+
+std::vector<std::string> MsgsOf(const std::string& batch, bool& ok) {
+  std::vector<std::string> msgs;
+  ok = MsgsCoalescer::forEachMsgInBatch(
+      batch.data(), batch.size(),
+      [&msgs](const char* msg, MsgSize size) {
+        msgs.push_back(std::string(msg, size));
+      });
+  return msgs;
+}
+
+// builds a batch (header, followed by (uint32_t size, message) entries)
+std::string Batch(const std::vector<std::string>& msgs) {
+  const MsgType type = MsgCode::MsgsBatch;
+  std::string b((const char*)&type, sizeof(MsgType));
+  for (const std::string& m : msgs) {
+    const uint32_t size = m.size();
+    b.append((const char*)&size, sizeof(size));
+    b.append(m);
+  }
+  return b;
+}
+
+MsgType TypeOf(const std::string& m) {
+  MsgType t = 0;
+  memcpy(&t, m.data(), sizeof(MsgType));
+  return t;
+}
+
+class MsgsCoalescerTest : public ::testing::Test {
+ protected:
+  MsgsCoalescerTest() : coalescer(&comm, kNumOfReplicas, kMaxBatchSize) {}
+
+  int Send(ReplicaId dest, const std::string& m) {
+    return coalescer.send(dest, m.data(), m.size());
+  }
+
+  RecordingCommunication comm;
+  MsgsCoalescer coalescer;
+};
+
+TEST_F(MsgsCoalescerTest, nothing_is_sent_before_flush) {
+  Send(1, Msg(MsgCode::PreparePartial, 20, 'a'));
+  Send(2, Msg(MsgCode::CommitPartial, 20, 'b'));
+  ASSERT_TRUE(comm.sent.empty());
+
+  coalescer.flush();
+  ASSERT_EQ(2u, comm.sent.size());
+
+  // flushing again does not send anything
+  coalescer.flush();
+  ASSERT_EQ(2u, comm.sent.size());
+}
+
+TEST_F(MsgsCoalescerTest, single_message_is_sent_as_is) {
+  const std::string m = Msg(MsgCode::PreparePartial, 20, 'a');
+  Send(1, m);
+  coalescer.flush();
+
+  ASSERT_EQ(1u, comm.sent.size());
+  ASSERT_EQ(1u, comm.sent[0].first);
+  ASSERT_EQ(m, comm.sent[0].second);
+}
+
+TEST_F(MsgsCoalescerTest, messages_to_the_same_replica_are_batched) {
+  const std::string a = Msg(MsgCode::PreparePartial, 20, 'a');
+  const std::string b = Msg(MsgCode::CommitPartial, 30, 'b');
+  const std::string c = Msg(MsgCode::Checkpoint, 10, 'c');
+  Send(1, a);
+  Send(2, c);
+  Send(1, b);
+  Send(1, c);
+  coalescer.flush();
+
+  ASSERT_EQ(2u, comm.sent.size());
+  ASSERT_EQ(1u, comm.sent[0].first);
+  ASSERT_EQ(Batch({a, b, c}), comm.sent[0].second);
+  ASSERT_EQ(2u, comm.sent[1].first);
+  ASSERT_EQ(c, comm.sent[1].second);
+
+  bool ok = false;
+  std::vector<std::string> msgs = MsgsOf(comm.sent[0].second, ok);
+  ASSERT_TRUE(ok);
+  ASSERT_EQ((std::vector<std::string>{a, b, c}), msgs);
+}
+
+TEST_F(MsgsCoalescerTest, full_batch_is_sent_before_the_next_message) {
+  std::vector<std::string> msgs;
+  for (char i = 0; i < 10; i++)
+    msgs.push_back(Msg(MsgCode::PreparePartial, 50, 'a' + i));
+
+  for (const std::string& m : msgs) {
+    Send(3, m);
+    for (const auto& s : comm.sent) ASSERT_LE(s.second.size(), kMaxBatchSize);
+  }
+  coalescer.flush();
+
+  // the messages arrive in order, and every batch is within the limit
+  std::vector<std::string> received;
+  for (const auto& s : comm.sent) {
+    ASSERT_EQ(3u, s.first);
+    ASSERT_LE(s.second.size(), kMaxBatchSize);
+    if (TypeOf(s.second) == MsgCode::MsgsBatch) {
+      bool ok = false;
+      std::vector<std::string> batchMsgs = MsgsOf(s.second, ok);
+      ASSERT_TRUE(ok);
+      received.insert(received.end(), batchMsgs.begin(), batchMsgs.end());
+    } else {
+      received.push_back(s.second);
+    }
+  }
+  ASSERT_EQ(msgs, received);
+  ASSERT_GT(comm.sent.size(), 1u);
+}
+
+TEST_F(MsgsCoalescerTest, oversized_message_is_sent_directly_after_the_batch) {
+  const std::string a = Msg(MsgCode::PreparePartial, 20, 'a');
+  const std::string b = Msg(MsgCode::CommitPartial, 20, 'b');
+  const std::string big = Msg(MsgCode::PrePrepare, kMaxBatchSize, 'c');
+  Send(0, a);
+  Send(0, b);
+  ASSERT_EQ(0, Send(0, big));
+
+  // the pending batch goes first, so the order is kept
+  ASSERT_EQ(2u, comm.sent.size());
+  ASSERT_EQ(Batch({a, b}), comm.sent[0].second);
+  ASSERT_EQ(big, comm.sent[1].second);
+
+  coalescer.flush();
+  ASSERT_EQ(2u, comm.sent.size());
+}
+
+TEST_F(MsgsCoalescerTest, error_of_direct_send_is_returned) {
+  comm.errorCode = 7;
+  ASSERT_EQ(7, Send(0, Msg(MsgCode::PrePrepare, kMaxBatchSize, 'c')));
+  ASSERT_EQ(0, Send(0, Msg(MsgCode::PreparePartial, 20, 'a')));
+}
+
+TEST(MsgsCoalescerBatch, valid_batch) {
+  const std::string a = Msg(MsgCode::PreparePartial, 2, 'a');
+  const std::string b = Msg(MsgCode::CommitPartial, 100, 'b');
+  bool ok = false;
+  ASSERT_EQ((std::vector<std::string>{a, b}), MsgsOf(Batch({a, b}), ok));
+  ASSERT_TRUE(ok);
+}
+
+TEST(MsgsCoalescerBatch, empty_batch_is_rejected) {
+  bool ok = true;
+  ASSERT_TRUE(MsgsOf(Batch({}), ok).empty());
+  ASSERT_FALSE(ok);
+}
+
+TEST(MsgsCoalescerBatch, truncated_entries_are_rejected) {
+  const std::string batch = Batch({Msg(MsgCode::PreparePartial, 20, 'a'),
+                                   Msg(MsgCode::CommitPartial, 20, 'b')});
+  // every prefix that ends inside an entry (in its size field or in its
+  // message) is malformed, and no message is delivered
+  const size_t firstEntryEnd = sizeof(MsgType) + sizeof(uint32_t) + 20;
+  for (size_t len = sizeof(MsgType) + 1; len < batch.size(); len++) {
+    if (len == firstEntryEnd) continue;
+    bool ok = true;
+    ASSERT_TRUE(MsgsOf(batch.substr(0, len), ok).empty()) << len;
+    ASSERT_FALSE(ok) << len;
+  }
+}
+
+TEST(MsgsCoalescerBatch, zero_and_oversized_lengths_are_rejected) {
+  const std::string a = Msg(MsgCode::PreparePartial, 20, 'a');
+  const uint32_t lengths[] = {0, 1, 21, 0xFFFFFFFF, 0x80000000};
+  for (uint32_t len : lengths) {
+    std::string batch = Batch({a, a});
+    // the size of the second entry
+    memcpy(&batch[sizeof(MsgType) + sizeof(uint32_t) + a.size()], &len,
+           sizeof(len));
+    bool ok = true;
+    ASSERT_TRUE(MsgsOf(batch, ok).empty()) << len;
+    ASSERT_FALSE(ok) << len;
+  }
+}
+
+TEST(MsgsCoalescerBatch, nested_batch_is_delivered_as_one_message) {
+  // a nested batch is not expanded (the receiver drops it)
+  const std::string a = Msg(MsgCode::PreparePartial, 20, 'a');
+  const std::string nested = Batch({a, a});
+  bool ok = false;
+  std::vector<std::string> msgs = MsgsOf(Batch({a, nested}), ok);
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(2u, msgs.size());
+  ASSERT_EQ(a, msgs[0]);
+  ASSERT_EQ(nested, msgs[1]);
+  ASSERT_EQ(MsgCode::MsgsBatch, TypeOf(msgs[1]));
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,156 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ReplicasInfo.hpp"
+#include "SigManager.hpp"
+#include "Crypto.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+struct ClusterConfig {
+  int16_t f;
+  int16_t c;
+};
+
+const ClusterConfig kConfigs[] = {{1, 0}, {1, 1}, {2, 0}, {3, 1}, {10, 0}};
+
+class ReplicasInfoTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    std::string publicKey;
+    std::string privateKey;
+    ASSERT_TRUE(RSAKeysGenerator::generateKeys(publicKey, privateKey));
+    sigManager = new SigManager(0, 1, privateKey, {{0, publicKey}});
+  }
+
+  static void TearDownTestCase() {
+    delete sigManager;
+    sigManager = nullptr;
+  }
+
+  static std::unique_ptr<ReplicasInfo> Make(const ClusterConfig& config) {
+    const int16_t n = 3 * config.f + 2 * config.c + 1;
+    return std::unique_ptr<ReplicasInfo>(new ReplicasInfo(
+        0, *sigManager, n, config.f, config.c, false, false, 150));
+  }
+
+  static SigManager* sigManager;
+};
+
+SigManager* ReplicasInfoTest::sigManager = nullptr;
+
+// Walks the tree from the primary and checks that every replica (other than
+// the primary) is reached exactly once, and that no node has more than fanout
+// children.
+void CheckTree(const ReplicasInfo& info, ViewNum v, SeqNum s, uint16_t fanout) {
+  const int16_t n = info.numberOfReplicas();
+  const ReplicaId primary = info.primaryOfView(v);
+
+  std::vector<int> timesReached(n, 0);
+  std::deque<ReplicaId> toVisit{primary};
+  std::vector<ReplicaId> children;
+  while (!toVisit.empty()) {
+    const ReplicaId node = toVisit.front();
+    toVisit.pop_front();
+
+    info.getChildrenInPrePrepareTree(node, v, s, fanout, children);
+    ASSERT_LE(children.size(), fanout);
+    for (ReplicaId child : children) {
+      ASSERT_LT(child, n);
+      ASSERT_NE(primary, child);
+      ASSERT_NE(node, child);
+      timesReached[child]++;
+      // a node that is reached twice would also be visited twice (stop here)
+      ASSERT_EQ(1, timesReached[child])
+          << "replica " << child << " (n=" << n << " v=" << v << " s=" << s
+          << " fanout=" << fanout << ")";
+      toVisit.push_back(child);
+    }
+  }
+
+  for (ReplicaId r = 0; r < n; r++) {
+    if (r == primary) continue;
+    ASSERT_EQ(1, timesReached[r])
+        << "replica " << r << " (n=" << n << " v=" << v << " s=" << s
+        << " fanout=" << fanout << ")";
+  }
+}
+
+TEST_F(ReplicasInfoTest, every_replica_appears_once_in_the_tree) {
+  for (const ClusterConfig& config : kConfigs) {
+    std::unique_ptr<ReplicasInfo> info = Make(config);
+    const uint16_t n = info->numberOfReplicas();
+    const uint16_t fanouts[] = {1, 2, 3, 4, (uint16_t)(n - 1), n,
+                                (uint16_t)(2 * n)};
+    for (uint16_t fanout : fanouts) {
+      for (ViewNum v = 0; v < 2 * n; v++) {
+        for (SeqNum s = 1; s <= 3 * n; s++) CheckTree(*info, v, s, fanout);
+        CheckTree(*info, v, 1000003, fanout);
+      }
+    }
+  }
+}
+
+TEST_F(ReplicasInfoTest, large_fanout_is_a_star) {
+  for (const ClusterConfig& config : kConfigs) {
+    std::unique_ptr<ReplicasInfo> info = Make(config);
+    const int16_t n = info->numberOfReplicas();
+    std::vector<ReplicaId> children;
+    for (ViewNum v = 0; v < (ViewNum)n; v++) {
+      const ReplicaId primary = info->primaryOfView(v);
+      info->getChildrenInPrePrepareTree(primary, v, 17, n - 1, children);
+      ASSERT_EQ((size_t)(n - 1), children.size());
+      for (ReplicaId r = 0; r < n; r++) {
+        if (r == primary) continue;
+        info->getChildrenInPrePrepareTree(r, v, 17, n - 1, children);
+        ASSERT_TRUE(children.empty());
+      }
+    }
+  }
+}
+
+TEST_F(ReplicasInfoTest, relaying_load_is_rotated_by_seq_num) {
+  for (const ClusterConfig& config : kConfigs) {
+    std::unique_ptr<ReplicasInfo> info = Make(config);
+    const int16_t n = info->numberOfReplicas();
+    const int16_t m = n - 1;
+    const uint16_t fanout = 2;
+    const ViewNum v = 1;
+    const ReplicaId primary = info->primaryOfView(v);
+
+    // over m consecutive sequence numbers, every replica is a child of the
+    // primary exactly fanout times
+    std::vector<int> timesChildOfPrimary(n, 0);
+    std::vector<ReplicaId> children;
+    for (SeqNum s = 100; s < 100 + m; s++) {
+      info->getChildrenInPrePrepareTree(primary, v, s, fanout, children);
+      for (ReplicaId child : children) timesChildOfPrimary[child]++;
+    }
+    for (ReplicaId r = 0; r < n; r++) {
+      ASSERT_EQ(r == primary ? 0 : (int)std::min<int16_t>(fanout, m),
+                timesChildOfPrimary[r]);
+    }
+  }
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,217 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ClientRequestMsg.hpp"
+#include "RequestTracer.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+// a minimal JSON parser, only used to check that the dump is valid JSON
+class JsonValidator {
+ public:
+  explicit JsonValidator(const std::string& s) : s_(s) {}
+
+  bool valid() {
+    if (!value()) return false;
+    skipSpaces();
+    return pos_ == s_.size();
+  }
+
+ private:
+  void skipSpaces() {
+    while (pos_ < s_.size() && strchr(" \t\r\n", s_[pos_]) != nullptr) pos_++;
+  }
+
+  bool consume(char c) {
+    skipSpaces();
+    if (pos_ >= s_.size() || s_[pos_] != c) return false;
+    pos_++;
+    return true;
+  }
+
+  bool literal(const char* l) {
+    if (s_.compare(pos_, strlen(l), l) != 0) return false;
+    pos_ += strlen(l);
+    return true;
+  }
+
+  bool string() {
+    if (!consume('"')) return false;
+    while (pos_ < s_.size() && s_[pos_] != '"') {
+      if (s_[pos_] == '\\') pos_++;
+      pos_++;
+    }
+    return consume('"');
+  }
+
+  bool number() {
+    const size_t begin = pos_;
+    if (pos_ < s_.size() && s_[pos_] == '-') pos_++;
+    while (pos_ < s_.size() && strchr("0123456789.eE+-", s_[pos_]) != nullptr)
+      pos_++;
+    return pos_ > begin;
+  }
+
+  template <typename ElementFunc>
+  bool sequence(char open, char close, ElementFunc element) {
+    if (!consume(open)) return false;
+    if (consume(close)) return true;
+    do {
+      if (!element()) return false;
+    } while (consume(','));
+    return consume(close);
+  }
+
+  bool value() {
+    skipSpaces();
+    if (pos_ >= s_.size()) return false;
+    switch (s_[pos_]) {
+      case '{':
+        return sequence('{', '}', [this]() {
+          return string() && consume(':') && value();
+        });
+      case '[':
+        return sequence('[', ']', [this]() { return value(); });
+      case '"':
+        return string();
+      case 't':
+        return literal("true");
+      case 'f':
+        return literal("false");
+      case 'n':
+        return literal("null");
+      default:
+        return number();
+    }
+  }
+
+  const std::string& s_;
+  size_t pos_ = 0;
+};
+
+size_t count(const std::string& s, const std::string& sub) {
+  size_t n = 0;
+  for (size_t i = s.find(sub); i != std::string::npos; i = s.find(sub, i + 1))
+    n++;
+  return n;
+}
+
+// the beginning of an event in the dump
+std::string event(const std::string& name, const char* ph) {
+  return "{\"name\":\"" + name + "\",\"cat\":\"request\",\"ph\":\"" + ph + "\"";
+}
+
+TEST(RequestTracerTest, traced_flag_of_a_request) {
+  const char request[] = "request";
+  ClientRequestMsg m(5, true, 17, sizeof(request), request);
+  EXPECT_FALSE(m.isTraced());
+
+  m.setAsTraced();
+  m.setAsReadWrite();  // the other flags are kept
+  EXPECT_TRUE(m.isTraced());
+  EXPECT_FALSE(m.isReadOnly());
+
+  // the flags are sent with the request
+  std::vector<char> buf(m.body(), m.body() + m.size());
+  ClientRequestMsg received((ClientRequestMsgHeader*)buf.data());
+  EXPECT_TRUE(received.isTraced());
+  EXPECT_FALSE(received.isReadOnly());
+  EXPECT_EQ(5, received.clientProxyId());
+  EXPECT_EQ(17u, received.requestSeqNum());
+  EXPECT_EQ(sizeof(request), received.requestLength());
+  EXPECT_EQ(0, memcmp(request, received.requestBuf(), sizeof(request)));
+
+  ClientRequestMsg readOnly(5, true, 18, sizeof(request), request);
+  readOnly.setAsTraced();
+  EXPECT_TRUE(readOnly.isTraced());
+  EXPECT_TRUE(readOnly.isReadOnly());
+}
+
+TEST(RequestTracerTest, sampling) {
+  RequestTracer::setSamplingPeriod(0);
+  EXPECT_FALSE(RequestTracer::enabled());
+  EXPECT_FALSE(RequestTracer::sample());
+
+  RequestTracer::setSamplingPeriod(4);
+  EXPECT_TRUE(RequestTracer::enabled());
+  int sampled = 0;
+  for (int i = 0; i < 100; i++)
+    if (RequestTracer::sample()) sampled++;
+  EXPECT_EQ(25, sampled);
+  RequestTracer::setSamplingPeriod(0);
+}
+
+TEST(RequestTracerTest, record_and_dump) {
+  const int kThreads = 4;
+  const ReqId kRequests = 50;
+  const TraceStage stages[] = {ReplicaReceived, Committed, Executed};
+
+  // nothing is recorded if tracing is disabled
+  RequestTracer::setSamplingPeriod(0);
+  RequestTracer::record(9, 9, 9, Executed);
+
+  // each thread records the requests of one client, on node 0 and node 1
+  RequestTracer::setSamplingPeriod(1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([t, &stages]() {
+      for (ReqId r = 1; r <= kRequests; r++)
+        for (NodeIdType node = 0; node < 2; node++)
+          for (TraceStage stage : stages)
+            RequestTracer::record(node, 100 + t, r, stage);
+    });
+  }
+  for (std::thread& t : threads) t.join();
+  RequestTracer::setSamplingPeriod(0);
+
+  const char* fileName = "request_tracer_tests.json";
+  ASSERT_TRUE(RequestTracer::dump(fileName));
+  std::ifstream f(fileName);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  const std::string json = ss.str();
+  remove(fileName);
+
+  EXPECT_TRUE(JsonValidator(json).valid());
+
+  // a "request" span for each (request, node), with an event for each stage
+  const size_t numOfTraces = kThreads * kRequests * 2;
+  EXPECT_EQ(numOfTraces, count(json, event("request", "b")));
+  EXPECT_EQ(numOfTraces, count(json, event("request", "e")));
+  for (const char* stage : {"ReplicaReceived", "Committed", "Executed"})
+    EXPECT_EQ(numOfTraces, count(json, event(stage, "n")));
+
+  // spans between consecutive stages (none after the last stage)
+  EXPECT_EQ(numOfTraces, count(json, event("Committed", "b")));
+  EXPECT_EQ(0u, count(json, event("Executed", "b")));
+
+  // 2 nodes * (2 "request" events + 3 stages + 2 spans of 2 events)
+  EXPECT_EQ(18u, count(json, "\"id\":\"103-50\"}"));
+  EXPECT_EQ(0u, count(json, "\"pid\":9,"));
+  EXPECT_EQ(1u, count(json, "\"args\":{\"name\":\"node 0\"}"));
+  EXPECT_EQ(1u, count(json, "\"args\":{\"name\":\"node 1\"}"));
+}
+
+}  // namespace impl
+}  // namespace bftEngine
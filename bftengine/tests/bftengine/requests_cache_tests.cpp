@@ -0,0 +1,267 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "RequestsCache.hpp"
+#include "CompactPrePrepareMsg.hpp"
+#include "PrePrepareMsg.hpp"
+#include "ClientRequestMsg.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+const ReplicaId kPrimary = 0;
+const ViewNum kView = 3;
+const SeqNum kSeqNum = 17;
+
+ClientRequestMsg* MakeRequest(NodeIdType clientId, ReqId reqSeqNum,
+                              const std::string& content = "") {
+  std::string body = content;
+  if (body.empty()) {
+    // larger than a RequestRef, so a compact PrePrepare is smaller
+    body = std::string(100, 'a' + (clientId % 26)) + std::to_string(reqSeqNum);
+  }
+  return new ClientRequestMsg(clientId, false, reqSeqNum, body.size(),
+                              body.data());
+}
+
+Digest DigestOf(const ClientRequestMsg* m) {
+  Digest d;
+  RequestsCache::computeDigestOfRequest(m, d);
+  return d;
+}
+
+// builds a PrePrepareMsg with the given requests (the requests are not owned)
+PrePrepareMsg* MakePrePrepare(const std::vector<ClientRequestMsg*>& requests) {
+  PrePrepareMsg* pp = new PrePrepareMsg(kPrimary, kView, kSeqNum,
+                                        CommitPath::OPTIMISTIC_FAST, false);
+  for (ClientRequestMsg* r : requests) pp->addRequest(r->body(), r->size());
+  pp->finishAddingRequests();
+  return pp;
+}
+
+TEST(RequestsCache, get_returns_added_request) {
+  RequestsCache cache(10);
+  ClientRequestMsg* m = MakeRequest(5, 100);
+  const Digest d = DigestOf(m);
+  cache.add(m);
+
+  ASSERT_EQ(1u, cache.numOfRequests());
+  ASSERT_EQ(m, cache.get(5, 100, d));
+
+  ASSERT_EQ(nullptr, cache.get(5, 101, d));
+  ASSERT_EQ(nullptr, cache.get(6, 100, d));
+  Digest other = d;
+  other.content()[0] ^= 0x1;
+  ASSERT_EQ(nullptr, cache.get(5, 100, other));
+}
+
+TEST(RequestsCache, same_id_with_different_content_is_kept_separately) {
+  RequestsCache cache(10);
+  ClientRequestMsg* m1 = MakeRequest(5, 100, "first");
+  ClientRequestMsg* m2 = MakeRequest(5, 100, "second");
+  const Digest d1 = DigestOf(m1);
+  const Digest d2 = DigestOf(m2);
+  cache.add(m1);
+  cache.add(m2);
+
+  ASSERT_EQ(2u, cache.numOfRequests());
+  ASSERT_EQ(m1, cache.get(5, 100, d1));
+  ASSERT_EQ(m2, cache.get(5, 100, d2));
+}
+
+TEST(RequestsCache, duplicate_is_dropped) {
+  RequestsCache cache(10);
+  ClientRequestMsg* m = MakeRequest(5, 100);
+  const Digest d = DigestOf(m);
+  cache.add(m);
+  cache.add(MakeRequest(5, 100));  // the cache deletes the duplicate
+
+  ASSERT_EQ(1u, cache.numOfRequests());
+  ASSERT_EQ(m, cache.get(5, 100, d));
+}
+
+TEST(RequestsCache, oldest_request_is_evicted_when_full) {
+  const uint32_t kMax = 4;
+  RequestsCache cache(kMax);
+  std::vector<Digest> digests;
+  for (ReqId i = 1; i <= kMax + 2; i++) {
+    // clients are added out of order, so the eviction order is not the order
+    // of the keys
+    ClientRequestMsg* m = MakeRequest(10 - i, i);
+    digests.push_back(DigestOf(m));
+    cache.add(m);
+    ASSERT_LE(cache.numOfRequests(), kMax);
+  }
+
+  ASSERT_EQ(kMax, cache.numOfRequests());
+  ASSERT_EQ(nullptr, cache.get(9, 1, digests[0]));
+  ASSERT_EQ(nullptr, cache.get(8, 2, digests[1]));
+  for (ReqId i = 3; i <= kMax + 2; i++) {
+    ASSERT_NE(nullptr, cache.get(10 - i, i, digests[i - 1]));
+  }
+}
+
+TEST(RequestsCache, executed_requests_are_removed) {
+  RequestsCache cache(100);
+  std::vector<std::vector<Digest>> digests(3);
+  for (NodeIdType client = 0; client < 3; client++) {
+    for (ReqId i = 1; i <= 5; i++) {
+      ClientRequestMsg* m = MakeRequest(client, i * 10);
+      digests[client].push_back(DigestOf(m));
+      cache.add(m);
+    }
+  }
+  ASSERT_EQ(15u, cache.numOfRequests());
+
+  cache.onRequestExecuted(1, 35);
+
+  ASSERT_EQ(12u, cache.numOfRequests());
+  for (NodeIdType client = 0; client < 3; client++) {
+    for (ReqId i = 1; i <= 5; i++) {
+      ClientRequestMsg* m = cache.get(client, i * 10, digests[client][i - 1]);
+      if (client == 1 && i <= 3)
+        ASSERT_EQ(nullptr, m);
+      else
+        ASSERT_NE(nullptr, m);
+    }
+  }
+
+  // executing a later request removes the remaining ones
+  cache.onRequestExecuted(1, 1000);
+  ASSERT_EQ(10u, cache.numOfRequests());
+
+  cache.clear();
+  ASSERT_EQ(0u, cache.numOfRequests());
+  ASSERT_EQ(nullptr, cache.get(0, 10, digests[0][0]));
+}
+
+TEST(RequestsCache, evicted_after_execution_keeps_insertion_order) {
+  RequestsCache cache(3);
+  ClientRequestMsg* a = MakeRequest(1, 1);
+  ClientRequestMsg* b = MakeRequest(2, 1);
+  ClientRequestMsg* c = MakeRequest(3, 1);
+  const Digest da = DigestOf(a);
+  const Digest dc = DigestOf(c);
+  cache.add(a);
+  cache.add(b);
+  cache.add(c);
+
+  cache.onRequestExecuted(2, 1);
+  ASSERT_EQ(2u, cache.numOfRequests());
+
+  ClientRequestMsg* d = MakeRequest(4, 1);
+  ClientRequestMsg* e = MakeRequest(5, 1);
+  const Digest de = DigestOf(e);
+  cache.add(d);
+  cache.add(e);  // evicts a, the oldest remaining request
+
+  ASSERT_EQ(3u, cache.numOfRequests());
+  ASSERT_EQ(nullptr, cache.get(1, 1, da));
+  ASSERT_EQ(c, cache.get(3, 1, dc));
+  ASSERT_EQ(e, cache.get(5, 1, de));
+}
+
+class CompactPrePrepareMsgTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (NodeIdType client = 0; client < 7; client++)
+      requests.push_back(MakeRequest(client, 1000 + client));
+    pp.reset(MakePrePrepare(requests));
+    compact.reset(CompactPrePrepareMsg::create(pp.get()));
+    ASSERT_NE(nullptr, compact.get());
+  }
+
+  void TearDown() override {
+    for (ClientRequestMsg* r : requests) delete r;
+  }
+
+  std::vector<ClientRequestMsg*> requests;
+  std::unique_ptr<PrePrepareMsg> pp;
+  std::unique_ptr<CompactPrePrepareMsg> compact;
+};
+
+TEST_F(CompactPrePrepareMsgTest, round_trip) {
+  ASSERT_LT(compact->size(), pp->size());
+  ASSERT_EQ(kView, compact->viewNumber());
+  ASSERT_EQ(kSeqNum, compact->seqNumber());
+  ASSERT_EQ(CommitPath::OPTIMISTIC_FAST, compact->firstPath());
+  ASSERT_EQ(pp->digestOfRequests(), compact->digestOfRequests());
+  ASSERT_EQ(requests.size(), compact->numberOfRequests());
+
+  RequestsCache cache(100);
+  for (ClientRequestMsg* r : requests)
+    cache.add(MakeRequest(r->clientProxyId(), r->requestSeqNum()));
+
+  uint16_t missing = 1;
+  std::unique_ptr<PrePrepareMsg> rebuilt(
+      compact->createPrePrepareMsg(cache, missing));
+  ASSERT_EQ(0, missing);
+  ASSERT_NE(nullptr, rebuilt.get());
+
+  ASSERT_EQ(kPrimary, rebuilt->senderId());
+  ASSERT_EQ(kView, rebuilt->viewNumber());
+  ASSERT_EQ(kSeqNum, rebuilt->seqNumber());
+  ASSERT_EQ(CommitPath::OPTIMISTIC_FAST, rebuilt->firstPath());
+  ASSERT_EQ(pp->digestOfRequests(), rebuilt->digestOfRequests());
+  ASSERT_EQ(pp->numberOfRequests(), rebuilt->numberOfRequests());
+  ASSERT_EQ(pp->size(), rebuilt->size());
+  ASSERT_EQ(0, memcmp(pp->body(), rebuilt->body(), pp->size()));
+}
+
+TEST_F(CompactPrePrepareMsgTest, missing_requests_are_counted) {
+  RequestsCache cache(100);
+  uint16_t missing = 0;
+  ASSERT_EQ(nullptr, compact->createPrePrepareMsg(cache, missing));
+  ASSERT_EQ(requests.size(), missing);
+
+  for (size_t i = 0; i < requests.size(); i += 2)
+    cache.add(MakeRequest(requests[i]->clientProxyId(),
+                          requests[i]->requestSeqNum()));
+  ASSERT_EQ(nullptr, compact->createPrePrepareMsg(cache, missing));
+  ASSERT_EQ(requests.size() / 2, missing);
+}
+
+TEST_F(CompactPrePrepareMsgTest, request_with_other_content_is_missing) {
+  RequestsCache cache(100);
+  for (size_t i = 0; i < requests.size(); i++) {
+    if (i == 3) {
+      // same (clientId, reqSeqNum), different content
+      cache.add(MakeRequest(requests[i]->clientProxyId(),
+                            requests[i]->requestSeqNum(), "other"));
+    } else {
+      cache.add(MakeRequest(requests[i]->clientProxyId(),
+                            requests[i]->requestSeqNum()));
+    }
+  }
+
+  uint16_t missing = 0;
+  ASSERT_EQ(nullptr, compact->createPrePrepareMsg(cache, missing));
+  ASSERT_EQ(1, missing);
+}
+
+TEST(CompactPrePrepareMsg, not_created_when_not_smaller) {
+  std::vector<ClientRequestMsg*> requests;
+  requests.push_back(MakeRequest(1, 1, "x"));
+  std::unique_ptr<PrePrepareMsg> pp(MakePrePrepare(requests));
+  // a RequestRef is larger than this request
+  ASSERT_EQ(nullptr, CompactPrePrepareMsg::create(pp.get()));
+  delete requests[0];
+}
+
+}  // namespace impl
+}  // namespace bftEngine
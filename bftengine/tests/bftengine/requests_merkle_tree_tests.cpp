@@ -0,0 +1,208 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "RequestsMerkleTree.hpp"
+#include "SysConsts.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+// Requests of different sizes, so leaves that are hashed together in
+// computeLeafDigests do not all have the same length.
+std::vector<std::string> MakeRequests(uint32_t numOfRequests) {
+  std::vector<std::string> requests;
+  for (uint32_t i = 0; i < numOfRequests; i++) {
+    requests.push_back(std::string(1 + (i * 7) % 300, 'a' + (i % 26)) +
+                       std::to_string(i));
+  }
+  return requests;
+}
+
+std::vector<Digest> LeavesOf(const std::vector<std::string>& requests) {
+  std::vector<Digest> leaves(requests.size());
+  for (size_t i = 0; i < requests.size(); i++) {
+    RequestsMerkleTree::computeLeafDigest(
+        requests[i].data(), requests[i].size(), leaves[i]);
+  }
+  return leaves;
+}
+
+Digest RootOfRequests(const std::vector<std::string>& requests) {
+  std::vector<const char*> ptrs;
+  std::vector<uint32_t> sizes;
+  for (const std::string& r : requests) {
+    ptrs.push_back(r.data());
+    sizes.push_back(r.size());
+  }
+  Digest root;
+  RequestsMerkleTree::computeRootOfRequests(
+      ptrs.data(), sizes.data(), requests.size(), root);
+  return root;
+}
+
+Digest RootFromBuilder(const std::vector<Digest>& leaves) {
+  RequestsMerkleTree::Builder builder;
+  for (const Digest& leaf : leaves) builder.add(leaf);
+  EXPECT_EQ(leaves.size(), builder.numberOfLeaves());
+  Digest root;
+  builder.computeRoot(root);
+  return root;
+}
+
+const uint32_t kNumsOfLeaves[] = {
+    1, 2, 3, 5, 7, 8, 13, 33, minNumOfRequestsForParallelDigest - 1,
+    minNumOfRequestsForParallelDigest, 100, 128, 257, 1000};
+
+TEST(RequestsMerkleTree, leaf_digests_match_single_leaf_digests) {
+  std::vector<std::string> requests = MakeRequests(21);
+  std::vector<const char*> ptrs;
+  std::vector<uint32_t> sizes;
+  for (const std::string& r : requests) {
+    ptrs.push_back(r.data());
+    sizes.push_back(r.size());
+  }
+  std::vector<Digest> leaves(requests.size());
+  RequestsMerkleTree::computeLeafDigests(
+      ptrs.data(), sizes.data(), requests.size(), leaves.data());
+
+  ASSERT_EQ(LeavesOf(requests), leaves);
+}
+
+TEST(RequestsMerkleTree, all_root_computations_agree) {
+  for (uint32_t n : kNumsOfLeaves) {
+    std::vector<std::string> requests = MakeRequests(n);
+    std::vector<Digest> leaves = LeavesOf(requests);
+
+    Digest root;
+    RequestsMerkleTree::computeRoot(leaves.data(), n, root);
+
+    ASSERT_EQ(root, RootFromBuilder(leaves)) << n << " leaves";
+    ASSERT_EQ(root, RootOfRequests(requests)) << n << " leaves";
+  }
+}
+
+TEST(RequestsMerkleTree, root_of_one_leaf_is_the_leaf) {
+  std::vector<std::string> requests = MakeRequests(1);
+  std::vector<Digest> leaves = LeavesOf(requests);
+  ASSERT_EQ(leaves[0], RootOfRequests(requests));
+  ASSERT_EQ(leaves[0], RootFromBuilder(leaves));
+}
+
+TEST(RequestsMerkleTree, root_of_three_leaves_has_rfc6962_shape) {
+  std::vector<Digest> leaves = LeavesOf(MakeRequests(3));
+  Digest left;
+  RequestsMerkleTree::computeParentDigest(leaves[0], leaves[1], left);
+  Digest expected;
+  RequestsMerkleTree::computeParentDigest(left, leaves[2], expected);
+
+  Digest root;
+  RequestsMerkleTree::computeRoot(leaves.data(), 3, root);
+  ASSERT_EQ(expected, root);
+}
+
+TEST(RequestsMerkleTree, root_depends_on_order_and_content) {
+  std::vector<std::string> requests =
+      MakeRequests(minNumOfRequestsForParallelDigest + 3);
+  const Digest root = RootOfRequests(requests);
+
+  std::vector<std::string> swapped = requests;
+  std::swap(swapped[0], swapped[swapped.size() - 1]);
+  ASSERT_NE(root, RootOfRequests(swapped));
+
+  std::vector<std::string> changed = requests;
+  changed[17][0] ^= 0x1;
+  ASSERT_NE(root, RootOfRequests(changed));
+}
+
+TEST(RequestsMerkleTree, inclusion_proofs_verify) {
+  for (uint32_t n : kNumsOfLeaves) {
+    std::vector<Digest> leaves = LeavesOf(MakeRequests(n));
+    Digest root;
+    RequestsMerkleTree::computeRoot(leaves.data(), n, root);
+
+    for (uint32_t i = 0; i < n; i++) {
+      std::vector<Digest> proof;
+      RequestsMerkleTree::computeInclusionProof(leaves.data(), n, i, proof);
+      ASSERT_TRUE(RequestsMerkleTree::verifyInclusionProof(
+          leaves[i], i, n, proof, root))
+          << "leaf " << i << " of " << n;
+    }
+  }
+}
+
+TEST(RequestsMerkleTree, inclusion_proofs_reject_tampered_input) {
+  for (uint32_t n : kNumsOfLeaves) {
+    if (n < 2) continue;
+    std::vector<Digest> leaves = LeavesOf(MakeRequests(n));
+    Digest root;
+    RequestsMerkleTree::computeRoot(leaves.data(), n, root);
+
+    for (uint32_t i = 0; i < n; i += 1 + n / 16) {
+      std::vector<Digest> proof;
+      RequestsMerkleTree::computeInclusionProof(leaves.data(), n, i, proof);
+
+      // tampered leaf
+      Digest tamperedLeaf = leaves[i];
+      tamperedLeaf.content()[0] ^= 0x1;
+      ASSERT_FALSE(RequestsMerkleTree::verifyInclusionProof(
+          tamperedLeaf, i, n, proof, root));
+
+      // another leaf with the proof of leaf i
+      const uint32_t other = (i + 1) % n;
+      ASSERT_FALSE(RequestsMerkleTree::verifyInclusionProof(
+          leaves[other], i, n, proof, root));
+
+      // the right leaf at a wrong position
+      ASSERT_FALSE(RequestsMerkleTree::verifyInclusionProof(
+          leaves[i], other, n, proof, root));
+
+      // tampered sibling
+      std::vector<Digest> tamperedProof = proof;
+      tamperedProof.back().content()[5] ^= 0x1;
+      ASSERT_FALSE(RequestsMerkleTree::verifyInclusionProof(
+          leaves[i], i, n, tamperedProof, root));
+
+      // truncated proof
+      tamperedProof = proof;
+      tamperedProof.pop_back();
+      ASSERT_FALSE(RequestsMerkleTree::verifyInclusionProof(
+          leaves[i], i, n, tamperedProof, root));
+
+      // out of range index
+      ASSERT_FALSE(RequestsMerkleTree::verifyInclusionProof(
+          leaves[i], n, n, proof, root));
+    }
+  }
+}
+
+TEST(RequestsMerkleTree, leaf_and_parent_digests_are_domain_separated) {
+  std::vector<Digest> leaves = LeavesOf(MakeRequests(2));
+  Digest parent;
+  RequestsMerkleTree::computeParentDigest(leaves[0], leaves[1], parent);
+
+  // a "request" that is the concatenation of two digests
+  std::string concatenated(leaves[0].content(), sizeof(Digest));
+  concatenated.append(leaves[1].content(), sizeof(Digest));
+  Digest leaf;
+  RequestsMerkleTree::computeLeafDigest(
+      concatenated.data(), concatenated.size(), leaf);
+
+  ASSERT_NE(parent, leaf);
+}
+
+}  // namespace impl
+}  // namespace bftEngine
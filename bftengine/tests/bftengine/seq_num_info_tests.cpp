@@ -0,0 +1,108 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "SeqNumInfo.hpp"
+#include "PrePrepareMsg.hpp"
+#include "PrePrepareDigestMsg.hpp"
+#include "ClientRequestMsg.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+const ReplicaId kPrimary = 0;
+const ViewNum kView = 2;
+const SeqNum kSeqNum = 40;
+
+// a PrePrepareMsg that was received from sender (the primary or a relay)
+PrePrepareMsg* MakePrePrepare(ReplicaId sender, const std::string& request) {
+  ClientRequestMsg req(10, false, 1, request.size(), request.data());
+  PrePrepareMsg* pp = new PrePrepareMsg(sender, kView, kSeqNum,
+                                        CommitPath::SLOW, false);
+  pp->addRequest(req.body(), req.size());
+  pp->finishAddingRequests();
+  return pp;
+}
+
+class RelayedPrePrepareTest : public ::testing::Test {
+ protected:
+  // the PrePrepareDigestMsg of the primary arrives
+  void AddDigestOf(const std::string& request) {
+    std::unique_ptr<PrePrepareMsg> pp(MakePrePrepare(kPrimary, request));
+    ASSERT_TRUE(info.addMsg(new PrePrepareDigestMsg(kPrimary, pp.get())));
+  }
+
+  SeqNumInfo info;
+};
+
+TEST_F(RelayedPrePrepareTest, matching_message_is_taken) {
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(1, "correct"));
+  AddDigestOf("correct");
+
+  std::unique_ptr<PrePrepareMsg> pp(info.takeRelayedPrePrepareMsg());
+  ASSERT_NE(nullptr, pp.get());
+  ASSERT_EQ(1, pp->senderId());
+
+  // the held messages were released
+  ASSERT_EQ(nullptr, info.takeRelayedPrePrepareMsg());
+}
+
+TEST_F(RelayedPrePrepareTest, faulty_relay_does_not_replace_correct_message) {
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(1, "correct"));
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(2, "forged"));
+  AddDigestOf("correct");
+
+  std::unique_ptr<PrePrepareMsg> pp(info.takeRelayedPrePrepareMsg());
+  ASSERT_NE(nullptr, pp.get());
+  ASSERT_EQ(1, pp->senderId());
+}
+
+TEST_F(RelayedPrePrepareTest, correct_message_after_forged_one_is_taken) {
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(2, "forged"));
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(3, "forged too"));
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(1, "correct"));
+  AddDigestOf("correct");
+
+  std::unique_ptr<PrePrepareMsg> pp(info.takeRelayedPrePrepareMsg());
+  ASSERT_NE(nullptr, pp.get());
+  ASSERT_EQ(1, pp->senderId());
+}
+
+TEST_F(RelayedPrePrepareTest, only_the_first_message_of_a_relay_is_held) {
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(2, "forged"));
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(2, "correct"));
+  AddDigestOf("correct");
+
+  ASSERT_EQ(nullptr, info.takeRelayedPrePrepareMsg());
+}
+
+TEST_F(RelayedPrePrepareTest, no_matching_message) {
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(2, "forged"));
+  AddDigestOf("correct");
+
+  ASSERT_EQ(nullptr, info.takeRelayedPrePrepareMsg());
+}
+
+TEST_F(RelayedPrePrepareTest, reset_frees_held_messages) {
+  info.holdRelayedPrePrepareMsg(MakePrePrepare(1, "correct"));
+  info.resetAndFree();
+  AddDigestOf("correct");
+
+  ASSERT_EQ(nullptr, info.takeRelayedPrePrepareMsg());
+}
+
+}  // namespace impl
+}  // namespace bftEngine
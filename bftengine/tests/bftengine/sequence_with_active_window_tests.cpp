@@ -0,0 +1,157 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stdint.h>
+
+#include <set>
+
+#include "gtest/gtest.h"
+#include "PrimitiveTypes.hpp"
+#include "SequenceWithActiveWindow.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+// an item holds the number that was written to it (0 after reset)
+struct TestItem {
+  SeqNum value;
+  void* initData;
+
+  static int numOfFreedItems;
+
+  static void init(TestItem& i, void* d) { i.initData = d; }
+
+  static void free(TestItem& i) { numOfFreedItems++; }
+
+  static void reset(TestItem& i) { i.value = 0; }
+};
+
+int TestItem::numOfFreedItems = 0;
+
+class TestSequence
+    : public SequenceWithActiveWindow<SeqNum, TestItem, TestItem> {
+ public:
+  TestSequence(uint16_t windowSize, uint16_t resolution, SeqNum windowFirst)
+      : SequenceWithActiveWindow(windowSize, resolution, windowFirst,
+                                 &initData) {}
+
+  uint32_t slots() const { return numSlots; }
+
+  uint32_t slotIndexOf(SeqNum n) { return (uint32_t)(&get(n) - activeWindow); }
+
+  // writes n to the item of each number n in the active window
+  void fill() {
+    for (SeqNum n = beginningOfActiveWindow;
+         n < beginningOfActiveWindow + windowSize; n += resolution)
+      get(n).value = n;
+  }
+
+  int initData = 0;
+};
+
+TEST(SequenceWithActiveWindowTest, power_of_two_slots) {
+  EXPECT_EQ(16u, TestSequence(16, 1, 1).slots());
+  EXPECT_EQ(32u, TestSequence(17, 1, 1).slots());
+  EXPECT_EQ(512u, TestSequence(300, 1, 1).slots());
+  EXPECT_EQ(2u, TestSequence(300, 150, 0).slots());
+  EXPECT_EQ(4u, TestSequence(300, 100, 0).slots());
+
+  // all the slots are initialized, and freed when the sequence is deleted
+  TestItem::numOfFreedItems = 0;
+  {
+    TestSequence seq(300, 1, 1);
+    for (SeqNum n = 1; n <= 300; n++) {
+      EXPECT_EQ(0, seq.get(n).value);
+      EXPECT_EQ(&seq.initData, seq.get(n).initData);
+    }
+  }
+  EXPECT_EQ(512, TestItem::numOfFreedItems);
+}
+
+TEST(SequenceWithActiveWindowTest, masking) {
+  // the active window [501, 800] wraps around the 512 slots
+  TestSequence seq(300, 1, 501);
+  EXPECT_TRUE(seq.insideActiveWindow(501));
+  EXPECT_TRUE(seq.insideActiveWindow(800));
+  EXPECT_FALSE(seq.insideActiveWindow(500));
+  EXPECT_FALSE(seq.insideActiveWindow(801));
+  EXPECT_EQ(501, seq.currentActiveWindow().first);
+  EXPECT_EQ(800, seq.currentActiveWindow().second);
+
+  std::set<uint32_t> slots;
+  for (SeqNum n = 501; n <= 800; n++) {
+    EXPECT_EQ((uint32_t)(n % 512), seq.slotIndexOf(n));
+    slots.insert(seq.slotIndexOf(n));
+  }
+  EXPECT_EQ(300u, slots.size());
+
+  // with a resolution, the item of n is the item of n / resolution
+  TestSequence checkpoints(300, 150, 600);
+  EXPECT_EQ(0u, checkpoints.slotIndexOf(600));
+  EXPECT_EQ(1u, checkpoints.slotIndexOf(750));
+}
+
+TEST(SequenceWithActiveWindowTest, advance_across_wraparound) {
+  TestSequence seq(300, 1, 1);
+  seq.fill();
+
+  // advance by half of the window, many times around the 512 slots
+  for (SeqNum first = 151; first < 10000; first += 150) {
+    seq.advanceActiveWindow(first);
+    EXPECT_EQ(first, seq.currentActiveWindow().first);
+
+    // the items that stayed in the window are kept, the new ones are reset
+    for (SeqNum n = first; n < first + 150; n++) EXPECT_EQ(n, seq.get(n).value);
+    for (SeqNum n = first + 150; n < first + 300; n++)
+      EXPECT_EQ(0, seq.get(n).value);
+
+    seq.fill();
+  }
+}
+
+TEST(SequenceWithActiveWindowTest, advance_by_a_window_or_more) {
+  TestSequence seq(300, 1, 1);
+  seq.fill();
+
+  // advancing to the same number does nothing
+  seq.advanceActiveWindow(1);
+  EXPECT_EQ(1, seq.get(1).value);
+
+  seq.advanceActiveWindow(301);
+  for (SeqNum n = 301; n <= 600; n++) EXPECT_EQ(0, seq.get(n).value);
+
+  seq.fill();
+  seq.advanceActiveWindow(5001);
+  for (SeqNum n = 5001; n <= 5300; n++) EXPECT_EQ(0, seq.get(n).value);
+
+  seq.fill();
+  seq.resetAll(7001);
+  EXPECT_EQ(7001, seq.currentActiveWindow().first);
+  for (SeqNum n = 7001; n <= 7300; n++) EXPECT_EQ(0, seq.get(n).value);
+}
+
+TEST(SequenceWithActiveWindowTest, advance_with_resolution) {
+  TestSequence checkpoints(300, 150, 0);
+  checkpoints.fill();
+  EXPECT_EQ(150, checkpoints.get(150).value);
+
+  for (SeqNum first = 150; first < 3000; first += 150) {
+    checkpoints.advanceActiveWindow(first);
+    EXPECT_EQ(first, checkpoints.get(first).value);
+    EXPECT_EQ(0, checkpoints.get(first + 150).value);
+    checkpoints.fill();
+  }
+}
+
+}  // namespace impl
+}  // namespace bftEngine
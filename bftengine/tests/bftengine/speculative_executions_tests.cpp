@@ -0,0 +1,155 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "SpeculativeExecutions.hpp"
+
+namespace bftEngine {
+namespace impl {
+
+// records the commits and the rollbacks of the speculative versions
+class TestRequestsHandler : public RequestsHandler {
+ public:
+  int execute(uint16_t clientId, uint64_t sequenceNum, bool readOnly,
+              uint32_t requestSize, const char* request, uint32_t maxReplySize,
+              char* outReply, uint32_t& outActualReplySize) override {
+    return -1;
+  }
+
+  void commitSpeculative(uint64_t sequenceNum) override {
+    commits.push_back(sequenceNum);
+  }
+
+  void rollbackSpeculative(uint64_t lastCommittedSeqNum) override {
+    rollbacks.push_back(lastCommittedSeqNum);
+  }
+
+  std::vector<uint64_t> commits;
+  std::vector<uint64_t> rollbacks;
+};
+
+std::vector<SpeculativeExecutions::Reply> replies(NodeIdType clientId,
+                                                  ReqId reqSeqNum) {
+  std::vector<SpeculativeExecutions::Reply> v;
+  v.push_back(SpeculativeExecutions::Reply{clientId, reqSeqNum, "reply"});
+  return v;
+}
+
+// the speculative executions of the SeqNums 11, 12, 13 (after the checkpoint
+// 10), with the requests digests 1, 2, 3
+void addThree(SpeculativeExecutions& spec) {
+  Digest history;
+  for (SeqNum s = 11; s <= 13; s++) {
+    const Digest digestOfRequests((unsigned char)(s - 10));
+    Digest next;
+    SpeculativeExecutions::calcHistoryDigest(history, s, digestOfRequests, next);
+    spec.add(s, digestOfRequests, next, replies(100, s));
+    history = next;
+  }
+}
+
+TEST(SpeculativeExecutionsTest, commit) {
+  TestRequestsHandler handler;
+  SpeculativeExecutions spec(&handler);
+  EXPECT_TRUE(spec.empty());
+  EXPECT_EQ(nullptr, spec.repliesOf(11, Digest(1)));
+
+  addThree(spec);
+  EXPECT_EQ(3u, spec.size());
+  EXPECT_EQ(13u, spec.lastReqSeqNumOf(100));
+  EXPECT_EQ(0u, spec.lastReqSeqNumOf(101));
+
+  const std::vector<SpeculativeExecutions::Reply>* r =
+      spec.repliesOf(11, Digest(1));
+  ASSERT_NE(nullptr, r);
+  ASSERT_EQ(1u, r->size());
+  EXPECT_EQ(100, (*r)[0].clientId);
+  EXPECT_EQ(11u, (*r)[0].reqSeqNum);
+  EXPECT_EQ("reply", (*r)[0].reply);
+
+  spec.commit(11);
+  EXPECT_EQ(std::vector<uint64_t>({11}), handler.commits);
+  EXPECT_TRUE(handler.rollbacks.empty());
+  EXPECT_EQ(2u, spec.size());
+
+  ASSERT_NE(nullptr, spec.repliesOf(12, Digest(2)));
+  spec.commit(12);
+  ASSERT_NE(nullptr, spec.repliesOf(13, Digest(3)));
+  spec.commit(13);
+  EXPECT_EQ(std::vector<uint64_t>({11, 12, 13}), handler.commits);
+  EXPECT_TRUE(spec.empty());
+  EXPECT_TRUE(handler.rollbacks.empty());
+}
+
+TEST(SpeculativeExecutionsTest, committed_requests_mismatch) {
+  TestRequestsHandler handler;
+  SpeculativeExecutions spec(&handler);
+  addThree(spec);
+  spec.commit(11);
+
+  // 12 was committed with other requests: 12 and 13 are rolled back
+  EXPECT_EQ(nullptr, spec.repliesOf(12, Digest(7)));
+  EXPECT_EQ(std::vector<uint64_t>({11}), handler.commits);
+  EXPECT_EQ(std::vector<uint64_t>({11}), handler.rollbacks);
+  EXPECT_TRUE(spec.empty());
+  EXPECT_EQ(0u, spec.lastReqSeqNumOf(100));
+}
+
+TEST(SpeculativeExecutionsTest, view_change_rollback) {
+  TestRequestsHandler handler;
+  SpeculativeExecutions spec(&handler);
+
+  // nothing to roll back
+  spec.rollback(10);
+  EXPECT_TRUE(handler.rollbacks.empty());
+
+  addThree(spec);
+  spec.rollback(10);
+  EXPECT_EQ(std::vector<uint64_t>({10}), handler.rollbacks);
+  EXPECT_TRUE(handler.commits.empty());
+  EXPECT_TRUE(spec.empty());
+
+  // the SeqNums can be executed speculatively again (e.g. in the new view)
+  addThree(spec);
+  EXPECT_EQ(3u, spec.size());
+}
+
+TEST(SpeculativeExecutionsTest, history_digest) {
+  TestRequestsHandler handler;
+  SpeculativeExecutions spec(&handler);
+  addThree(spec);
+
+  Digest h11, h12, h13;
+  SpeculativeExecutions::calcHistoryDigest(Digest(), 11, Digest(1), h11);
+  SpeculativeExecutions::calcHistoryDigest(h11, 12, Digest(2), h12);
+  SpeculativeExecutions::calcHistoryDigest(h12, 13, Digest(3), h13);
+  EXPECT_EQ(h13, spec.lastHistoryDigest());
+
+  // the history depends on the requests of all the SeqNums, and on the SeqNums
+  Digest other11, other12, other13;
+  SpeculativeExecutions::calcHistoryDigest(Digest(), 11, Digest(4), other11);
+  SpeculativeExecutions::calcHistoryDigest(other11, 12, Digest(2), other12);
+  SpeculativeExecutions::calcHistoryDigest(other12, 13, Digest(3), other13);
+  EXPECT_NE(h13, other13);
+
+  Digest shifted;
+  SpeculativeExecutions::calcHistoryDigest(h11, 13, Digest(2), shifted);
+  EXPECT_NE(h12, shifted);
+}
+
+}  // namespace impl
+}  // namespace bftEngine
@@ -0,0 +1,136 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "DirtyPagesTracker.hpp"
+
+namespace bftEngine {
+namespace SimpleInMemoryStateTransfer {
+namespace impl {
+
+const uint32_t kNumOfPages = 4;
+
+// a page-aligned buffer of kNumOfPages OS pages
+class DirtyPagesTrackerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pageSize_ = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+    void* p = nullptr;
+    ASSERT_EQ(0, posix_memalign(&p, pageSize_, kNumOfPages * pageSize_));
+    buf_ = static_cast<char*>(p);
+    for (uint32_t i = 0; i < kNumOfPages * pageSize_; i++) buf_[i] = 0;
+  }
+
+  void TearDown() override { free(buf_); }
+
+  std::vector<int64_t> dirtyPages(const DirtyPagesTracker& tracker) {
+    std::vector<int64_t> offsets;
+    EXPECT_TRUE(tracker.getDirtyPages(offsets));
+    return offsets;
+  }
+
+  int64_t page(uint32_t i) { return static_cast<int64_t>(i) * pageSize_; }
+
+  uint32_t pageSize_ = 0;
+  char* buf_ = nullptr;
+};
+
+TEST_F(DirtyPagesTrackerTest, write_protection_finds_written_pages) {
+  DirtyPagesTracker tracker(buf_, kNumOfPages * pageSize_, false);
+  ASSERT_EQ(DirtyPagesTracker::WriteProtection, tracker.method());
+  ASSERT_TRUE(tracker.reset());
+  EXPECT_TRUE(dirtyPages(tracker).empty());
+
+  buf_[page(1) + 7] = 1;
+  buf_[page(3)] = 1;
+  buf_[page(3) + 1] = 1;
+  EXPECT_EQ((std::vector<int64_t>{page(1), page(3)}), dirtyPages(tracker));
+
+  ASSERT_TRUE(tracker.reset());
+  EXPECT_TRUE(dirtyPages(tracker).empty());
+  buf_[page(0)] = 2;
+  EXPECT_EQ((std::vector<int64_t>{page(0)}), dirtyPages(tracker));
+}
+
+TEST_F(DirtyPagesTrackerTest, write_protection_skips_partial_pages) {
+  // the region starts and ends in the middle of a page
+  const int64_t shift = 100;
+  char* begin = buf_ + shift;
+  DirtyPagesTracker tracker(begin, 2 * pageSize_, false);
+  ASSERT_EQ(DirtyPagesTracker::WriteProtection, tracker.method());
+  ASSERT_TRUE(tracker.reset());
+
+  // the partial pages are always dirty
+  EXPECT_EQ((std::vector<int64_t>{-shift, page(2) - shift}),
+            dirtyPages(tracker));
+
+  // the data outside the region (on the partial pages) can still be written
+  // by system calls
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  ASSERT_EQ(2, write(fds[1], "ab", 2));
+  EXPECT_EQ(1, read(fds[0], buf_, 1));
+  EXPECT_EQ(1, read(fds[0], begin + 2 * pageSize_, 1));
+  close(fds[0]);
+  close(fds[1]);
+  EXPECT_EQ('a', buf_[0]);
+  EXPECT_EQ('b', begin[2 * pageSize_]);
+
+  begin[page(1)] = 1;
+  EXPECT_EQ((std::vector<int64_t>{-shift, page(1) - shift, page(2) - shift}),
+            dirtyPages(tracker));
+}
+
+TEST_F(DirtyPagesTrackerTest, write_protection_region_inside_one_page) {
+  DirtyPagesTracker tracker(buf_ + 10, 20, false);
+  ASSERT_EQ(DirtyPagesTracker::WriteProtection, tracker.method());
+  ASSERT_TRUE(tracker.reset());
+  EXPECT_EQ((std::vector<int64_t>{-10}), dirtyPages(tracker));
+  buf_[0] = 1;
+}
+
+TEST_F(DirtyPagesTrackerTest, one_write_protection_tracker_per_process) {
+  DirtyPagesTracker tracker(buf_, pageSize_, false);
+  ASSERT_EQ(DirtyPagesTracker::WriteProtection, tracker.method());
+  DirtyPagesTracker other(buf_ + pageSize_, pageSize_, false);
+  EXPECT_EQ(DirtyPagesTracker::None, other.method());
+  EXPECT_FALSE(other.reset());
+}
+
+TEST_F(DirtyPagesTrackerTest, soft_dirty_bits_find_written_pages) {
+  DirtyPagesTracker tracker(buf_, kNumOfPages * pageSize_);
+  if (tracker.method() != DirtyPagesTracker::SoftDirtyBits) {
+    std::cout << "soft-dirty bits are not supported (test skipped)"
+              << std::endl;
+    return;
+  }
+  ASSERT_TRUE(tracker.reset());
+  EXPECT_TRUE(dirtyPages(tracker).empty());
+
+  buf_[page(0)] = 1;
+  buf_[page(2) + 5] = 1;
+  EXPECT_EQ((std::vector<int64_t>{page(0), page(2)}), dirtyPages(tracker));
+
+  ASSERT_TRUE(tracker.reset());
+  EXPECT_TRUE(dirtyPages(tracker).empty());
+}
+
+}  // namespace impl
+}  // namespace SimpleInMemoryStateTransfer
+}  // namespace bftEngine
@@ -0,0 +1,246 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0 License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#ifndef CONCORD_BFT_ASYNC_LOGGER_HPP
+#define CONCORD_BFT_ASYNC_LOGGER_HPP
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace concordlogger {
+
+// Prints the records of SimpleLoggerImpl on a background thread (enabled by
+// USE_ASYNC_LOGGING).
+// The logging thread only formats the text of a record (with vsnprintf,
+// directly into a slot of a bounded lock-free queue) and takes a time stamp;
+// the time stamp is converted to local time and the record is printed by the
+// background thread. The queue has multiple producers and a single consumer.
+// If the queue is full, the logging thread waits for a free slot (records are
+// never dropped or reordered).
+// Records of level fatal are flushed synchronously, and the queue is flushed
+// when the process exits (but not if it is aborted).
+class AsyncLogger {
+ public:
+  static const size_t kNumOfSlots = 4096;  // a power of 2
+  static const size_t kMaxNameLen = 31;
+  static const size_t kMaxInlineTextLen = 215;
+
+  // the instance is never destroyed, so it can be used by the destructors of
+  // static objects (after exit, records are printed synchronously)
+  static AsyncLogger &instance() {
+    static AsyncLogger *logger = new AsyncLogger();
+    return *logger;
+  }
+
+  void log(int level, const std::string &name, const char *format,
+           va_list &args) {
+    size_t pos = 0;
+    Slot *s = claim(pos);
+    if (s == nullptr) {
+      va_list args2;
+      va_copy(args2, args);
+      int size = vsnprintf(nullptr, 0, format, args2);
+      va_end(args2);
+      std::string text(size > 0 ? size : 0, '\0');
+      vsnprintf(&text[0], text.size() + 1, format, args);
+      printRecord(level, name.c_str(), std::chrono::system_clock::now(),
+                  text.c_str());
+      return;
+    }
+
+    fillHeader(s, level, name);
+    va_list args2;
+    va_copy(args2, args);
+    int size = vsnprintf(s->text, sizeof(s->text), format, args);
+    if (size >= static_cast<int>(sizeof(s->text))) {
+      s->longText = new char[size + 1];
+      vsnprintf(s->longText, size + 1, format, args2);
+    }
+    va_end(args2);
+    publish(s, pos, level);
+  }
+
+  void log(int level, const std::string &name, const std::string &text) {
+    size_t pos = 0;
+    Slot *s = claim(pos);
+    if (s == nullptr) {
+      printRecord(level, name.c_str(), std::chrono::system_clock::now(),
+                  text.c_str());
+      return;
+    }
+
+    fillHeader(s, level, name);
+    if (text.size() < sizeof(s->text)) {
+      memcpy(s->text, text.c_str(), text.size() + 1);
+    } else {
+      s->longText = new char[text.size() + 1];
+      memcpy(s->longText, text.c_str(), text.size() + 1);
+    }
+    publish(s, pos, level);
+  }
+
+  // waits until all the records that were logged before the call are printed
+  void flush() {
+    const size_t target = enqueuePos_.load();
+    while (!stopped_ && dequeuePos_.load() < target) {
+      cond_.notify_one();
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    fflush(stdout);
+  }
+
+ private:
+  static const int kFatalLevel = 5;
+
+  struct Slot {
+    std::atomic<size_t> seq;
+    int level;
+    std::chrono::system_clock::time_point time;
+    char name[kMaxNameLen + 1];
+    char *longText;  // allocated if the text does not fit in text
+    char text[kMaxInlineTextLen + 1];
+  };
+
+  AsyncLogger() : slots_(new Slot[kNumOfSlots]) {
+    for (size_t i = 0; i < kNumOfSlots; i++) slots_[i].seq.store(i);
+    thread_ = std::thread(&AsyncLogger::run, this);
+    atexit(&AsyncLogger::onExit);
+  }
+
+  static void onExit() {
+    AsyncLogger &l = instance();
+    l.stopping_ = true;
+    l.cond_.notify_one();
+    if (l.thread_.joinable()) l.thread_.join();
+    l.stopped_ = true;
+    // records that were claimed while the thread was stopping
+    l.drain();
+    fflush(stdout);
+  }
+
+  // bounded MPMC queue of D. Vyukov (with a single consumer); returns
+  // nullptr if the background thread was stopped (the process exits)
+  Slot *claim(size_t &pos) {
+    pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (!stopped_) {
+      Slot *s = &slots_[pos & (kNumOfSlots - 1)];
+      const size_t seq = s->seq.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+          return s;
+      } else if (diff < 0) {
+        // full
+        cond_.notify_one();
+        std::this_thread::yield();
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    return nullptr;
+  }
+
+  void fillHeader(Slot *s, int level, const std::string &name) {
+    s->level = level;
+    s->time = std::chrono::system_clock::now();
+    size_t len = name.size();
+    if (len > kMaxNameLen) len = kMaxNameLen;
+    memcpy(s->name, name.c_str(), len);
+    s->name[len] = '\0';
+    s->longText = nullptr;
+  }
+
+  void publish(Slot *s, size_t pos, int level) {
+    s->seq.store(pos + 1, std::memory_order_release);
+    if (level >= kFatalLevel) flush();
+  }
+
+  // returns the number of printed records; only called by the consumer
+  size_t drain() {
+    size_t n = 0;
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot *s = &slots_[pos & (kNumOfSlots - 1)];
+      if (s->seq.load(std::memory_order_acquire) != pos + 1) break;
+
+      printRecord(s->level, s->name, s->time,
+                  s->longText != nullptr ? s->longText : s->text);
+      delete[] s->longText;
+      s->longText = nullptr;
+
+      s->seq.store(pos + kNumOfSlots, std::memory_order_release);
+      dequeuePos_.store(++pos);
+      n++;
+    }
+    return n;
+  }
+
+  void run() {
+    while (true) {
+      const bool stopping = stopping_;
+      if (drain() > 0) continue;
+      if (stopping) return;
+
+      fflush(stdout);
+      std::unique_lock<std::mutex> lock(lock_);
+      cond_.wait_for(lock, std::chrono::milliseconds(2));
+    }
+  }
+
+  static void printRecord(int level, const char *name,
+                          std::chrono::system_clock::time_point time,
+                          const char *text) {
+    static const char *levels[] =
+        {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+    using namespace std::chrono;
+    const int ms = static_cast<int>(
+        duration_cast<milliseconds>(time.time_since_epoch()).count() % 1000);
+    const std::time_t timer = system_clock::to_time_t(time);
+    std::tm bt;
+    localtime_r(&timer, &bt);
+    char timeStr[32];
+    strftime(timeStr, sizeof(timeStr), "%F %T", &bt);
+
+    printf("%s %s.%03d (%s) %s\n",
+           (level >= 0 && level <= kFatalLevel) ? levels[level] : "",
+           timeStr, ms, name, text);
+  }
+
+  Slot *const slots_;
+  std::atomic<size_t> enqueuePos_{0};
+  std::atomic<size_t> dequeuePos_{0};
+
+  std::thread thread_;
+  std::mutex lock_;
+  std::condition_variable cond_;
+  std::atomic<bool> stopping_{false};
+  std::atomic<bool> stopped_{false};
+};
+
+}  // namespace concordlogger
+
+#endif  // CONCORD_BFT_ASYNC_LOGGER_HPP
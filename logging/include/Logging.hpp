@@ -22,8 +22,19 @@
 #ifdef USE_LOG4CPP
 #include <log4cplus/loggingmacros.h>
 typedef log4cplus::Logger LoggerImpl;
+#elif defined(USE_ASYNC_LOGGING)
+#include "AsyncLogger.hpp"
 #endif
 
+// The LOG_* statements of levels below CONCORD_LOG_MIN_LEVEL are compiled out
+// (their arguments are not evaluated). The levels are numbered as in LogLevel:
+// 0 - trace, 1 - debug, 2 - info, 3 - warn, 4 - error, 5 - fatal.
+#ifndef CONCORD_LOG_MIN_LEVEL
+#define CONCORD_LOG_MIN_LEVEL 0
+#endif
+
+#define CONCORD_LOG_ENABLED(level) ((level) >= CONCORD_LOG_MIN_LEVEL)
+
 namespace concordlogger {
 
 #ifndef USE_LOG4CPP
@@ -68,7 +79,15 @@ class SimpleLoggerImpl {
  public:
   explicit SimpleLoggerImpl(std::string name) : _name{std::move(name)} {}
 
+  const std::string &name() const {
+    return _name;
+  }
+
   inline void print(concordlogger::LogLevel l, std::string text) {
+#ifdef USE_ASYNC_LOGGING
+    AsyncLogger::instance().log(l, _name, text);
+    return;
+#endif
     std::stringstream time;
     get_time(time);
     printf("%s %s (%s) %s\n",
@@ -97,6 +116,16 @@ class Logger {
     return output;
   }
 
+#ifndef USE_LOG4CPP
+  inline void print(LogLevel l, const char *format, va_list &args) {
+#ifdef USE_ASYNC_LOGGING
+    AsyncLogger::instance().log(l, _impl.name(), format, args);
+#else
+    _impl.print(l, prepare(format, args));
+#endif
+  }
+#endif
+
  public:
   inline LoggerImpl getImpl() {
     return _impl;
@@ -118,8 +147,7 @@ class Logger {
     LOG4CPLUS_FATAL_FMT(_impl, format, args);
 #else
     CHECK_ENABLED(LogLevel::fatal);
-    std::string output = prepare(format, args);
-    fatal(output);
+    print(LogLevel::fatal, format, args);
 #endif
     va_end(args);
   }
@@ -144,8 +172,7 @@ class Logger {
     LOG4CPLUS_ERROR_FMT(_impl, format, args);
 #else
     CHECK_ENABLED(LogLevel::error);
-    std::string output = prepare(format, args);
-    error(output);
+    print(LogLevel::error, format, args);
 #endif
     va_end(args);
   }
@@ -170,8 +197,7 @@ class Logger {
     LOG4CPLUS_WARN_FMT(_impl, format, args);
 #else
     CHECK_ENABLED(LogLevel::warn);
-    std::string output = prepare(format, args);
-    warn(output);
+    print(LogLevel::warn, format, args);
 #endif
     va_end(args);
   }
@@ -196,8 +222,7 @@ class Logger {
     LOG4CPLUS_INFO_FMT(_impl, format, args);
 #else
     CHECK_ENABLED(LogLevel::info);
-    std::string output = prepare(format, args);
-    info(output);
+    print(LogLevel::info, format, args);
 #endif
     va_end(args);
   }
@@ -222,8 +247,7 @@ class Logger {
     LOG4CPLUS_DEBUG_FMT(_impl, format, args);
 #else
     CHECK_ENABLED(LogLevel::debug);
-    std::string output = prepare(format, args);
-    debug(output);
+    print(LogLevel::debug, format, args);
 #endif
     va_end(args);
   }
@@ -248,8 +272,7 @@ class Logger {
     LOG4CPLUS_FATAL_FMT(_impl, format, args);
 #else
     CHECK_ENABLED(LogLevel::trace);
-    std::string output = prepare(format, args);
-    trace(output);
+    print(LogLevel::trace, format, args);
 #endif
     va_end(args);
   }
@@ -269,41 +292,41 @@ class Logger {
 }; // Logger
 
 #ifdef USE_LOG4CPP
-#define LOG_TRACE(l, s) LOG4CPLUS_TRACE(l.getImpl(),s)
-#define LOG_TRACE_F(l, ...) LOG4CPLUS_TRACE_FMT(l.getImpl(), __VA_ARGS__)
+#define LOG_TRACE(l, s) do {if (CONCORD_LOG_ENABLED(0)) LOG4CPLUS_TRACE(l.getImpl(),s);} while (0)
+#define LOG_TRACE_F(l, ...) do {if (CONCORD_LOG_ENABLED(0)) LOG4CPLUS_TRACE_FMT(l.getImpl(), __VA_ARGS__);} while (0)
 
-#define LOG_DEBUG(l, s)LOG4CPLUS_DEBUG(l.getImpl(),s)
-#define LOG_DEBUG_F(l,...) LOG4CPLUS_DEBUG_FMT(l.getImpl(),__VA_ARGS__)
+#define LOG_DEBUG(l, s) do {if (CONCORD_LOG_ENABLED(1)) LOG4CPLUS_DEBUG(l.getImpl(),s);} while (0)
+#define LOG_DEBUG_F(l,...) do {if (CONCORD_LOG_ENABLED(1)) LOG4CPLUS_DEBUG_FMT(l.getImpl(),__VA_ARGS__);} while (0)
 
-#define LOG_INFO(l, s) LOG4CPLUS_INFO(l.getImpl(),s)
-#define LOG_INFO_F(l,...) LOG4CPLUS_INFO_FMT(l.getImpl(), __VA_ARGS__)
+#define LOG_INFO(l, s) do {if (CONCORD_LOG_ENABLED(2)) LOG4CPLUS_INFO(l.getImpl(),s);} while (0)
+#define LOG_INFO_F(l,...) do {if (CONCORD_LOG_ENABLED(2)) LOG4CPLUS_INFO_FMT(l.getImpl(), __VA_ARGS__);} while (0)
 
-#define LOG_WARN(l, s) LOG4CPLUS_WARN(l.getImpl(),s)
-#define LOG_WARN_F(logger,...) LOG4CPLUS_WARN_FMT(logger.getImpl(),__VA_ARGS__)
+#define LOG_WARN(l, s) do {if (CONCORD_LOG_ENABLED(3)) LOG4CPLUS_WARN(l.getImpl(),s);} while (0)
+#define LOG_WARN_F(logger,...) do {if (CONCORD_LOG_ENABLED(3)) LOG4CPLUS_WARN_FMT(logger.getImpl(),__VA_ARGS__);} while (0)
 
-#define LOG_ERROR(l, s) LOG4CPLUS_ERROR(l.getImpl(),s)
-#define LOG_ERROR_F(l,...) LOG4CPLUS_ERROR_FMT(l.getImpl(),__VA_ARGS__)
+#define LOG_ERROR(l, s) do {if (CONCORD_LOG_ENABLED(4)) LOG4CPLUS_ERROR(l.getImpl(),s);} while (0)
+#define LOG_ERROR_F(l,...) do {if (CONCORD_LOG_ENABLED(4)) LOG4CPLUS_ERROR_FMT(l.getImpl(),__VA_ARGS__);} while (0)
 
-#define LOG_FATAL(l, s) LOG4CPLUS_FATAL(l.getImpl(),s)
-#define LOG_FATAL_F(l,...) LOG4CPLUS_FATAL_FMT(l.getImpl(),__VA_ARGS__)
+#define LOG_FATAL(l, s) do {if (CONCORD_LOG_ENABLED(5)) LOG4CPLUS_FATAL(l.getImpl(),s);} while (0)
+#define LOG_FATAL_F(l,...) do {if (CONCORD_LOG_ENABLED(5)) LOG4CPLUS_FATAL_FMT(l.getImpl(),__VA_ARGS__);} while (0)
 #else
-#define LOG_TRACE(l, s) {std::ostringstream os; os << s; l.trace (os);}
-#define LOG_TRACE_F(l, ...) l.trace(__VA_ARGS__)
+#define LOG_TRACE(l, s) do {if (CONCORD_LOG_ENABLED(0)) {std::ostringstream os; os << s; l.trace (os);}} while (0)
+#define LOG_TRACE_F(l, ...) do {if (CONCORD_LOG_ENABLED(0)) l.trace(__VA_ARGS__);} while (0)
 
-#define LOG_DEBUG(l, s) {std::ostringstream os; os << s; l.debug (os);}
-#define LOG_DEBUG_F(l, ...) l.debug(__VA_ARGS__)
+#define LOG_DEBUG(l, s) do {if (CONCORD_LOG_ENABLED(1)) {std::ostringstream os; os << s; l.debug (os);}} while (0)
+#define LOG_DEBUG_F(l, ...) do {if (CONCORD_LOG_ENABLED(1)) l.debug(__VA_ARGS__);} while (0)
 
-#define LOG_INFO(l, s) {std::ostringstream os; os << s; l.info (os);}
-#define LOG_INFO_F(l, ...) l.info(__VA_ARGS__)
+#define LOG_INFO(l, s) do {if (CONCORD_LOG_ENABLED(2)) {std::ostringstream os; os << s; l.info (os);}} while (0)
+#define LOG_INFO_F(l, ...) do {if (CONCORD_LOG_ENABLED(2)) l.info(__VA_ARGS__);} while (0)
 
-#define LOG_WARN(l, s) {std::ostringstream os; os << s; l.warn(os);}
-#define LOG_WARN_F(l, ...) l.warn(__VA_ARGS__)
+#define LOG_WARN(l, s) do {if (CONCORD_LOG_ENABLED(3)) {std::ostringstream os; os << s; l.warn(os);}} while (0)
+#define LOG_WARN_F(l, ...) do {if (CONCORD_LOG_ENABLED(3)) l.warn(__VA_ARGS__);} while (0)
 
-#define LOG_ERROR(l, s) {std::ostringstream os; os << s; l.error(os);}
-#define LOG_ERROR_F(l, ...) l.error(__VA_ARGS__)
+#define LOG_ERROR(l, s) do {if (CONCORD_LOG_ENABLED(4)) {std::ostringstream os; os << s; l.error(os);}} while (0)
+#define LOG_ERROR_F(l, ...) do {if (CONCORD_LOG_ENABLED(4)) l.error(__VA_ARGS__);} while (0)
 
-#define LOG_FATAL(l, s) {std::ostringstream os; os << s; l.fatal(os);}
-#define LOG_FATAL_F(l, ...) l.fatal(__VA_ARGS__)
+#define LOG_FATAL(l, s) do {if (CONCORD_LOG_ENABLED(5)) {std::ostringstream os; os << s; l.fatal(os);}} while (0)
+#define LOG_FATAL_F(l, ...) do {if (CONCORD_LOG_ENABLED(5)) l.fatal(__VA_ARGS__);} while (0)
 #endif
 
 } // namespace
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "bls/relic/LagrangeInterpolation.h"
+#include "bls/relic/BlsLagrangeCoeffCache.h"
 #include "threshsign/bls/relic/BlsPublicParameters.h"
 #include "threshsign/bls/relic/PublicParametersFactory.h"
 
@@ -44,6 +45,67 @@ void printTime(const AveragingTimer& t, int numCoeffs, int numIters) {
                         << endl;
 }
 
+/**
+ * Cached vs. uncached coefficients for a sequence of threshold signatures, where (as in steady state)
+ * the same k fastest signers sign most of the messages, and a few other sets of signers sign the rest.
+ */
+void benchCoeffCache(const BlsPublicParameters& params, int n, int k, int numIters) {
+    const int numSigs = 100;
+    const int numOtherSets = 3;
+
+    std::vector<VectorOfShares> sets(numOtherSets + 1);
+    for(VectorOfShares& s : sets) {
+        VectorOfShares::randomSubset(s, n, k);
+    }
+
+    // 90% of the signatures use sets[0]
+    std::vector<size_t> sigSets(numSigs);
+    for(size_t& s : sigSets) {
+        s = (rand() % 10 == 0) ? static_cast<size_t>(1 + rand() % numOtherSets) : 0;
+    }
+
+    std::vector<BNT> coeffs(static_cast<size_t>(n + 1), BNT(0)), cachedCoeffs(static_cast<size_t>(n + 1), BNT(0));
+
+    AveragingTimer tu("Uncached coeffs     ");
+    for(int i = 0; i < numIters; i++) {
+        tu.startLap();
+        for(size_t s : sigSets) {
+            lagrangeCoeffAccumReduced(sets[s], coeffs, params.getGroupOrder());
+        }
+        tu.endLap();
+    }
+
+    AveragingTimer tc("LRU-cached coeffs   ");
+    uint64_t hits = 0, misses = 0;
+    for(int i = 0; i < numIters; i++) {
+        BlsLagrangeCoeffCache cache(16, params.getGroupOrder());
+        tc.startLap();
+        for(size_t s : sigSets) {
+            cache.getCoeffs(sets[s], cachedCoeffs);
+        }
+        tc.endLap();
+        hits = cache.getNumHits();
+        misses = cache.getNumMisses();
+    }
+
+    // Make sure the cached coefficients are the right ones (for the last set)
+    const VectorOfShares& last = sets[sigSets.back()];
+    for(ShareID id = last.first(); last.isEnd(id) == false; id = last.next(id)) {
+        size_t idx = static_cast<size_t>(id);
+        if(coeffs[idx] != cachedCoeffs[idx]) {
+            logerror << "CachedCoeff[" << idx << "] != Coeff [" << idx << "]" << endl;
+            throw std::runtime_error("Bad coeff");
+        }
+    }
+
+    std::cout << tu.getName() << " (" << numIters << " iters avg): "
+              << tu.averageLapTime()/numSigs << " microsecs per signature" << endl;
+    std::cout << tc.getName() << " (" << numIters << " iters avg): "
+              << tc.averageLapTime()/numSigs << " microsecs per signature"
+              << " (" << hits << " hits, " << misses << " misses)" << endl;
+    std::cout << endl;
+}
+
 int RelicAppMain(const Library& lib, const std::vector<std::string>& args) {
     (void)args;
 
@@ -162,6 +224,8 @@ int RelicAppMain(const Library& lib, const std::vector<std::string>& args) {
         }
 
         //} 100 iterations
+
+        benchCoeffCache(params, n, k, numIters);
     }
 
 #ifdef INCREMENTAL_BENCH
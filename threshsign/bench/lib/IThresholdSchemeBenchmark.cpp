@@ -75,6 +75,8 @@ void IThresholdSchemeBenchmark::start() {
             pairT.endLap();
         }
 
+        benchExtra();
+
         // Pick random subset of signers
         VectorOfShares signers;
         VectorOfShares::randomSubset(signers, numSigners, reqSigners);
@@ -82,6 +82,9 @@ public:
     virtual void aggregateShares(const VectorOfShares& signers) = 0;
     virtual void sanityCheckThresholdSignature(const VectorOfShares& signers) = 0;
 
+    // Scheme-specific measurements (reported by printExtraNumbers())
+    virtual void benchExtra() {}
+
     void printResults(std::ostream& out);
     void printHeaders(std::ostream& out);
     virtual void printExtraHeaders(std::ostream& out) { (void)out; }
@@ -14,6 +14,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "threshsign/Serializable.h"
 #include "IPublicKey.h"
@@ -37,6 +38,40 @@ class IThresholdVerifier : public Serializable {
                       int sigLen) const = 0;
   virtual int requiredLengthForSignedData() const = 0;
 
+  /**
+   * Identifies the invalid shares among the given signature shares on msg
+   * (e.g., after the threshold signature assembled from them failed to verify).
+   * The default implementation verifies the shares one by one, using an
+   * accumulator with share verification.
+   *
+   * @param outInvalidShares  the indexes (in sigShares) of the invalid shares,
+   *                          in increasing order
+   */
+  virtual void findInvalidShares(const char *msg,
+                                 int msgLen,
+                                 const char *const *sigShares,
+                                 const int *sigShareLens,
+                                 int numOfShares,
+                                 std::vector<int> &outInvalidShares);
+
+  /**
+   * Assembles the threshold signatures of several accumulators (accs[i] has
+   * the shares of msgs[i]) and verifies them. Implementations may share work
+   * between the accumulators (e.g., the BLS verifier checks all the signatures
+   * with one randomized pairing equation). The default implementation calls
+   * getFullSignedData() and verify() for each accumulator.
+   *
+   * @param outSigs   outSigs[i] receives the signature assembled by accs[i]
+   *                  (requiredLengthForSignedData() bytes)
+   * @param outValid  outValid[i] is true IFF that signature is valid
+   */
+  virtual void combineAndVerify(IThresholdAccumulator *const *accs,
+                                const char *const *msgs,
+                                const int *msgLens,
+                                int num,
+                                char *const *outSigs,
+                                std::vector<bool> &outValid);
+
   virtual const IPublicKey &getPublicKey() const = 0;
   virtual const IShareVerificationKey &getShareVerificationKey(ShareID signer) const = 0;
 
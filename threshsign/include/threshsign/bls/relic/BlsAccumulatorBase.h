@@ -36,7 +36,7 @@ protected:
     G1T threshSig;  // the final assembled threshold signature
     G1T hash;		// expected hash of the message being signed
 
-    G2T gen2;       // the generate of group G_2 (needed when verifying sigshares)
+    G2T negGen2;    // the negated generator of group G_2 (needed when verifying sigshares, see pairingsAreEqual())
 
     // True if share verification is enabled
     bool shareVerificationEnabled;
@@ -101,7 +101,7 @@ public:
      *
      * @return the assembled threshold signature
      */
-    //const G1T& getThresholdSignature() const { return threshSig; }
+    const G1T& getThresholdSignature() const { return threshSig; }
 
     /**
      * Converts the threshold signature to a byte sequence.
@@ -559,6 +559,14 @@ class GTT {
   }
 };
 
+/**
+ * Returns true IFF e(p1, q1) == e(p2, q2), given negQ2 = -q2 (e.g., the negated generator of G2, computed once).
+ * Checks that e(p1, q1) * e(p2, -q2) is the identity with one multi-pairing: the two Miller loops share their
+ * squarings and there is a single final exponentiation, which is much cheaper than computing and comparing
+ * two pairings.
+ */
+bool pairingsAreEqual(const G1T &p1, const G2T &q1, const G1T &p2, const G2T &negQ2);
+
 /**
  * Easily print RELIC types using std::ostream objects like std::cout
  */
@@ -27,6 +27,8 @@
 namespace BLS {
 namespace Relic {
 
+class BlsLagrangeCoeffCache;
+
 class BlsThresholdAccumulator : public BlsAccumulatorBase {
 protected:
     /**
@@ -35,10 +37,15 @@ protected:
      */
     std::vector<BNT> coeffs;
 
+    /**
+     * Lagrange coefficients of recent sets of signers (owned by the verifier; nullptr if coefficients are not cached)
+     */
+    BlsLagrangeCoeffCache* coeffCache;
+
 public:
     BlsThresholdAccumulator(const std::vector<BlsPublicKey>& vks,
             NumSharesType reqSigners, NumSharesType totalSigners,
-            bool withShareVerification);
+            bool withShareVerification, BlsLagrangeCoeffCache* coeffCache = nullptr);
     virtual ~BlsThresholdAccumulator() {}
 
 // IThresholdAccumulator overloads.
@@ -64,6 +71,16 @@ public:
 
     void exponentiateLagrangeCoeff(); 
 
+    /**
+     * Same as above, but with coefficients that were computed by another accumulator with the same set of signers
+     * (used by BlsThresholdVerifier::combineAndVerify() to compute the coefficients once per set of signers).
+     */
+    void exponentiateLagrangeCoeff(const std::vector<BNT>& lagrangeCoeffs);
+
+    const std::vector<BNT>& getLagrangeCoeffs() const { return coeffs; }
+
+    const VectorOfShares& getSigners() const { return validSharesBits; }
+
     /**
      * NOTE: We are now using fast multi exponentiation which computes \sigma = \prod_i \sigma_i ^ \ell_i directly and faster than computing \sigma_i ^ \ell_i individually.
      * (Here \sigma denotes the threshold signature, \ell_i is the ith Lagrange coeff and \sigma_i is the ith signature share.)
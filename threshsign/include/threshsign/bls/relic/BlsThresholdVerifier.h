@@ -25,13 +25,18 @@
 namespace BLS {
 namespace Relic {
 
+class BlsLagrangeCoeffCache;
+
 class BlsThresholdVerifier : public IThresholdVerifier {
  protected:
   BlsPublicParameters params_;
   mutable BlsPublicKey publicKey_;
   std::vector<BlsPublicKey> publicKeysVector_;
   const G2T generator2_;
+  G2T negGenerator2_;  // -generator2_, computed once (see pairingsAreEqual())
   const NumSharesType reqSigners_ = 0, numSigners_ = 0;
+  // Lagrange coefficients of recent sets of signers, shared by the accumulators
+  std::shared_ptr<BlsLagrangeCoeffCache> coeffCache_;
 
  public:
   BlsThresholdVerifier(const BlsPublicParameters &params, const G2T &pk,
@@ -77,6 +82,32 @@ class BlsThresholdVerifier : public IThresholdVerifier {
     return params_.getSignatureSize();
   }
 
+  /**
+   * Uses BlsBatchVerifier: the shares are aggregated in a binary tree, and
+   * only the subtrees whose aggregated share fails to verify are searched, so
+   * a few bad shares cost O(log n) pairings each (instead of verifying all the
+   * n shares). The shares are multiplied by random weights before they are
+   * aggregated, so bad shares cannot cancel each other out.
+   */
+  void findInvalidShares(const char *msg,
+                         int msgLen,
+                         const char *const *sigShares,
+                         const int *sigShareLens,
+                         int numOfShares,
+                         std::vector<int> &outInvalidShares) override;
+
+  /**
+   * Computes the Lagrange coefficients once per distinct set of signers, and
+   * verifies all the signatures with one randomized pairing check (falling
+   * back to verifying them one by one if the check fails).
+   */
+  void combineAndVerify(IThresholdAccumulator *const *accs,
+                        const char *const *msgs,
+                        const int *msgLens,
+                        int num,
+                        char *const *outSigs,
+                        std::vector<bool> &outValid) override;
+
   const IPublicKey &getPublicKey() const override { return publicKey_; }
 
   const IShareVerificationKey &getShareVerificationKey(ShareID signer)
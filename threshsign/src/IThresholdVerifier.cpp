@@ -14,3 +14,39 @@
 #include "threshsign/Configuration.h"
 
 #include "threshsign/IThresholdVerifier.h"
+#include "threshsign/IThresholdAccumulator.h"
+
+void IThresholdVerifier::findInvalidShares(const char *msg,
+                                           int msgLen,
+                                           const char *const *sigShares,
+                                           const int *sigShareLens,
+                                           int numOfShares,
+                                           std::vector<int> &outInvalidShares) {
+  IThresholdAccumulator *acc = newAccumulator(true);
+  acc->setExpectedDigest(reinterpret_cast<const unsigned char *>(msg), msgLen);
+
+  int numOfValidShares = 0;
+  for (int i = 0; i < numOfShares; i++) {
+    const int prevNumOfValidShares = numOfValidShares;
+    numOfValidShares = acc->add(sigShares[i], sigShareLens[i]);
+    if (prevNumOfValidShares + 1 != numOfValidShares)
+      outInvalidShares.push_back(i);
+  }
+
+  release(acc);
+}
+
+void IThresholdVerifier::combineAndVerify(IThresholdAccumulator *const *accs,
+                                          const char *const *msgs,
+                                          const int *msgLens,
+                                          int num,
+                                          char *const *outSigs,
+                                          std::vector<bool> &outValid) {
+  const int sigLen = requiredLengthForSignedData();
+  outValid.assign(static_cast<size_t>(num), false);
+
+  for (int i = 0; i < num; i++) {
+    accs[i]->getFullSignedData(outSigs[i], sigLen);
+    outValid[i] = verify(msgs[i], msgLens[i], outSigs[i], sigLen);
+  }
+}
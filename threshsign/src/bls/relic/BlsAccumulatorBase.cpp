@@ -51,7 +51,9 @@ BlsAccumulatorBase::BlsAccumulatorBase(const std::vector<BlsPublicKey>& verifKey
 {
     assertEqual(vks.size(), static_cast<std::vector<BlsPublicKey>::size_type>(totalSigners + 1));
 
+    G2T gen2;
     g2_get_gen(gen2);	// NOTE: requires BLS::Relic::Library::Get() call above to be made
+    g2_neg(negGen2, gen2);
 }
 
 void BlsAccumulatorBase::onExpectedDigestSet() {
@@ -65,24 +67,11 @@ bool BlsAccumulatorBase::verifyShare(ShareID id, const G1T& sigShare) {
 	assertTrue(hasExpectedDigest());
 	assertInclusiveRange(1, id, totalSigners);
 
-    GTT e1, e2;
-
-	// Pair hash with PK
-	// FIXME: RELIC: This should not require non-const y
-	G2T& vk = const_cast<G2T&>(vks[static_cast<size_t>(id)].getPoint());
+	const G2T& vk = vks[static_cast<size_t>(id)].getPoint();
 	//logdbg << "Checking signature " << sigShare << " on hash " << hash << " against VK of signer " << id << " " << vk << endl;
-	pc_map(e1, hash, vk);
-
-	// Pair signature with group's generator
-	// FIXME: RELIC: This should not require non-const sigShare
-	pc_map(e2, const_cast<G1T&>(sigShare), gen2);
-
-	// Make sure the two pairings are equal
-	if (gt_cmp(e1, e2) != CMP_EQ) {
-		return false;
-	} else {
-		return true;
-	}
+
+	// Make sure e(hash, vk) == e(sigShare, gen2)
+	return pairingsAreEqual(hash, vk, sigShare, negGen2);
 }
 
 } /* namespace Relic */
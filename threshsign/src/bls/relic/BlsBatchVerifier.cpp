@@ -39,8 +39,21 @@ void BlsBatchVerifier::addShare(ShareID id, const G1T& sigShare) {
 	// MAYDO: We could start aggregating incrementally after a leaf is appended
 	// (powers of two + finish it off in batchVerify()). Make sure aggregate() still works incrementally.
 
+    // Each leaf holds (r * sigShare, r * vk) for a random non-zero 64-bit r. A single share verifies
+    // iff its weighted version does, but without the weights bad shares could be crafted so that
+    // their errors cancel out in an aggregated node (e.g., sig1 + D and sig2 - D), and then no
+    // subtree that contains both of them would fail (with the weights, this happens w.p. ~2^{-64}).
+    BNT r;
+    do {
+        r.Random(64);
+    } while(r == BNT(0));
+
+    G1T weightedSig = G1T::Times(sigShare, r);
+    G2T weightedVk = vk;
+    weightedVk.Times(r);
+
     // We just insert in the tree directly as a leaf
-    aggTree.appendLeaf(Share(id, sigShare, vk));
+    aggTree.appendLeaf(Share(id, weightedSig, weightedVk));
 }
 
 void BlsBatchVerifier::aggregateSigsAndVerifKeys() {
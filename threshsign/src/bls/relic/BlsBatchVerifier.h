@@ -273,8 +273,8 @@ protected:
     public:
         bool isAggregated;
         ShareID id; // for internal nodes, this is set to zero
-        G1T sig;    // possibly, the aggregated signature
-        G2T vk;     // possibly, the aggregated VK
+        G1T sig;    // the randomly weighted signature (possibly, aggregated)
+        G2T vk;     // the VK, with the same weight (possibly, aggregated)
 
     public:
         bool operator!=(const Share& s) {
@@ -0,0 +1,80 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0 License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#ifdef ERROR // TODO(GG): should be fixed by encapsulating relic (or windows) definitions in cpp files
+#undef ERROR
+#endif
+
+#include "threshsign/Configuration.h"
+
+#include "BlsLagrangeCoeffCache.h"
+#include "LagrangeInterpolation.h"
+
+#include "XAssert.h"
+
+namespace BLS {
+namespace Relic {
+
+BlsLagrangeCoeffCache::BlsLagrangeCoeffCache(size_t capacity, const BNT& fieldOrder)
+    : capacity(capacity), fieldOrder(fieldOrder), hits(0), misses(0)
+{
+    assertStrictlyPositive(capacity);
+}
+
+void BlsLagrangeCoeffCache::getCoeffs(const VectorOfShares& signers, std::vector<BNT>& lagrangeCoeffs) {
+    assertLessThanOrEqual(static_cast<size_t>(signers.last()), lagrangeCoeffs.size() - 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto it = entries.begin(); it != entries.end(); it++) {
+            if(it->first == signers) {
+                entries.splice(entries.begin(), entries, it);
+                const std::vector<BNT>& cached = it->second;
+                for(ShareID id = signers.first(); signers.isEnd(id) == false; id = signers.next(id)) {
+                    size_t i = static_cast<size_t>(id);
+                    lagrangeCoeffs[i] = cached[i];
+                }
+                hits++;
+                return;
+            }
+        }
+        misses++;
+    }
+
+    // Computed without holding the lock, so that other threads can use the cache meanwhile
+    // (if two threads miss on the same set, it is inserted twice, and the older copy is evicted eventually).
+    std::vector<BNT> coeffs(static_cast<size_t>(signers.last() + 1));
+    lagrangeCoeffAccumReduced(signers, coeffs, fieldOrder);
+    for(ShareID id = signers.first(); signers.isEnd(id) == false; id = signers.next(id)) {
+        size_t i = static_cast<size_t>(id);
+        lagrangeCoeffs[i] = coeffs[i];
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.emplace_front(signers, std::move(coeffs));
+    if(entries.size() > capacity) {
+        entries.pop_back();
+    }
+}
+
+uint64_t BlsLagrangeCoeffCache::getNumHits() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+uint64_t BlsLagrangeCoeffCache::getNumMisses() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+} /* namespace Relic */
+} /* namespace BLS */
@@ -0,0 +1,65 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0 License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#pragma once
+
+#include "threshsign/VectorOfShares.h"
+#include "threshsign/bls/relic/BlsNumTypes.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace BLS {
+namespace Relic {
+
+/**
+ * LRU cache of Lagrange coefficients, indexed by the set of signers.
+ * In steady state the same (fastest) signers contribute to most threshold signatures, so the
+ * coefficients are only recomputed when the set of signers changes.
+ *
+ * Thread-safe: one cache is shared by all the accumulators of a BlsThresholdVerifier.
+ * The cache is small, so entries are looked up linearly (comparing bit vectors is much cheaper than
+ * computing the coefficients).
+ */
+class BlsLagrangeCoeffCache {
+protected:
+    typedef std::pair<VectorOfShares, std::vector<BNT>> Entry;
+
+    const size_t capacity;
+    const BNT fieldOrder;
+
+    std::mutex mutex;
+    std::list<Entry> entries;   // most recently used first
+    uint64_t hits, misses;
+
+public:
+    BlsLagrangeCoeffCache(size_t capacity, const BNT& fieldOrder);
+
+public:
+    /**
+     * Sets lagrangeCoeffs[i] for each signer i in 'signers' (lagrangeCoeffs must have at least
+     * signers.last() + 1 elements). Computes the coefficients if they are not in the cache.
+     */
+    void getCoeffs(const VectorOfShares& signers, std::vector<BNT>& lagrangeCoeffs);
+
+    /**
+     * For benchmarks and tests.
+     */
+    uint64_t getNumHits();
+    uint64_t getNumMisses();
+};
+
+} /* namespace Relic */
+} /* namespace BLS */
@@ -276,6 +276,34 @@ const GTT& GTT::Zero() {
     return zero;
 }
 
+bool pairingsAreEqual(const G1T& p1, const G2T& q1, const G1T& p2, const G2T& negQ2) {
+    g1_t p[2];
+    g2_t q[2];
+    for(int i = 0; i < 2; i++) {
+        g1_null(p[i]);
+        g1_new(p[i]);
+        g2_null(q[i]);
+        g2_new(q[i]);
+    }
+
+    // FIXME: RELIC: g1_copy and g2_copy take non-const args
+    g1_copy(p[0], const_cast<G1T&>(p1));
+    g2_copy(q[0], const_cast<G2T&>(q1));
+    g1_copy(p[1], const_cast<G1T&>(p2));
+    g2_copy(q[1], const_cast<G2T&>(negQ2));
+
+    GTT e;
+    pc_map_sim(e, p, q, 2);
+    bool result = e.isUnity();
+
+    for(int i = 0; i < 2; i++) {
+        g1_free(p[i]);
+        g2_free(q[i]);
+    }
+
+    return result;
+}
+
 /**
  * std::ostream overload
  */
@@ -22,6 +22,7 @@
 #include "threshsign/bls/relic/FastMultExp.h"
 
 #include "BlsAlmostMultisigCoefficients.h"
+#include "BlsLagrangeCoeffCache.h"
 #include "LagrangeInterpolation.h"
 
 #include <vector>
@@ -34,18 +35,27 @@ namespace BLS {
 namespace Relic {
 
 BlsThresholdAccumulator::BlsThresholdAccumulator(const std::vector<BlsPublicKey>& vks,
-        NumSharesType reqSigners, NumSharesType totalSigners, bool withShareVerification)
-    : BlsAccumulatorBase(vks, reqSigners, totalSigners, withShareVerification)
+        NumSharesType reqSigners, NumSharesType totalSigners, bool withShareVerification,
+        BlsLagrangeCoeffCache* coeffCache)
+    : BlsAccumulatorBase(vks, reqSigners, totalSigners, withShareVerification), coeffCache(coeffCache)
 {
     coeffs.resize(static_cast<size_t>(totalSigners + 1));
     assertEqual(threshSig, G1T::Identity());
 }
 
 void BlsThresholdAccumulator::computeLagrangeCoeff() {
-    lagrangeCoeffAccumReduced(validSharesBits, coeffs, BLS::Relic::Library::Get().getG2Order());
+    if(coeffCache != nullptr) {
+        coeffCache->getCoeffs(validSharesBits, coeffs);
+    } else {
+        lagrangeCoeffAccumReduced(validSharesBits, coeffs, BLS::Relic::Library::Get().getG2Order());
+    }
 }
 
 void BlsThresholdAccumulator::exponentiateLagrangeCoeff() {
+    exponentiateLagrangeCoeff(coeffs);
+}
+
+void BlsThresholdAccumulator::exponentiateLagrangeCoeff(const std::vector<BNT>& lagrangeCoeffs) {
     // Raise shares[i] to the power of coeffs[i]
     //for(ShareID id = validSharesBits.first(); validSharesBits.isEnd(id) == false; id = validSharesBits.next(id)) {
     //    size_t i = static_cast<size_t>(id);
@@ -53,7 +63,7 @@ void BlsThresholdAccumulator::exponentiateLagrangeCoeff() {
     //}
 
     int maxBits = Library::Get().getG2OrderNumBits();
-    threshSig = fastMultExp<G1T>(validSharesBits, validShares, coeffs, maxBits);
+    threshSig = fastMultExp<G1T>(validSharesBits, validShares, lagrangeCoeffs, maxBits);
 }
 
 } /* namespace Relic */
@@ -20,11 +20,15 @@
 #include "threshsign/bls/relic/BlsThresholdAccumulator.h"
 #include "threshsign/bls/relic/BlsPublicKey.h"
 #include "threshsign/bls/relic/BlsPublicParameters.h"
+#include "threshsign/bls/relic/Library.h"
 
 #include "BlsAlmostMultisigAccumulator.h"
+#include "BlsBatchVerifier.h"
+#include "BlsLagrangeCoeffCache.h"
 
 #include <algorithm>
 #include <iterator>
+#include <map>
 
 #include "Log.h"
 #include "XAssert.h"
@@ -38,6 +42,9 @@ const string BlsThresholdVerifier::className_ = "BlsThresholdVerifier";
 const uint32_t BlsThresholdVerifier::classVersion_ = 1;
 bool BlsThresholdVerifier::registered_ = false;
 
+// Max number of sets of signers whose Lagrange coefficients are cached
+static const size_t kLagrangeCoeffCacheSize = 16;
+
 void BlsThresholdVerifier::registerClass() {
   if (!registered_) {
     classNameToObjectMap_[className_] =
@@ -52,7 +59,9 @@ BlsThresholdVerifier::BlsThresholdVerifier(
     : params_(params), publicKey_(pk),
       publicKeysVector_(verificationKeys.begin(), verificationKeys.end()),
       generator2_(params.getGenerator2()), reqSigners_(reqSigners),
-      numSigners_(numSigners) {
+      numSigners_(numSigners),
+      coeffCache_(make_shared<BlsLagrangeCoeffCache>(
+          kLagrangeCoeffCacheSize, Library::Get().getG2Order())) {
   assertEqual(verificationKeys.size(),
               static_cast<vector<BlsPublicKey>::size_type>(numSigners + 1));
   // verifKeys[0] was copied as well, but it's set to a dummy PK so it does not matter
@@ -60,6 +69,9 @@ BlsThresholdVerifier::BlsThresholdVerifier(
               static_cast<vector<BlsPublicKey>::size_type>(numSigners + 1));
   registerClass();
 
+  // FIXME: RELIC: g2_neg takes non-const args
+  g2_neg(negGenerator2_, const_cast<G2T &>(generator2_));
+
 #ifdef TRACE
   logtrace << "VKs (array has size " << vks.size() << ")" << endl;
   copy(vks.begin(), vks.end(), ostream_iterator<BlsPublicKey>(cout, "\n"));
@@ -77,7 +89,8 @@ IThresholdAccumulator *BlsThresholdVerifier::newAccumulator(
     return new BlsAlmostMultisigAccumulator(publicKeysVector_, numSigners_);
   } else {
     return new BlsThresholdAccumulator(publicKeysVector_, reqSigners_,
-                                       numSigners_, withShareVerification);
+                                       numSigners_, withShareVerification,
+                                       coeffCache_.get());
   }
 }
 
@@ -97,15 +110,123 @@ bool BlsThresholdVerifier::verify(const char *msg,
 bool BlsThresholdVerifier::verify(const G1T &msgHash,
                                   const G1T &sigShare,
                                   const G2T &pk) const {
-  // FIXME: RELIC: Dealing with library peculiarities here by using a const cast
-  // Pair hash with PK
-  GTT e1, e2;pc_map(e1, const_cast<G1T &>(msgHash), const_cast<G2T &>(pk));
+  // Make sure e(msgHash, pk) == e(sigShare, generator2_)
+  return pairingsAreEqual(msgHash, pk, sigShare, negGenerator2_);
+}
+
+void BlsThresholdVerifier::findInvalidShares(const char *msg,
+                                             int msgLen,
+                                             const char *const *sigShares,
+                                             const int *sigShareLens,
+                                             int numOfShares,
+                                             vector<int> &outInvalidShares) {
+  if (numOfShares <= 0) return;
+
+  G1T h;
+  g1_map(h, reinterpret_cast<const unsigned char *>(msg), msgLen);
+
+  // Index (in sigShares) of the share of each signer. As in the accumulators,
+  // only the first share of a signer is considered, and the other shares of
+  // the same signer are invalid.
+  map<ShareID, int> indexOfSigner;
+  BlsBatchVerifier batchVer(*this, numOfShares);
+  BlsSigshareParser parser;
+  for (int i = 0; i < numOfShares; i++) {
+    pair<ShareID, G1T> share = parser(sigShares[i], sigShareLens[i]);
+    if (share.first < 1 || share.first > numSigners_ ||
+        indexOfSigner.count(share.first) > 0) {
+      outInvalidShares.push_back(i);
+      continue;
+    }
+    indexOfSigner[share.first] = i;
+    batchVer.addShare(share.first, share.second);
+  }
+
+  if (!batchVer.empty()) {
+    vector<ShareID> badSigners;
+    batchVer.batchVerify(h, true, badSigners, true);
+    for (ShareID id : badSigners)
+      outInvalidShares.push_back(indexOfSigner[id]);
+  }
 
-  // Pair signature with group's generator
-  pc_map(e2, const_cast<G1T &>(sigShare), const_cast<G2T &>(generator2_));
+  sort(outInvalidShares.begin(), outInvalidShares.end());
+}
+
+void BlsThresholdVerifier::combineAndVerify(IThresholdAccumulator *const *accs,
+                                            const char *const *msgs,
+                                            const int *msgLens,
+                                            int num,
+                                            char *const *outSigs,
+                                            vector<bool> &outValid) {
+  const int sigLen = requiredLengthForSignedData();
+  outValid.assign(static_cast<size_t>(num), false);
+  if (num <= 0) return;
+
+  // Assemble the signatures. The Lagrange coefficients only depend on the set
+  // of signers, so they are computed once for each distinct set (in steady
+  // state, the same replicas sign most of the sequence numbers).
+  vector<G1T> sigs(static_cast<size_t>(num));
+  vector<BlsThresholdAccumulator *> firstOfSigners;
+  for (int i = 0; i < num; i++) {
+    BlsThresholdAccumulator *acc =
+        dynamic_cast<BlsThresholdAccumulator *>(accs[i]);
+    if (acc == nullptr) {
+      accs[i]->getFullSignedData(outSigs[i], sigLen);
+      sigs[i].fromBytes(reinterpret_cast<const unsigned char *>(outSigs[i]),
+                        sigLen);
+      continue;
+    }
+
+    BlsThresholdAccumulator *sameSigners = nullptr;
+    for (BlsThresholdAccumulator *other : firstOfSigners) {
+      if (other->getSigners() == acc->getSigners()) {
+        sameSigners = other;
+        break;
+      }
+    }
+
+    if (sameSigners == nullptr) {
+      acc->computeLagrangeCoeff();
+      acc->exponentiateLagrangeCoeff();
+      firstOfSigners.push_back(acc);
+    } else {
+      acc->exponentiateLagrangeCoeff(sameSigners->getLagrangeCoeffs());
+    }
+    acc->aggregateShares();
+    acc->sigToBytes(reinterpret_cast<unsigned char *>(outSigs[i]), sigLen);
+    sigs[i] = acc->getThresholdSignature();
+  }
+
+  vector<G1T> hashes(static_cast<size_t>(num));
+  for (int i = 0; i < num; i++)
+    g1_map(hashes[i], reinterpret_cast<const unsigned char *>(msgs[i]),
+           msgLens[i]);
+
+  if (num == 1) {
+    outValid[0] = verify(hashes[0], sigs[0], publicKey_.y);
+    return;
+  }
+
+  // Randomized batch verification: for random 64-bit r_i,
+  //   e(\sum_i r_i * H(m_i), PK) == e(\sum_i r_i * sig_i, g2)
+  // holds when some signature is invalid only with probability ~2^{-64}.
+  // This costs two pairings instead of two pairings per signature.
+  G1T hashesSum, sigsSum;
+  for (int i = 0; i < num; i++) {
+    BNT r;
+    r.Random(64);
+    hashesSum = G1T::Add(hashesSum, G1T::Times(hashes[i], r));
+    sigsSum = G1T::Add(sigsSum, G1T::Times(sigs[i], r));
+  }
+
+  if (verify(hashesSum, sigsSum, publicKey_.y)) {
+    outValid.assign(static_cast<size_t>(num), true);
+    return;
+  }
 
-  // Make sure the two pairings are equal
-  return (gt_cmp(e1, e2) == CMP_EQ);
+  // at least one of the signatures is invalid
+  for (int i = 0; i < num; i++)
+    outValid[i] = verify(hashes[i], sigs[i], publicKey_.y);
 }
 
 /************** Serialization **************/
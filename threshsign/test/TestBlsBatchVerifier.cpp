@@ -12,6 +12,8 @@
 
 #include "threshsign/Configuration.h"
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <set>
 #include <vector>
@@ -38,6 +40,13 @@ void batchVerifyHelper(BlsBatchVerifier& ver, int numBadShares, const G1T& msgPo
         const VectorOfShares& badSubset,
         const VectorOfShares& goodSubset, bool checkRoot);
 
+void findInvalidSharesHelper(BlsThresholdVerifier& verifier, std::vector<IThresholdSigner*>& signers,
+        const VectorOfShares& allSubset, const VectorOfShares& badSubset,
+        const char * msg, int msgLen);
+
+void combineAndVerifyHelper(BlsThresholdVerifier& verifier, std::vector<IThresholdSigner*>& signers,
+        int k, int n, bool withBadShare);
+
 void runBatchVerificationTest(int k, int n, int maxShares, int numBadShares = 0) {
     testAssertLessThanOrEqual(numBadShares, k);
     testAssertLessThanOrEqual(k, n);
@@ -100,6 +109,84 @@ void runBatchVerificationTest(int k, int n, int maxShares, int numBadShares = 0)
         batchVerifyHelper(batchVer, numBadShares, msgPoint, badSubset, goodSubset, false);
     }
 
+    findInvalidSharesHelper(*verifier, signers, allSubset, badSubset, msg, msgLen);
+    combineAndVerifyHelper(*verifier, signers, k, n, numBadShares > 0);
+
+    for(IThresholdSigner * signer : signers)
+        delete signer;
+    delete verifierTemp;
+}
+
+/**
+ * Two bad shares whose errors cancel out: share #bad1 is sig + D and share #bad2 is sig - D, so the
+ * unweighted sum of all the shares is the sum of the good shares.
+ */
+void runCancellingSharesTest(int k, int n, ShareID bad1, ShareID bad2) {
+    testAssertLessThanOrEqual(k, n);
+    testAssertTrue(bad1 != bad2 && bad1 <= k && bad2 <= k);
+
+    BlsPublicParameters params = PublicParametersFactory::getWhatever();
+    BlsThresholdFactory factory(params);
+    std::vector<IThresholdSigner*> signers(static_cast<size_t>(n + 1));
+    IThresholdVerifier* verifierTemp;
+
+    std::tie(signers, verifierTemp) = factory.newRandomSigners(k, n);
+    BlsThresholdVerifier * verifier = dynamic_cast<BlsThresholdVerifier*>(verifierTemp);
+
+    const char * msg = "some message";
+    int msgLen = static_cast<int>(strlen(msg));
+    const unsigned char * buf = reinterpret_cast<const unsigned char*>(msg);
+    G1T msgPoint;
+    g1_map(msgPoint, buf, msgLen);
+
+    G1T delta, negDelta;
+    delta.Random();
+    g1_neg(negDelta, delta);
+
+    std::vector<std::vector<char>> shareBufs;
+    G1T goodSum, badSum;
+    BlsBatchVerifier batchVer(*verifier, k);
+    for(ShareID id = 1; id <= k; id++) {
+        BlsThresholdSigner * signer = dynamic_cast<BlsThresholdSigner*>(signers[static_cast<size_t>(id)]);
+        G1T sig = signer->signData(buf, msgLen);
+        goodSum.Add(sig);
+
+        if(id == bad1) sig.Add(delta);
+        if(id == bad2) sig.Add(negDelta);
+        badSum.Add(sig);
+
+        batchVer.addShare(id, sig);
+
+        int len = signer->requiredLengthForSignedData();
+        std::vector<char> shareBuf(static_cast<size_t>(len));
+        memcpy(shareBuf.data(), &id, sizeof(ShareID));
+        sig.toBytes(reinterpret_cast<unsigned char*>(shareBuf.data()) + sizeof(ShareID),
+            len - static_cast<int>(sizeof(ShareID)));
+        shareBufs.push_back(shareBuf);
+    }
+
+    // without weights, the aggregated node above both bad shares would verify
+    testAssertTrue(goodSum == badSum);
+
+    std::vector<ShareID> badShares;
+    testAssertFalse(batchVer.batchVerify(msgPoint, true, badShares, true));
+    testAssertEqual(badShares.size(), 2u);
+    testAssertTrue(std::find(badShares.begin(), badShares.end(), bad1) != badShares.end());
+    testAssertTrue(std::find(badShares.begin(), badShares.end(), bad2) != badShares.end());
+
+    std::vector<const char*> shares;
+    std::vector<int> lens;
+    for(const std::vector<char>& shareBuf : shareBufs) {
+        shares.push_back(shareBuf.data());
+        lens.push_back(static_cast<int>(shareBuf.size()));
+    }
+
+    std::vector<int> invalidShares;
+    verifier->findInvalidShares(msg, msgLen, shares.data(), lens.data(), static_cast<int>(shares.size()), invalidShares);
+    testAssertEqual(invalidShares.size(), 2u);
+    testAssertEqual(invalidShares[0], std::min(bad1, bad2) - 1);
+    testAssertEqual(invalidShares[1], std::max(bad1, bad2) - 1);
+
     for(IThresholdSigner * signer : signers)
         delete signer;
     delete verifierTemp;
@@ -146,6 +233,108 @@ void batchVerifyHelper(BlsBatchVerifier& ver, int numBadShares, const G1T& msgPo
 
 }
 
+void findInvalidSharesHelper(BlsThresholdVerifier& verifier, std::vector<IThresholdSigner*>& signers,
+        const VectorOfShares& allSubset, const VectorOfShares& badSubset,
+        const char * msg, int msgLen) {
+    std::vector<std::vector<char>> shareBufs;
+    std::vector<ShareID> ids;
+
+    for(ShareID id = allSubset.first(); allSubset.isEnd(id) == false; id = allSubset.next(id)) {
+        IThresholdSigner * signer = signers[static_cast<size_t>(id)];
+        int len = signer->requiredLengthForSignedData();
+        std::vector<char> buf(static_cast<size_t>(len));
+        signer->signData(msg, msgLen, buf.data(), len);
+
+        if(badSubset.contains(id)) {
+            // Replace the signature by sig=sig*2, keeping the signer ID
+            std::pair<ShareID, G1T> share = BlsSigshareParser()(buf.data(), len);
+            share.second.Double();
+            share.second.toBytes(reinterpret_cast<unsigned char*>(buf.data()) + sizeof(ShareID),
+                len - static_cast<int>(sizeof(ShareID)));
+        }
+
+        shareBufs.push_back(buf);
+        ids.push_back(id);
+    }
+
+    std::vector<const char*> shares;
+    std::vector<int> lens;
+    for(const std::vector<char>& buf : shareBufs) {
+        shares.push_back(buf.data());
+        lens.push_back(static_cast<int>(buf.size()));
+    }
+
+    std::vector<int> invalidShares;
+    verifier.findInvalidShares(msg, msgLen, shares.data(), lens.data(), static_cast<int>(shares.size()), invalidShares);
+
+    testAssertEqual(invalidShares.size(), static_cast<std::vector<int>::size_type>(badSubset.count()));
+    for(int i : invalidShares) {
+        testAssertTrue(badSubset.contains(ids[static_cast<size_t>(i)]));
+    }
+}
+
+void combineAndVerifyHelper(BlsThresholdVerifier& verifier, std::vector<IThresholdSigner*>& signers,
+        int k, int n, bool withBadShare) {
+    const int numMsgs = 5;
+    std::vector<std::string> msgs;
+    for(int m = 0; m < numMsgs; m++) {
+        msgs.push_back("message #" + std::to_string(m));
+    }
+
+    std::vector<IThresholdAccumulator*> accs;
+    std::vector<const char*> msgPtrs;
+    std::vector<int> msgLens;
+    for(int m = 0; m < numMsgs; m++) {
+        const char * msg = msgs[static_cast<size_t>(m)].c_str();
+        int msgLen = static_cast<int>(msgs[static_cast<size_t>(m)].size());
+
+        // Even messages are signed by 1..k and odd messages by n-k+1..n, so the sets of signers repeat
+        ShareID first = (m % 2 == 0) ? 1 : n - k + 1;
+        IThresholdAccumulator * acc = verifier.newAccumulator(false);
+        for(ShareID id = first; id < first + k; id++) {
+            IThresholdSigner * signer = signers[static_cast<size_t>(id)];
+            int len = signer->requiredLengthForSignedData();
+            std::vector<char> buf(static_cast<size_t>(len));
+            signer->signData(msg, msgLen, buf.data(), len);
+
+            if(withBadShare && m == numMsgs - 1 && id == first) {
+                std::pair<ShareID, G1T> share = BlsSigshareParser()(buf.data(), len);
+                share.second.Double();
+                share.second.toBytes(reinterpret_cast<unsigned char*>(buf.data()) + sizeof(ShareID),
+                    len - static_cast<int>(sizeof(ShareID)));
+            }
+
+            acc->add(buf.data(), len);
+        }
+        acc->setExpectedDigest(reinterpret_cast<const unsigned char*>(msg), msgLen);
+
+        accs.push_back(acc);
+        msgPtrs.push_back(msg);
+        msgLens.push_back(msgLen);
+    }
+
+    int sigLen = verifier.requiredLengthForSignedData();
+    std::vector<std::vector<char>> sigBufs(numMsgs, std::vector<char>(static_cast<size_t>(sigLen)));
+    std::vector<char*> sigs;
+    for(std::vector<char>& buf : sigBufs) {
+        sigs.push_back(buf.data());
+    }
+
+    std::vector<bool> valid;
+    verifier.combineAndVerify(accs.data(), msgPtrs.data(), msgLens.data(), numMsgs, sigs.data(), valid);
+
+    testAssertEqual(valid.size(), static_cast<std::vector<bool>::size_type>(numMsgs));
+    for(int m = 0; m < numMsgs; m++) {
+        bool expected = !(withBadShare && m == numMsgs - 1);
+        testAssertTrue(valid[static_cast<size_t>(m)] == expected);
+        testAssertTrue(verifier.verify(msgPtrs[static_cast<size_t>(m)], msgLens[static_cast<size_t>(m)],
+            sigs[static_cast<size_t>(m)], sigLen) == expected);
+    }
+
+    for(IThresholdAccumulator * acc : accs)
+        verifier.release(acc);
+}
+
 int RelicAppMain(const Library& lib, const std::vector<std::string>& args) {
     (void)args;
     (void)lib;
@@ -161,6 +350,13 @@ int RelicAppMain(const Library& lib, const std::vector<std::string>& args) {
         }
     }
 
+    for(int k = 2; k < 17; k++) {
+        logdbg << "Testing the BLS batch verifier with cancelling bad shares and k = " << k << endl;
+        // siblings, and shares in different subtrees
+        runCancellingSharesTest(k, k + 2, 1, 2);
+        runCancellingSharesTest(k, k + 2, 1, k);
+    }
+
     return 0;
 }
 
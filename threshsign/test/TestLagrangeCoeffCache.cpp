@@ -0,0 +1,121 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0 License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#include "threshsign/Configuration.h"
+
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Log.h"
+#include "XAssert.h"
+#include "app/RelicMain.h"
+
+#include "threshsign/VectorOfShares.h"
+#include "threshsign/bls/relic/Library.h"
+
+#include "bls/relic/LagrangeInterpolation.h"
+#include "bls/relic/BlsLagrangeCoeffCache.h"
+
+using namespace std;
+using namespace BLS::Relic;
+
+/**
+ * Gets the coefficients of 'signers' from the cache and checks that they are equal to freshly
+ * computed ones, and that the coefficients of the other signers are not touched.
+ */
+void checkCoeffs(BlsLagrangeCoeffCache& cache, const VectorOfShares& signers, int numSigners,
+        const BNT& fieldOrder) {
+    const BNT untouched(12345);
+    std::vector<BNT> cachedCoeffs(static_cast<size_t>(numSigners + 1), untouched);
+    cache.getCoeffs(signers, cachedCoeffs);
+
+    std::vector<BNT> freshCoeffs(static_cast<size_t>(numSigners + 1), untouched);
+    lagrangeCoeffAccumReduced(signers, freshCoeffs, fieldOrder);
+
+    for(int i = 1; i <= numSigners; i++) {
+        size_t pos = static_cast<size_t>(i);
+        if(signers.contains(i) == false) {
+            testAssertEqual(cachedCoeffs[pos], untouched);
+            continue;
+        }
+        if(cachedCoeffs[pos] != freshCoeffs[pos]) {
+            logerror << "Mismatch for signer " << i << " of " << signers << endl;
+            logerror << "  cachedCoeffs[" << i << "] = " << cachedCoeffs[pos] << endl;
+            logerror << "  freshCoeffs[" << i << "] = " << freshCoeffs[pos] << endl;
+            throw std::runtime_error("Bad cached coeffs");
+        }
+    }
+}
+
+int RelicAppMain(const Library& lib, const std::vector<std::string>& args) {
+    (void)args;
+
+    const size_t capacity = 16;
+    const int numSets = 3 * static_cast<int>(capacity);
+    const int numSigners = 31;
+    const int reqSigners = 21;
+    const BNT& fieldOrder = lib.getG2Order();
+
+    // Distinct sets of signers (more than the cache holds)
+    std::vector<VectorOfShares> sets;
+    while(sets.size() < static_cast<size_t>(numSets)) {
+        VectorOfShares signers;
+        VectorOfShares::randomSubset(signers, numSigners, reqSigners);
+        bool isNew = true;
+        for(const VectorOfShares& s : sets) {
+            if(s == signers) {
+                isNew = false;
+                break;
+            }
+        }
+        if(isNew)
+            sets.push_back(signers);
+    }
+
+    BlsLagrangeCoeffCache cache(capacity, fieldOrder);
+
+    // First use of every set: all misses, and the oldest sets are evicted
+    for(const VectorOfShares& signers : sets)
+        checkCoeffs(cache, signers, numSigners, fieldOrder);
+    testAssertEqual(cache.getNumHits(), 0u);
+    testAssertEqual(cache.getNumMisses(), static_cast<uint64_t>(numSets));
+
+    // The last 'capacity' sets are cached (in any order)
+    for(int i = numSets - 1; i >= numSets - static_cast<int>(capacity); i--)
+        checkCoeffs(cache, sets[static_cast<size_t>(i)], numSigners, fieldOrder);
+    testAssertEqual(cache.getNumHits(), static_cast<uint64_t>(capacity));
+    testAssertEqual(cache.getNumMisses(), static_cast<uint64_t>(numSets));
+
+    // The first set was evicted: it is recomputed, and evicts the least recently used set
+    // (i.e., sets[numSets - 1], since the sets above were used from the last to the first)
+    checkCoeffs(cache, sets[0], numSigners, fieldOrder);
+    testAssertEqual(cache.getNumMisses(), static_cast<uint64_t>(numSets + 1));
+    checkCoeffs(cache, sets[0], numSigners, fieldOrder);
+    testAssertEqual(cache.getNumHits(), static_cast<uint64_t>(capacity + 1));
+    checkCoeffs(cache, sets[static_cast<size_t>(numSets - 1)], numSigners, fieldOrder);
+    testAssertEqual(cache.getNumMisses(), static_cast<uint64_t>(numSets + 2));
+
+    // Random accesses: a few hot sets and many cold ones
+    uint64_t numGets = 0;
+    for(int i = 0; i < 20 * numSets; i++) {
+        size_t s = static_cast<size_t>((rand() % 4 == 0) ? rand() % numSets : rand() % 4);
+        checkCoeffs(cache, sets[s], numSigners, fieldOrder);
+        numGets++;
+    }
+    testAssertEqual(cache.getNumHits() + cache.getNumMisses(),
+        static_cast<uint64_t>(numSets + capacity + 3) + numGets);
+    testAssertStrictlyPositive(cache.getNumHits());
+
+    return 0;
+}
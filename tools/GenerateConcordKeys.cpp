@@ -18,6 +18,7 @@
 #include <cryptopp/dll.h>
 
 #include "threshsign/ThresholdSignaturesTypes.h"
+#include "bftengine/Crypto.hpp"
 #include "KeyfileIOUtils.hpp"
 
 // Helper functions and static state to this executable's main function.
@@ -54,6 +55,18 @@ static std::pair<std::string, std::string> generateRsaKey() {
   return keyPair;
 }
 
+static std::pair<std::string, std::string> generateEdDSAKey() {
+
+  // Uses the Ed25519 key generation of corebft (see EdDSAKeysGenerator). Both
+  // keys are output as 32 bytes in hexadecimal (the private key is the secret
+  // seed).
+
+  std::pair<std::string, std::string> keyPair;
+  bftEngine::impl::EdDSAKeysGenerator::generateKeys(keyPair.second,
+                                                    keyPair.first);
+  return keyPair;
+}
+
 static bool parseUInt16(uint16_t& output,
                         const std::string& str,
                         uint16_t min,
@@ -88,8 +101,9 @@ static bool parseUInt16(uint16_t& output,
  * generates a new set of keys for a Concord deployment with given F and C
  * values and writes them to an output file. The output is formatted using
  * constructs from a subset of YAML to make it both human and machine readable.
- * The output includes an RSA key pair for each of the replicas for general
- * communication and non-threshold cryptographic purposes and the complete key
+ * The output includes an RSA or EdDSA key pair for each of the replicas for
+ * general communication and non-threshold cryptographic purposes (such as
+ * signing ViewChange messages) and the complete key
  * set for the four threshold cryptosystems used by Concord. All
  * per-replica keys are given in lists in which the order corresponds to the
  * replicas' order.
@@ -121,6 +135,8 @@ int main(int argc, char** argv) {
     "  --slow_commit_cryptosys SYSTEM_TYPE PARAMETER\n"
     "  --commit_cryptosys SYSTEM_TYPE PARAMETER\n"
     "  --opptimistic_commit_cryptosys SYSTEM_TYPE PARAMETER\n"
+    "and what signature scheme to use for the non-threshold replica keys:\n"
+    "  --replica_sig_scheme rsa|eddsa (default rsa)\n"
     "Currently, the following cryptosystem types are supported\n"
     "(and take the following as parameters):\n";
 
@@ -163,6 +179,7 @@ int main(int argc, char** argv) {
   std::string commitParam = "BN-P254";
   std::string optType = "multisig-bls";
   std::string optParam = "BN-P254";
+  bftEngine::SignatureScheme sigScheme = bftEngine::SignatureScheme::RSA;
   
   // Read input from the command line.
   // Note we ignore argv[0] because that just contains the command that was used
@@ -245,6 +262,23 @@ int main(int argc, char** argv) {
       optParam = argv[i + 2];
       i += 2;
 
+    } else if (option == "--replica_sig_scheme") {
+      if (i >= argc - 1) {
+        std::cout << "Expected an argument to --replica_sig_scheme.\n";
+        return -1;
+      }
+      std::string arg = argv[i + 1];
+      if (arg == "rsa") {
+        sigScheme = bftEngine::SignatureScheme::RSA;
+      } else if (arg == "eddsa") {
+        sigScheme = bftEngine::SignatureScheme::EdDSA;
+      } else {
+        std::cout << "Invalid value given for --replica_sig_scheme: " << arg
+          << " (expected rsa or eddsa).\n";
+        return -1;
+      }
+      ++i;
+
     } else {
       std::cout << "Unrecognized command line argument: " << option << "\n";
       return -1;
@@ -334,9 +368,10 @@ int main(int argc, char** argv) {
     }
   }
 
-  std::vector<std::pair<std::string, std::string>> rsaKeys;
+  std::vector<std::pair<std::string, std::string>> replicaKeys;
   for (uint16_t i = 0; i < n; ++i) {
-    rsaKeys.push_back(generateRsaKey());
+    replicaKeys.push_back((sigScheme == bftEngine::SignatureScheme::EdDSA)
+      ? generateEdDSAKey() : generateRsaKey());
   }
 
   Cryptosystem execSys(execType, execParam, n, execThresh);
@@ -353,8 +388,8 @@ int main(int argc, char** argv) {
 
   for (uint16_t i = 0; i < n; ++i) {
     if (!outputReplicaKeyfile(i, n, f, c, outputFiles[i],
-          outputPrefix + std::to_string(i), rsaKeys, execSys, slowSys,
-          commitSys, optSys)) {
+          outputPrefix + std::to_string(i), replicaKeys, sigScheme, execSys,
+          slowSys, commitSys, optSys)) {
       return -1;
     }
   }
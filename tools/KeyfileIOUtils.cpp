@@ -19,6 +19,16 @@
 
 #include "KeyfileIOUtils.hpp"
 
+// Names of the non-threshold signature schemes in keyfiles (the keys of a
+// scheme are given in <name>_public_keys and <name>_private_key).
+static std::string sigSchemeName(bftEngine::SignatureScheme scheme) {
+  return (scheme == bftEngine::SignatureScheme::EdDSA) ? "eddsa" : "rsa";
+}
+
+static std::string sigSchemeDisplayName(bftEngine::SignatureScheme scheme) {
+  return (scheme == bftEngine::SignatureScheme::EdDSA) ? "EdDSA" : "RSA";
+}
+
 // Helper function to outputReplicaKeyfile.
 static void serializeCryptosystemPublicConfiguration(std::ostream& output,
                                                      const Cryptosystem& system,
@@ -55,7 +65,8 @@ bool outputReplicaKeyfile(uint16_t replicaID,
                           std::ostream& output,
                           const std::string& outputFilename,
                           const std::vector<std::pair<std::string,
-                            std::string>>& rsaKeys,
+                            std::string>>& replicaKeys,
+                          bftEngine::SignatureScheme sigScheme,
                           const Cryptosystem& execSys,
                           const Cryptosystem& slowSys,
                           const Cryptosystem& commitSys,
@@ -75,10 +86,11 @@ bool outputReplicaKeyfile(uint16_t replicaID,
   output << "c_val: " << c << "\n";
   output << "replica_id: " << replicaID << "\n\n";
 
-  output << "# RSA non-threshold replica public keys\n";
-  output << "rsa_public_keys:\n";
+  output << "# " << sigSchemeDisplayName(sigScheme)
+    << " non-threshold replica public keys\n";
+  output << sigSchemeName(sigScheme) << "_public_keys:\n";
   for (uint16_t i = 0; i < numReplicas; ++i) {
-    output << "  - " << rsaKeys[i].second << "\n";
+    output << "  - " << replicaKeys[i].second << "\n";
   }
 
   serializeCryptosystemPublicConfiguration(output, execSys, "Execution",
@@ -92,7 +104,8 @@ bool outputReplicaKeyfile(uint16_t replicaID,
 
   output << "\n# Private keys for this replica\n";
 
-  output << "rsa_private_key: " << rsaKeys[replicaID].first << "\n";
+  output << sigSchemeName(sigScheme) << "_private_key: "
+    << replicaKeys[replicaID].first << "\n";
   output << "execution_cryptosystem_private_key: "
     << execSys.getPrivateKey(replicaID + 1) << "\n";
   output << "slow_commit_cryptosystem_private_key: "
@@ -192,6 +205,26 @@ static bool validateRSAPrivateKey (const std::string& key) {
   return std::regex_match(key, std::regex("[0-9A-Fa-f]+"));
 }
 
+// EdDSA (Ed25519) public and private keys are 32 bytes each.
+const size_t eddsaKeyHexadecimalLength = 64;
+
+static bool validateEdDSAKey (const std::string& key) {
+  return (key.length() == eddsaKeyHexadecimalLength)
+      && (std::regex_match(key, std::regex("[0-9A-Fa-f]+")));
+}
+
+static bool validatePublicKey (bftEngine::SignatureScheme scheme,
+                               const std::string& key) {
+  return (scheme == bftEngine::SignatureScheme::EdDSA)
+      ? validateEdDSAKey(key) : validateRSAPublicKey(key);
+}
+
+static bool validatePrivateKey (bftEngine::SignatureScheme scheme,
+                                const std::string& key) {
+  return (scheme == bftEngine::SignatureScheme::EdDSA)
+      ? validateEdDSAKey(key) : validateRSAPrivateKey(key);
+}
+
 // Checks that there are entries for all identifiers given in entries in the
 // variable map produced by parsing the keyfile, and prints errors if there
 // are not.
@@ -541,33 +574,49 @@ bool inputReplicaKeyfile(std::istream& input,
       " num_replicas], inclusive.\n";
   }
 
-  // Load RSA public keys
-  if (listAssignments.count("rsa_public_keys") < 1) {
-    if (identifierLines.count("rsa_public_keys") < 1) {
-      std::cout << filename << ": Missing assignment for required parameter:"
-        " rsa_public_keys.\n";
+  // Load non-threshold public keys; their signature scheme is determined by
+  // the name of the list (rsa_public_keys or eddsa_public_keys).
+  bftEngine::SignatureScheme sigScheme = bftEngine::SignatureScheme::RSA;
+  if (identifierLines.count("eddsa_public_keys") > 0) {
+    if (identifierLines.count("rsa_public_keys") > 0) {
+      std::cout << filename << ": line " << identifierLines["eddsa_public_keys"]
+        << ": only one of rsa_public_keys and eddsa_public_keys may be"
+        " given.\n";
+      return false;
+    }
+    sigScheme = bftEngine::SignatureScheme::EdDSA;
+  }
+  const std::string sigName = sigSchemeDisplayName(sigScheme);
+  const std::string publicKeysVar = sigSchemeName(sigScheme) + "_public_keys";
+  const std::string privateKeyVar = sigSchemeName(sigScheme) + "_private_key";
+
+  if (listAssignments.count(publicKeysVar) < 1) {
+    if (identifierLines.count(publicKeysVar) < 1) {
+      std::cout << filename << ": Missing assignment for required parameter: "
+        << publicKeysVar << ".\n";
     } else {
-      std::cout << filename << ": line " << identifierLines["rsa_public_keys"]
-        << ": expected list for rsa_public_keys, found single value.\n";
+      std::cout << filename << ": line " << identifierLines[publicKeysVar]
+        << ": expected list for " << publicKeysVar
+        << ", found single value.\n";
     }
     return false;
   }
 
-  std::vector<std::string> rsaPublicKeys
-    = std::move(listAssignments["rsa_public_keys"]);
-  listAssignments.erase("rsa_public_keys");
+  std::vector<std::string> replicaPublicKeys
+    = std::move(listAssignments[publicKeysVar]);
+  listAssignments.erase(publicKeysVar);
 
-  if (rsaPublicKeys.size() != numReplicas) {
-    std::cout << filename << ": line " << identifierLines["rsa_public_keys"]
-      << ": incorrect number of public RSA keys given; the number of RSA keys"
-      " must match num_replicas.\n";
+  if (replicaPublicKeys.size() != numReplicas) {
+    std::cout << filename << ": line " << identifierLines[publicKeysVar]
+      << ": incorrect number of public " << sigName << " keys given; the"
+      " number of " << sigName << " keys must match num_replicas.\n";
     return false;
   }
   for (size_t i = 0; i < numReplicas; ++i) {
-    if (!validateRSAPublicKey(rsaPublicKeys[i])) {
+    if (!validatePublicKey(sigScheme, replicaPublicKeys[i])) {
       std::cout << filename << ": line "
-        <<  listEntryLines["rsa_public_keys"][i]
-        << ": Invalid RSA public key.\n";
+        <<  listEntryLines[publicKeysVar][i]
+        << ": Invalid " << sigName << " public key.\n";
       return false;
     }
   }
@@ -605,7 +654,7 @@ bool inputReplicaKeyfile(std::istream& input,
   }
 
   // Load private keys for this replica.
-  if (!expectEntries({"rsa_private_key", "execution_cryptosystem_private_key",
+  if (!expectEntries({privateKeyVar, "execution_cryptosystem_private_key",
         "slow_commit_cryptosystem_private_key",
         "commit_cryptosystem_private_key",
         "optimistic_commit_cryptosystem_private_key"}, valueAssignments,
@@ -613,12 +662,12 @@ bool inputReplicaKeyfile(std::istream& input,
     return false;
   }
 
-  std::string rsaPrivateKey = valueAssignments["rsa_private_key"];
-  valueAssignments.erase("rsa_private_key");
+  std::string replicaPrivateKey = valueAssignments[privateKeyVar];
+  valueAssignments.erase(privateKeyVar);
 
-  if (!validateRSAPrivateKey(rsaPrivateKey)) {
-    std::cout << filename << ": line " << identifierLines["rsa_private_key"]
-      << ": Invalid RSA private key.\n";
+  if (!validatePrivateKey(sigScheme, replicaPrivateKey)) {
+    std::cout << filename << ": line " << identifierLines[privateKeyVar]
+      << ": Invalid " << sigName << " private key.\n";
     return false;
   }
 
@@ -690,9 +739,10 @@ bool inputReplicaKeyfile(std::istream& input,
   config.publicKeysOfReplicas.clear();
   for (uint16_t i = 0; i < numReplicas; ++i) {
     config.publicKeysOfReplicas.insert(std::pair<uint16_t, std::string>(i,
-      rsaPublicKeys[i]));
+      replicaPublicKeys[i]));
   }
-  config.replicaPrivateKey = rsaPrivateKey;
+  config.replicaPrivateKey = replicaPrivateKey;
+  config.replicaSignatureScheme = sigScheme;
 
   config.thresholdSignerForExecution = execSys->createThresholdSigner();
   config.thresholdSignerForSlowPathCommit = slowSys->createThresholdSigner();
@@ -37,11 +37,13 @@
  * @param output         Output stream to which to write this keyfile.
  * @param outputFilename Filename to which output corresponds; this may be used
  *                       in giving more descriptive error messages.
- * @param rsaKeys        RSA keys generated for this deployment. It is expected
- *                       that there is one pair of keys per replica, each
- *                       represented as a pair of strings in rsaKeys, ordered by
- *                       replicaID. The private key should be the first string
- *                       in each pair and the public key the second.
+ * @param replicaKeys    Non-threshold (RSA or EdDSA) keys generated for this
+ *                       deployment. It is expected that there is one pair of
+ *                       keys per replica, each represented as a pair of
+ *                       strings in replicaKeys, ordered by replicaID. The
+ *                       private key should be the first string in each pair
+ *                       and the public key the second.
+ * @param sigScheme      Signature scheme of replicaKeys.
  * @param execSys        Cryptosystem for consensus on execution results in this
  *                       deployment, with all keys already generated.
  * @param slowSys        Cryptosystem for consensus on transaction commit order
@@ -64,7 +66,8 @@ bool outputReplicaKeyfile(uint16_t replicaID,
                           std::ostream& output,
                           const std::string& outputFilename,
                           const std::vector<std::pair<std::string,
-                            std::string>>& rsaKeys,
+                            std::string>>& replicaKeys,
+                          bftEngine::SignatureScheme sigScheme,
                           const Cryptosystem& execSys,
                           const Cryptosystem& slowSys,
                           const Cryptosystem& commitSys,
@@ -75,7 +78,7 @@ bool outputReplicaKeyfile(uint16_t replicaID,
  * outputReplicaKeyfile above and initialize the relevant fields of a
  * bftEninge::ReplicaConfig with the information read. If successful, this
  * function will set the following fileds of the ReplicaConfig: fVAl, CVal,
- * replicaId, publicKeysOfReplicas, replicaPrivateKey,
+ * replicaId, publicKeysOfReplicas, replicaPrivateKey, replicaSignatureScheme,
  * thresholdSignerForExecution, thresholdVerifierForExecution,
  * thresholdSignerForSlowPathCommit, thresholdVerifierForSlowPathCommit,
  * thresholdSignerForCommit, thresholdVerifierForCommit,
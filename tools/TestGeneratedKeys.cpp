@@ -186,33 +186,49 @@ static bool validateConfigStructIntegrity(
   return true;
 }
 
-// Helper function to test RSA keys to test the compatibility of a single key
-// pair.
-static bool testRSAKeyPair(const std::string& privateKey,
-                           const std::string& publicKey,
-                           uint16_t replicaID) {
+static std::string sigSchemeName(bftEngine::SignatureScheme scheme) {
+  return (scheme == bftEngine::SignatureScheme::EdDSA) ? "EdDSA" : "RSA";
+}
+
+// Helper function to test non-threshold (RSA or EdDSA) keys to test the
+// compatibility of a single key pair.
+static bool testReplicaKeyPair(bftEngine::SignatureScheme scheme,
+                               const std::string& privateKey,
+                               const std::string& publicKey,
+                               uint16_t replicaID) {
 
   // The signer and verifier are stored with unique pointers rather than by
   // value so that they can be constructed in try/catch statements without
   // limiting their scope to those statements; declaring them by value is not
   // possible in this case becuause they lack paramter-less default
   // constructors.
-  std::unique_ptr<bftEngine::impl::RSASigner> signer;
-  std::unique_ptr<bftEngine::impl::RSAVerifier> verifier;
+  std::unique_ptr<bftEngine::impl::ISigner> signer;
+  std::unique_ptr<bftEngine::impl::IVerifier> verifier;
 
-  std::string invalidPrivateKey = "TestGeneratedKeys: FAILURE: Invalid RSA"
-    " private key for replica " + std::to_string(replicaID) + ".\n";
-  std::string invalidPublicKey = "TestGeneratedKeys: FAILURE: Invalid RSA"
-    " public key for replica " + std::to_string(replicaID) + ".\n";
+  const std::string sigName = sigSchemeName(scheme);
+  std::string invalidPrivateKey = "TestGeneratedKeys: FAILURE: Invalid "
+    + sigName + " private key for replica " + std::to_string(replicaID)
+    + ".\n";
+  std::string invalidPublicKey = "TestGeneratedKeys: FAILURE: Invalid "
+    + sigName + " public key for replica " + std::to_string(replicaID)
+    + ".\n";
 
   try {
-    signer.reset(new bftEngine::impl::RSASigner(privateKey.c_str()));
+    if (scheme == bftEngine::SignatureScheme::EdDSA) {
+      signer.reset(new bftEngine::impl::EdDSASigner(privateKey.c_str()));
+    } else {
+      signer.reset(new bftEngine::impl::RSASigner(privateKey.c_str()));
+    }
   } catch (std::exception e) {
     std::cout << invalidPrivateKey;
     return false;
   }
   try {
-    verifier.reset(new bftEngine::impl::RSAVerifier(publicKey.c_str()));
+    if (scheme == bftEngine::SignatureScheme::EdDSA) {
+      verifier.reset(new bftEngine::impl::EdDSAVerifier(publicKey.c_str()));
+    } else {
+      verifier.reset(new bftEngine::impl::RSAVerifier(publicKey.c_str()));
+    }
   } catch (std::exception e) {
     std::cout << invalidPublicKey;
     return false;
@@ -236,7 +252,7 @@ static bool testRSAKeyPair(const std::string& privateKey,
       if (!signer->sign(hash.c_str(), hash.length(), signatureBuf,
             signatureLength, returnedSignatureLength)) {
         std::cout << "TestGeneratedKeys: FAILURE: Failed to sign data with"
-          " replica " << replicaID << "'s RSA private key.\n";
+          " replica " << replicaID << "'s " << sigName << " private key.\n";
         delete[] signatureBuf;
         return false;
       }
@@ -250,8 +266,9 @@ static bool testRSAKeyPair(const std::string& privateKey,
       if (!verifier->verify(hash.c_str(), hash.length(), signatureBuf,
             returnedSignatureLength)) {
         std::cout << "TestGeneratedKeys: FAILURE: A signature with replica "
-          << replicaID << "'s RSA private key could not be verified with"
-          " replica " << replicaID << "'s RSA public key.\n";
+          << replicaID << "'s " << sigName << " private key could not be"
+          " verified with replica " << replicaID << "'s " << sigName
+          << " public key.\n";
         delete[] signatureBuf;
         return false;
       }
@@ -267,14 +284,27 @@ static bool testRSAKeyPair(const std::string& privateKey,
   return true;
 }
 
-// Test that the RSA key pairs given in the keyfiles work, that the keyfiles
-// agree on what the public keys are, and that there are no duplicates.
-static bool testRSAKeys(const std::vector<bftEngine::ReplicaConfig>& configs) {
+// Test that the non-threshold (RSA or EdDSA) key pairs given in the keyfiles
+// work, that the keyfiles agree on what the public keys and their signature
+// scheme are, and that there are no duplicates.
+static bool testReplicaKeys(
+    const std::vector<bftEngine::ReplicaConfig>& configs) {
   uint16_t numReplicas = configs.size();
+  const bftEngine::SignatureScheme scheme = configs[0].replicaSignatureScheme;
+  const std::string sigName = sigSchemeName(scheme);
+
+  for (uint16_t i = 0; i < numReplicas; ++i) {
+    if (configs[i].replicaSignatureScheme != scheme) {
+      std::cout << "TestGeneratedKeys: FAILURE: Replicas 0 and " << i
+        << " use different signature schemes.\n";
+      return false;
+    }
+  }
 
-  std::cout << "Testing " << numReplicas << " RSA key pairs...\n";
+  std::cout << "Testing " << numReplicas << " " << sigName
+    << " key pairs...\n";
   std::unordered_map<uint16_t, std::string> expectedPublicKeys;
-  std::unordered_set<std::string> rsaPublicKeysSeen;
+  std::unordered_set<std::string> publicKeysSeen;
 
   // Test that a signature produced with each replica's private key can be
   // verified with that replica's public key.
@@ -288,11 +318,11 @@ static bool testRSAKeys(const std::vector<bftEngine::ReplicaConfig>& configs) {
       }
     }
 
-    if(!testRSAKeyPair(privateKey, publicKey, i)) {
+    if(!testReplicaKeyPair(scheme, privateKey, publicKey, i)) {
       return false;
     }
 
-    if (rsaPublicKeysSeen.count(publicKey) > 0) {
+    if (publicKeysSeen.count(publicKey) > 0) {
       uint16_t existingKeyholder;
       for (auto publicKeyEntry: expectedPublicKeys) {
         if (publicKeyEntry.second == publicKey) {
@@ -300,40 +330,43 @@ static bool testRSAKeys(const std::vector<bftEngine::ReplicaConfig>& configs) {
         }
       }
       std::cout << "TestGeneratedKeys: FAILURE: Replicas " << existingKeyholder
-        << " and " << i << " share the same RSA public key.\n";
+        << " and " << i << " share the same " << sigName << " public key.\n";
       return false;
     }
     expectedPublicKeys[i] = publicKey;
 
     if (((i + 1) % kTestProgressReportingInterval) == 0) {
       std::cout << "Tested " << (i + 1) << " out of " << numReplicas
-        << " RSA key pairs...\n";
+        << " " << sigName << " key pairs...\n";
     }
   }
 
-  std::cout << "Verifying that all replicas agree on RSA public keys...\n";
+  std::cout << "Verifying that all replicas agree on " << sigName
+    << " public keys...\n";
 
-  // Verify that all replicas' keyfiles agree on the RSA public keys.
+  // Verify that all replicas' keyfiles agree on the public keys.
   for (uint16_t i = 0; i < numReplicas; ++i) {
     for (auto publicKeyEntry: configs[i].publicKeysOfReplicas) {
       if (publicKeyEntry.second != expectedPublicKeys[publicKeyEntry.first]) {
         std::cout << "TestGeneratedKeys: FAILURE: Replica " << i << " has an"
-          " incorrect RSA public key for replica " << publicKeyEntry.first
+          " incorrect " << sigName << " public key for replica "
+          << publicKeyEntry.first
           << ".\n";
         return false;
       }
     }
   }
 
-  std::cout << "All RSA key tests were successful.\n";
+  std::cout << "All " << sigName << " key tests were successful.\n";
 
   return true;
 }
 
 // Testing the threshold cryptosystem keys is not as straightforward as testing
-// the RSA keys because each signature may have multiple signers. Testing all
-// possible signer combinations, or even only all signer combinations that we
-// expect to produce a complete valid threshold signature, is not feasible
+// the non-threshold replica keys because each signature may have multiple
+// signers. Testing all possible signer combinations, or even only all signer
+// combinations that we expect to produce a complete valid threshold signature,
+// is not feasible
 // (unless the number of signers is rather small), as the number of possible
 // signer combinations grows combinatorially with the number of signers; this
 // can get even worth if we consider testing whether signer order makes a
@@ -948,7 +981,7 @@ int main(int argc, char** argv) {
   }
   std::cout << "Cryptographic configurations read appear to be sane.\n";
   std::cout << "Testing key functionality and agreement...\n";
-  if (!testRSAKeys(configs)) {
+  if (!testReplicaKeys(configs)) {
     freeConfigs(configs);
     return -1;
   }
@@ -30,6 +30,19 @@ if ! ./TestGeneratedKeys -n 4 -o test_keyfile_; then
   exit -1
 fi
 
+rm test_keyfile_*
+echo "Generating keys (with EdDSA replica keys) for a 4-replica cluster..."
+if ./GenerateConcordKeys -f 1 -n 4 -o test_keyfile_ \
+    --replica_sig_scheme eddsa; then
+  echo "Done. Testing the keys..."
+  if ! ./TestGeneratedKeys -n 4 -o test_keyfile_; then
+    echo "testKeyGeneration: FAILURE"
+    exit -1
+  fi
+else
+  echo "EdDSA is not supported by this build (skipped)."
+fi
+
 rm test_keyfile_*
 echo "Generating keys for a 6-replica cluster..."
 ./GenerateConcordKeys -f 1 -n 6 -o test_keyfile_
@@ -0,0 +1,62 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#ifndef CONCORD_BFT_ED25519_HPP
+#define CONCORD_BFT_ED25519_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace concordUtil {
+
+// Ed25519 signatures (RFC 8032), with batch verification.
+// Verification uses the cofactored equation [8][S]B = [8]R + [8][k]A, so a
+// batch is accepted iff each of its signatures is accepted by Verify.
+// Signing runs in constant time. All the functions are thread-safe.
+class Ed25519 {
+ public:
+  static const size_t kPrivateKeySize = 32;  // the secret seed
+  static const size_t kPublicKeySize = 32;
+  static const size_t kSignatureSize = 64;
+  static const size_t kBatchSeedSize = 32;
+
+  // writes the public key of privateKey (kPrivateKeySize random bytes)
+  static void DerivePublicKey(const uint8_t* privateKey, uint8_t* outPublicKey);
+
+  // writes kSignatureSize bytes to outSignature
+  static void Sign(const uint8_t* privateKey, const void* msg, size_t len,
+                   uint8_t* outSignature);
+
+  static bool Verify(const uint8_t* publicKey, const void* msg, size_t len,
+                     const uint8_t* signature);
+
+  struct SignedMessage {
+    const uint8_t* publicKey;
+    const void* msg;
+    size_t len;
+    const uint8_t* signature;
+  };
+
+  // returns true iff Verify accepts all the n messages (except with
+  // probability 2^-128). Checks a random linear combination of the n
+  // verification equations with a single multi-scalar multiplication, which
+  // is about twice as fast as n calls to Verify. The 128-bit coefficients are
+  // derived from the messages and from randomSeed (kBatchSeedSize random
+  // bytes, which should be unknown to the signers).
+  static bool VerifyBatch(size_t n, const SignedMessage* msgs,
+                          const uint8_t* randomSeed);
+};
+
+}  // namespace concordUtil
+
+#endif  // CONCORD_BFT_ED25519_HPP
@@ -0,0 +1,71 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#ifndef CONCORD_BFT_SHA256_HPP
+#define CONCORD_BFT_SHA256_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace concordUtil {
+
+// SHA-256 with a context that does not allocate memory, and with the fastest
+// implementation that the CPU supports (chosen at run time):
+// - kShaNi: the SHA extensions of x86 CPUs.
+// - kAvx2MultiBuffer: portable C++ for single messages, and AVX2 for batches
+//   (UpdateMany and ComputeMany hash 8 independent messages at once).
+// - kGeneric: portable C++.
+class Sha256 {
+ public:
+  static const size_t kDigestSize = 32;
+
+  enum Implementation { kGeneric, kShaNi, kAvx2MultiBuffer };
+
+  Sha256() { Reset(); }
+
+  void Reset();
+
+  void Update(const void* data, size_t len);
+
+  // writes kDigestSize bytes to outDigest (Reset() should be called before the
+  // object is used again)
+  void Finish(void* outDigest);
+
+  static void Compute(const void* data, size_t len, void* outDigest);
+
+  // the same as contexts[i]->Update(data[i], lengths[i]) for 0 <= i < n, but
+  // faster when the messages have similar lengths
+  static void UpdateMany(size_t n, Sha256* const* contexts,
+                         const void* const* data, const size_t* lengths);
+
+  // outDigests[i] = SHA-256 of (inputs[i], lengths[i]) for 0 <= i < n
+  static void ComputeMany(size_t n, const void* const* inputs,
+                          const size_t* lengths, void* const* outDigests);
+
+  static Implementation CurrentImplementation();
+  static const char* ImplementationName(Implementation impl);
+
+  // returns false (and changes nothing) if the CPU does not support impl.
+  // Should not be called while digests are computed by other threads.
+  static bool SetImplementation(Implementation impl);
+
+ private:
+  uint32_t state_[8];
+  uint64_t length_;  // number of bytes passed to Update
+  uint8_t buffer_[64];
+  size_t bufferLength_;
+};
+
+}  // namespace concordUtil
+
+#endif  // CONCORD_BFT_SHA256_HPP
@@ -0,0 +1,777 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#include "Ed25519.hpp"
+
+#include <string.h>
+
+#include <vector>
+
+namespace concordUtil {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// SHA-512 (FIPS 180-4)
+///////////////////////////////////////////////////////////////////////////////
+
+const uint64_t kSha512InitialState[8] = {
+    0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1, 0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+
+const uint64_t kSha512RoundConstants[80] = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f,
+    0xe9b5dba58189dbbc, 0x3956c25bf348b538, 0x59f111f1b605d019,
+    0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242,
+    0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+    0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3,
+    0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65, 0x2de92c6f592b0275,
+    0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f,
+    0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+    0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc,
+    0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6,
+    0x92722c851482353b, 0xa2bfe8a14cf10364, 0xa81a664bbc423001,
+    0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+    0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99,
+    0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb,
+    0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc,
+    0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915,
+    0xc67178f2e372532b, 0xca273eceea26619c, 0xd186b8c721c0c207,
+    0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba,
+    0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+    0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a,
+    0x5fcb6fab3ad6faec, 0x6c44198c4a475817};
+
+inline uint64_t LoadBigEndian64(const uint8_t* p) {
+  uint64_t x = 0;
+  for (int i = 0; i < 8; i++) x = (x << 8) | p[i];
+  return x;
+}
+
+inline void StoreBigEndian64(uint8_t* p, uint64_t x) {
+  for (int i = 7; i >= 0; i--) {
+    p[i] = static_cast<uint8_t>(x);
+    x >>= 8;
+  }
+}
+
+inline uint64_t LoadLittleEndian64(const uint8_t* p) {
+  uint64_t x = 0;
+  for (int i = 7; i >= 0; i--) x = (x << 8) | p[i];
+  return x;
+}
+
+inline void StoreLittleEndian64(uint8_t* p, uint64_t x) {
+  for (int i = 0; i < 8; i++) {
+    p[i] = static_cast<uint8_t>(x);
+    x >>= 8;
+  }
+}
+
+inline uint64_t Rotr64(uint64_t x, int n) { return (x >> n) | (x << (64 - n)); }
+
+class Sha512 {
+ public:
+  static const size_t kDigestSize = 64;
+
+  Sha512() : length_(0), bufferLength_(0) {
+    memcpy(state_, kSha512InitialState, sizeof(state_));
+  }
+
+  void Update(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    length_ += len;
+
+    if (bufferLength_ > 0) {
+      const size_t n = (len < 128 - bufferLength_) ? len : 128 - bufferLength_;
+      memcpy(buffer_ + bufferLength_, p, n);
+      bufferLength_ += n;
+      p += n;
+      len -= n;
+      if (bufferLength_ < 128) return;
+      Compress(buffer_);
+      bufferLength_ = 0;
+    }
+
+    for (; len >= 128; p += 128, len -= 128) Compress(p);
+
+    memcpy(buffer_, p, len);
+    bufferLength_ = len;
+  }
+
+  void Finish(uint8_t* outDigest) {
+    const uint64_t bitLength = length_ * 8;
+
+    buffer_[bufferLength_++] = 0x80;
+    if (bufferLength_ > 112) {
+      memset(buffer_ + bufferLength_, 0, 128 - bufferLength_);
+      Compress(buffer_);
+      bufferLength_ = 0;
+    }
+    // the high 64 bits of the 128-bit length are 0
+    memset(buffer_ + bufferLength_, 0, 120 - bufferLength_);
+    StoreBigEndian64(buffer_ + 120, bitLength);
+    Compress(buffer_);
+
+    for (int i = 0; i < 8; i++) StoreBigEndian64(outDigest + 8 * i, state_[i]);
+  }
+
+ private:
+  void Compress(const uint8_t* block) {
+    uint64_t w[80];
+    for (int i = 0; i < 16; i++) w[i] = LoadBigEndian64(block + 8 * i);
+    for (int i = 16; i < 80; i++) {
+      const uint64_t s0 =
+          Rotr64(w[i - 15], 1) ^ Rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+      const uint64_t s1 =
+          Rotr64(w[i - 2], 19) ^ Rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint64_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 80; i++) {
+      const uint64_t s1 = Rotr64(e, 14) ^ Rotr64(e, 18) ^ Rotr64(e, 41);
+      const uint64_t ch = (e & f) ^ (~e & g);
+      const uint64_t t1 = h + s1 + ch + kSha512RoundConstants[i] + w[i];
+      const uint64_t s0 = Rotr64(a, 28) ^ Rotr64(a, 34) ^ Rotr64(a, 39);
+      const uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+      const uint64_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+  }
+
+  uint64_t state_[8];
+  uint64_t length_;  // number of bytes passed to Update
+  uint8_t buffer_[128];
+  size_t bufferLength_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// The field GF(2^255 - 19): 5 limbs of 51 bits
+///////////////////////////////////////////////////////////////////////////////
+
+typedef unsigned __int128 uint128;
+
+const uint64_t kMask51 = (1ULL << 51) - 1;
+
+struct Fe {
+  uint64_t v[5];
+};
+
+inline Fe FeFromInt(uint64_t x) {
+  Fe h = {{x, 0, 0, 0, 0}};
+  return h;
+}
+
+// each limb < 2^51 (except v[0], which may exceed it by a small multiple of 19)
+inline void FeCarry(Fe& h) {
+  uint64_t c;
+  c = h.v[0] >> 51;
+  h.v[0] &= kMask51;
+  h.v[1] += c;
+  c = h.v[1] >> 51;
+  h.v[1] &= kMask51;
+  h.v[2] += c;
+  c = h.v[2] >> 51;
+  h.v[2] &= kMask51;
+  h.v[3] += c;
+  c = h.v[3] >> 51;
+  h.v[3] &= kMask51;
+  h.v[4] += c;
+  c = h.v[4] >> 51;
+  h.v[4] &= kMask51;
+  h.v[0] += 19 * c;
+}
+
+inline Fe FeAdd(const Fe& f, const Fe& g) {
+  Fe h;
+  for (int i = 0; i < 5; i++) h.v[i] = f.v[i] + g.v[i];
+  FeCarry(h);
+  return h;
+}
+
+// f + 2p - g (the limbs of g are at most the limbs of 2p)
+inline Fe FeSub(const Fe& f, const Fe& g) {
+  Fe h;
+  h.v[0] = f.v[0] + 0xFFFFFFFFFFFDAULL - g.v[0];
+  for (int i = 1; i < 5; i++) h.v[i] = f.v[i] + 0xFFFFFFFFFFFFEULL - g.v[i];
+  FeCarry(h);
+  return h;
+}
+
+inline Fe FeNeg(const Fe& f) { return FeSub(FeFromInt(0), f); }
+
+Fe FeMul(const Fe& f, const Fe& g) {
+  const uint64_t f0 = f.v[0], f1 = f.v[1], f2 = f.v[2], f3 = f.v[3],
+                 f4 = f.v[4];
+  const uint64_t g0 = g.v[0], g1 = g.v[1], g2 = g.v[2], g3 = g.v[3],
+                 g4 = g.v[4];
+  const uint64_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3,
+                 g4_19 = 19 * g4;
+
+  uint128 r0 = (uint128)f0 * g0 + (uint128)f1 * g4_19 + (uint128)f2 * g3_19 +
+               (uint128)f3 * g2_19 + (uint128)f4 * g1_19;
+  uint128 r1 = (uint128)f0 * g1 + (uint128)f1 * g0 + (uint128)f2 * g4_19 +
+               (uint128)f3 * g3_19 + (uint128)f4 * g2_19;
+  uint128 r2 = (uint128)f0 * g2 + (uint128)f1 * g1 + (uint128)f2 * g0 +
+               (uint128)f3 * g4_19 + (uint128)f4 * g3_19;
+  uint128 r3 = (uint128)f0 * g3 + (uint128)f1 * g2 + (uint128)f2 * g1 +
+               (uint128)f3 * g0 + (uint128)f4 * g4_19;
+  uint128 r4 = (uint128)f0 * g4 + (uint128)f1 * g3 + (uint128)f2 * g2 +
+               (uint128)f3 * g1 + (uint128)f4 * g0;
+
+  Fe h;
+  uint64_t c;
+  c = (uint64_t)(r0 >> 51);
+  h.v[0] = (uint64_t)r0 & kMask51;
+  r1 += c;
+  c = (uint64_t)(r1 >> 51);
+  h.v[1] = (uint64_t)r1 & kMask51;
+  r2 += c;
+  c = (uint64_t)(r2 >> 51);
+  h.v[2] = (uint64_t)r2 & kMask51;
+  r3 += c;
+  c = (uint64_t)(r3 >> 51);
+  h.v[3] = (uint64_t)r3 & kMask51;
+  r4 += c;
+  c = (uint64_t)(r4 >> 51);
+  h.v[4] = (uint64_t)r4 & kMask51;
+  h.v[0] += 19 * c;
+  c = h.v[0] >> 51;
+  h.v[0] &= kMask51;
+  h.v[1] += c;
+  return h;
+}
+
+inline Fe FeSq(const Fe& f) { return FeMul(f, f); }
+
+inline Fe FeSqTimes(Fe f, int n) {
+  for (int i = 0; i < n; i++) f = FeSq(f);
+  return f;
+}
+
+// z^(2^250 - 1), and z^11 in outZ11
+Fe FePow2250Minus1(const Fe& z, Fe& outZ11) {
+  const Fe z2 = FeSq(z);
+  const Fe z9 = FeMul(FeSqTimes(z2, 2), z);
+  outZ11 = FeMul(z9, z2);
+  const Fe z_5_0 = FeMul(FeSq(outZ11), z9);                  // 2^5 - 1
+  const Fe z_10_0 = FeMul(FeSqTimes(z_5_0, 5), z_5_0);       // 2^10 - 1
+  const Fe z_20_0 = FeMul(FeSqTimes(z_10_0, 10), z_10_0);    // 2^20 - 1
+  const Fe z_40_0 = FeMul(FeSqTimes(z_20_0, 20), z_20_0);    // 2^40 - 1
+  const Fe z_50_0 = FeMul(FeSqTimes(z_40_0, 10), z_10_0);    // 2^50 - 1
+  const Fe z_100_0 = FeMul(FeSqTimes(z_50_0, 50), z_50_0);   // 2^100 - 1
+  const Fe z_200_0 = FeMul(FeSqTimes(z_100_0, 100), z_100_0);  // 2^200 - 1
+  return FeMul(FeSqTimes(z_200_0, 50), z_50_0);              // 2^250 - 1
+}
+
+// z^(p - 2) = z^(2^255 - 21)
+Fe FeInvert(const Fe& z) {
+  Fe z11;
+  const Fe t = FePow2250Minus1(z, z11);
+  return FeMul(FeSqTimes(t, 5), z11);
+}
+
+// z^((p - 5) / 8) = z^(2^252 - 3)
+Fe FePow22523(const Fe& z) {
+  Fe z11;
+  const Fe t = FePow2250Minus1(z, z11);
+  return FeMul(FeSqTimes(t, 2), z);
+}
+
+// ignores the most significant bit
+Fe FeFromBytes(const uint8_t* s) {
+  const uint64_t w0 = LoadLittleEndian64(s);
+  const uint64_t w1 = LoadLittleEndian64(s + 8);
+  const uint64_t w2 = LoadLittleEndian64(s + 16);
+  const uint64_t w3 = LoadLittleEndian64(s + 24);
+  Fe h;
+  h.v[0] = w0 & kMask51;
+  h.v[1] = ((w0 >> 51) | (w1 << 13)) & kMask51;
+  h.v[2] = ((w1 >> 38) | (w2 << 26)) & kMask51;
+  h.v[3] = ((w2 >> 25) | (w3 << 39)) & kMask51;
+  h.v[4] = (w3 >> 12) & kMask51;
+  return h;
+}
+
+// the canonical encoding (in [0, p))
+void FeToBytes(uint8_t* s, const Fe& f) {
+  Fe t = f;
+  FeCarry(t);
+  FeCarry(t);
+
+  // q = 1 iff t >= p
+  uint64_t q = (t.v[0] + 19) >> 51;
+  q = (t.v[1] + q) >> 51;
+  q = (t.v[2] + q) >> 51;
+  q = (t.v[3] + q) >> 51;
+  q = (t.v[4] + q) >> 51;
+
+  t.v[0] += 19 * q;
+  for (int i = 0; i < 4; i++) {
+    t.v[i + 1] += t.v[i] >> 51;
+    t.v[i] &= kMask51;
+  }
+  t.v[4] &= kMask51;
+
+  StoreLittleEndian64(s, t.v[0] | (t.v[1] << 51));
+  StoreLittleEndian64(s + 8, (t.v[1] >> 13) | (t.v[2] << 38));
+  StoreLittleEndian64(s + 16, (t.v[2] >> 26) | (t.v[3] << 25));
+  StoreLittleEndian64(s + 24, (t.v[3] >> 39) | (t.v[4] << 12));
+}
+
+bool FeIsZero(const Fe& f) {
+  uint8_t s[32];
+  FeToBytes(s, f);
+  uint8_t x = 0;
+  for (int i = 0; i < 32; i++) x |= s[i];
+  return x == 0;
+}
+
+bool FeEqual(const Fe& f, const Fe& g) { return FeIsZero(FeSub(f, g)); }
+
+bool FeIsNegative(const Fe& f) {
+  uint8_t s[32];
+  FeToBytes(s, f);
+  return (s[0] & 1) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Points of the curve -x^2 + y^2 = 1 + d x^2 y^2
+///////////////////////////////////////////////////////////////////////////////
+
+// extended coordinates: x = X/Z, y = Y/Z, x*y = T/Z
+struct Point {
+  Fe x, y, z, t;
+};
+
+// a point prepared for additions: (Y + X, Y - X, Z, 2d*T)
+struct CachedPoint {
+  Fe yPlusX, yMinusX, z, t2d;
+};
+
+const size_t kBaseTableRows = 64;  // a row for each 4 bits of a scalar
+
+struct Constants {
+  Constants();
+
+  Fe d;
+  Fe d2;
+  Fe sqrtM1;  // sqrt(-1)
+  Point base;
+
+  // baseTable[i][j] = j * 16^i * base
+  CachedPoint baseTable[kBaseTableRows][16];
+};
+
+const Constants& GetConstants() {
+  static const Constants constants;  // initialized once (thread-safe)
+  return constants;
+}
+
+Point Identity() {
+  Point p = {FeFromInt(0), FeFromInt(1), FeFromInt(1), FeFromInt(0)};
+  return p;
+}
+
+CachedPoint ToCached(const Point& p, const Fe& d2) {
+  CachedPoint c = {FeAdd(p.y, p.x), FeSub(p.y, p.x), p.z, FeMul(p.t, d2)};
+  return c;
+}
+
+// RFC 8032, section 5.1.4 (complete for all the points)
+Point Add(const Point& p, const CachedPoint& q) {
+  const Fe a = FeMul(FeSub(p.y, p.x), q.yMinusX);
+  const Fe b = FeMul(FeAdd(p.y, p.x), q.yPlusX);
+  const Fe c = FeMul(p.t, q.t2d);
+  const Fe zz = FeMul(p.z, q.z);
+  const Fe d = FeAdd(zz, zz);
+  const Fe e = FeSub(b, a);
+  const Fe f = FeSub(d, c);
+  const Fe g = FeAdd(d, c);
+  const Fe h = FeAdd(b, a);
+  Point r = {FeMul(e, f), FeMul(g, h), FeMul(f, g), FeMul(e, h)};
+  return r;
+}
+
+Point Double(const Point& p) {
+  const Fe a = FeSq(p.x);
+  const Fe b = FeSq(p.y);
+  const Fe zz = FeSq(p.z);
+  const Fe c = FeAdd(zz, zz);
+  const Fe h = FeAdd(a, b);
+  const Fe e = FeSub(h, FeSq(FeAdd(p.x, p.y)));
+  const Fe g = FeSub(a, b);
+  const Fe f = FeAdd(c, g);
+  Point r = {FeMul(e, f), FeMul(g, h), FeMul(f, g), FeMul(e, h)};
+  return r;
+}
+
+Point Negate(const Point& p) {
+  Point r = {FeNeg(p.x), p.y, p.z, FeNeg(p.t)};
+  return r;
+}
+
+bool IsIdentity(const Point& p) { return FeIsZero(p.x) && FeEqual(p.y, p.z); }
+
+void Encode(uint8_t* s, const Point& p) {
+  const Fe zInv = FeInvert(p.z);
+  const Fe x = FeMul(p.x, zInv);
+  const Fe y = FeMul(p.y, zInv);
+  FeToBytes(s, y);
+  if (FeIsNegative(x)) s[31] |= 0x80;
+}
+
+// RFC 8032, section 5.1.3 (non-canonical encodings are rejected)
+bool Decode(const uint8_t* s, const Constants& k, Point& outPoint) {
+  const Fe y = FeFromBytes(s);
+  uint8_t canonical[32];
+  FeToBytes(canonical, y);
+  canonical[31] |= (s[31] & 0x80);
+  if (memcmp(canonical, s, 32) != 0) return false;
+
+  const Fe one = FeFromInt(1);
+  const Fe y2 = FeSq(y);
+  const Fe u = FeSub(y2, one);
+  const Fe v = FeAdd(FeMul(k.d, y2), one);
+  const Fe v3 = FeMul(FeSq(v), v);
+  const Fe v7 = FeMul(FeSq(v3), v);
+  Fe x = FeMul(FeMul(u, v3), FePow22523(FeMul(u, v7)));
+
+  const Fe vx2 = FeMul(v, FeSq(x));
+  if (!FeEqual(vx2, u)) {
+    if (!FeEqual(vx2, FeNeg(u))) return false;
+    x = FeMul(x, k.sqrtM1);
+  }
+
+  const bool xIsNegative = (s[31] & 0x80) != 0;
+  if (xIsNegative && FeIsZero(x)) return false;
+  if (FeIsNegative(x) != xIsNegative) x = FeNeg(x);
+
+  outPoint.x = x;
+  outPoint.y = y;
+  outPoint.z = one;
+  outPoint.t = FeMul(x, y);
+  return true;
+}
+
+Constants::Constants() {
+  d = FeMul(FeNeg(FeFromInt(121665)), FeInvert(FeFromInt(121666)));
+  d2 = FeAdd(d, d);
+
+  // 2^((p - 1) / 4), where (p - 1) / 4 = 2 * (2^252 - 3) + 1
+  const Fe two = FeFromInt(2);
+  sqrtM1 = FeMul(FeSq(FePow22523(two)), two);
+
+  // the point with y = 4/5 and a positive x
+  uint8_t encodedBase[32];
+  memset(encodedBase, 0x66, sizeof(encodedBase));
+  encodedBase[0] = 0x58;
+  Decode(encodedBase, *this, base);
+
+  Point row = base;  // 16^i * base
+  for (size_t i = 0; i < kBaseTableRows; i++) {
+    const CachedPoint rowCached = ToCached(row, d2);
+    Point multiple = Identity();
+    baseTable[i][0] = ToCached(multiple, d2);
+    for (int j = 1; j < 16; j++) {
+      multiple = Add(multiple, rowCached);
+      baseTable[i][j] = ToCached(multiple, d2);
+    }
+    for (int j = 0; j < 4; j++) row = Double(row);
+  }
+}
+
+inline uint32_t NibbleOf(const uint8_t* scalar, size_t i) {
+  return (scalar[i / 2] >> (4 * (i & 1))) & 15;
+}
+
+// constant-time table[index]
+CachedPoint Select(const CachedPoint* table, uint32_t index) {
+  CachedPoint r = table[0];
+  for (uint64_t j = 1; j < 16; j++) {
+    const uint64_t mask = 0 - (((j ^ index) - 1) >> 63);  // j == index
+    const uint64_t* src = reinterpret_cast<const uint64_t*>(&table[j]);
+    uint64_t* dst = reinterpret_cast<uint64_t*>(&r);
+    for (size_t l = 0; l < sizeof(CachedPoint) / sizeof(uint64_t); l++)
+      dst[l] ^= mask & (dst[l] ^ src[l]);
+  }
+  return r;
+}
+
+// scalar * base, in constant time (scalar is 32 bytes)
+Point ScalarMultBase(const uint8_t* scalar, const Constants& k) {
+  Point r = Identity();
+  for (size_t i = 0; i < kBaseTableRows; i++)
+    r = Add(r, Select(k.baseTable[i], NibbleOf(scalar, i)));
+  return r;
+}
+
+// a point with its multiples by 0..15, and its scalar (32 bytes)
+struct MultiScalarTerm {
+  CachedPoint multiples[16];
+  uint8_t scalar[32];
+};
+
+void InitTerm(MultiScalarTerm& term, const Point& p, const Constants& k) {
+  const CachedPoint cached = ToCached(p, k.d2);
+  Point multiple = Identity();
+  term.multiples[0] = ToCached(multiple, k.d2);
+  term.multiples[1] = cached;
+  multiple = p;
+  for (int j = 2; j < 16; j++) {
+    multiple = Add(multiple, cached);
+    term.multiples[j] = ToCached(multiple, k.d2);
+  }
+}
+
+// sum of terms[i].scalar * terms[i].point (Straus: the doublings are shared by
+// all the terms, in windows of 4 bits). Not constant time.
+Point MultiScalarMult(const std::vector<MultiScalarTerm>& terms) {
+  Point r = Identity();
+  for (size_t w = kBaseTableRows; w-- > 0;) {
+    if (w + 1 < kBaseTableRows)
+      for (int j = 0; j < 4; j++) r = Double(r);
+    for (const MultiScalarTerm& term : terms) {
+      const uint32_t nibble = NibbleOf(term.scalar, w);
+      if (nibble != 0) r = Add(r, term.multiples[nibble]);
+    }
+  }
+  return r;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scalars modulo L = 2^252 + 27742317777372353535851937790883648493
+///////////////////////////////////////////////////////////////////////////////
+
+const int64_t kL[32] = {0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58,
+                        0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+                        0,    0,    0,    0,    0,    0,    0,    0,
+                        0,    0,    0,    0,    0,    0,    0,    0x10};
+
+// out = x mod L, where x is 64 limbs of (about) 8 bits
+void ScReduceLimbs(int64_t* x, uint8_t* out) {
+  for (int i = 63; i >= 32; i--) {
+    int64_t carry = 0;
+    int j;
+    for (j = i - 32; j < i - 12; j++) {
+      x[j] += carry - 16 * x[i] * kL[j - (i - 32)];
+      carry = (x[j] + 128) >> 8;
+      x[j] -= carry * 256;
+    }
+    x[j] += carry;
+    x[i] = 0;
+  }
+
+  int64_t carry = 0;
+  for (int j = 0; j < 32; j++) {
+    x[j] += carry - (x[31] >> 4) * kL[j];
+    carry = x[j] >> 8;
+    x[j] &= 255;
+  }
+  for (int j = 0; j < 32; j++) x[j] -= carry * kL[j];
+  for (int i = 0; i < 32; i++) {
+    x[i + 1] += x[i] >> 8;
+    out[i] = static_cast<uint8_t>(x[i] & 255);
+  }
+}
+
+// out = s mod L (s is 64 bytes)
+void ScReduce(const uint8_t* s, uint8_t* out) {
+  int64_t x[64];
+  for (int i = 0; i < 64; i++) x[i] = s[i];
+  ScReduceLimbs(x, out);
+}
+
+// out = (a * b + c) mod L (a, b and c are 32 bytes)
+void ScMulAdd(const uint8_t* a, const uint8_t* b, const uint8_t* c,
+              uint8_t* out) {
+  int64_t x[64] = {0};
+  for (int i = 0; i < 32; i++) x[i] = c[i];
+  for (int i = 0; i < 32; i++)
+    for (int j = 0; j < 32; j++) x[i + j] += (int64_t)a[i] * b[j];
+  ScReduceLimbs(x, out);
+}
+
+// s < L
+bool ScIsCanonical(const uint8_t* s) {
+  for (int i = 31; i >= 0; i--) {
+    if (s[i] < kL[i]) return true;
+    if (s[i] > kL[i]) return false;
+  }
+  return false;
+}
+
+// k = SHA-512(R || A || msg) mod L
+void ChallengeOf(const uint8_t* r, const uint8_t* publicKey, const void* msg,
+                 size_t len, uint8_t* outK) {
+  uint8_t h[Sha512::kDigestSize];
+  Sha512 sha;
+  sha.Update(r, 32);
+  sha.Update(publicKey, Ed25519::kPublicKeySize);
+  sha.Update(msg, len);
+  sha.Finish(h);
+  ScReduce(h, outK);
+}
+
+// the secret scalar, and the prefix of the nonces (RFC 8032, section 5.1.5)
+void ExpandPrivateKey(const uint8_t* privateKey, uint8_t* outScalar,
+                      uint8_t* outPrefix) {
+  uint8_t h[Sha512::kDigestSize];
+  Sha512 sha;
+  sha.Update(privateKey, Ed25519::kPrivateKeySize);
+  sha.Finish(h);
+  h[0] &= 248;
+  h[31] &= 127;
+  h[31] |= 64;
+  memcpy(outScalar, h, 32);
+  memcpy(outPrefix, h + 32, 32);
+}
+
+}  // namespace
+
+void Ed25519::DerivePublicKey(const uint8_t* privateKey,
+                              uint8_t* outPublicKey) {
+  uint8_t a[32], prefix[32];
+  ExpandPrivateKey(privateKey, a, prefix);
+  Encode(outPublicKey, ScalarMultBase(a, GetConstants()));
+}
+
+void Ed25519::Sign(const uint8_t* privateKey, const void* msg, size_t len,
+                   uint8_t* outSignature) {
+  const Constants& k = GetConstants();
+
+  uint8_t a[32], prefix[32];
+  ExpandPrivateKey(privateKey, a, prefix);
+  uint8_t publicKey[kPublicKeySize];
+  Encode(publicKey, ScalarMultBase(a, k));
+
+  // r = SHA-512(prefix || msg) mod L, R = r * base
+  uint8_t h[Sha512::kDigestSize];
+  Sha512 sha;
+  sha.Update(prefix, sizeof(prefix));
+  sha.Update(msg, len);
+  sha.Finish(h);
+  uint8_t r[32];
+  ScReduce(h, r);
+  Encode(outSignature, ScalarMultBase(r, k));
+
+  // S = (r + k * a) mod L
+  uint8_t challenge[32];
+  ChallengeOf(outSignature, publicKey, msg, len, challenge);
+  ScMulAdd(challenge, a, r, outSignature + 32);
+}
+
+bool Ed25519::Verify(const uint8_t* publicKey, const void* msg, size_t len,
+                     const uint8_t* signature) {
+  const Constants& k = GetConstants();
+
+  const uint8_t* s = signature + 32;
+  if (!ScIsCanonical(s)) return false;
+
+  Point a, r;
+  if (!Decode(publicKey, k, a) || !Decode(signature, k, r)) return false;
+
+  // [8]([S]B - [k]A - R) should be the identity
+  std::vector<MultiScalarTerm> terms(1);
+  InitTerm(terms[0], Negate(a), k);
+  ChallengeOf(signature, publicKey, msg, len, terms[0].scalar);
+
+  Point p = MultiScalarMult(terms);
+  p = Add(p, ToCached(ScalarMultBase(s, k), k.d2));
+  p = Add(p, ToCached(Negate(r), k.d2));
+  for (int i = 0; i < 3; i++) p = Double(p);
+  return IsIdentity(p);
+}
+
+bool Ed25519::VerifyBatch(size_t n, const SignedMessage* msgs,
+                          const uint8_t* randomSeed) {
+  const Constants& k = GetConstants();
+  if (n == 0) return true;
+
+  // a term for -A_i (with scalar z_i * k_i) and a term for -R_i (with scalar
+  // z_i) of each signature
+  std::vector<MultiScalarTerm> terms(2 * n);
+  std::vector<uint8_t> challenges(32 * n);
+
+  Sha512 batchSha;  // the coefficients depend on all the signatures
+  for (size_t i = 0; i < n; i++) {
+    const SignedMessage& m = msgs[i];
+    if (!ScIsCanonical(m.signature + 32)) return false;
+
+    Point a, r;
+    if (!Decode(m.publicKey, k, a) || !Decode(m.signature, k, r)) return false;
+    InitTerm(terms[2 * i], Negate(a), k);
+    InitTerm(terms[2 * i + 1], Negate(r), k);
+
+    ChallengeOf(m.signature, m.publicKey, m.msg, m.len, &challenges[32 * i]);
+    batchSha.Update(m.signature, kSignatureSize);
+    batchSha.Update(&challenges[32 * i], 32);
+  }
+  uint8_t batchDigest[Sha512::kDigestSize];
+  batchSha.Finish(batchDigest);
+
+  // sum of z_i * S_i
+  const uint8_t zero[32] = {0};
+  uint8_t sumOfS[32] = {0};
+  for (size_t i = 0; i < n; i++) {
+    // z_i = the first 128 bits of SHA-512(seed || batchDigest || i)
+    uint8_t index[8];
+    StoreLittleEndian64(index, i);
+    uint8_t h[Sha512::kDigestSize];
+    Sha512 sha;
+    sha.Update(randomSeed, kBatchSeedSize);
+    sha.Update(batchDigest, sizeof(batchDigest));
+    sha.Update(index, sizeof(index));
+    sha.Finish(h);
+
+    uint8_t* const z = terms[2 * i + 1].scalar;
+    memcpy(z, h, 16);
+    memset(z + 16, 0, 16);
+
+    ScMulAdd(z, &challenges[32 * i], zero, terms[2 * i].scalar);
+    ScMulAdd(z, msgs[i].signature + 32, sumOfS, sumOfS);
+  }
+
+  // [8](sum of z_i * ([S_i]B - [k_i]A_i - R_i)) should be the identity
+  Point p = MultiScalarMult(terms);
+  p = Add(p, ToCached(ScalarMultBase(sumOfS, k), k.d2));
+  for (int i = 0; i < 3; i++) p = Double(p);
+  return IsIdentity(p);
+}
+
+}  // namespace concordUtil
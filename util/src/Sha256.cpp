@@ -0,0 +1,471 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the
+// LICENSE file.
+
+#include "Sha256.hpp"
+
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CONCORD_SHA256_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace concordUtil {
+
+namespace {
+
+const uint32_t kInitialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                   0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                   0x1f83d9ab, 0x5be0cd19};
+
+const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+const size_t kLanes = 8;  // of the multi-buffer implementation
+
+inline uint32_t LoadBigEndian32(const uint8_t* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void StoreBigEndian32(uint8_t* p, uint32_t x) {
+  p[0] = static_cast<uint8_t>(x >> 24);
+  p[1] = static_cast<uint8_t>(x >> 16);
+  p[2] = static_cast<uint8_t>(x >> 8);
+  p[3] = static_cast<uint8_t>(x);
+}
+
+inline uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+////////////////////////////////////////////////////////////////////////////////
+// Compression functions (process numBlocks blocks of 64 bytes)
+////////////////////////////////////////////////////////////////////////////////
+
+typedef void (*CompressFunc)(uint32_t* state, const uint8_t* data,
+                             size_t numBlocks);
+
+// processes one block of each of the kLanes messages
+typedef void (*CompressManyFunc)(uint32_t* const* states,
+                                 const uint8_t* const* data, size_t numBlocks);
+
+void CompressGeneric(uint32_t* state, const uint8_t* data, size_t numBlocks) {
+  uint32_t w[64];
+  for (; numBlocks > 0; numBlocks--, data += 64) {
+    for (int t = 0; t < 16; t++) w[t] = LoadBigEndian32(data + 4 * t);
+    for (int t = 16; t < 64; t++) {
+      const uint32_t s0 =
+          Rotr(w[t - 15], 7) ^ Rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+      const uint32_t s1 =
+          Rotr(w[t - 2], 17) ^ Rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+      w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int t = 0; t < 64; t++) {
+      const uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+      const uint32_t ch = (e & f) ^ (~e & g);
+      const uint32_t t1 = h + s1 + ch + kRoundConstants[t] + w[t];
+      const uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+      const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + s0 + maj;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#ifdef CONCORD_SHA256_X86
+
+// the SHA extensions process 4 rounds (with 4 message words) per
+// _mm_sha256rnds2_epu32 pair; the state is kept as ABEF and CDGH
+__attribute__((target("sha,sse4.1"))) void CompressShaNi(uint32_t* state,
+                                                          const uint8_t* data,
+                                                          size_t numBlocks) {
+  const __m128i byteSwap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+  __m128i state1 =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);                // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1B);          // EFGH
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+  for (; numBlocks > 0; numBlocks--, data += 64) {
+    const __m128i abefSave = state0;
+    const __m128i cdghSave = state1;
+
+    __m128i w[16];  // groups of 4 message words
+    for (int g = 0; g < 16; g++) {
+      if (g < 4) {
+        w[g] = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * g)),
+            byteSwap);
+      } else {
+        __m128i x = _mm_sha256msg1_epu32(w[g - 4], w[g - 3]);
+        x = _mm_add_epi32(x, _mm_alignr_epi8(w[g - 1], w[g - 2], 4));
+        w[g] = _mm_sha256msg2_epu32(x, w[g - 1]);
+      }
+
+      __m128i msg = _mm_add_epi32(
+          w[g], _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(&kRoundConstants[4 * g])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);     // ABEF
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+#define CONCORD_ROTR256(x, n) \
+  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+// lane i of each vector belongs to message i
+__attribute__((target("avx2"))) void CompressManyAvx2(
+    uint32_t* const* states, const uint8_t* const* data, size_t numBlocks) {
+  __m256i s[8];
+  for (int j = 0; j < 8; j++) {
+    s[j] = _mm256_setr_epi32(states[0][j], states[1][j], states[2][j],
+                             states[3][j], states[4][j], states[5][j],
+                             states[6][j], states[7][j]);
+  }
+
+  __m256i w[64];
+  for (size_t offset = 0; offset < numBlocks * 64; offset += 64) {
+    for (int t = 0; t < 16; t++) {
+      const size_t o = offset + 4 * t;
+      w[t] = _mm256_setr_epi32(
+          LoadBigEndian32(data[0] + o), LoadBigEndian32(data[1] + o),
+          LoadBigEndian32(data[2] + o), LoadBigEndian32(data[3] + o),
+          LoadBigEndian32(data[4] + o), LoadBigEndian32(data[5] + o),
+          LoadBigEndian32(data[6] + o), LoadBigEndian32(data[7] + o));
+    }
+    for (int t = 16; t < 64; t++) {
+      const __m256i s0 = _mm256_xor_si256(
+          _mm256_xor_si256(CONCORD_ROTR256(w[t - 15], 7),
+                           CONCORD_ROTR256(w[t - 15], 18)),
+          _mm256_srli_epi32(w[t - 15], 3));
+      const __m256i s1 = _mm256_xor_si256(
+          _mm256_xor_si256(CONCORD_ROTR256(w[t - 2], 17),
+                           CONCORD_ROTR256(w[t - 2], 19)),
+          _mm256_srli_epi32(w[t - 2], 10));
+      w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0),
+                              _mm256_add_epi32(w[t - 7], s1));
+    }
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+    __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 64; t++) {
+      const __m256i s1 = _mm256_xor_si256(
+          _mm256_xor_si256(CONCORD_ROTR256(e, 6), CONCORD_ROTR256(e, 11)),
+          CONCORD_ROTR256(e, 25));
+      const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f),
+                                          _mm256_andnot_si256(e, g));
+      const __m256i t1 = _mm256_add_epi32(
+          _mm256_add_epi32(_mm256_add_epi32(h, s1), ch),
+          _mm256_add_epi32(
+              _mm256_set1_epi32(static_cast<int>(kRoundConstants[t])), w[t]));
+      const __m256i s0 = _mm256_xor_si256(
+          _mm256_xor_si256(CONCORD_ROTR256(a, 2), CONCORD_ROTR256(a, 13)),
+          CONCORD_ROTR256(a, 22));
+      const __m256i maj = _mm256_xor_si256(
+          _mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+          _mm256_and_si256(b, c));
+      h = g;
+      g = f;
+      f = e;
+      e = _mm256_add_epi32(d, t1);
+      d = c;
+      c = b;
+      b = a;
+      a = _mm256_add_epi32(t1, _mm256_add_epi32(s0, maj));
+    }
+    s[0] = _mm256_add_epi32(s[0], a);
+    s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c);
+    s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e);
+    s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g);
+    s[7] = _mm256_add_epi32(s[7], h);
+  }
+
+  for (int j = 0; j < 8; j++) {
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), s[j]);
+    for (size_t i = 0; i < kLanes; i++) states[i][j] = lanes[i];
+  }
+}
+
+#undef CONCORD_ROTR256
+
+bool CpuSupports(Sha256::Implementation impl) {
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+  const bool ssse3 = (ecx & (1u << 9)) != 0;
+  const bool sse41 = (ecx & (1u << 19)) != 0;
+  const bool osxsave = (ecx & (1u << 27)) != 0;
+  const bool avx = (ecx & (1u << 28)) != 0;
+
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+  const bool avx2 = (ebx & (1u << 5)) != 0;
+  const bool sha = (ebx & (1u << 29)) != 0;
+
+  if (impl == Sha256::kShaNi) return sha && ssse3 && sse41;
+
+  if (impl == Sha256::kAvx2MultiBuffer) {
+    if (!avx2 || !avx || !osxsave) return false;
+    // the OS saves the YMM registers
+    uint32_t xcr0Low = 0, xcr0High = 0;
+    __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    return (xcr0Low & 0x6) == 0x6;
+  }
+
+  return true;
+}
+
+#else
+
+bool CpuSupports(Sha256::Implementation impl) {
+  return (impl == Sha256::kGeneric);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Dispatching
+////////////////////////////////////////////////////////////////////////////////
+
+struct Dispatch {
+  Sha256::Implementation impl;
+  CompressFunc compress;
+  CompressManyFunc compressMany;  // nullptr if batches are not faster
+};
+
+Dispatch MakeDispatch(Sha256::Implementation impl) {
+  Dispatch d = {Sha256::kGeneric, &CompressGeneric, nullptr};
+#ifdef CONCORD_SHA256_X86
+  if (impl == Sha256::kShaNi) {
+    d.impl = impl;
+    d.compress = &CompressShaNi;
+  } else if (impl == Sha256::kAvx2MultiBuffer) {
+    d.impl = impl;
+    d.compressMany = &CompressManyAvx2;
+  }
+#endif
+  return d;
+}
+
+Dispatch& CurrentDispatch() {
+  static Dispatch d = MakeDispatch(
+      CpuSupports(Sha256::kShaNi)
+          ? Sha256::kShaNi
+          : (CpuSupports(Sha256::kAvx2MultiBuffer) ? Sha256::kAvx2MultiBuffer
+                                                  : Sha256::kGeneric));
+  return d;
+}
+
+}  // namespace
+
+void Sha256::Reset() {
+  memcpy(state_, kInitialState, sizeof(state_));
+  length_ = 0;
+  bufferLength_ = 0;
+}
+
+void Sha256::Update(const void* data, size_t len) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  length_ += len;
+
+  if (bufferLength_ > 0) {
+    const size_t n = (len < 64 - bufferLength_) ? len : (64 - bufferLength_);
+    memcpy(buffer_ + bufferLength_, p, n);
+    bufferLength_ += n;
+    p += n;
+    len -= n;
+    if (bufferLength_ < 64) return;
+    CurrentDispatch().compress(state_, buffer_, 1);
+    bufferLength_ = 0;
+  }
+
+  if (len >= 64) {
+    const size_t numBlocks = len / 64;
+    CurrentDispatch().compress(state_, p, numBlocks);
+    p += numBlocks * 64;
+    len -= numBlocks * 64;
+  }
+
+  if (len > 0) {
+    memcpy(buffer_, p, len);
+    bufferLength_ = len;
+  }
+}
+
+void Sha256::Finish(void* outDigest) {
+  const uint64_t bitLength = length_ * 8;
+
+  buffer_[bufferLength_++] = 0x80;
+  if (bufferLength_ > 56) {
+    memset(buffer_ + bufferLength_, 0, 64 - bufferLength_);
+    CurrentDispatch().compress(state_, buffer_, 1);
+    bufferLength_ = 0;
+  }
+  memset(buffer_ + bufferLength_, 0, 56 - bufferLength_);
+  StoreBigEndian32(buffer_ + 56, static_cast<uint32_t>(bitLength >> 32));
+  StoreBigEndian32(buffer_ + 60, static_cast<uint32_t>(bitLength));
+  CurrentDispatch().compress(state_, buffer_, 1);
+  bufferLength_ = 0;
+
+  uint8_t* out = static_cast<uint8_t*>(outDigest);
+  for (int i = 0; i < 8; i++) StoreBigEndian32(out + 4 * i, state_[i]);
+}
+
+void Sha256::Compute(const void* data, size_t len, void* outDigest) {
+  Sha256 c;
+  c.Update(data, len);
+  c.Finish(outDigest);
+}
+
+void Sha256::UpdateMany(size_t n, Sha256* const* contexts,
+                        const void* const* data, const size_t* lengths) {
+  const CompressManyFunc compressMany = CurrentDispatch().compressMany;
+
+  for (size_t first = 0; first < n; first += kLanes) {
+    const size_t numOfLanes = (n - first < kLanes) ? (n - first) : kLanes;
+    const uint8_t* p[kLanes];
+    size_t len[kLanes];
+
+    // complete the partial blocks, so each message continues at the beginning
+    // of a block
+    for (size_t i = 0; i < numOfLanes; i++) {
+      Sha256* c = contexts[first + i];
+      p[i] = static_cast<const uint8_t*>(data[first + i]);
+      len[i] = lengths[first + i];
+      if (c->bufferLength_ > 0) {
+        const size_t fill = 64 - c->bufferLength_;
+        const size_t n1 = (len[i] < fill) ? len[i] : fill;
+        c->Update(p[i], n1);
+        p[i] += n1;
+        len[i] -= n1;
+      }
+    }
+
+    // the blocks that all the messages have are processed together
+    size_t numBlocks =
+        (compressMany != nullptr && numOfLanes > 1) ? SIZE_MAX : 0;
+    for (size_t i = 0; i < numOfLanes && numBlocks > 0; i++) {
+      if (contexts[first + i]->bufferLength_ > 0)
+        numBlocks = 0;
+      else if (len[i] / 64 < numBlocks)
+        numBlocks = len[i] / 64;
+    }
+
+    if (numBlocks > 0) {
+      uint32_t unusedStates[kLanes][8] = {};
+      uint32_t* states[kLanes];
+      const uint8_t* lanesData[kLanes];
+      for (size_t i = 0; i < kLanes; i++) {
+        // unused lanes process (again) the first message
+        states[i] = (i < numOfLanes) ? contexts[first + i]->state_
+                                     : unusedStates[i];
+        lanesData[i] = (i < numOfLanes) ? p[i] : p[0];
+      }
+      compressMany(states, lanesData, numBlocks);
+
+      for (size_t i = 0; i < numOfLanes; i++) {
+        contexts[first + i]->length_ += numBlocks * 64;
+        p[i] += numBlocks * 64;
+        len[i] -= numBlocks * 64;
+      }
+    }
+
+    for (size_t i = 0; i < numOfLanes; i++)
+      contexts[first + i]->Update(p[i], len[i]);
+  }
+}
+
+void Sha256::ComputeMany(size_t n, const void* const* inputs,
+                         const size_t* lengths, void* const* outDigests) {
+  Sha256 contexts[kLanes];
+  Sha256* ptrs[kLanes];
+  for (size_t i = 0; i < kLanes; i++) ptrs[i] = &contexts[i];
+
+  for (size_t first = 0; first < n; first += kLanes) {
+    const size_t numOfLanes = (n - first < kLanes) ? (n - first) : kLanes;
+    for (size_t i = 0; i < numOfLanes; i++) contexts[i].Reset();
+    UpdateMany(numOfLanes, ptrs, inputs + first, lengths + first);
+    for (size_t i = 0; i < numOfLanes; i++)
+      contexts[i].Finish(outDigests[first + i]);
+  }
+}
+
+Sha256::Implementation Sha256::CurrentImplementation() {
+  return CurrentDispatch().impl;
+}
+
+const char* Sha256::ImplementationName(Implementation impl) {
+  switch (impl) {
+    case kShaNi:
+      return "sha-ni";
+    case kAvx2MultiBuffer:
+      return "avx2-multi-buffer";
+    default:
+      return "generic";
+  }
+}
+
+bool Sha256::SetImplementation(Implementation impl) {
+  if (!CpuSupports(impl)) return false;
+  CurrentDispatch() = MakeDispatch(impl);
+  return true;
+}
+
+}  // namespace concordUtil
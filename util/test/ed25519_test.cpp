@@ -0,0 +1,210 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+//
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "Ed25519.hpp"
+
+using namespace std;
+
+namespace concordUtil {
+
+static string ToHex(const string& bytes) {
+  string s;
+  char buf[3];
+  for (unsigned char c : bytes) {
+    snprintf(buf, sizeof(buf), "%02x", c);
+    s += buf;
+  }
+  return s;
+}
+
+static string FromHex(const string& hex) {
+  string bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2)
+    bytes += static_cast<char>(stoi(hex.substr(i, 2), nullptr, 16));
+  return bytes;
+}
+
+static const uint8_t* Bytes(const string& s) {
+  return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+struct TestVector {
+  const char* privateKey;
+  const char* publicKey;
+  const char* msg;
+  const char* signature;
+};
+
+// the first 3 vectors are from RFC 8032 (section 7.1)
+static const TestVector kTestVectors[] = {
+    {"9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+     "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a", "",
+     "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+     "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b"},
+    {"4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+     "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c", "72",
+     "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+     "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00"},
+    {"c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+     "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+     "af82",
+     "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac"
+     "18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a"},
+    {"4d4896f9e17fd8f0816496da087a3ebecc676aaa2c5d8ce1b3c6acbc5f1670a9",
+     "142f3d620838ba973873f3ea2934cf7f739c9d39596640b8369aacb87245f44c",
+     "821bc72985d7645e7dbb07780b4eb4d9fb9d979464a52b2b803afb03c5338aebdc8c3b"
+     "678358f3d8935a75e844a88c9bf5ba0162c8dbd2f4e2f0bd83cf2184c78f346df30e7b"
+     "de5d918d33f081697cd05b6a5800898a9fc99c54759907cd3aa22d8c952e",
+     "3d537fdeb7677bb0758b71e9000746b7dc4aa00663508deb58d4c87ed19ee3f0"
+     "7d1dab4625903df99e22f5ab6d915f167530b5460766d6cb3fce114c8289ba0d"},
+    {"dc17cc8dccd9d1ee4108d7f1ac1215de047303c1c1473f441ccc9f2f584a112a",
+     "c5fed586dcc633268624ad10221ada86639a00a43a347a5c89ac1ce56c6fa125",
+     "284187f32ba845a5b64b74b3527f791d064f62576bcb30421b40e6ba82fa35f79b6ed1"
+     "f9053904652509b8f52972b481ad6d8bd538faf9a1ccb184733986a60765ac93cd52a8"
+     "a16d0fbc4c20f736e00c4e12db134feaf04cbe286a904021028fe0d90997d137f6e691"
+     "752bd3dedef9c7b49f8209603358193492ace56e97317e1af0aa634b817f04539cdf66"
+     "e648042833db53cffc90c822566d3644ac18d661ee8c58eae1d6af887cc4fc883c10b9"
+     "0a15222b2ae9893644c2559981d7415e56571d4a3cdef19ac7",
+     "69cc08392e350e5354d69dbd2abd78e6c35d47c806fdcc8e77bde141730da565"
+     "5ba465b2630f7385d3e2d286d66a0108dbae27ff194da083ac10c0414e8a4605"},
+};
+
+// a key pair, and signed messages
+struct Signer {
+  explicit Signer(char seed) : privateKey(Ed25519::kPrivateKeySize, seed) {
+    publicKey.resize(Ed25519::kPublicKeySize);
+    Ed25519::DerivePublicKey(Bytes(privateKey),
+                             reinterpret_cast<uint8_t*>(&publicKey[0]));
+  }
+
+  string Sign(const string& msg) const {
+    string sig(Ed25519::kSignatureSize, 0);
+    Ed25519::Sign(Bytes(privateKey), msg.data(), msg.size(),
+                  reinterpret_cast<uint8_t*>(&sig[0]));
+    return sig;
+  }
+
+  string privateKey;
+  string publicKey;
+};
+
+static bool Verify(const string& publicKey, const string& msg,
+                   const string& sig) {
+  return Ed25519::Verify(Bytes(publicKey), msg.data(), msg.size(), Bytes(sig));
+}
+
+static const string kSeed(Ed25519::kBatchSeedSize, 's');
+
+// verifies the batch of (signers[i], msgs[i], sigs[i])
+static bool VerifyBatch(const vector<const Signer*>& signers,
+                        const vector<string>& msgs, const vector<string>& sigs,
+                        const string& seed = kSeed) {
+  vector<Ed25519::SignedMessage> batch;
+  for (size_t i = 0; i < msgs.size(); i++)
+    batch.push_back(Ed25519::SignedMessage{Bytes(signers[i]->publicKey),
+                                           msgs[i].data(), msgs[i].size(),
+                                           Bytes(sigs[i])});
+  return Ed25519::VerifyBatch(batch.size(), batch.data(), Bytes(seed));
+}
+
+TEST(Ed25519Test, KnownAnswers) {
+  for (const TestVector& v : kTestVectors) {
+    const string privateKey = FromHex(v.privateKey);
+    const string msg = FromHex(v.msg);
+
+    string publicKey(Ed25519::kPublicKeySize, 0);
+    Ed25519::DerivePublicKey(Bytes(privateKey),
+                             reinterpret_cast<uint8_t*>(&publicKey[0]));
+    ASSERT_EQ(v.publicKey, ToHex(publicKey));
+
+    string sig(Ed25519::kSignatureSize, 0);
+    Ed25519::Sign(Bytes(privateKey), msg.data(), msg.size(),
+                  reinterpret_cast<uint8_t*>(&sig[0]));
+    ASSERT_EQ(v.signature, ToHex(sig));
+
+    ASSERT_TRUE(Verify(publicKey, msg, sig));
+  }
+}
+
+TEST(Ed25519Test, InvalidSignaturesAreRejected) {
+  const Signer signer('a'), other('b');
+  const string msg = "message";
+  const string sig = signer.Sign(msg);
+  ASSERT_TRUE(Verify(signer.publicKey, msg, sig));
+
+  ASSERT_FALSE(Verify(other.publicKey, msg, sig));
+  ASSERT_FALSE(Verify(signer.publicKey, "messagE", sig));
+  for (size_t i = 0; i < sig.size(); i += 7) {
+    string corrupted = sig;
+    corrupted[i] ^= 4;
+    ASSERT_FALSE(Verify(signer.publicKey, msg, corrupted));
+  }
+
+  // S + L is an equivalent, but non-canonical, scalar
+  const string kL = FromHex(
+      "edd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010");
+  string nonCanonical = sig;
+  int carry = 0;
+  for (size_t i = 0; i < 32; i++) {
+    const int sum = (uint8_t)sig[32 + i] + (uint8_t)kL[i] + carry;
+    nonCanonical[32 + i] = static_cast<char>(sum & 255);
+    carry = sum >> 8;
+  }
+  ASSERT_FALSE(Verify(signer.publicKey, msg, nonCanonical));
+
+  // a public key that is not on the curve (y = 2)
+  string notOnCurve(Ed25519::kPublicKeySize, 0);
+  notOnCurve[0] = 2;
+  ASSERT_FALSE(Verify(notOnCurve, msg, sig));
+}
+
+TEST(Ed25519Test, Batches) {
+  vector<Signer> signers;
+  for (char c = 'a'; c < 'e'; c++) signers.push_back(Signer(c));
+
+  vector<const Signer*> batchSigners;
+  vector<string> msgs, sigs;
+  ASSERT_TRUE(VerifyBatch(batchSigners, msgs, sigs));
+
+  // signatures of several signers (some of them sign several messages)
+  for (size_t i = 0; i < 13; i++) {
+    batchSigners.push_back(&signers[i % signers.size()]);
+    msgs.push_back(string(i * 10, 'a' + i));
+    sigs.push_back(batchSigners.back()->Sign(msgs.back()));
+    ASSERT_TRUE(VerifyBatch(batchSigners, msgs, sigs));
+    ASSERT_TRUE(VerifyBatch(batchSigners, msgs, sigs, string(32, 't')));
+  }
+
+  // a single invalid signature fails the batch
+  for (size_t i = 0; i < msgs.size(); i++) {
+    vector<string> corrupted = sigs;
+    corrupted[i][i % 64] ^= 1;
+    ASSERT_FALSE(VerifyBatch(batchSigners, msgs, corrupted));
+
+    vector<string> otherMsgs = msgs;
+    otherMsgs[i] += "!";
+    ASSERT_FALSE(VerifyBatch(batchSigners, otherMsgs, sigs));
+  }
+
+  // two invalid signatures that would cancel out in a plain sum
+  vector<string> swapped = sigs;
+  swap(swapped[0], swapped[1]);
+  ASSERT_FALSE(VerifyBatch(batchSigners, msgs, swapped));
+}
+
+}  // namespace concordUtil
@@ -0,0 +1,135 @@
+// Concord
+//
+// Copyright (c) 2019 VMware, Inc. All Rights Reserved.
+//
+// This product is licensed to you under the Apache 2.0 license (the "License").
+// You may not use this product except in compliance with the Apache 2.0
+// License.
+//
+// This product may include a number of subcomponents with separate copyright
+// notices and license terms. Your use of these subcomponents is subject to the
+// terms and conditions of the subcomponent's license, as noted in the LICENSE
+// file.
+//
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "Sha256.hpp"
+
+using namespace std;
+
+namespace concordUtil {
+
+static string ToHex(const unsigned char* digest) {
+  string s;
+  char buf[3];
+  for (size_t i = 0; i < Sha256::kDigestSize; i++) {
+    snprintf(buf, sizeof(buf), "%02x", digest[i]);
+    s += buf;
+  }
+  return s;
+}
+
+static string Digest(const string& input) {
+  unsigned char digest[Sha256::kDigestSize];
+  Sha256::Compute(input.data(), input.size(), digest);
+  return ToHex(digest);
+}
+
+static const Sha256::Implementation kAllImplementations[] = {
+    Sha256::kGeneric, Sha256::kShaNi, Sha256::kAvx2MultiBuffer};
+
+// runs the test with each implementation that the CPU supports
+class Sha256Test : public ::testing::TestWithParam<Sha256::Implementation> {
+ protected:
+  void SetUp() override {
+    previous_ = Sha256::CurrentImplementation();
+    supported_ = Sha256::SetImplementation(GetParam());
+  }
+
+  void TearDown() override { Sha256::SetImplementation(previous_); }
+
+  Sha256::Implementation previous_;
+  bool supported_ = false;
+};
+
+TEST_P(Sha256Test, KnownAnswers) {
+  if (!supported_) return;
+
+  ASSERT_EQ(
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      Digest(""));
+  ASSERT_EQ(
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      Digest("abc"));
+  ASSERT_EQ(
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      Digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+  ASSERT_EQ(
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+      Digest(string(1000000, 'a')));
+}
+
+TEST_P(Sha256Test, IncrementalUpdates) {
+  if (!supported_) return;
+
+  string input;
+  for (int i = 0; i < 1000; i++) input += static_cast<char>(i * 7);
+
+  for (size_t split = 0; split <= input.size(); split += 37) {
+    Sha256 c;
+    c.Update(input.data(), split);
+    c.Update(input.data() + split, input.size() - split);
+    unsigned char digest[Sha256::kDigestSize];
+    c.Finish(digest);
+    ASSERT_EQ(Digest(input), ToHex(digest));
+  }
+}
+
+TEST_P(Sha256Test, ManyMessages) {
+  if (!supported_) return;
+
+  // messages of different lengths (and some of equal lengths), each one after
+  // a different prefix
+  vector<string> messages;
+  for (size_t i = 0; i < 21; i++)
+    messages.push_back(string((i % 3 == 0) ? 4096 : i * 100, 'a' + i));
+
+  vector<const void*> inputs;
+  vector<size_t> lengths;
+  for (const string& m : messages) {
+    inputs.push_back(m.data());
+    lengths.push_back(m.size());
+  }
+
+  vector<Sha256> contexts(messages.size());
+  vector<Sha256*> contextPtrs;
+  for (size_t i = 0; i < contexts.size(); i++) {
+    contexts[i].Update("prefix", i % 7);
+    contextPtrs.push_back(&contexts[i]);
+  }
+  Sha256::UpdateMany(messages.size(), contextPtrs.data(), inputs.data(),
+                     lengths.data());
+
+  vector<unsigned char> digests(messages.size() * Sha256::kDigestSize);
+  vector<void*> outDigests;
+  for (size_t i = 0; i < messages.size(); i++)
+    outDigests.push_back(&digests[i * Sha256::kDigestSize]);
+  Sha256::ComputeMany(messages.size(), inputs.data(), lengths.data(),
+                      outDigests.data());
+
+  for (size_t i = 0; i < messages.size(); i++) {
+    unsigned char digest[Sha256::kDigestSize];
+    contexts[i].Finish(digest);
+    ASSERT_EQ(Digest(string("prefix", i % 7) + messages[i]), ToHex(digest));
+    ASSERT_EQ(Digest(messages[i]),
+              ToHex(static_cast<unsigned char*>(outDigests[i])));
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(AllImplementations, Sha256Test,
+                        ::testing::ValuesIn(kAllImplementations));
+
+}  // namespace concordUtil